@@ -0,0 +1,402 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - ANALISE DO LOG DE EVENTOS
+// ============================================================================
+//
+// Lê os logs binários gravados por `war --simular N --eventos ARQUIVO` e
+// calcula, em paralelo, os agregados de balanceamento: taxa de conquista por
+// razão de tropas (atacante / defensor), duração média das partidas e
+// sucesso das missões por TipoMissao.
+//
+// Cada arquivo é mapeado em memória (mmap) e os registros de tamanho fixo são
+// lidos direto do mapeamento, sem interpretação de texto nem alocação por
+// evento. Como todo registro é completo por si só, o arquivo é dividido em
+// fatias iguais, uma por thread; cada thread soma na sua própria cópia dos
+// agregados, e as cópias são somadas no fim.
+//
+// Compilação (na mesma pasta de war.c):
+//   gcc -std=c11 -O2 -Wall -Wextra -pthread analisar_eventos.c -o analisar_eventos -lm
+// Uso:
+//   ./war --simular 1000000 --eventos eventos.bin
+//   ./analisar_eventos eventos.bin [--threads N]
+//
+// ============================================================================
+
+#define WAR_SEM_MAIN
+#include "war.c"
+
+// --- Constantes da Análise ---
+#define NUM_TIPOS_MISSAO 4          // Valores de TipoMissao
+#define NUM_MODOS_ATAQUE 2          // Valores de ModoAtaque
+#define NUM_FAIXAS_RAZAO 8          // Faixas de razão de tropas (ver LIMITES_RAZAO)
+#define MAX_THREADS_ANALISE 256     // Limite de --threads
+
+// Limites superiores (numerador, denominador) das faixas de razão atacante / defensor;
+// a última faixa não tem limite. Comparados em inteiros: a / d < n / m  <=>  a * m < n * d
+static const int LIMITES_RAZAO[NUM_FAIXAS_RAZAO - 1][2] = {
+    { 1, 2 }, { 1, 1 }, { 3, 2 }, { 2, 1 }, { 3, 1 }, { 5, 1 }, { 10, 1 }
+};
+static const char* const NOMES_FAIXAS_RAZAO[NUM_FAIXAS_RAZAO] = {
+    "< 0,5", "0,5 a 1", "1 a 1,5", "1,5 a 2", "2 a 3", "3 a 5", "5 a 10", ">= 10"
+};
+static const char* const NOMES_MODOS_ATAQUE[NUM_MODOS_ATAQUE] = { "rodada", "blitz" };
+static const char* const NOMES_TIPOS_MISSAO[NUM_TIPOS_MISSAO] = {
+    "Conquistar continente", "Eliminar cor", "Controlar territorios", "Sobreviver turnos"
+};
+
+// --- Estruturas de Dados ---
+/**
+ * @brief Agregados de um trecho do log (de uma thread ou, somados, de todos)
+ */
+typedef struct {
+    uint64_t eventos;                                           // Registros lidos
+    uint64_t desconhecidos;                                     // Registros de tipo desconhecido (ignorados)
+    uint64_t ataques[NUM_MODOS_ATAQUE][NUM_FAIXAS_RAZAO];       // Rodadas ou batalhas em cada faixa
+    uint64_t conquistas[NUM_MODOS_ATAQUE][NUM_FAIXAS_RAZAO];    // Das quais terminaram em conquista
+    uint64_t perdasAtacante[NUM_MODOS_ATAQUE][NUM_FAIXAS_RAZAO];
+    uint64_t perdasDefensor[NUM_MODOS_ATAQUE][NUM_FAIXAS_RAZAO];
+    uint64_t reforcos;                                          // Reforços de uma cor
+    uint64_t tropasReforco;                                     // Tropas distribuídas nesses reforços
+    uint64_t missoesAtribuidas[NUM_TIPOS_MISSAO];
+    uint64_t verificacoesMissao[NUM_TIPOS_MISSAO];
+    uint64_t missoesCumpridas[NUM_TIPOS_MISSAO];                // Verificações que cumpriram a missão (uma por missão cumprida)
+    uint64_t vitoriasMissao[NUM_TIPOS_MISSAO];                  // Partidas vencidas por missão desse tipo
+    uint64_t partidas;                                          // Eventos de fim de partida
+    uint64_t totalTurnos;
+    int32_t minTurnos;
+    int32_t maxTurnos;
+    uint64_t fimPorTipo[3];                                     // Partidas por TipoFimPartida
+    uint64_t vitoriasPorCor[MAX_CORES];
+} AgregadosEventos;
+
+/**
+ * @brief Fatia do log analisada por uma thread
+ */
+typedef struct {
+    _Alignas(ALINHAMENTO_MAPA) const RegistroEvento* registros;
+    size_t numRegistros;
+    AgregadosEventos agregados;
+} FatiaAnalise;
+
+/**
+ * @brief Opções de linha de comando da análise
+ */
+typedef struct {
+    int numThreads;                     // Threads por arquivo
+    int numArquivos;
+    char** arquivos;                    // Caminhos dos logs (argv)
+} OpcoesAnalise;
+
+// ============================================================================
+// AGREGACAO
+// ============================================================================
+
+static void zerarAgregados(AgregadosEventos* agregados) {
+    memset(agregados, 0, sizeof(*agregados));
+    agregados->minTurnos = INT32_MAX;
+}
+
+// Faixa da razão tropas do atacante / tropas do defensor
+static inline int faixaRazao(int32_t atacante, int32_t defensor) {
+    int faixa = 0;
+    while (faixa < NUM_FAIXAS_RAZAO - 1 &&
+           (int64_t)atacante * LIMITES_RAZAO[faixa][1] >= (int64_t)LIMITES_RAZAO[faixa][0] * defensor) {
+        faixa++;
+    }
+    return faixa;
+}
+
+static inline void acumularEvento(AgregadosEventos* agregados, const RegistroEvento* registro) {
+    agregados->eventos++;
+    switch (registro->tipo) {
+        case EVENTO_ATAQUE: {
+            int modo = registro->detalhe;
+            if (modo >= NUM_MODOS_ATAQUE || registro->valores[1] <= 0) {
+                break;
+            }
+            int faixa = faixaRazao(registro->valores[0], registro->valores[1]);
+            agregados->ataques[modo][faixa]++;
+            agregados->conquistas[modo][faixa] += (registro->valores[3] == registro->valores[1]);
+            agregados->perdasAtacante[modo][faixa] += (uint64_t)registro->valores[2];
+            agregados->perdasDefensor[modo][faixa] += (uint64_t)registro->valores[3];
+            break;
+        }
+        case EVENTO_REFORCO:
+            agregados->reforcos++;
+            agregados->tropasReforco += (uint64_t)registro->valores[0];
+            break;
+        case EVENTO_MISSAO_ATRIBUIDA:
+            if (registro->detalhe < NUM_TIPOS_MISSAO) {
+                agregados->missoesAtribuidas[registro->detalhe]++;
+            }
+            break;
+        case EVENTO_MISSAO_VERIFICADA:
+            if (registro->detalhe < NUM_TIPOS_MISSAO) {
+                agregados->verificacoesMissao[registro->detalhe]++;
+                agregados->missoesCumpridas[registro->detalhe] += (registro->valores[1] != 0);
+            }
+            break;
+        case EVENTO_FIM_PARTIDA: {
+            int32_t turnos = registro->valores[0];
+            agregados->partidas++;
+            agregados->totalTurnos += (uint64_t)turnos;
+            if (turnos < agregados->minTurnos) agregados->minTurnos = turnos;
+            if (turnos > agregados->maxTurnos) agregados->maxTurnos = turnos;
+            if (registro->detalhe < 3) {
+                agregados->fimPorTipo[registro->detalhe]++;
+            }
+            if (registro->cor < MAX_CORES) {
+                agregados->vitoriasPorCor[registro->cor]++;
+            }
+            if (registro->valores[1] >= 0 && registro->valores[1] < NUM_TIPOS_MISSAO) {
+                agregados->vitoriasMissao[registro->valores[1]]++;
+            }
+            break;
+        }
+        default:
+            agregados->desconhecidos++;
+            break;
+    }
+}
+
+static void somarAgregados(AgregadosEventos* total, const AgregadosEventos* parcial) {
+    // Todos os campos antes de minTurnos são contadores de 64 bits
+    const uint64_t* origem = (const uint64_t*)parcial;
+    uint64_t* destino = (uint64_t*)total;
+    for (size_t i = 0; i < offsetof(AgregadosEventos, minTurnos) / sizeof(uint64_t); i++) {
+        destino[i] += origem[i];
+    }
+    if (parcial->minTurnos < total->minTurnos) total->minTurnos = parcial->minTurnos;
+    if (parcial->maxTurnos > total->maxTurnos) total->maxTurnos = parcial->maxTurnos;
+    for (int f = 0; f < 3; f++) {
+        total->fimPorTipo[f] += parcial->fimPorTipo[f];
+    }
+    for (int c = 0; c < MAX_CORES; c++) {
+        total->vitoriasPorCor[c] += parcial->vitoriasPorCor[c];
+    }
+}
+
+// Corpo de cada thread: percorre a sua fatia direto do mapeamento
+static void* analisarFatia(void* argumento) {
+    FatiaAnalise* fatia = (FatiaAnalise*)argumento;
+    zerarAgregados(&fatia->agregados);
+    for (size_t i = 0; i < fatia->numRegistros; i++) {
+        acumularEvento(&fatia->agregados, &fatia->registros[i]);
+    }
+    return NULL;
+}
+
+// Mapeia, confere e analisa um arquivo; retorna 0 em caso de erro (já informado).
+// threadsUsadas recebe quantas threads analisaram o arquivo (no máximo uma por registro)
+static int analisarArquivo(const char* caminho, int numThreads, AgregadosEventos* total, CabecalhoEventos* cabecalho,
+                           int* threadsUsadas) {
+    size_t tamanho = 0;
+    void* base = mapearArquivo(caminho, &tamanho);
+    if (base == NULL) {
+        fprintf(stderr, "[ERRO] Nao foi possivel abrir '%s'.\n", caminho);
+        return 0;
+    }
+
+    const char* erro = NULL;
+    if (tamanho < sizeof(CabecalhoEventos)) {
+        erro = "arquivo menor que o cabecalho";
+    } else {
+        memcpy(cabecalho, base, sizeof(*cabecalho));
+        if (memcmp(cabecalho->assinatura, ASSINATURA_EVENTOS, sizeof(cabecalho->assinatura)) != 0) {
+            erro = "nao e um log de eventos";
+        } else if (cabecalho->versao != VERSAO_EVENTOS || cabecalho->tamanhoRegistro != sizeof(RegistroEvento)) {
+            erro = "versao do formato diferente desta analise";
+        } else if (cabecalho->numRegistros == 0 && tamanho > sizeof(CabecalhoEventos)) {
+            erro = "log incompleto (a simulacao nao terminou)";
+        } else if (cabecalho->numRegistros != (tamanho - sizeof(CabecalhoEventos)) / sizeof(RegistroEvento) ||
+                   (tamanho - sizeof(CabecalhoEventos)) % sizeof(RegistroEvento) != 0) {
+            erro = "tamanho do arquivo nao confere com o cabecalho";
+        }
+    }
+    if (erro != NULL) {
+        fprintf(stderr, "[ERRO] %s: %s.\n", caminho, erro);
+        liberarMapeamento(base, tamanho);
+        return 0;
+    }
+
+    // Os registros começam logo após o cabecalho (48 bytes: alinhamento de 8 preservado)
+    const RegistroEvento* registros = (const RegistroEvento*)((const char*)base + sizeof(CabecalhoEventos));
+    size_t numRegistros = (size_t)cabecalho->numRegistros;
+    if ((size_t)numThreads > numRegistros) {
+        numThreads = numRegistros > 0 ? (int)numRegistros : 1;
+    }
+#ifndef WAR_TEM_THREADS
+    numThreads = 1;
+#endif
+    *threadsUsadas = numThreads;
+
+    static FatiaAnalise fatias[MAX_THREADS_ANALISE];
+    for (int t = 0; t < numThreads; t++) {
+        size_t inicio = numRegistros * (size_t)t / (size_t)numThreads;
+        size_t fim = numRegistros * (size_t)(t + 1) / (size_t)numThreads;
+        fatias[t].registros = registros + inicio;
+        fatias[t].numRegistros = fim - inicio;
+    }
+
+#ifdef WAR_TEM_THREADS
+    pthread_t threads[MAX_THREADS_ANALISE];
+    int criada[MAX_THREADS_ANALISE] = {0};
+    for (int t = 1; t < numThreads; t++) {
+        criada[t] = (pthread_create(&threads[t], NULL, analisarFatia, &fatias[t]) == 0);
+    }
+    analisarFatia(&fatias[0]);
+    for (int t = 1; t < numThreads; t++) {
+        if (criada[t]) {
+            pthread_join(threads[t], NULL);
+        } else {
+            analisarFatia(&fatias[t]); // Sem thread: a fatia é analisada aqui mesmo
+        }
+    }
+#else
+    analisarFatia(&fatias[0]);
+#endif
+
+    for (int t = 0; t < numThreads; t++) {
+        somarAgregados(total, &fatias[t].agregados);
+    }
+    liberarMapeamento(base, tamanho);
+    return 1;
+}
+
+// ============================================================================
+// RELATORIO
+// ============================================================================
+
+static double porcentagem(uint64_t parte, uint64_t total) {
+    return total > 0 ? 100.0 * (double)parte / (double)total : 0.0;
+}
+
+static double media(uint64_t soma, uint64_t quantidade) {
+    return quantidade > 0 ? (double)soma / (double)quantidade : 0.0;
+}
+
+static void exibirRelatorio(const AgregadosEventos* a, const CabecalhoEventos* cabecalho, int numArquivos,
+                            int numThreads, double segundos) {
+    printf("\n%s================ ANALISE DO LOG DE EVENTOS ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf("Arquivos: %d | Eventos: %" PRIu64 " | Partidas: %" PRIu64 "\n", numArquivos, a->eventos, a->partidas);
+    printf("Lote (primeiro arquivo): semente %" PRIu64 " | Territorios: %d | Jogadores: %d | Limite de turnos: %d%s\n",
+           cabecalho->semente, cabecalho->numTerritorios, cabecalho->numJogadores, cabecalho->maxTurnos,
+           cabecalho->blitz ? " | blitz" : "");
+    printf("Tempo: %.3f s | %s%.0f eventos/s%s | Threads: %d\n", segundos, COR_VERDE_NEGRITO,
+           segundos > 0.0 ? (double)a->eventos / segundos : 0.0, COR_RESET, numThreads);
+    if (a->desconhecidos > 0) {
+        printf("%s[!] %" PRIu64 " eventos de tipo desconhecido ignorados.%s\n", COR_AMARELO, a->desconhecidos, COR_RESET);
+    }
+
+    printf("\n[DURACAO]\n");
+    printf("  Turnos por partida: media %.2f | min %d | max %d\n", media(a->totalTurnos, a->partidas),
+           a->partidas > 0 ? a->minTurnos : 0, a->partidas > 0 ? a->maxTurnos : 0);
+    printf("  Dominacao total:  %12" PRIu64 " (%5.1f%%)\n", a->fimPorTipo[FIM_DOMINACAO],
+           porcentagem(a->fimPorTipo[FIM_DOMINACAO], a->partidas));
+    printf("  Missao cumprida:  %12" PRIu64 " (%5.1f%%)\n", a->fimPorTipo[FIM_MISSAO],
+           porcentagem(a->fimPorTipo[FIM_MISSAO], a->partidas));
+    printf("  Limite de turnos: %12" PRIu64 " (%5.1f%%)\n", a->fimPorTipo[FIM_SEM_VENCEDOR],
+           porcentagem(a->fimPorTipo[FIM_SEM_VENCEDOR], a->partidas));
+
+    printf("\n[VENCEDORES]\n");
+    for (int c = 0; c < MAX_CORES; c++) {
+        if (a->vitoriasPorCor[c] > 0 || c < cabecalho->numJogadores) {
+            printf("  %-10s %12" PRIu64 " (%5.1f%%)\n", nomeDaCor(c), a->vitoriasPorCor[c],
+                   porcentagem(a->vitoriasPorCor[c], a->partidas));
+        }
+    }
+
+    printf("\n[CONQUISTA POR RAZAO DE TROPAS (atacante / defensor)]\n");
+    for (int m = 0; m < NUM_MODOS_ATAQUE; m++) {
+        uint64_t totalModo = 0;
+        for (int f = 0; f < NUM_FAIXAS_RAZAO; f++) totalModo += a->ataques[m][f];
+        if (totalModo == 0) {
+            continue;
+        }
+        printf("  Modo %s (%" PRIu64 " %s)\n", NOMES_MODOS_ATAQUE[m], totalModo, m == ATAQUE_RODADA ? "rodadas" : "batalhas");
+        printf("  %-10s %14s %10s %12s %12s\n", "Razao", "Ataques", "Conquista", "Perdas atq", "Perdas def");
+        for (int f = 0; f < NUM_FAIXAS_RAZAO; f++) {
+            if (a->ataques[m][f] == 0) continue;
+            printf("  %-10s %14" PRIu64 " %9.1f%% %12.2f %12.2f\n", NOMES_FAIXAS_RAZAO[f], a->ataques[m][f],
+                   porcentagem(a->conquistas[m][f], a->ataques[m][f]),
+                   media(a->perdasAtacante[m][f], a->ataques[m][f]), media(a->perdasDefensor[m][f], a->ataques[m][f]));
+        }
+    }
+
+    printf("\n[MISSOES POR TIPO]\n");
+    // Sucesso: fração das verificações que encontraram a missão cumprida
+    printf("  %-22s %12s %12s %12s %9s %12s\n", "Tipo", "Atribuidas", "Verificacoes", "Cumpridas", "Sucesso",
+           "Vitorias");
+    for (int t = 0; t < NUM_TIPOS_MISSAO; t++) {
+        printf("  %-22s %12" PRIu64 " %12" PRIu64 " %12" PRIu64 " %8.1f%% %12" PRIu64 "\n", NOMES_TIPOS_MISSAO[t],
+               a->missoesAtribuidas[t], a->verificacoesMissao[t], a->missoesCumpridas[t],
+               porcentagem(a->missoesCumpridas[t], a->verificacoesMissao[t]), a->vitoriasMissao[t]);
+    }
+
+    printf("\n[REFORCOS]\n");
+    printf("  Reforcos por cor: %" PRIu64 " | tropas por reforco: media %.2f\n", a->reforcos,
+           media(a->tropasReforco, a->reforcos));
+    printf("%s===========================================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+}
+
+// ============================================================================
+// LINHA DE COMANDO
+// ============================================================================
+
+static void exibirUsoAnalise(const char* nomePrograma) {
+    fprintf(stderr, "Uso: %s ARQUIVO... [opcoes]\n", nomePrograma);
+    fprintf(stderr, "Analisa logs gravados por: war --simular N --eventos ARQUIVO\n");
+    fprintf(stderr, "  --threads N       Threads da analise (1-%d, padrao: numero de processadores)\n",
+            MAX_THREADS_ANALISE);
+}
+
+static int processarArgumentosAnalise(int argc, char* argv[], OpcoesAnalise* opcoes) {
+    int nucleos = numeroDeNucleos();
+    opcoes->numThreads = nucleos < MAX_THREADS_ANALISE ? nucleos : MAX_THREADS_ANALISE;
+    opcoes->numArquivos = 0;
+    opcoes->arquivos = argv; // Os caminhos são compactados no início de argv
+
+    for (int i = 1; i < argc; i++) {
+        long valor;
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, MAX_THREADS_ANALISE, &valor)) return 0;
+            opcoes->numThreads = (int)valor;
+        } else if (strncmp(argv[i], "--", 2) == 0) {
+            return 0;
+        } else {
+            opcoes->arquivos[opcoes->numArquivos++] = argv[i];
+        }
+    }
+    return opcoes->numArquivos > 0;
+}
+
+int main(int argc, char* argv[]) {
+    OpcoesAnalise opcoes;
+    if (!processarArgumentosAnalise(argc, argv, &opcoes)) {
+        exibirUsoAnalise(argv[0]);
+        return 1;
+    }
+
+    AgregadosEventos total;
+    zerarAgregados(&total);
+    CabecalhoEventos primeiro, cabecalho;
+    memset(&primeiro, 0, sizeof(primeiro));
+
+    int maxThreadsUsadas = 1;
+    double inicio = tempoAtualSegundos();
+    for (int i = 0; i < opcoes.numArquivos; i++) {
+        int threadsUsadas;
+        if (!analisarArquivo(opcoes.arquivos[i], opcoes.numThreads, &total, &cabecalho, &threadsUsadas)) {
+            return 1;
+        }
+        if (i == 0) {
+            primeiro = cabecalho;
+        }
+        if (threadsUsadas > maxThreadsUsadas) {
+            maxThreadsUsadas = threadsUsadas;
+        }
+    }
+    double segundos = tempoAtualSegundos() - inicio;
+
+    exibirRelatorio(&total, &primeiro, opcoes.numArquivos, maxThreadsUsadas, segundos);
+    return 0;
+}
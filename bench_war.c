@@ -0,0 +1,516 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - BENCHMARKS
+// ============================================================================
+//
+// Microbenchmarks do motor do jogo (combate, reforços, fim de jogo, missões e
+// montagem de partidas) em vários tamanhos de mapa, mais partidas completas
+// por segundo. Os resultados saem em JSON na saída padrão (ou em --saida
+// ARQUIVO) para serem comparados entre versões; um resumo legível vai para a
+// saída de erros.
+//
+// Compilação (na mesma pasta de war.c):
+//   gcc -std=c11 -O2 -Wall -Wextra -pthread bench_war.c -o bench_war -lm
+// Para medir o custo da instrumentação, compare com um executável gerado
+// com -DWAR_SEM_METRICAS (o campo "metricas" do JSON indica qual é qual).
+//
+// As funções interativas (simularAtaque, faseDeReforcos, verificarFimDeJogo)
+// são medidas pelos seus núcleos silenciosos (resolverCombate,
+// aplicarReforcos, jogoTerminou): é o que roda dentro das simulações, e a
+// E/S de console só acrescentaria ruído às medidas.
+//
+// ============================================================================
+
+#define WAR_SEM_MAIN
+#include "war.c"
+
+// --- Constantes dos Benchmarks ---
+#define AMOSTRAS_PADRAO 5           // Amostras por benchmark (relata mediana e mínimo)
+#define TEMPO_AMOSTRA_PADRAO 0.1    // Segundos por amostra
+#define MAX_AMOSTRAS 100            // Limite de --amostras
+#define NUM_PARES_BENCH 4096        // Pares atacante/defensor pré-sorteados (potência de 2)
+#define NUM_MISSOES_BENCH 64        // Missões pré-sorteadas para verificarMissao (potência de 2)
+#define LOTE_RODADAS_BENCH 1024     // Rodadas por chamada de resolverCombatesEmLote
+#define JOGADORES_BENCH 5           // Cores em jogo nos mapas dos benchmarks
+#define TROPAS_BATALHA_GRANDE 10000 // Tropas de cada lado em resolverBatalhaGrande (bem acima da tabela exata)
+#define MAX_TERRITORIOS_PARTIDA 1000    // Maior mapa gerado usado nas partidas completas
+#define VERSAO_FORMATO_BENCH 1      // Versão do formato JSON
+
+// Instrumentação do motor presente neste executável (ver WAR_SEM_METRICAS)
+#ifdef WAR_COM_METRICAS
+#define METRICAS_COMPILADAS 1
+#else
+#define METRICAS_COMPILADAS 0
+#endif
+
+// --- Estruturas de Dados ---
+/**
+ * @brief Estado compartilhado pelos benchmarks de um cenário (mapa)
+ */
+typedef struct {
+    const char* nomeCenario;            // "gerado" ou "americas"
+    Mapa* mapa;                         // Mapa do cenário
+    Mapa* copia;                        // Cópia de trabalho de copiarPosicao
+    PilhaDesfazer pilha;                // Pilha de fazerDesfazer
+    const DefinicaoMapa* definicao;     // Definição com fronteiras (NULL = mapa gerado)
+    EstadoRNG rng;                      // Gerador dos benchmarks
+    int32_t pares[2 * NUM_PARES_BENCH]; // Atacante e defensor de cada combate
+    Missao missoes[NUM_MISSOES_BENCH];  // Missões sorteadas no mapa do cenário
+    GeradorDados dados;                 // Gerador dos combates em lote
+    int32_t tropasAtacante[LOTE_RODADAS_BENCH];
+    int32_t tropasDefensor[LOTE_RODADAS_BENCH];
+    uint8_t perdasAtacante[LOTE_RODADAS_BENCH];
+    uint8_t perdasDefensor[LOTE_RODADAS_BENCH];
+    ConfigSimulacao config;             // Configuração das partidas completas
+    uint64_t proximaPartida;            // Índice da próxima partida (semente)
+    ArenaPartida arena;                 // Arena das partidas montadas e desmontadas
+} ContextoBench;
+
+/**
+ * @brief Corpo de um benchmark: executa n operações e devolve um valor a consumir
+ */
+typedef uint64_t (*FuncaoBench)(ContextoBench* contexto, long n);
+
+/**
+ * @brief Um benchmark registrado
+ */
+typedef struct {
+    const char* nome;                   // Nome estável (chave no JSON)
+    FuncaoBench funcao;                 // Corpo medido
+    int maxTerritorios;                 // Maior mapa gerado em que roda (0 = só uma vez, sem mapa)
+    int blitz;                          // Partidas com --blitz
+} Benchmark;
+
+/**
+ * @brief Opções de linha de comando do executável de benchmarks
+ */
+typedef struct {
+    int amostras;                       // Amostras por benchmark
+    double tempoAmostra;                // Segundos por amostra
+    uint64_t semente;                   // Semente de todos os sorteios
+    const char* filtro;                 // Só roda benchmarks cujo nome contém o texto
+    const char* rotulo;                 // Identificação da versão medida
+    const char* arquivoSaida;           // JSON em arquivo (NULL = saída padrão)
+} OpcoesBench;
+
+// Consome os resultados para o compilador não descartar o trabalho medido
+static volatile uint64_t sumidouro;
+
+// ============================================================================
+// CORPOS DOS BENCHMARKS
+// ============================================================================
+
+// Coloca o par k em condição de combate: cores diferentes e tropas fixas
+static inline void prepararPar(ContextoBench* contexto, int k, int tropasAtacante, int tropasDefensor,
+                               int* atacante, int* defensor) {
+    Mapa* mapa = contexto->mapa;
+    int a = contexto->pares[2 * k];
+    int d = contexto->pares[2 * k + 1];
+    if (mapa->dono[a] == mapa->dono[d]) {
+        transferirTerritorio(mapa, d, (mapa->dono[a] + 1) % JOGADORES_BENCH);
+    }
+    alterarTropas(mapa, a, tropasAtacante - mapa->tropas[a]);
+    alterarTropas(mapa, d, tropasDefensor - mapa->tropas[d]);
+    *atacante = a;
+    *defensor = d;
+}
+
+static uint64_t benchResolverCombate(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        int atacante, defensor;
+        prepararPar(contexto, (int)(i & (NUM_PARES_BENCH - 1)), 8, 4, &atacante, &defensor);
+        soma += (uint64_t)resolverCombate(contexto->mapa, atacante, defensor, &contexto->rng, NULL);
+    }
+    return soma;
+}
+
+static uint64_t benchResolverBatalha(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        int atacante, defensor;
+        prepararPar(contexto, (int)(i & (NUM_PARES_BENCH - 1)), 60, 40, &atacante, &defensor);
+        soma += (uint64_t)resolverBatalha(contexto->mapa, atacante, defensor, &contexto->rng, NULL);
+    }
+    return soma;
+}
+
+// Os dois lados fora da tabela exata: mede os blocos de rodadas de 2 dados contra 2
+static uint64_t benchResolverBatalhaGrande(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        int atacante, defensor;
+        prepararPar(contexto, (int)(i & (NUM_PARES_BENCH - 1)), TROPAS_BATALHA_GRANDE, TROPAS_BATALHA_GRANDE,
+                    &atacante, &defensor);
+        soma += (uint64_t)resolverBatalha(contexto->mapa, atacante, defensor, &contexto->rng, NULL);
+    }
+    return soma;
+}
+
+// Experimenta um ataque e volta à posição anterior desfazendo as alterações
+static uint64_t benchFazerDesfazer(ContextoBench* contexto, long n) {
+    Mapa* mapa = contexto->mapa;
+    uint64_t soma = 0;
+    iniciarPilhaDesfazer(&contexto->pilha);
+    for (long i = 0; i < n; i++) {
+        int atacante, defensor;
+        prepararPar(contexto, (int)(i & (NUM_PARES_BENCH - 1)), 8, 1, &atacante, &defensor);
+        mapa->desfazer = &contexto->pilha;
+        soma += (uint64_t)resolverCombate(mapa, atacante, defensor, &contexto->rng, NULL);
+        soma += (uint64_t)desfazerAte(mapa, 0);
+        mapa->desfazer = NULL;
+    }
+    return soma;
+}
+
+// O mesmo ataque experimentado sobre uma cópia da posição (o que a busca da IA faz)
+static uint64_t benchCopiarPosicao(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        int atacante, defensor;
+        prepararPar(contexto, (int)(i & (NUM_PARES_BENCH - 1)), 8, 1, &atacante, &defensor);
+        restaurarPosicao(contexto->copia, contexto->mapa);
+        soma += (uint64_t)resolverCombate(contexto->copia, atacante, defensor, &contexto->rng, NULL);
+    }
+    return soma;
+}
+
+static uint64_t benchCombatesEmLote(ContextoBench* contexto, long n) {
+    // n conta rodadas; cada chamada resolve LOTE_RODADAS_BENCH delas
+    uint64_t soma = 0;
+    for (long feitas = 0; feitas < n; feitas += LOTE_RODADAS_BENCH) {
+        resolverCombatesEmLote(&contexto->dados, contexto->tropasAtacante, contexto->tropasDefensor,
+                               LOTE_RODADAS_BENCH, contexto->perdasAtacante, contexto->perdasDefensor);
+        soma += contexto->perdasAtacante[feitas & (LOTE_RODADAS_BENCH - 1)];
+    }
+    return soma;
+}
+
+static uint64_t benchAplicarReforcos(ContextoBench* contexto, long n) {
+    // As tropas só crescem; o mapa é sorteado de novo a cada amostra
+    for (long i = 0; i < n; i++) {
+        aplicarReforcos(contexto->mapa, NULL);
+    }
+    return (uint64_t)contexto->mapa->tropasPorDono[0];
+}
+
+static uint64_t benchJogoTerminou(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        soma += (uint64_t)jogoTerminou(contexto->mapa);
+        sumidouro = soma; // Impede que a chamada constante saia do laço
+    }
+    return soma;
+}
+
+static uint64_t benchVerificarMissao(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        soma += (uint64_t)verificarMissao(&contexto->missoes[i & (NUM_MISSOES_BENCH - 1)], contexto->mapa, (int)(i & 15));
+    }
+    return soma;
+}
+
+static uint64_t benchGerarMissao(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        Missao missao;
+        gerarMissaoAleatoria(&missao, contexto->mapa, contexto->mapa->dono[0], &contexto->rng);
+        soma += (uint64_t)missao.tipo + (uint64_t)missao.valorAlvo;
+    }
+    return soma;
+}
+
+static uint64_t benchPartidas(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        EstadoRNG rng;
+        inicializarRNG(&rng, sementeDaPartida(contexto->config.semente, contexto->proximaPartida++));
+        ResultadoPartida resultado;
+        jogarPartidaAutomatica(contexto->mapa, &contexto->config, &rng, &resultado);
+        soma += (uint64_t)resultado.turnos;
+    }
+    return soma;
+}
+
+// Monta e desmonta o estado de uma partida (mapa, fronteiras, índice, contadores e
+// missões), como uma sessão do servidor; com arena, nada vai ao heap após o aquecimento
+static uint64_t montarPartida(ContextoBench* contexto, ArenaPartida* arena) {
+    int numTerritorios = contexto->mapa->numTerritorios;
+    Mapa* mapa = arena != NULL ? alocarMapaNaArena(arena, numTerritorios) : alocarMapa(numTerritorios);
+    prepararMapaAleatorio(mapa, JOGADORES_BENCH, &contexto->rng);
+    if (contexto->definicao != NULL) {
+        associarSubmapa(mapa, contexto->definicao);
+        recalcularContadores(mapa);
+    }
+    MotorMissoes missoes;
+    gerarMissoesDosJogadores(&missoes, mapa, 1, &contexto->rng);
+    uint64_t soma = (uint64_t)missoes.ativas + (uint64_t)mapa->territoriosPorDono[0];
+    liberarMemoria(mapa);
+    if (arena != NULL) {
+        reiniciarArena(arena);
+    }
+    return soma;
+}
+
+static uint64_t benchMontarPartida(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        soma += montarPartida(contexto, NULL);
+    }
+    return soma;
+}
+
+static uint64_t benchMontarPartidaArena(ContextoBench* contexto, long n) {
+    uint64_t soma = 0;
+    for (long i = 0; i < n; i++) {
+        soma += montarPartida(contexto, &contexto->arena);
+    }
+    return soma;
+}
+
+static const Benchmark BENCHMARKS[] = {
+    { "resolverCombate",        benchResolverCombate,   MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "resolverBatalha",        benchResolverBatalha,   MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "resolverBatalhaGrande",  benchResolverBatalhaGrande, MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "aplicarReforcos",        benchAplicarReforcos,   MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "jogoTerminou",           benchJogoTerminou,      MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "verificarMissao",        benchVerificarMissao,   MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "gerarMissaoAleatoria",   benchGerarMissao,       MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "fazerDesfazer",          benchFazerDesfazer,     MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "copiarPosicao",          benchCopiarPosicao,     MAX_TERRITORIOS_SIMULACAO, 0 },
+    { "resolverCombatesEmLote", benchCombatesEmLote,    0,                         0 },
+    { "partida",                benchPartidas,          MAX_TERRITORIOS_PARTIDA,   0 },
+    { "partidaBlitz",           benchPartidas,          MAX_TERRITORIOS_PARTIDA,   1 },
+    { "montarPartida",          benchMontarPartida,     MAX_TERRITORIOS_PARTIDA,   0 },
+    { "montarPartidaArena",     benchMontarPartidaArena, MAX_TERRITORIOS_PARTIDA,  0 },
+};
+#define NUM_BENCHMARKS ((int)(sizeof(BENCHMARKS) / sizeof(BENCHMARKS[0])))
+
+// ============================================================================
+// CENARIOS E MEDICAO
+// ============================================================================
+
+// Sorteia o mapa do cenário e tudo o que os benchmarks leem dele
+static void prepararCenario(ContextoBench* contexto, const Benchmark* benchmark, uint64_t semente) {
+    Mapa* mapa = contexto->mapa;
+    int numTerritorios = mapa->numTerritorios;
+    inicializarRNG(&contexto->rng, semente);
+    prepararMapaAleatorio(mapa, JOGADORES_BENCH, &contexto->rng);
+
+    for (int k = 0; k < NUM_PARES_BENCH; k++) {
+        int atacante = (int)aleatorioIntervalo(&contexto->rng, (uint32_t)numTerritorios);
+        int defensor = (int)aleatorioIntervalo(&contexto->rng, (uint32_t)(numTerritorios - 1));
+        contexto->pares[2 * k] = atacante;
+        contexto->pares[2 * k + 1] = defensor + (defensor >= atacante); // Nunca o próprio atacante
+    }
+    for (int k = 0; k < NUM_MISSOES_BENCH; k++) {
+        gerarMissaoAleatoria(&contexto->missoes[k], mapa, mapa->dono[k % mapa->numTerritorios], &contexto->rng);
+    }
+
+    inicializarGeradorDados(&contexto->dados, semente);
+    for (int i = 0; i < LOTE_RODADAS_BENCH; i++) {
+        contexto->tropasAtacante[i] = 2 + (int32_t)aleatorioIntervalo(&contexto->rng, 3);
+        contexto->tropasDefensor[i] = 1 + (int32_t)aleatorioIntervalo(&contexto->rng, 3);
+    }
+
+    memset(&contexto->config, 0, sizeof(contexto->config));
+    contexto->config.numTerritorios = numTerritorios;
+    contexto->config.numJogadores = JOGADORES_BENCH;
+    contexto->config.maxTurnos = MAX_TURNOS_MASTER;
+    contexto->config.semente = semente;
+    contexto->config.definicao = contexto->definicao;
+    contexto->config.numThreads = 1;
+    contexto->config.blitz = benchmark->blitz;
+    contexto->proximaPartida = 0;
+}
+
+static int compararDoubles(const void* a, const void* b) {
+    double x = *(const double*)a, y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+// Mede um benchmark em um cenário e grava o objeto JSON correspondente
+static void medirBenchmark(const Benchmark* benchmark, ContextoBench* contexto, const OpcoesBench* opcoes,
+                           FILE* saida, int* primeiro) {
+    // Calibração: dobrar n até uma execução levar ao menos 1/10 da amostra
+    long n = 1;
+    prepararCenario(contexto, benchmark, opcoes->semente);
+    while (1) {
+        double inicio = tempoAtualSegundos();
+        sumidouro += benchmark->funcao(contexto, n);
+        double segundos = tempoAtualSegundos() - inicio;
+        if (segundos >= opcoes->tempoAmostra / 10.0 || n >= (1L << 40)) {
+            double alvo = n * opcoes->tempoAmostra / (segundos > 1e-9 ? segundos : 1e-9);
+            n = alvo < 1.0 ? 1 : (long)alvo;
+            break;
+        }
+        n *= 2;
+    }
+
+    double nsPorOperacao[MAX_AMOSTRAS];
+    for (int a = 0; a < opcoes->amostras; a++) {
+        prepararCenario(contexto, benchmark, opcoes->semente + (uint64_t)a + 1);
+        double inicio = tempoAtualSegundos();
+        sumidouro += benchmark->funcao(contexto, n);
+        double segundos = tempoAtualSegundos() - inicio;
+        nsPorOperacao[a] = segundos * 1e9 / (double)n;
+    }
+    qsort(nsPorOperacao, (size_t)opcoes->amostras, sizeof(double), compararDoubles);
+    double mediana = nsPorOperacao[opcoes->amostras / 2];
+    double minimo = nsPorOperacao[0];
+    int territorios = benchmark->maxTerritorios > 0 ? contexto->mapa->numTerritorios : 0;
+
+    fprintf(saida, "%s\n    {\"bench\": \"%s\", \"cenario\": \"%s\", \"territorios\": %d, "
+            "\"operacoes_por_amostra\": %ld, \"amostras\": %d, \"ns_por_op_mediana\": %.3f, "
+            "\"ns_por_op_min\": %.3f, \"ops_por_s\": %.1f}",
+            *primeiro ? "" : ",", benchmark->nome, benchmark->maxTerritorios > 0 ? contexto->nomeCenario : "-",
+            territorios, n, opcoes->amostras, mediana, minimo, mediana > 0.0 ? 1e9 / mediana : 0.0);
+    *primeiro = 0;
+    fprintf(stderr, "%-24s %-9s %10d  %14.1f ns/op  %14.0f op/s\n", benchmark->nome,
+            benchmark->maxTerritorios > 0 ? contexto->nomeCenario : "-", territorios,
+            mediana, mediana > 0.0 ? 1e9 / mediana : 0.0);
+}
+
+// ============================================================================
+// LINHA DE COMANDO
+// ============================================================================
+
+static void exibirUsoBench(const char* nomePrograma) {
+    fprintf(stderr, "Uso: %s [opcoes]\n", nomePrograma);
+    fprintf(stderr, "  --amostras N      Amostras por benchmark (1-%d, padrao %d; relata mediana e minimo)\n",
+            MAX_AMOSTRAS, AMOSTRAS_PADRAO);
+    fprintf(stderr, "  --tempo MS        Duracao de cada amostra em milissegundos (padrao %d)\n",
+            (int)(TEMPO_AMOSTRA_PADRAO * 1000));
+    fprintf(stderr, "  --filtro TEXTO    Roda apenas os benchmarks cujo nome contem TEXTO\n");
+    fprintf(stderr, "  --rotulo TEXTO    Identificacao da versao medida (ex.: hash do commit)\n");
+    fprintf(stderr, "  --saida ARQUIVO   Grava o JSON em ARQUIVO em vez da saida padrao\n");
+    fprintf(stderr, "  --seed S          Semente dos mapas e sorteios (padrao 1)\n");
+}
+
+static int processarArgumentosBench(int argc, char* argv[], OpcoesBench* opcoes) {
+    opcoes->amostras = AMOSTRAS_PADRAO;
+    opcoes->tempoAmostra = TEMPO_AMOSTRA_PADRAO;
+    opcoes->semente = 1;
+    opcoes->filtro = NULL;
+    opcoes->rotulo = "";
+    opcoes->arquivoSaida = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        long valor;
+        if (strcmp(argv[i], "--amostras") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, MAX_AMOSTRAS, &valor)) return 0;
+            opcoes->amostras = (int)valor;
+        } else if (strcmp(argv[i], "--tempo") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, 60000, &valor)) return 0;
+            opcoes->tempoAmostra = valor / 1000.0;
+        } else if (strcmp(argv[i], "--filtro") == 0 && i + 1 < argc) {
+            opcoes->filtro = argv[++i];
+        } else if (strcmp(argv[i], "--rotulo") == 0 && i + 1 < argc) {
+            opcoes->rotulo = argv[++i];
+        } else if (strcmp(argv[i], "--saida") == 0 && i + 1 < argc) {
+            opcoes->arquivoSaida = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            char* fim;
+            opcoes->semente = strtoull(argv[++i], &fim, 10);
+            if (*fim != '\0') return 0;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Escreve uma string JSON, escapando aspas, barras e controles
+static void escreverTextoJson(FILE* saida, const char* texto) {
+    fputc('"', saida);
+    for (const unsigned char* c = (const unsigned char*)texto; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(saida, "\\%c", *c);
+        } else if (*c < 0x20) {
+            fprintf(saida, "\\u%04x", *c);
+        } else {
+            fputc(*c, saida);
+        }
+    }
+    fputc('"', saida);
+}
+
+int main(int argc, char* argv[]) {
+    OpcoesBench opcoes;
+    if (!processarArgumentosBench(argc, argv, &opcoes)) {
+        exibirUsoBench(argv[0]);
+        return 1;
+    }
+
+    FILE* saida = stdout;
+    if (opcoes.arquivoSaida != NULL) {
+        saida = fopen(opcoes.arquivoSaida, "w");
+        if (saida == NULL) {
+            fprintf(stderr, "[ERRO] Nao foi possivel criar '%s'.\n", opcoes.arquivoSaida);
+            return 1;
+        }
+    }
+
+    inicializarTabelaBatalha();
+    DefinicaoMapa* americas = carregarMapaPadrao();
+    if (americas == NULL) {
+        return 1;
+    }
+
+    // Mapas gerados (sem fronteiras) de tamanhos crescentes e o mapa embutido
+    static const int TAMANHOS[] = { NUM_TERRITORIOS_PREDEFINIDOS, 1000, 100000, 1000000 };
+    int numCenarios = (int)(sizeof(TAMANHOS) / sizeof(TAMANHOS[0])) + 1;
+
+    fprintf(saida, "{\n  \"formato\": %d,\n  \"rotulo\": ", VERSAO_FORMATO_BENCH);
+    escreverTextoJson(saida, opcoes.rotulo);
+    fprintf(saida, ",\n  \"data\": %ld,\n  \"semente\": %" PRIu64 ",\n  \"amostras\": %d,\n"
+            "  \"tempo_amostra_s\": %.3f,\n  \"simd_dados\": %s,\n  \"metricas\": %s,\n  \"compilador\": ",
+            (long)time(NULL), opcoes.semente, opcoes.amostras, opcoes.tempoAmostra,
+            combatesEmLoteVetoriais() ? "\"avx2\"" : "\"escalar\"", METRICAS_COMPILADAS ? "true" : "false");
+#ifdef __VERSION__
+    escreverTextoJson(saida, __VERSION__);
+#else
+    escreverTextoJson(saida, "desconhecido");
+#endif
+    fprintf(saida, ",\n  \"resultados\": [");
+
+    int primeiro = 1;
+    for (int b = 0; b < NUM_BENCHMARKS; b++) {
+        const Benchmark* benchmark = &BENCHMARKS[b];
+        if (opcoes.filtro != NULL && strstr(benchmark->nome, opcoes.filtro) == NULL) {
+            continue;
+        }
+        for (int c = 0; c < numCenarios; c++) {
+            int embutido = (c == numCenarios - 1);
+            int territorios = embutido ? americas->numTerritorios : TAMANHOS[c];
+            if (benchmark->maxTerritorios == 0 ? c > 0 : (!embutido && territorios > benchmark->maxTerritorios)) {
+                continue; // Benchmarks sem mapa rodam uma única vez; os demais, até o seu limite
+            }
+            ContextoBench* contexto = (ContextoBench*)calloc(1, sizeof(ContextoBench));
+            if (contexto == NULL) {
+                fprintf(stderr, "[ERRO] Memoria insuficiente.\n");
+                return 1;
+            }
+            contexto->nomeCenario = embutido ? "americas" : "gerado";
+            contexto->mapa = alocarMapa(territorios);
+            contexto->copia = alocarMapa(territorios);
+            inicializarArena(&contexto->arena, TAM_ARENA_INICIAL);
+            if (embutido) {
+                contexto->definicao = americas;
+                associarMapaCompleto(contexto->mapa, americas);
+            }
+            medirBenchmark(benchmark, contexto, &opcoes, saida, &primeiro);
+            liberarMemoria(contexto->mapa);
+            liberarMemoria(contexto->copia);
+            liberarArena(&contexto->arena);
+            free(contexto);
+        }
+    }
+
+    fprintf(saida, "\n  ]\n}\n");
+    if (saida != stdout) {
+        fclose(saida);
+    }
+    liberarDefinicaoMapa(americas);
+    return 0;
+}
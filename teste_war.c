@@ -0,0 +1,1053 @@
+// ============================================================================
+//         PROJETO WAR ESTRUTURADO - TESTES
+// ============================================================================
+//
+// Testes de regressão do motor do jogo. Cada teste monta o seu cenário,
+// confere o resultado e imprime [OK] ou [ERRO]; o código de saída é 1 se
+// algum falhar.
+//
+// Compilação e execução (na mesma pasta de war.c):
+//   gcc -std=c11 -O2 -Wall -Wextra -pthread teste_war.c -o teste_war -lm
+//   ./teste_war
+//
+// ============================================================================
+
+#define WAR_SEM_MAIN
+#include "war.c"
+
+// --- Constantes dos Testes ---
+#define SEMENTE_TESTES 2024         // Semente de todos os sorteios
+#define TERRITORIOS_TESTE 40        // Territórios dos mapas gerados
+#define JOGADORES_TESTE 3           // Cores em jogo nos mapas gerados
+#define TERRITORIOS_BITBOARD_TESTE (MAX_TERRITORIOS_BITBOARD - 3)  // Ocupa as quatro palavras, a última incompleta
+#define JOGADORES_BITBOARD_TESTE 5  // Cores em jogo no teste de bitsDoDono
+#define SEMENTE_REPLAY 1            // Partida em que Amarelo cumpre "sobreviver 8 turnos" no turno 8
+#define ARQUIVO_ENTRADA_TESTE "teste_war_entrada.tmp"   // Jogadas digitadas na partida ao vivo
+#define ARQUIVO_LOG_TESTE "teste_war_partida.tmp"       // Log gravado da partida ao vivo
+#define ARQUIVO_SNAPSHOT_TESTE "teste_war_snapshot.tmp" // Snapshot salvo e recarregado
+#define ARQUIVO_MAPA_TESTE "teste_war_mapa.tmp"         // Arquivos de mapa e de configuração lidos
+#define ARQUIVO_SAIDA_TESTE "teste_war_saida.tmp"       // Saída capturada (mensagens de erro)
+#define TURNO_SNAPSHOT 6            // Turno gravado no snapshot de teste
+
+// Partida do Nível Master com 8 territórios cadastrados em que ninguém ataca:
+// cada turno é só "-1" (encerrar ataques) e Enter
+static const char ENTRADA_PARTIDA_PASSIVA[] =
+    "8\n"
+    "2\n1\n3\n" "4\n2\n3\n" "6\n3\n3\n" "8\n4\n3\n"
+    "10\n5\n3\n" "12\n1\n3\n" "14\n2\n3\n" "16\n3\n3\n"
+    "\n"
+    "-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n"
+    "-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n-1\n\n";
+
+/**
+ * @brief Um teste registrado
+ */
+typedef struct {
+    const char* nome;               // Nome exibido no resultado
+    int (*funcao)(void);            // Devolve 1 se passou
+} Teste;
+
+// ============================================================================
+// AUXILIARES
+// ============================================================================
+
+// Dono, tropas e contadores por cor iguais nos dois mapas
+static int mesmaPosicao(const Mapa* a, const Mapa* b) {
+    size_t n = (size_t)a->numTerritorios;
+    return a->numTerritorios == b->numTerritorios &&
+           memcmp(a->dono, b->dono, n * sizeof(a->dono[0])) == 0 &&
+           memcmp(a->tropas, b->tropas, n * sizeof(a->tropas[0])) == 0 &&
+           memcmp(a->territoriosPorDono, b->territoriosPorDono, sizeof(a->territoriosPorDono)) == 0 &&
+           memcmp(a->tropasPorDono, b->tropasPorDono, sizeof(a->tropasPorDono)) == 0;
+}
+
+// Manda a saída padrão para um arquivo; devolve o descritor a restaurar
+static int desviarSaida(const char* destino) {
+    fflush(stdout);
+    int salvo = dup(STDOUT_FILENO);
+    if (freopen(destino, "w", stdout) == NULL) {
+        dup2(salvo, STDOUT_FILENO);
+    }
+    return salvo;
+}
+
+static int silenciarSaida(void) {
+    return desviarSaida("/dev/null");
+}
+
+static void restaurarSaida(int salvo) {
+    fflush(stdout);
+    dup2(salvo, STDOUT_FILENO);
+    close(salvo);
+}
+
+// Lê um arquivo inteiro; devolve NULL se não conseguir
+static char* lerArquivoTeste(const char* caminho, size_t* tamanho) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return NULL;
+    }
+    fseek(arquivo, 0, SEEK_END);
+    long bytes = ftell(arquivo);
+    fseek(arquivo, 0, SEEK_SET);
+    char* dados = (char*)malloc(bytes > 0 ? (size_t)bytes : 1);
+    if (dados != NULL && fread(dados, 1, (size_t)bytes, arquivo) != (size_t)bytes) {
+        free(dados);
+        dados = NULL;
+    }
+    fclose(arquivo);
+    *tamanho = (size_t)bytes;
+    return dados;
+}
+
+static int gravarArquivoTeste(const char* caminho, const void* dados, size_t tamanho) {
+    FILE* arquivo = fopen(caminho, "wb");
+    if (arquivo == NULL) {
+        return 0;
+    }
+    int ok = fwrite(dados, 1, tamanho, arquivo) == tamanho;
+    return (fclose(arquivo) == 0) && ok;
+}
+
+// Mapa completo da definição, com donos e tropas sorteados e os contadores montados
+static Mapa* montarMapaDaDefinicao(const DefinicaoMapa* definicao, EstadoRNG* rng) {
+    Mapa* mapa = alocarMapa(definicao->numTerritorios);
+    prepararMapaAleatorio(mapa, JOGADORES_TESTE, rng);
+    associarMapaCompleto(mapa, definicao);
+    recalcularContadores(mapa);
+    return mapa;
+}
+
+// Imprime a falha de um teste e devolve 0
+static int falhar(const char* motivo) {
+    printf("       %s\n", motivo);
+    return 0;
+}
+
+// ============================================================================
+// TESTES
+// ============================================================================
+
+// Final de uma batalha numa só escala: tropas do atacante na conquista, ou
+// menos as tropas do defensor quando o atacante fica com 1
+static int finalComSinal(int atacante, int defensor) {
+    return defensor == 0 ? atacante : -defensor;
+}
+
+static int compararInteiros(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Maior distância entre as distribuições acumuladas de duas amostras ordenadas (Kolmogorov-Smirnov)
+static double distanciaKS(const int* a, const int* b, int n) {
+    double maior = 0.0;
+    int i = 0, j = 0;
+    while (i < n && j < n) {
+        int valor = a[i] < b[j] ? a[i] : b[j];
+        while (i < n && a[i] == valor) i++;
+        while (j < n && b[j] == valor) j++;
+        double distancia = fabs((double)(i - j) / n);
+        if (distancia > maior) maior = distancia;
+    }
+    return maior;
+}
+
+// Compara 'amostras' batalhas de sortearFimDeBatalha com as mesmas batalhas
+// jogadas rodada a rodada com resolverCombate
+static int mesmaDistribuicaoDeBatalha(int tropasAtacante, int tropasDefensor, int amostras, EstadoRNG* rng) {
+    Mapa* mapa = alocarMapa(2);
+    int* sorteadas = (int*)malloc((size_t)amostras * sizeof(int));
+    int* rodadas = (int*)malloc((size_t)amostras * sizeof(int));
+    if (sorteadas == NULL || rodadas == NULL) {
+        free(sorteadas);
+        free(rodadas);
+        liberarMemoria(mapa);
+        return 0;
+    }
+    int vitoriasSorteadas = 0, vitoriasRodadas = 0;
+    for (int s = 0; s < amostras; s++) {
+        int a = tropasAtacante, d = tropasDefensor;
+        sortearFimDeBatalha(&a, &d, rng);
+        sorteadas[s] = finalComSinal(a, d);
+        vitoriasSorteadas += d == 0;
+
+        mapa->dono[0] = 0;
+        mapa->dono[1] = 1;
+        mapa->tropas[0] = tropasAtacante;
+        mapa->tropas[1] = tropasDefensor;
+        recalcularContadores(mapa);
+        ResultadoCombate combate;
+        int conquistou = 0;
+        while (!conquistou && mapa->tropas[0] > 1) {
+            conquistou = resolverCombate(mapa, 0, 1, rng, &combate) == 2;
+        }
+        // Na conquista as tropas já foram movidas: vale o que o atacante tinha depois das perdas
+        rodadas[s] = conquistou ? combate.tropasAtacanteAntes - combate.perdasAtacante
+                                : finalComSinal(mapa->tropas[0], mapa->tropas[1]);
+        vitoriasRodadas += conquistou;
+    }
+    qsort(sorteadas, (size_t)amostras, sizeof(int), compararInteiros);
+    qsort(rodadas, (size_t)amostras, sizeof(int), compararInteiros);
+
+    // Nível de 0,1%: KS com c(0,001) = 1,95 e diferença de proporções com |z| < 3,3
+    double ks = distanciaKS(sorteadas, rodadas, amostras);
+    double limiteKS = 1.95 * sqrt(2.0 / amostras);
+    double p = (vitoriasSorteadas + vitoriasRodadas) / (2.0 * amostras);
+    double erro = sqrt(2.0 * p * (1.0 - p) / amostras);
+    double z = erro > 0.0 ? (double)abs(vitoriasSorteadas - vitoriasRodadas) / amostras / erro : 0.0;
+    int ok = ks < limiteKS && z < 3.3;
+    if (!ok) {
+        printf("       %d x %d: KS %.4f (limite %.4f), vitorias %d x %d (z %.2f)\n", tropasAtacante,
+               tropasDefensor, ks, limiteKS, vitoriasSorteadas, vitoriasRodadas, z);
+    }
+    free(sorteadas);
+    free(rodadas);
+    liberarMemoria(mapa);
+    return ok;
+}
+
+// sortearFimDeBatalha tem de seguir a distribuição das batalhas jogadas rodada
+// a rodada, dentro da tabela exata (alias) e acima dela (rodadas em bloco).
+// Roda antes de qualquer outro teste, então também confere que as consultas
+// montam a tabela sozinhas quando inicializarTabelaBatalha não foi chamada.
+static int testarFimDeBatalhaSegueAsRodadas(void) {
+    int ok = 1;
+    const ProbabilidadeBatalha* umContraUm = consultarProbabilidadeBatalha(2, 1);
+    if (umContraUm == NULL || fabs(umContraUm->probVitoria - 15.0 / 36.0) > 1e-12) {
+        ok = falhar("a tabela de batalhas nao foi montada na primeira consulta");
+    }
+    static const int BATALHAS[][3] = {
+        { 10, 8, 20000 }, { 60, 55, 20000 },    // Dentro da tabela
+        { 400, 390, 5000 }, { 3000, 3050, 2000 } // Acima dela
+    };
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    for (size_t i = 0; i < sizeof(BATALHAS) / sizeof(BATALHAS[0]); i++) {
+        if (!mesmaDistribuicaoDeBatalha(BATALHAS[i][0], BATALHAS[i][1], BATALHAS[i][2], &rng)) {
+            ok = falhar("distribuicao do fim da batalha diferente da jogada rodada a rodada");
+        }
+    }
+    return ok;
+}
+
+#ifdef WAR_TEM_AVX2
+// Resolve os mesmos lotes pelos dois caminhos, a partir do mesmo gerador, e
+// compara as perdas de cada rodada e o estado final do gerador
+static int mesmosCombatesEmLote(const GeradorDados* inicial, const int32_t* tropasAtacante,
+                                const int32_t* tropasDefensor, const int* tamanhos, int numLotes,
+                                uint8_t* perdas, int totalRodadas) {
+    GeradorDados escalar = *inicial, vetorial = *inicial;
+    uint8_t* perdasAtacanteEscalar = perdas;
+    uint8_t* perdasDefensorEscalar = perdas + totalRodadas;
+    uint8_t* perdasAtacanteVetorial = perdas + 2 * (size_t)totalRodadas;
+    uint8_t* perdasDefensorVetorial = perdas + 3 * (size_t)totalRodadas;
+    int inicio = 0;
+    for (int l = 0; l < numLotes; l++) {
+        resolverCombatesEmLoteEscalar(&escalar, tropasAtacante + inicio, tropasDefensor + inicio, tamanhos[l],
+                                      perdasAtacanteEscalar + inicio, perdasDefensorEscalar + inicio);
+        resolverCombatesEmLoteAVX2(&vetorial, tropasAtacante + inicio, tropasDefensor + inicio, tamanhos[l],
+                                   perdasAtacanteVetorial + inicio, perdasDefensorVetorial + inicio);
+        inicio += tamanhos[l];
+    }
+    return memcmp(perdasAtacanteEscalar, perdasAtacanteVetorial, (size_t)inicio) == 0 &&
+           memcmp(perdasDefensorEscalar, perdasDefensorVetorial, (size_t)inicio) == 0 &&
+           memcmp(escalar.s, vetorial.s, sizeof(escalar.s)) == 0;
+}
+#endif
+
+// O caminho AVX2 dos combates em lote e o escalar, com a mesma semente, dão as
+// mesmas perdas rodada a rodada, inclusive em lotes que não fecham grupos de
+// LANES_DADOS e quando uma lane tem a rodada rejeitada e volta ao escalar
+static int testarCombatesEmLoteVetorialIgualAoEscalar(void) {
+#ifdef WAR_TEM_AVX2
+    if (!combatesEmLoteVetoriais()) {
+        printf("       CPU sem AVX2: so o caminho escalar esta em uso\n");
+        return 1;
+    }
+    static const int TAMANHOS[] = { 1, 3, 4, 7, 4096, 65533, 30000 };
+    enum { NUM_LOTES = sizeof(TAMANHOS) / sizeof(TAMANHOS[0]) };
+    int total = 0;
+    for (int l = 0; l < NUM_LOTES; l++) total += TAMANHOS[l];
+    int32_t* tropasAtacante = (int32_t*)malloc((size_t)total * sizeof(int32_t));
+    int32_t* tropasDefensor = (int32_t*)malloc((size_t)total * sizeof(int32_t));
+    uint8_t* perdas = (uint8_t*)malloc((size_t)total * 4);
+    if (tropasAtacante == NULL || tropasDefensor == NULL || perdas == NULL) {
+        free(tropasAtacante);
+        free(tropasDefensor);
+        free(perdas);
+        return falhar("memoria insuficiente");
+    }
+    // Tropas de 2 a 4 no ataque e de 1 a 3 na defesa: as 4 combinações de dados
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    for (int i = 0; i < total; i++) {
+        tropasAtacante[i] = 2 + (int32_t)aleatorioIntervalo(&rng, 3);
+        tropasDefensor[i] = 1 + (int32_t)aleatorioIntervalo(&rng, 3);
+    }
+
+    int ok = 1;
+    GeradorDados gerador;
+    inicializarGeradorDados(&gerador, SEMENTE_TESTES);
+    if (!mesmosCombatesEmLote(&gerador, tropasAtacante, tropasDefensor, TAMANHOS, NUM_LOTES, perdas, total)) {
+        ok = falhar("perdas ou estado do gerador diferentes entre AVX2 e escalar");
+    }
+
+    // Com a palavra 1 do estado zerada, a próxima saída da lane é 0: os dados
+    // dela caem na faixa rejeitada e a rodada é sorteada de novo pelo escalar
+    for (int p = 1; p < LANES_DADOS; p += 2) {
+        gerador.s[1][p] = 0;
+    }
+    const int loteComRejeicao[] = { 2 * LANES_DADOS + 1 };
+    if (!mesmosCombatesEmLote(&gerador, tropasAtacante, tropasDefensor, loteComRejeicao, 1, perdas,
+                              loteComRejeicao[0])) {
+        ok = falhar("rodada rejeitada resolvida de outro jeito pelo caminho AVX2");
+    }
+    free(tropasAtacante);
+    free(tropasDefensor);
+    free(perdas);
+    return ok;
+#else
+    printf("       compilado sem AVX2: so o caminho escalar existe\n");
+    return 1;
+#endif
+}
+
+// Marcas aninhadas com a pilha transbordando dentro da mais interna: nenhuma
+// das duas pode ser desfeita, nem a externa depois da interna, até a pilha
+// ser esvaziada
+static int testarTransbordoComMarcasAninhadas(void) {
+    static PilhaDesfazer pilha;
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    Mapa* mapa = alocarMapa(TERRITORIOS_TESTE);
+    Mapa* inicial = alocarMapa(TERRITORIOS_TESTE);
+    Mapa* cheio = alocarMapa(TERRITORIOS_TESTE);
+    prepararMapaAleatorio(mapa, JOGADORES_TESTE, &rng);
+    restaurarPosicao(inicial, mapa);
+
+    iniciarPilhaDesfazer(&pilha);
+    mapa->desfazer = &pilha;
+    int32_t marcaExterna = pilha.numAlteracoes;
+    alterarTropas(mapa, 0, 3);
+    int32_t marcaInterna = pilha.numAlteracoes;
+    for (int i = 0; !pilha.transbordou; i++) {
+        alterarTropas(mapa, i % TERRITORIOS_TESTE, 1);
+    }
+    restaurarPosicao(cheio, mapa);
+
+    int ok = 1;
+    if (desfazerAte(mapa, marcaInterna) != 0) {
+        ok = falhar("a marca interna foi desfeita com alteracoes perdidas");
+    }
+    if (!pilha.transbordou || pilha.numAlteracoes != TAM_PILHA_DESFAZER) {
+        ok = falhar("desfazer a marca interna limpou o transbordo da pilha");
+    }
+    if (desfazerAte(mapa, marcaExterna) != 0) {
+        ok = falhar("a marca externa foi desfeita depois do transbordo");
+    }
+    if (!mesmaPosicao(mapa, cheio)) {
+        ok = falhar("o mapa foi alterado por um desfazer recusado");
+    }
+
+    // Esvaziada pelo dono, a pilha volta a desfazer com exatidão
+    restaurarPosicao(mapa, inicial);
+    iniciarPilhaDesfazer(&pilha);
+    int32_t marca = pilha.numAlteracoes;
+    alterarTropas(mapa, 1, 5);
+    if (desfazerAte(mapa, marca) != 1 || !mesmaPosicao(mapa, inicial)) {
+        ok = falhar("a pilha esvaziada nao desfez a alteracao seguinte");
+    }
+
+    mapa->desfazer = NULL;
+    liberarMemoria(cheio);
+    liberarMemoria(inicial);
+    liberarMemoria(mapa);
+    return ok;
+}
+
+// Joga uma partida ao vivo pelo nivelMaster, gravando o log, e a reproduz:
+// o replay tem de chegar ao mesmo turno final e ao mesmo vencedor
+static int testarReplayChegaAoFimDaPartida(void) {
+    DefinicaoMapa* definicao = carregarMapaPadrao();
+    FILE* entrada = fopen(ARQUIVO_ENTRADA_TESTE, "w");
+    if (definicao == NULL || entrada == NULL) {
+        return falhar("nao foi possivel preparar o mapa ou a entrada da partida");
+    }
+    fputs(ENTRADA_PARTIDA_PASSIVA, entrada);
+    fclose(entrada);
+
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_REPLAY);
+    ResultadoPartida aoVivo, reproduzido;
+    int saida = silenciarSaida();
+    int jogou = freopen(ARQUIVO_ENTRADA_TESTE, "r", stdin) != NULL &&
+                iniciarGravacao(ARQUIVO_LOG_TESTE, SEMENTE_REPLAY, definicao);
+    if (jogou) {
+        // Os mesmos passos do main para o Nível Master
+        registrarDecisao(DECISAO_NIVEL, 2, 0, 0);
+        nivelMaster(definicao, &rng, NULL, NULL, NULL, NULL, &aoVivo);
+        encerrarGravacao();
+        jogou = reproduzirPartida(ARQUIVO_LOG_TESTE, definicao, 0, 0, &reproduzido);
+    }
+    restaurarSaida(saida);
+    remove(ARQUIVO_ENTRADA_TESTE);
+    remove(ARQUIVO_LOG_TESTE);
+    liberarDefinicaoMapa(definicao);
+    if (!jogou) {
+        return falhar("nao foi possivel jogar ou reproduzir a partida");
+    }
+
+    int ok = 1;
+    if (aoVivo.tipoFim != FIM_MISSAO) {
+        ok = falhar("a partida ao vivo deveria terminar por missao cumprida");
+    }
+    if (reproduzido.turnos != aoVivo.turnos) {
+        ok = falhar("o replay terminou em outro turno");
+    }
+    if (reproduzido.tipoFim != aoVivo.tipoFim || reproduzido.corVencedora != aoVivo.corVencedora) {
+        ok = falhar("o replay terminou com outro vencedor");
+    }
+    return ok;
+}
+
+// Salva a posição, as missões e o gerador de uma partida e carrega de volta:
+// tudo o que o jogo usa tem de voltar igual, inclusive o índice por dono
+static int testarSnapshotIdaEVolta(void) {
+    DefinicaoMapa* definicao = carregarMapaPadrao();
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    Mapa* mapa = montarMapaDaDefinicao(definicao, &rng);
+    MotorMissoes missoes;
+    gerarMissoesDosJogadores(&missoes, mapa, 1, &rng);
+    for (int i = 0; i < 20; i++) {
+        transferirTerritorio(mapa, (int)aleatorioIntervalo(&rng, (uint32_t)mapa->numTerritorios),
+                             (int)aleatorioIntervalo(&rng, JOGADORES_TESTE));
+    }
+
+    MotorMissoes carregadas;
+    EstadoRNG rngCarregado;
+    int corJogador = -1, turno = 0;
+    int saida = silenciarSaida();
+    Mapa* carregado = NULL;
+    if (salvarSnapshot(ARQUIVO_SNAPSHOT_TESTE, mapa, &missoes, 2, TURNO_SNAPSHOT, &rng)) {
+        carregado = carregarSnapshot(ARQUIVO_SNAPSHOT_TESTE, definicao, &carregadas, &corJogador, &turno,
+                                     &rngCarregado);
+    }
+    restaurarSaida(saida);
+    remove(ARQUIVO_SNAPSHOT_TESTE);
+
+    int ok = 1;
+    if (carregado == NULL) {
+        ok = falhar("o snapshot salvo nao foi carregado");
+    } else {
+        size_t n = (size_t)mapa->numTerritorios;
+        size_t contadores = (size_t)mapa->numContinentes * (MAX_CORES + 1) * sizeof(int32_t);
+        if (!mesmaPosicao(carregado, mapa) || memcmp(carregado->nomeId, mapa->nomeId, n * sizeof(uint32_t)) != 0) {
+            ok = falhar("territorios ou contadores por cor diferentes");
+        }
+        if (carregado->numContinentes != mapa->numContinentes ||
+            memcmp(carregado->territoriosPorContinente, mapa->territoriosPorContinente, contadores) != 0 ||
+            memcmp(carregado->inicioVizinhos, mapa->inicioVizinhos, (n + 1) * sizeof(int32_t)) != 0) {
+            ok = falhar("contadores por continente ou fronteiras diferentes");
+        }
+        if (memcmp(carregado->inicioDoDono, mapa->inicioDoDono, sizeof(mapa->inicioDoDono)) != 0) {
+            ok = falhar("grupos do indice por dono diferentes");
+        }
+        for (size_t i = 0; i < n; i++) {
+            int32_t posicao = carregado->posicaoPorCor[i];
+            if (carregado->territoriosPorCor[posicao] != (int32_t)i ||
+                posicao < carregado->inicioDoDono[carregado->dono[i]] ||
+                posicao >= carregado->inicioDoDono[carregado->dono[i] + 1]) {
+                ok = falhar("indice por dono inconsistente");
+                break;
+            }
+        }
+        int mesmasMissoes = carregadas.ativas == missoes.ativas && carregadas.turno == TURNO_SNAPSHOT;
+        for (int cor = 0; cor < MAX_CORES; cor++) {
+            if ((missoes.ativas & (1u << cor)) &&
+                memcmp(&carregadas.missoes[cor], &missoes.missoes[cor], sizeof(Missao)) != 0) {
+                mesmasMissoes = 0;
+            }
+        }
+        if (!mesmasMissoes) {
+            ok = falhar("missoes diferentes");
+        }
+        if (memcmp(&rngCarregado, &rng, sizeof(rng)) != 0 || corJogador != 2 || turno != TURNO_SNAPSHOT) {
+            ok = falhar("gerador, cor do jogador ou turno diferentes");
+        }
+        liberarMemoria(carregado);
+    }
+    liberarMemoria(mapa);
+    liberarDefinicaoMapa(definicao);
+    return ok;
+}
+
+// Grava uma variação do snapshot e confere que o carregamento a recusa
+static int snapshotRecusado(const char* dados, size_t tamanho, const DefinicaoMapa* definicao) {
+    MotorMissoes missoes;
+    EstadoRNG rng;
+    int corJogador, turno;
+    if (!gravarArquivoTeste(ARQUIVO_SNAPSHOT_TESTE, dados, tamanho)) {
+        return 0;
+    }
+    int saida = silenciarSaida();
+    Mapa* mapa = carregarSnapshot(ARQUIVO_SNAPSHOT_TESTE, definicao, &missoes, &corJogador, &turno, &rng);
+    restaurarSaida(saida);
+    remove(ARQUIVO_SNAPSHOT_TESTE);
+    if (mapa != NULL) {
+        liberarMemoria(mapa);
+        return 0;
+    }
+    return 1;
+}
+
+// Snapshots truncados, de outro mapa ou com valores corrompidos são recusados
+// antes de qualquer acesso aos arrays
+static int testarSnapshotsInvalidosRecusados(void) {
+    static const char MAPA_PEQUENO[] =
+        "continente Ilhas\n"
+        "territorio 0 Norte\n"
+        "territorio 0 Sul\n"
+        "territorio 0 Leste\n"
+        "fronteira 0 1\n"
+        "fronteira 1 2\n";
+    DefinicaoMapa* definicao = carregarMapaPadrao();
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    Mapa* mapa = montarMapaDaDefinicao(definicao, &rng);
+    MotorMissoes missoes;
+    gerarMissoesDosJogadores(&missoes, mapa, 1, &rng);
+    int saida = silenciarSaida();
+    int salvo = salvarSnapshot(ARQUIVO_SNAPSHOT_TESTE, mapa, &missoes, 0, TURNO_SNAPSHOT, &rng);
+    DefinicaoMapa* outroMapa = NULL;
+    if (gravarArquivoTeste(ARQUIVO_MAPA_TESTE, MAPA_PEQUENO, sizeof(MAPA_PEQUENO) - 1)) {
+        outroMapa = carregarDefinicaoMapa(ARQUIVO_MAPA_TESTE);
+    }
+    restaurarSaida(saida);
+    remove(ARQUIVO_MAPA_TESTE);
+    size_t tamanho = 0;
+    char* original = salvo ? lerArquivoTeste(ARQUIVO_SNAPSHOT_TESTE, &tamanho) : NULL;
+    char* dados = original != NULL ? (char*)malloc(tamanho) : NULL;
+    liberarMemoria(mapa);
+    if (dados == NULL || outroMapa == NULL) {
+        free(dados);
+        free(original);
+        liberarDefinicaoMapa(outroMapa);
+        liberarDefinicaoMapa(definicao);
+        return falhar("nao foi possivel preparar o snapshot ou o outro mapa");
+    }
+
+    int ok = 1;
+    CabecalhoSnapshot* cabecalho = (CabecalhoSnapshot*)dados;
+    memcpy(dados, original, tamanho);
+    if (!snapshotRecusado(dados, tamanho - ALINHAMENTO_MAPA, definicao)) {
+        ok = falhar("snapshot truncado aceito");
+    }
+    if (!snapshotRecusado(dados, tamanho, outroMapa)) {
+        ok = falhar("snapshot de outro mapa aceito");
+    }
+    cabecalho->territoriosPorDono[0] += 100000;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("contador de territorios por dono corrompido aceito");
+    }
+    memcpy(dados, original, tamanho);
+    cabecalho->tropasPorDono[1] += 7;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("contador de tropas por dono corrompido aceito");
+    }
+    memcpy(dados, original, tamanho);
+    ((uint32_t*)(dados + cabecalho->deslocamento[ARRAY_NOME_ID]))[3] = (uint32_t)definicao->numTerritorios;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("nomeId fora da definicao aceito");
+    }
+    memcpy(dados, original, tamanho);
+    ((int32_t*)(dados + cabecalho->deslocamento[ARRAY_VIZINHOS]))[0] = cabecalho->numTerritorios;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("vizinho fora do mapa aceito");
+    }
+    memcpy(dados, original, tamanho);
+    ((uint16_t*)(dados + cabecalho->deslocamento[ARRAY_CONTINENTE]))[0] = (uint16_t)cabecalho->numContinentes;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("continente fora do mapa aceito");
+    }
+    memcpy(dados, original, tamanho);
+    ((int32_t*)(dados + cabecalho->deslocamento[ARRAY_TROPAS]))[0] = 0;
+    if (!snapshotRecusado(dados, tamanho, definicao)) {
+        ok = falhar("territorio sem tropas aceito");
+    }
+
+    free(dados);
+    free(original);
+    remove(ARQUIVO_SNAPSHOT_TESTE);
+    liberarDefinicaoMapa(outroMapa);
+    liberarDefinicaoMapa(definicao);
+    return ok;
+}
+
+static Missao missaoDeTeste(TipoMissao tipo, int cor, int corAlvo, int valorAlvo) {
+    Missao missao;
+    memset(&missao, 0, sizeof(missao));
+    missao.tipo = tipo;
+    missao.cor = cor;
+    missao.corAlvo = corAlvo;
+    missao.valorAlvo = valorAlvo;
+    return missao;
+}
+
+// Cada evento marca como pendentes só as missões inscritas nele: ganho de
+// território (continente e controle, da própria cor), perda (eliminar, da cor
+// alvo) e fim de turno (sobreviver); e a eliminação cumpre a missão de eliminar
+static int testarEventosMarcamAsMissoesCertas(void) {
+    enum { CONTINENTE, ELIMINAR, CONTROLAR, SOBREVIVER }; // Cor de cada missão
+    DefinicaoMapa* definicao = carregarMapaPadrao();
+    Mapa* mapa = alocarMapa(definicao->numTerritorios);
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        mapa->dono[i] = (uint8_t)(i % 4);
+        mapa->tropas[i] = 2;
+    }
+    associarMapaCompleto(mapa, definicao);
+    recalcularContadores(mapa);
+
+    MotorMissoes motor;
+    memset(&motor, 0, sizeof(motor));
+    Missao missoes[4] = {
+        missaoDeTeste(CONQUISTAR_CONTINENTE, CONTINENTE, SEM_COR, 1),
+        missaoDeTeste(ELIMINAR_COR, ELIMINAR, SOBREVIVER, 0),
+        missaoDeTeste(CONTROLAR_TERRITORIOS, CONTROLAR, SEM_COR, mapa->numTerritorios),
+        missaoDeTeste(SOBREVIVER_TURNOS, SOBREVIVER, SEM_COR, 1000),
+    };
+    for (int cor = 0; cor < 4; cor++) {
+        atribuirMissao(&motor, &missoes[cor]);
+    }
+    int ok = 1;
+    if (motor.pendentes != 0xF || avaliarMissoes(&motor, mapa) != SEM_COR || motor.pendentes != 0) {
+        ok = falhar("missoes recem-atribuidas nao foram avaliadas uma vez");
+    }
+    mapa->missoes = &motor;
+
+    // Território de CONTROLAR para CONTINENTE: só o ganho de CONTINENTE interessa
+    // (CONTROLAR perde, e ninguém está inscrito na perda dela)
+    transferirTerritorio(mapa, 2, CONTINENTE);
+    if (motor.pendentes != (1u << CONTINENTE)) {
+        ok = falhar("ganho de territorio nao marcou so a missao de continente");
+    }
+    avaliarMissoes(&motor, mapa);
+
+    // Território de SOBREVIVER para CONTROLAR: ganho de CONTROLAR e perda da cor alvo de ELIMINAR
+    transferirTerritorio(mapa, 3, CONTROLAR);
+    if (motor.pendentes != ((1u << CONTROLAR) | (1u << ELIMINAR))) {
+        ok = falhar("perda da cor alvo nao marcou a missao de eliminar");
+    }
+    avaliarMissoes(&motor, mapa);
+
+    // Território de CONTINENTE para ELIMINAR: nenhuma missão depende disso
+    transferirTerritorio(mapa, 0, ELIMINAR);
+    if (motor.pendentes != 0) {
+        ok = falhar("troca de dono sem missao interessada marcou pendencias");
+    }
+
+    // Fim de turno: só sobreviver
+    notificarFimDeTurno(&motor, 2);
+    if (motor.pendentes != (1u << SOBREVIVER)) {
+        ok = falhar("fim de turno nao marcou so a missao de sobreviver");
+    }
+    avaliarMissoes(&motor, mapa);
+
+    // Eliminar a cor alvo: a última perda cumpre a missão de eliminar
+    int cumpriu = SEM_COR;
+    for (int i = 0; i < mapa->numTerritorios && cumpriu == SEM_COR; i++) {
+        if (mapa->dono[i] == SOBREVIVER) {
+            transferirTerritorio(mapa, i, CONTROLAR);
+            cumpriu = avaliarMissoes(&motor, mapa);
+            if (cumpriu != SEM_COR && mapa->territoriosPorDono[SOBREVIVER] != 0) {
+                ok = falhar("missao de eliminar cumprida antes da eliminacao");
+            }
+        }
+    }
+    if (cumpriu != ELIMINAR || motor.cumpridas != (1u << ELIMINAR)) {
+        ok = falhar("eliminacao da cor alvo nao cumpriu a missao de eliminar");
+    }
+
+    mapa->missoes = NULL;
+    liberarMemoria(mapa);
+    liberarDefinicaoMapa(definicao);
+    return ok;
+}
+
+// Copia para 'saida' o que foi capturado por desviarSaida(ARQUIVO_SAIDA_TESTE) e apaga o arquivo
+static void lerSaidaCapturada(char* saida, size_t tamanhoSaida) {
+    size_t tamanho = 0;
+    char* capturada = lerArquivoTeste(ARQUIVO_SAIDA_TESTE, &tamanho);
+    saida[0] = '\0';
+    if (capturada != NULL) {
+        size_t copiar = tamanho < tamanhoSaida - 1 ? tamanho : tamanhoSaida - 1;
+        memcpy(saida, capturada, copiar);
+        saida[copiar] = '\0';
+        free(capturada);
+    }
+    remove(ARQUIVO_SAIDA_TESTE);
+}
+
+// Carrega um mapa escrito em 'texto' e devolve a definição (ou NULL); a saída
+// do carregador fica em 'saida' (terminada em '\0', até tamanhoSaida bytes)
+static DefinicaoMapa* carregarMapaDeTexto(const char* texto, char* saida, size_t tamanhoSaida) {
+    saida[0] = '\0';
+    if (!gravarArquivoTeste(ARQUIVO_MAPA_TESTE, texto, strlen(texto))) {
+        return NULL;
+    }
+    int salvo = desviarSaida(ARQUIVO_SAIDA_TESTE);
+    DefinicaoMapa* definicao = carregarDefinicaoMapa(ARQUIVO_MAPA_TESTE);
+    restaurarSaida(salvo);
+    lerSaidaCapturada(saida, tamanhoSaida);
+    remove(ARQUIVO_MAPA_TESTE);
+    return definicao;
+}
+
+// Cada erro do carregador de mapas é recusado com a sua mensagem (e a linha,
+// quando o erro é de uma linha), e um mapa válido continua sendo aceito
+static int testarMapasInvalidosRecusados(void) {
+#define CABECALHO_MAPA "continente Ilhas\nterritorio 0 Norte\nterritorio 0 Sul\nterritorio 0 Leste\n"
+    static const struct {
+        const char* texto;
+        const char* mensagem;
+    } CASOS[] = {
+        { "continente Ilhas\nterritorio Norte\n", ":2: continente do territorio ausente" },
+        { "continente Ilhas\nterritorio 1 Norte\n", ":2: continente do territorio nao declarado" },
+        { "continente Ilhas\nterritorio 0 \n", ":2: territorio sem nome" },
+        { CABECALHO_MAPA "fronteira 0\n", ":5: fronteira precisa de dois territorios" },
+        { CABECALHO_MAPA "fronteira 0 1 2\n", ":5: texto extra apos a fronteira" },
+        { CABECALHO_MAPA "fronteira 2 2\n", ":5: territorio nao pode fazer fronteira consigo mesmo" },
+        { CABECALHO_MAPA "fronteira 0 100000000\n", ":5: territorio da fronteira fora do limite" },
+        { CABECALHO_MAPA "ilha 0\n", ":5: declaracao desconhecida" },
+        { "continente Ilhas\nterritorio 0 Norte\nterritorio 0 Sul\n", "pelo menos 3 territorios" },
+        { CABECALHO_MAPA "fronteira 0 3\n", "fronteira com territorio nao declarado" },
+        { CABECALHO_MAPA "territorio 0 Sul\n", "territorio 'Sul' declarado duas vezes (1 e 3)" },
+        { CABECALHO_MAPA "fronteira 0 1\nfronteira 1 2\nfronteira 1 0\n", "fronteira entre os territorios 0 e 1 repetida" },
+        { CABECALHO_MAPA "fronteira 2 1\nfronteira 2 1\n", "fronteira entre os territorios 1 e 2 repetida" },
+    };
+    char saida[512];
+    int ok = 1;
+    for (size_t i = 0; i < sizeof(CASOS) / sizeof(CASOS[0]); i++) {
+        DefinicaoMapa* definicao = carregarMapaDeTexto(CASOS[i].texto, saida, sizeof(saida));
+        if (definicao != NULL || strstr(saida, CASOS[i].mensagem) == NULL) {
+            printf("       esperado \"%s\", obtido: %s\n", CASOS[i].mensagem, definicao != NULL ? "mapa aceito" : saida);
+            ok = falhar("mapa invalido sem a mensagem de erro esperada");
+        }
+        liberarDefinicaoMapa(definicao);
+    }
+
+    // Linha longa demais (maior que o buffer de leitura)
+    char longa[TAM_LINHA_MAPA + 64];
+    memset(longa, 'x', sizeof(longa) - 2);
+    memcpy(longa, "continente ", 11);
+    longa[sizeof(longa) - 2] = '\n';
+    longa[sizeof(longa) - 1] = '\0';
+    DefinicaoMapa* definicao = carregarMapaDeTexto(longa, saida, sizeof(saida));
+    if (definicao != NULL || strstr(saida, ":1: linha longa demais") == NULL) {
+        ok = falhar("linha longa demais aceita");
+    }
+    liberarDefinicaoMapa(definicao);
+
+    // As mesmas fronteiras, cada uma uma vez, formam um mapa válido
+    definicao = carregarMapaDeTexto(CABECALHO_MAPA "fronteira 0 1\nfronteira 2 1\n", saida, sizeof(saida));
+    if (definicao == NULL || definicao->numFronteiras != 2 ||
+        definicao->inicioVizinhos[2] - definicao->inicioVizinhos[1] != 2) {
+        ok = falhar("mapa valido recusado");
+    }
+    liberarDefinicaoMapa(definicao);
+#undef CABECALHO_MAPA
+    return ok;
+}
+
+// Uma alteração sorteada entre as que o motor faz numa partida: rodada de
+// combate, batalha inteira, mudança de tropas, troca de dono ou reforços
+static void jogarLanceAleatorio(Mapa* mapa, int numJogadores, EstadoRNG* rng) {
+    uint32_t n = (uint32_t)mapa->numTerritorios;
+    int territorio = (int)aleatorioIntervalo(rng, n);
+    switch (aleatorioIntervalo(rng, 5)) {
+        case 0:
+        case 1: {
+            int atacante = territorio;
+            int defensor = (int)aleatorioIntervalo(rng, n);
+            if (mapa->tropas[atacante] <= 1 || mapa->dono[atacante] == mapa->dono[defensor]) {
+                alterarTropas(mapa, atacante, 1);
+            } else if (aleatorioIntervalo(rng, 2) == 0) {
+                resolverCombate(mapa, atacante, defensor, rng, NULL);
+            } else {
+                resolverBatalha(mapa, atacante, defensor, rng, NULL);
+            }
+            break;
+        }
+        case 2: {
+            // Saltos grandes atravessam as faixas de tropas do hash
+            int delta = (int)aleatorioIntervalo(rng, 300) - mapa->tropas[territorio] / 2;
+            alterarTropas(mapa, territorio, delta);
+            break;
+        }
+        case 3: {
+            int novoDono = (mapa->dono[territorio] + 1 + (int)aleatorioIntervalo(rng, (uint32_t)numJogadores - 1)) %
+                           numJogadores;
+            transferirTerritorio(mapa, territorio, novoDono);
+            break;
+        }
+        default:
+            aplicarReforcos(mapa, NULL);
+            break;
+    }
+}
+
+// O hash de Zobrist mantido a cada alteração e ao desfazer é sempre igual ao
+// recalculado do zero, e voltar a uma marca devolve o hash que ela tinha
+static int testarHashZobristIgualAoRecalculado(void) {
+    static PilhaDesfazer pilha;
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    Mapa* mapa = alocarMapa(TERRITORIOS_TESTE);
+    prepararMapaAleatorio(mapa, JOGADORES_TESTE, &rng);
+    ativarHashZobrist(mapa);
+    mapa->desfazer = &pilha;
+
+    int ok = 1;
+    if (mapa->hash != calcularHashZobrist(mapa)) {
+        ok = falhar("hash ativado diferente do recalculado");
+    }
+    for (int rodada = 0; rodada < 2000 && ok; rodada++) {
+        // Marcas aninhadas: até 3 níveis, cada um com alguns lances, desfeitos do mais interno ao externo
+        iniciarPilhaDesfazer(&pilha);
+        int32_t marcas[3];
+        uint64_t hashes[3];
+        int niveis = 1 + (int)aleatorioIntervalo(&rng, 3);
+        for (int nivel = 0; nivel < niveis && ok; nivel++) {
+            marcas[nivel] = pilha.numAlteracoes;
+            hashes[nivel] = mapa->hash;
+            for (int lance = (int)aleatorioIntervalo(&rng, 6); lance >= 0 && ok; lance--) {
+                jogarLanceAleatorio(mapa, JOGADORES_TESTE, &rng);
+                if (mapa->hash != calcularHashZobrist(mapa)) {
+                    ok = falhar("hash incremental diferente do recalculado depois de um lance");
+                }
+            }
+        }
+        for (int nivel = niveis - 1; nivel >= 0 && ok; nivel--) {
+            if (desfazerAte(mapa, marcas[nivel]) != 1 || mapa->hash != hashes[nivel] ||
+                mapa->hash != calcularHashZobrist(mapa)) {
+                ok = falhar("hash depois de desfazer diferente do da marca ou do recalculado");
+            }
+        }
+        // A posição segue da última marca desfeita com alguns lances sem pilha
+        mapa->desfazer = NULL;
+        jogarLanceAleatorio(mapa, JOGADORES_TESTE, &rng);
+        mapa->desfazer = &pilha;
+        if (ok && mapa->hash != calcularHashZobrist(mapa)) {
+            ok = falhar("hash incremental diferente do recalculado sem pilha de desfazer");
+        }
+    }
+    mapa->desfazer = NULL;
+    liberarMemoria(mapa);
+    return ok;
+}
+
+// Confere bit a bit que bitsDoDono marca exatamente os territórios de cada
+// cor, sem bits além do último território, e que o índice por cor concorda
+static int bitsDoDonoConferem(const Mapa* mapa) {
+    int32_t n = mapa->numTerritorios;
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        for (int32_t i = 0; i < MAX_TERRITORIOS_BITBOARD; i++) {
+            int esperado = i < n && mapa->dono[i] == cor;
+            if (testarBit(&mapa->bitsDoDono[cor], i) != esperado) {
+                return 0;
+            }
+        }
+    }
+    for (int32_t i = 0; i < n; i++) {
+        int32_t posicao = mapa->posicaoPorCor[i];
+        int cor = mapa->dono[i];
+        if (mapa->territoriosPorCor[posicao] != i || posicao < mapa->inicioDoDono[cor] ||
+            posicao >= mapa->inicioDoDono[cor + 1]) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// bitsDoDono acompanha o dono em cada transferência e em cada desfazer, com
+// marcas aninhadas, num mapa que usa as quatro palavras do bitboard
+static int testarBitsDoDonoSeguemODono(void) {
+    static PilhaDesfazer pilha;
+    static uint8_t donos[3][MAX_TERRITORIOS_BITBOARD];
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    Mapa* mapa = alocarMapa(TERRITORIOS_BITBOARD_TESTE);
+    prepararMapaAleatorio(mapa, JOGADORES_BITBOARD_TESTE, &rng);
+    mapa->desfazer = &pilha;
+    size_t bytesDonos = (size_t)mapa->numTerritorios;
+
+    int ok = bitsDoDonoConferem(mapa) || falhar("bitsDoDono do mapa novo diferente do dono");
+    for (int rodada = 0; rodada < 2000 && ok; rodada++) {
+        iniciarPilhaDesfazer(&pilha);
+        int32_t marcas[3];
+        int niveis = 1 + (int)aleatorioIntervalo(&rng, 3);
+        for (int nivel = 0; nivel < niveis && ok; nivel++) {
+            marcas[nivel] = pilha.numAlteracoes;
+            memcpy(donos[nivel], mapa->dono, bytesDonos);
+            for (int lance = (int)aleatorioIntervalo(&rng, 8); lance >= 0 && ok; lance--) {
+                int territorio = (int)aleatorioIntervalo(&rng, (uint32_t)mapa->numTerritorios);
+                int novoDono = (mapa->dono[territorio] + 1 +
+                                (int)aleatorioIntervalo(&rng, JOGADORES_BITBOARD_TESTE - 1)) %
+                               JOGADORES_BITBOARD_TESTE;
+                transferirTerritorio(mapa, territorio, novoDono);
+                if (!bitsDoDonoConferem(mapa)) {
+                    ok = falhar("bitsDoDono diferente do dono depois de uma transferência");
+                }
+            }
+        }
+        for (int nivel = niveis - 1; nivel >= 0 && ok; nivel--) {
+            if (desfazerAte(mapa, marcas[nivel]) != 1 || memcmp(mapa->dono, donos[nivel], bytesDonos) != 0) {
+                ok = falhar("desfazer não devolveu os donos da marca");
+            } else if (!bitsDoDonoConferem(mapa)) {
+                ok = falhar("bitsDoDono diferente do dono depois de desfazer");
+            }
+        }
+        // Lances variados sem pilha levam a posição adiante entre as rodadas
+        mapa->desfazer = NULL;
+        jogarLanceAleatorio(mapa, JOGADORES_BITBOARD_TESTE, &rng);
+        mapa->desfazer = &pilha;
+        if (ok && !bitsDoDonoConferem(mapa)) {
+            ok = falhar("bitsDoDono diferente do dono depois de um lance sem pilha");
+        }
+    }
+    mapa->desfazer = NULL;
+    liberarMemoria(mapa);
+    return ok;
+}
+
+// Carrega uma configuração de partida escrita em 'texto' sobre 'definicao'; a
+// saída do carregador fica em 'saida'
+static Mapa* carregarConfigDeTexto(const char* texto, const DefinicaoMapa* definicao, MotorMissoes* missoes,
+                                   int* corJogador, char* saida, size_t tamanhoSaida) {
+    saida[0] = '\0';
+    if (!gravarArquivoTeste(ARQUIVO_MAPA_TESTE, texto, strlen(texto))) {
+        return NULL;
+    }
+    EstadoRNG rng;
+    inicializarRNG(&rng, SEMENTE_TESTES);
+    int salvo = desviarSaida(ARQUIVO_SAIDA_TESTE);
+    Mapa* mapa = carregarConfigPartida(ARQUIVO_MAPA_TESTE, definicao, missoes, corJogador, &rng);
+    restaurarSaida(salvo);
+    lerSaidaCapturada(saida, tamanhoSaida);
+    remove(ARQUIVO_MAPA_TESTE);
+    return mapa;
+}
+
+// --config: a posição declarada é montada como escrita (territórios, cores,
+// tropas, jogador e missão), e cada erro, de linha ou do arquivo inteiro, é
+// recusado com a sua mensagem
+static int testarConfiguracoesDePartida(void) {
+#define POSICAO_CONFIG "territorio 5 Azul Brasil\nterritorio 3 Azul Argentina\n" \
+                       "territorio 2 Vermelho Panama\nterritorio 6 Verde Nicaragua\n"
+    DefinicaoMapa* definicao = carregarMapaPadrao();
+    MotorMissoes missoes;
+    int corJogador = SEM_COR;
+    char saida[512];
+    int ok = 1;
+
+    // Aceita: a posição do exemplo do README, sem extras
+    Mapa* mapa = carregarConfigDeTexto("# treino\njogador Vermelho\nextras nenhuma\n"
+                                       "missao continente America Central\n" POSICAO_CONFIG,
+                                       definicao, &missoes, &corJogador, saida, sizeof(saida));
+    static const char* const NOMES[] = { "Brasil", "Argentina", "Panama", "Nicaragua" };
+    static const int DONOS[] = { 0, 0, 1, 2 };
+    static const int TROPAS[] = { 5, 3, 2, 6 };
+    if (mapa == NULL) {
+        ok = falhar("configuracao valida recusada");
+    } else {
+        for (int i = 0; i < 4; i++) {
+            if (mapa->numTerritorios != 4 || strcmp(nomeDoTerritorio(mapa, i), NOMES[i]) != 0 ||
+                mapa->dono[i] != DONOS[i] || mapa->tropas[i] != TROPAS[i]) {
+                ok = falhar("territorios diferentes dos declarados");
+                break;
+            }
+        }
+        const Missao* missao = &missoes.missoes[corJogador];
+        if (corJogador != 1 || missao->tipo != CONQUISTAR_CONTINENTE || missao->valorAlvo != 1 ||
+            missoes.ativas != 0x7 || mapa->tropasPorDono[0] != 8) {
+            ok = falhar("jogador, missoes ou contadores diferentes dos declarados");
+        }
+        liberarMemoria(mapa);
+    }
+
+    // Aceita: sem 'jogador', a cor é a do primeiro território
+    mapa = carregarConfigDeTexto("territorio 2 Verde Mexico\n" POSICAO_CONFIG, definicao, &missoes, &corJogador,
+                                 saida, sizeof(saida));
+    if (mapa == NULL || corJogador != 2) {
+        ok = falhar("sem jogador declarado, a cor nao foi a do primeiro territorio");
+    }
+    liberarMemoria(mapa);
+
+    static const struct {
+        const char* texto;
+        const char* mensagem;
+    } CASOS[] = {
+        { "territorio 0 Azul Brasil\n", ":1: tropas do territorio fora do intervalo" },
+        { "territorio Azul Brasil\n", ":1: tropas do territorio ausentes" },
+        { "territorio 5 Laranja Brasil\n", ":1: cor desconhecida" },
+        { "territorio 5 Azul\n", ":1: territorio sem nome" },
+        { "territorio 5 Azul Atlantida\n", ":1: territorio nao existe no mapa" },
+        { POSICAO_CONFIG "territorio 1 Verde Brasil\n", ":5: territorio declarado duas vezes" },
+        { "jogador Azul Verde\n", ":1: jogador precisa de exatamente uma cor" },
+        { "extras talvez\n", ":1: politica de extras desconhecida" },
+        { "missao voar\n", ":1: tipo de missao desconhecido" },
+        { "missao continente Europa\n", ":1: continente nao existe no mapa" },
+        { "missao controlar 0\n", ":1: numero da missao fora do intervalo" },
+        { "missao sobreviver muito\n", ":1: missao precisa de um numero" },
+        { "invadir Brasil\n", ":1: declaracao desconhecida" },
+        { "territorio 5 Azul Brasil\nterritorio 2 Verde Panama\n", "pelo menos 3 territorios" },
+        { "jogador Amarelo\n" POSICAO_CONFIG, "a cor do jogador nao tem territorios" },
+        { "jogador Azul\nmissao eliminar Azul\n" POSICAO_CONFIG, ":2: o jogador nao pode eliminar a propria cor" },
+        { "jogador Azul\nmissao eliminar Roxo\n" POSICAO_CONFIG, ":2: a cor a eliminar nao esta em jogo" },
+        { "missao controlar 5\n" POSICAO_CONFIG, ":1: a missao pede mais territorios que os da partida" },
+        { "missao sobreviver 1000\n" POSICAO_CONFIG, ":1: a missao pede mais turnos que os da partida" },
+        { "missao continente America do Norte\n" POSICAO_CONFIG,
+          ":1: o continente da missao nao tem territorios na partida" },
+    };
+    for (size_t i = 0; i < sizeof(CASOS) / sizeof(CASOS[0]); i++) {
+        mapa = carregarConfigDeTexto(CASOS[i].texto, definicao, &missoes, &corJogador, saida, sizeof(saida));
+        if (mapa != NULL || strstr(saida, CASOS[i].mensagem) == NULL) {
+            printf("       esperado \"%s\", obtido: %s\n", CASOS[i].mensagem, mapa != NULL ? "posicao aceita" : saida);
+            ok = falhar("configuracao invalida sem a mensagem de erro esperada");
+        }
+        liberarMemoria(mapa);
+    }
+    liberarDefinicaoMapa(definicao);
+#undef POSICAO_CONFIG
+    return ok;
+}
+
+static const Teste TESTES[] = {
+    { "fim de batalha sorteado segue as rodadas, dentro e acima da tabela", testarFimDeBatalhaSegueAsRodadas },
+    { "combates em lote: AVX2 igual ao escalar rodada a rodada", testarCombatesEmLoteVetorialIgualAoEscalar },
+    { "transbordo da pilha com marcas aninhadas", testarTransbordoComMarcasAninhadas },
+    { "replay chega ao turno final e ao vencedor da partida", testarReplayChegaAoFimDaPartida },
+    { "snapshot salvo e carregado volta igual", testarSnapshotIdaEVolta },
+    { "snapshots truncados, de outro mapa ou corrompidos sao recusados", testarSnapshotsInvalidosRecusados },
+    { "mapas invalidos, com nomes ou fronteiras repetidos, sao recusados", testarMapasInvalidosRecusados },
+    { "conquistas, eliminacoes e fim de turno marcam so as missoes inscritas", testarEventosMarcamAsMissoesCertas },
+    { "configuracoes de partida aceitas e recusadas", testarConfiguracoesDePartida },
+    { "hash de Zobrist igual ao recalculado depois de fazer e desfazer", testarHashZobristIgualAoRecalculado },
+    { "bitsDoDono igual ao dono depois de transferir e desfazer", testarBitsDoDonoSeguemODono },
+};
+#define NUM_TESTES ((int)(sizeof(TESTES) / sizeof(TESTES[0])))
+
+int main(void) {
+    // Sem inicializarTabelaBatalha: o primeiro teste confere que as consultas a montam
+    int falhas = 0;
+    for (int i = 0; i < NUM_TESTES; i++) {
+        int passou = TESTES[i].funcao();
+        printf("%s[%s] %s%s\n", passou ? COR_VERDE : COR_VERMELHO_NEGRITO, passou ? "OK" : "ERRO",
+               TESTES[i].nome, COR_RESET);
+        falhas += !passou;
+    }
+    printf("\n%d de %d teste(s) passaram.\n", NUM_TESTES - falhas, NUM_TESTES);
+    liberarRenderizador();
+    return falhas > 0 ? 1 : 0;
+}
@@ -16,21 +16,103 @@
 // ============================================================================
 
 // Inclusão das bibliotecas padrão necessárias para entrada/saída, alocação de memória, manipulação de strings e tempo.
+#define _POSIX_C_SOURCE 200809L     // mmap/fstat (snapshots) em sistemas POSIX
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <locale.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <math.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <signal.h>
+
+// Snapshots são mapeados em memória onde houver mmap; nos demais sistemas, lidos de uma vez
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define WAR_TEM_MMAP 1
+#define WAR_TEM_THREADS 1           // Busca da IA em várias threads (pthreads)
+#define WAR_TEM_WRITE 1             // Quadros enviados com write() direto no descritor da saída
+#endif
+
+// Servidor de partidas (--servidor): laço de eventos com epoll, só no Linux
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#define WAR_TEM_SERVIDOR 1
+#endif
+
+// Rolagem de dados em lote com AVX2 (x86, GCC/Clang); a CPU é consultada em tempo de execução
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define WAR_TEM_AVX2 1
+#endif
+
+// Instrumentação (contadores, tempos de fase e histogramas); -DWAR_SEM_METRICAS a remove
+#ifndef WAR_SEM_METRICAS
+#define WAR_COM_METRICAS 1
+#endif
 
 // --- Constantes Globais ---
 // Definem valores fixos para o número máximo de territórios e tamanho máximo de strings, facilitando a manutenção.
-#define MAX_TERRITORIOS 20          // Máximo de territórios permitidos no jogo
+#define MAX_TERRITORIOS 20          // Máximo de territórios no cadastro interativo
 #define MIN_TERRITORIOS 3           // Mínimo de territórios para um jogo válido
 #define TAM_MAX_NOME 50             // Tamanho máximo para nomes de territórios
 #define TAM_MAX_COR 20              // Tamanho máximo para nomes de cores
-#define NUM_TERRITORIOS_PREDEFINIDOS 5  // Número de territórios pré-cadastrados
+#define NUM_TERRITORIOS_PREDEFINIDOS 5  // Territórios do Nível Aventureiro e padrão da simulação
+#define MAX_TERRITORIOS_SIMULACAO 100000000 // Limite de sanidade para mapas gerados (--territorios)
+#define ALINHAMENTO_MAPA 64         // Alinhamento (linha de cache) de cada array do mapa
+#define TAM_ARENA_INICIAL (16 * 1024)   // Bloco inicial da arena de uma sessão (cresce se preciso)
+#define TAM_PILHA_DESFAZER 4096     // Alterações guardadas por uma pilha de desfazer (16 bytes cada)
+#define MAX_TERRITORIOS_BITBOARD 256    // Mapas até este tamanho mantêm os territórios de cada cor em bits
+#define PALAVRAS_BITBOARD (MAX_TERRITORIOS_BITBOARD / 64)
 #define NUM_CORES_PREDEFINIDAS 5    // Número de cores disponíveis para exércitos
+#define MAX_CORES 16                // Capacidade do registro de cores (IDs de dono)
+#define SEM_COR (-1)                // ID usado quando nenhuma cor se aplica
 #define NUM_OPCOES_TROPAS 5         // Número de opções de tropas iniciais
+#define TROPAS_EXTRAS_CADASTRO 10   // Tropas extras distribuídas após o cadastro
+#define MAX_TURNOS_MASTER 15        // Limite de turnos de uma partida do Nível Master
+#define TAM_TABELA_BATALHA 128      // Tropas máximas (por lado) cobertas pela tabela exata de batalhas
+#define MIN_RODADAS_EM_BLOCO 8      // Rodadas seguras de 2 dados contra 2 a partir das quais são sorteadas juntas
+#define MAX_CONTINENTES 65535       // Continentes por mapa (IDs de 16 bits)
+#define TAM_LINHA_MAPA 256          // Maior linha aceita em um arquivo de mapa
+#define MAX_TROPAS_CONFIG 1000000   // Tropas iniciais de um território em --config
+#define TAM_INICIAL_QUADRO 4096     // Capacidade inicial do buffer de saída do renderizador
+#define VERBOSIDADE_PADRAO 1        // 0 = resumo, 1 = dados e duelos, 2 = mapa completo sempre
+#define ASSINATURA_LOG "WARLOG1"    // Assinatura dos arquivos de --gravar (8 bytes com o '\0')
+#define VERSAO_LOG 1                // Versão do formato do log de partidas
+#define ASSINATURA_SNAPSHOT "WARSNAP"   // Assinatura dos arquivos de --salvar (8 bytes com o '\0')
+#define VERSAO_SNAPSHOT 2           // Versão do layout dos snapshots
+#define ASSINATURA_EVENTOS "WAREVT1"    // Assinatura dos arquivos de --eventos (8 bytes com o '\0')
+#define VERSAO_EVENTOS 1            // Versão do formato do log de eventos
+#define TAM_BUFFER_EVENTOS 4096     // Eventos acumulados por thread antes de cada escrita no arquivo
+#define COR_EVENTO_NENHUMA ((uint8_t)SEM_COR)  // Cor de um evento sem cor (ex.: partida sem vencedor)
+#define TEMPO_IA_PADRAO_MS 250      // Prazo padrão da IA por jogada
+#define MAX_THREADS_IA 64           // Máximo de buscas paralelas da IA
+#define MAX_THREADS_SIMULACAO 256   // Máximo de trabalhadores de --simular
+#define LOTE_PARTIDAS 64            // Partidas retiradas de uma vez da fila de um trabalhador
+#define HORIZONTE_IA 3              // Turnos completos simulados após a jogada avaliada
+#define PROFUNDIDADE_MAX_MCTS 64    // Jogadas de um mesmo turno representadas na árvore
+#define LOTE_ITERACOES_MCTS 8       // Iterações entre consultas ao relógio
+#define EXPLORACAO_MCTS 0.7         // Constante de exploração do UCT (recompensas de 0 a 1)
+#define NUM_BALDES_TROPAS 36        // Faixas de tropas do hash de Zobrist: 0-7 exatas, depois potências de 2
+#define BITS_TRANSPOSICAO 16        // Tabela de transposição da IA com 2^16 entradas de 16 bytes
+#define AMOSTRAS_TRANSPOSICAO 16    // Simulações de uma posição antes de a sua média substituir novas simulações
+#define NUM_FAIXAS_HISTOGRAMA 16    // Faixas dos histogramas de métricas: 0, 1, 2-3, 4-7, ..., >= 2^14
+#define LANES_DADOS 4               // Fluxos intercalados do gerador de dados em lote (64 bits x 4 = AVX2)
+#define TAM_LINHA_PROTOCOLO 256     // Maior linha aceita de um cliente do --servidor
+#define MAX_SAIDA_SESSAO (1 << 20)  // Respostas pendentes de uma sessão antes de desconectar o cliente
+#define EVENTOS_POR_ESPERA 256      // Eventos lidos por chamada a epoll_wait
 
 // --- Códigos de Cores ANSI para Terminal ---
 // Cores para melhorar a experiência visual do jogo
@@ -50,31 +132,221 @@
 
 // --- Estruturas ---
 /**
- * @brief Estrutura que representa um território no jogo WAR
- * 
- * Esta estrutura contém todas as informações necessárias para um território:
- * - nome: Nome do território (ex: "Brasil", "Argentina")
- * - corExercito: Cor do exército que controla o território
+ * @brief Estado de um gerador de números pseudoaleatórios xoshiro256**
+ *
+ * Substitui o rand() global: cada partida (ou cada thread) possui o seu
+ * próprio estado, permitindo reproduzir qualquer jogo a partir da semente
+ * e rodar simulações paralelas sem estado compartilhado.
+ */
+typedef struct {
+    uint64_t s[4];                  // Estado interno (nunca todo zero)
+} EstadoRNG;
+
+/**
+ * @brief Arena de memória de uma partida (ou de uma sessão do servidor)
+ *
+ * Todo o estado de uma partida sai de um único bloco: as reservas da
+ * partida crescem do início do bloco e as temporárias (listas de trabalho
+ * de uma única função) crescem do fim, liberadas de uma vez por
+ * liberarTemporariosDaArena. Não há free individual: reiniciarArena
+ * devolve tudo em O(1) e o bloco é reaproveitado pela próxima partida.
+ *
+ * Se uma partida não couber, o que faltar vem de blocos extras do heap;
+ * no reinício seguinte eles são liberados e o bloco principal cresce para
+ * o total usado (no mínimo dobra), então, após a primeira partida de cada tamanho, partidas
+ * iguais não fazem nenhuma alocação.
+ */
+typedef struct ArenaPartida {
+    char* bruto;                    // Bloco principal como veio do malloc
+    char* base;                     // Início do bloco alinhado a ALINHAMENTO_MAPA
+    size_t capacidade;              // Bytes utilizáveis a partir de 'base'
+    size_t usado;                   // Reservas da partida: [0, usado)
+    size_t topo;                    // Reservas temporárias: [topo, capacidade)
+    void* excedentes;               // Blocos extras desta partida (lista ligada)
+    size_t bytesExcedentes;         // Soma dos extras, incorporada no próximo reinício
+} ArenaPartida;
+
+/**
+ * @brief Tipos de alteração guardados na pilha de desfazer
+ */
+typedef enum {
+    ALTERACAO_TROPAS,               // valor = tropas somadas ao território
+    ALTERACAO_DONO                  // valor = dono anterior; posicao = posição anterior no índice por dono
+} TipoAlteracao;
+
+/**
+ * @brief Uma alteração do mapa, com o necessário para revertê-la
+ */
+typedef struct {
+    int32_t tipo;                   // TipoAlteracao
+    int32_t territorio;
+    int32_t valor;
+    int32_t posicao;
+} AlteracaoMapa;
+
+/**
+ * @brief Pilha de desfazer de tamanho fixo: jogadas experimentadas sem copiar o mapa
+ *
+ * Ligada a um mapa (mapa->desfazer), recebe cada alteração feita por
+ * alterarTropas, transferirTerritorio e aplicarReforcos, e com isso por todo
+ * o motor (combate, blitz, reforços, jogadores por script). desfazerAte
+ * reverte as alterações em ordem inversa até uma marca (um valor anterior
+ * de numAlteracoes) e devolve o mapa exatamente ao estado daquele momento,
+ * inclusive os contadores e a ordem do índice por dono. Quando enche, a
+ * pilha para de registrar e marca 'transbordou', que só iniciarPilhaDesfazer
+ * limpa: até lá nenhuma marca é desfeita e a posição só volta por cópia
+ * (restaurarPosicao).
+ */
+typedef struct PilhaDesfazer {
+    int32_t numAlteracoes;          // Alterações guardadas (a marca atual)
+    int32_t transbordou;            // 1 se alguma alteração não coube
+    AlteracaoMapa alteracoes[TAM_PILHA_DESFAZER];
+} PilhaDesfazer;
+
+/**
+ * @brief Conjunto de territórios de um mapa pequeno, um bit por território
+ */
+typedef struct {
+    uint64_t palavras[PALAVRAS_BITBOARD];
+} Bitboard;
+
+/**
+ * @brief Mapa de territórios do jogo WAR em layout de "estrutura de arrays"
+ *
+ * Cada território é um índice de 0 a numTerritorios - 1, e cada atributo
+ * fica em um array denso próprio, todos dentro de um único bloco alocado:
+ * - dono: ID da cor do exército que controla o território (ver RegistroCores)
  * - tropas: Número de tropas estacionadas no território
+ * - nomeId: Índice do território na DefinicaoMapa de origem (nome e continente)
+ *
+ * Não há limite de territórios em tempo de compilação; as varreduras de fim
+ * de jogo e de missões percorrem apenas o array 'dono' (1 byte por território).
+ *
+ * As fronteiras usam os índices do próprio mapa, em formato CSR: os vizinhos
+ * de t são vizinhos[inicioVizinhos[t]] até vizinhos[inicioVizinhos[t + 1] - 1].
+ * Sem fronteiras (inicioVizinhos == NULL, mapas gerados pela simulação),
+ * qualquer território pode atacar qualquer outro.
+ *
+ * Os contadores por dono (e por continente) são mantidos incrementalmente:
+ * depois da configuração inicial (recalcularContadores), dono e tropas só
+ * mudam por transferirTerritorio/alterarTropas, e as verificações de fim de
+ * jogo e de missões viram leituras em O(1). transferirTerritorio também
+ * avisa o motor de missões ligado ao mapa, se houver, e as duas registram a
+ * alteração na pilha de desfazer ligada ao mapa, se houver, e atualizam o
+ * hash de Zobrist, se ativado.
+ *
+ * O índice por dono agrupa os territórios por cor em um único array
+ * (territoriosPorCor; os da cor c ficam entre inicioDoDono[c] e
+ * inicioDoDono[c + 1] - 1), e posicaoPorCor diz onde cada território está.
+ * Uma conquista move o território entre os grupos com uma troca por
+ * fronteira de grupo (no máximo MAX_CORES - 1): percorrer os territórios de
+ * uma cor não varre o mapa, e a leitura é sequencial no array.
+ *
+ * Em mapas de até MAX_TERRITORIOS_BITBOARD territórios, o índice também
+ * guarda os territórios de cada cor em bits (bitsDoDono, mantido junto com
+ * o índice) e, se houver fronteiras, os vizinhos de cada território em bits
+ * (vizinhosBits, montado com o índice). Os jogadores por script e a IA
+ * percorrem os próprios territórios em ordem de índice pelos bits e pulam,
+ * com um AND, os que não fazem fronteira com nenhum inimigo.
+ *
+ * Um mapa criado por alocarMapaNaArena tira da arena a própria estrutura e
+ * todos os arrays auxiliares (índice, contadores, fronteiras de submapa), e
+ * liberarMemoria não libera nada: a memória volta com reiniciarArena.
+ */
+typedef struct {
+    int numTerritorios;             // Número de territórios no mapa
+    uint8_t* dono;                  // ID da cor controladora de cada território
+    int32_t* tropas;                // Tropas de cada território
+    uint32_t* nomeId;               // Índice do território na definição de origem
+    void* bloco;                    // Bloco único que contém todos os arrays
+    size_t tamanhoBloco;            // Tamanho do bloco em bytes
+    const struct DefinicaoMapa* definicao;  // Nomes e continentes (NULL = mapa gerado)
+    const int32_t* inicioVizinhos;  // Início da lista de vizinhos (numTerritorios + 1)
+    const int32_t* vizinhos;        // Listas de vizinhos concatenadas
+    const uint16_t* continente;     // Continente de cada território (NULL = sem continentes)
+    void* blocoFronteiras;          // Fronteiras próprias (submapa); NULL se compartilhadas
+    int32_t territoriosPorDono[MAX_CORES];  // Territórios controlados por cada cor
+    int64_t tropasPorDono[MAX_CORES];       // Soma das tropas de cada cor
+    int32_t inicioDoDono[MAX_CORES + 1];    // Início do grupo de cada cor em territoriosPorCor
+    int32_t* territoriosPorCor;     // Índices de território agrupados por cor
+    int32_t* posicaoPorCor;         // Posição de cada território em territoriosPorCor
+    int numContinentes;             // Continentes cobertos pelos contadores abaixo
+    int32_t* territoriosPorContinente;  // [continente * MAX_CORES + dono]
+    int32_t* tamanhoContinente;     // Territórios de cada continente no mapa
+    void* mapeamento;               // Snapshot mapeado que contém os arrays (NULL = memória própria)
+    size_t tamanhoMapeamento;       // Tamanho do mapeamento em bytes
+    struct MotorMissoes* missoes;   // Notificado a cada troca de dono (NULL = nenhum)
+    ArenaPartida* arena;            // Origem da memória do mapa (NULL = heap)
+    PilhaDesfazer* desfazer;        // Registra cada alteração para desfazerAte (NULL = não registrar)
+    uint64_t hash;                  // Hash de Zobrist da posição (só vale com comHash)
+    int comHash;                    // 1 = hash mantido a cada alteração (ativarHashZobrist)
+    const Bitboard* vizinhosBits;   // Vizinhos de cada território em bits (NULL = sem fronteiras ou mapa grande)
+    Bitboard bitsDoDono[MAX_CORES]; // Territórios de cada cor em bits (só em mapas pequenos)
+} Mapa;
+
+/**
+ * @brief Definição de um mapa: nomes, continentes e fronteiras
+ *
+ * Carregada uma única vez (arquivo de --mapa ou mapa embutido) e apenas lida
+ * durante o jogo. As fronteiras ficam no mesmo formato CSR do Mapa, indexadas
+ * pela ordem de declaração dos territórios no arquivo.
+ */
+typedef struct DefinicaoMapa {
+    int numTerritorios;             // Territórios declarados
+    int numContinentes;             // Continentes declarados
+    int numFronteiras;              // Fronteiras (cada uma aparece duas vezes em 'vizinhos')
+    char* nomes;                    // Nomes dos territórios, cada um terminado em '\0'
+    uint32_t* inicioNome;           // Deslocamento do nome de cada território em 'nomes'
+    uint16_t* continente;           // Continente de cada território
+    char (*nomesContinentes)[TAM_MAX_NOME]; // Nome de cada continente
+    int32_t* inicioVizinhos;        // Início da lista de vizinhos (numTerritorios + 1)
+    int32_t* vizinhos;              // Listas de vizinhos concatenadas
+} DefinicaoMapa;
+
+/**
+ * @brief Registro das cores (jogadores) em jogo
+ *
+ * O motor do jogo identifica os exércitos apenas por IDs inteiros pequenos
+ * (índices neste registro); os nomes servem somente para exibição.
+ * As NUM_CORES_PREDEFINIDAS primeiras entradas são as cores do cadastro.
+ */
+typedef struct {
+    int numCores;                           // Cores registradas
+    char nomes[MAX_CORES][TAM_MAX_COR];     // Nome de exibição de cada ID
+} RegistroCores;
+
+// --- Renderização ---
+/**
+ * @brief Camada de saída do jogo interativo
+ *
+ * Cada quadro (mapa, combate, reforços) é montado em um único buffer e
+ * enviado ao terminal de uma vez. O renderizador guarda o dono e as tropas
+ * de cada território do último mapa exibido para redesenhar apenas as linhas
+ * que mudaram.
  */
 typedef struct {
-    char nome[TAM_MAX_NOME];        // Nome do território
-    char corExercito[TAM_MAX_COR];  // Cor do exército controlador
-    int tropas;                     // Número de tropas no território
-} Territorio;
+    char* quadro;                   // Texto do quadro em construção
+    size_t tamanho;                 // Bytes usados em 'quadro'
+    size_t capacidade;              // Bytes alocados em 'quadro'
+    int verbosidade;                // Nível de detalhe (ver VERBOSIDADE_PADRAO)
+    const Mapa* mapaExibido;        // Mapa do último quadro de mapa (NULL = nenhum)
+    int numExibidos;                // Territórios registrados abaixo
+    uint8_t* donoExibido;           // Dono de cada território no último quadro
+    int32_t* tropasExibidas;        // Tropas de cada território no último quadro
+} Renderizador;
 
 // --- Sistema de Missões ---
 /**
  * @brief Enumeração dos tipos de missões disponíveis no jogo
  * 
  * Define os diferentes objetivos que um jogador pode receber:
- * - CONQUISTAR_CONTINENTE: Dominar todos os territórios de uma cor específica
+ * - CONQUISTAR_CONTINENTE: Dominar todos os territórios de um continente do mapa
  * - ELIMINAR_COR: Eliminar completamente uma cor específica do mapa
  * - CONTROLAR_TERRITORIOS: Controlar um número específico de territórios
  * - SOBREVIVER_TURNOS: Sobreviver por um número específico de turnos
  */
 typedef enum {
-    CONQUISTAR_CONTINENTE,      // Dominar todos os territórios de uma cor
+    CONQUISTAR_CONTINENTE,      // Dominar todos os territórios de um continente
     ELIMINAR_COR,              // Eliminar uma cor específica
     CONTROLAR_TERRITORIOS,     // Controlar X territórios
     SOBREVIVER_TURNOS          // Sobreviver X turnos
@@ -86,1030 +358,7844 @@ typedef enum {
  * Contém todas as informações necessárias para uma missão:
  * - tipo: Tipo da missão (enum TipoMissao)
  * - descricao: Descrição textual da missão
- * - corAlvo: Cor alvo (para missões que envolvem cores específicas)
- * - valorAlvo: Valor numérico alvo (territórios ou turnos)
+ * - corAlvo: ID da cor alvo (para missões que envolvem cores específicas)
+ * - valorAlvo: Valor numérico alvo (territórios, turnos ou ID do continente)
  * - cumprida: Status de cumprimento da missão
+ * - cor: Cor do exército que recebeu a missão
  */
 typedef struct {
     TipoMissao tipo;                    // Tipo da missão
     char descricao[100];                // Descrição da missão
-    char corAlvo[TAM_MAX_COR];         // Cor alvo (se aplicável)
-    int valorAlvo;                      // Valor alvo (territórios/turnos)
+    int corAlvo;                        // ID da cor alvo (SEM_COR se não se aplica)
+    int valorAlvo;                      // Valor alvo (territórios/turnos/continente)
     int cumprida;                       // 0 = não cumprida, 1 = cumprida
+    int cor;                            // Cor dona da missão
 } Missao;
 
-// --- Protótipos das Funções ---
-// Declarações antecipadas de todas as funções que serão usadas no programa, organizadas por categoria.
+/**
+ * @brief Motor de missões orientado a eventos (uma missão por cor em jogo)
+ *
+ * Cada missão se inscreve nos eventos que podem cumpri-la: a sua cor ganhar
+ * um território (continente e controle de territórios), a cor alvo perder um
+ * território (eliminar cor) e o fim de um turno (sobreviver). Um evento só
+ * marca as missões inscritas como pendentes; avaliarMissoes reavalia apenas
+ * essas. Os conjuntos de missões são máscaras de bits, um bit por cor.
+ */
+typedef struct MotorMissoes {
+    Missao missoes[MAX_CORES];          // Missão de cada cor (válida se o bit está em 'ativas')
+    uint32_t ativas;                    // Cores que receberam missão
+    uint32_t cumpridas;                 // Missões já cumpridas
+    uint32_t pendentes;                 // Missões a reavaliar na próxima avaliação
+    uint32_t inscritasGanho[MAX_CORES]; // Reavaliar quando a cor ganha um território
+    uint32_t inscritasPerda[MAX_CORES]; // Reavaliar quando a cor perde um território
+    uint32_t inscritasFimDeTurno;       // Reavaliar a cada fim de turno
+    int turno;                          // Turno corrente (usado por SOBREVIVER_TURNOS)
+} MotorMissoes;
 
-// === FUNÇÕES UTILITÁRIAS ===
+// --- Combate ---
 /**
- * @brief Limpa o buffer de entrada para evitar problemas com scanf
+ * @brief Resultado detalhado de uma rodada de combate
+ *
+ * Preenchido pelo núcleo silencioso do combate (resolverCombate) e usado
+ * pela camada interativa apenas para exibição:
+ * - dadosAtacante/dadosDefensor: quantidade de dados rolados por lado
+ * - resultadosAtacante/resultadosDefensor: dados já ordenados (maior primeiro)
+ * - tropasAtacanteAntes/tropasDefensorAntes: tropas antes de aplicar as perdas
+ * - perdasAtacante/perdasDefensor: tropas perdidas por cada lado
  */
-void limparBufferEntrada(void);
+typedef struct {
+    int dadosAtacante;                  // Dados rolados pelo atacante (1 ou 2)
+    int dadosDefensor;                  // Dados rolados pelo defensor (1 ou 2)
+    int resultadosAtacante[2];          // Dados do atacante em ordem decrescente
+    int resultadosDefensor[2];          // Dados do defensor em ordem decrescente
+    int tropasAtacanteAntes;            // Tropas do atacante antes da rodada
+    int tropasDefensorAntes;            // Tropas do defensor antes da rodada
+    int perdasAtacante;                 // Tropas perdidas pelo atacante
+    int perdasDefensor;                 // Tropas perdidas pelo defensor
+} ResultadoCombate;
 
 /**
- * @brief Lê uma string de forma segura, removendo quebras de linha
- * @param destino Ponteiro para onde armazenar a string
- * @param tamanhoMax Tamanho máximo da string
+ * @brief Resultado exato esperado de uma batalha completa
+ *
+ * Uma batalha é a sequência de rodadas de simularAtaque entre o mesmo par de
+ * territórios até a conquista (defensor com 0 tropas) ou até o atacante ficar
+ * com apenas 1 tropa. Os valores são a solução exata da cadeia de Markov
+ * sobre os estados (tropas do atacante, tropas do defensor).
  */
-void lerString(char* destino, int tamanhoMax);
+typedef struct {
+    double probVitoria;                 // Probabilidade de o atacante conquistar
+    double atacantesRestantes;          // Tropas esperadas do atacante ao final
+    double defensoresRestantes;         // Tropas esperadas do defensor ao final
+} ProbabilidadeBatalha;
 
-// === FUNÇÕES DE CADASTRO E EXIBIÇÃO ===
 /**
- * @brief Cadastra territórios com seleção dinâmica e validação de duplicatas
- * @param territorios Array de territórios a ser preenchido
- * @param tamanho Número de territórios a cadastrar
+ * @brief Distribuição exata do estado final de uma batalha, em tabela de alias
+ *
+ * Os resultados possíveis a partir de (a, d) tropas são numerados assim:
+ * k < a = conquista com k + 1 tropas restantes no atacante; k >= a = atacante
+ * reduzido a 1 tropa com k - a + 1 tropas restantes no defensor. Pelo método
+ * de Vose, sortear um resultado custa um índice uniforme e uma comparação,
+ * qualquer que seja o tamanho dos exércitos.
  */
-void cadastrarTerritorios(Territorio territorios[], int tamanho);
+typedef struct {
+    int32_t numResultados;              // a + d
+    double* probabilidade;              // Chance de manter a coluna sorteada
+    int32_t* alias;                     // Resultado alternativo de cada coluna
+} DistribuicaoBatalha;
 
 /**
- * @brief Exibe o mapa atual com todos os territórios e suas informações
- * @param territorios Array de territórios (somente leitura)
- * @param tamanho Número de territórios no array
+ * @brief Resultado de uma batalha completa resolvida de uma vez (blitz)
  */
-void exibirMapa(const Territorio territorios[], int tamanho);
+typedef struct {
+    int tropasAtacanteAntes;            // Tropas do atacante antes da batalha
+    int tropasDefensorAntes;            // Tropas do defensor antes da batalha
+    int perdasAtacante;                 // Tropas perdidas pelo atacante
+    int perdasDefensor;                 // Tropas perdidas pelo defensor
+    int conquistou;                     // 1 = defensor conquistado
+} ResultadoBatalha;
 
-// === FUNÇÕES DE SELEÇÃO DINÂMICA ===
 /**
- * @brief Permite seleção de território com validação de duplicatas
- * @param territoriosUsados Array com índices dos territórios já utilizados
- * @param numUsados Número de territórios já utilizados
- * @return Índice do território selecionado
+ * @brief Gerador dos combates em lote: LANES_DADOS fluxos xoshiro256** intercalados
+ *
+ * s[k][p] é a palavra k do estado do fluxo p, de modo que os fluxos avançam
+ * juntos em um registrador vetorial. A rodada i de um lote sempre usa o
+ * fluxo i % LANES_DADOS, então o caminho escalar e o vetorial consomem
+ * exatamente os mesmos números e produzem as mesmas perdas.
  */
-int selecionarTerritorio(int territoriosUsados[], int numUsados);
+typedef struct {
+    _Alignas(32) uint64_t s[4][LANES_DADOS];
+} GeradorDados;
 
+// --- Gravação e Replay de Partidas ---
 /**
- * @brief Permite seleção de cor com validação de duplicatas
- * @param corEscolhida String onde será armazenada a cor escolhida
- * @param coresUsadas Array com índices das cores já utilizadas
- * @param numUsadas Número de cores já utilizadas
- * @return Índice da cor selecionada
+ * @brief Tipos de decisão registrados no log de uma partida
  */
-int selecionarCor(char* corEscolhida, int coresUsadas[], int numUsadas);
+typedef enum {
+    DECISAO_NIVEL = 1,          // Nível escolhido no menu (valores[0])
+    DECISAO_NUM_TERRITORIOS,    // Territórios do Nível Master (valores[0])
+    DECISAO_TERRITORIO,         // Cadastro: território da definição, cor e tropas
+    DECISAO_TURNO,              // Início das ações de um turno do Nível Master (valores[0])
+    DECISAO_ATAQUE              // Ataque: atacante, defensor (índices do mapa) e modo (ModoAtaque)
+} TipoDecisao;
 
 /**
- * @brief Permite seleção do número inicial de tropas
- * @return Número de tropas selecionado
+ * @brief Modo de um ataque registrado (valores[2] de DECISAO_ATAQUE)
  */
-int selecionarTropas(void);
+typedef enum {
+    ATAQUE_RODADA = 0,          // Uma rodada de dados
+    ATAQUE_BLITZ = 1            // Batalha completa, até a conquista ou 1 tropa no atacante
+} ModoAtaque;
 
-// === FUNÇÕES DE GERENCIAMENTO DE MEMÓRIA ===
 /**
- * @brief Aloca memória dinamicamente para o mapa de territórios
- * @param numTerritorios Número de territórios a alocar
- * @return Ponteiro para o array de territórios alocado
+ * @brief Cabeçalho do log de partida (gravado uma vez, no início do arquivo)
  */
-Territorio* alocarMapa(int numTerritorios);
+typedef struct {
+    char assinatura[8];                 // ASSINATURA_LOG
+    uint32_t versao;                    // VERSAO_LOG
+    uint32_t numTerritoriosMapa;        // Territórios da definição usada (conferido no replay)
+    uint64_t semente;                   // Semente do gerador da partida
+    uint32_t numFronteirasMapa;         // Fronteiras da definição usada (conferido no replay)
+    uint32_t reservado;                 // Zero (alinhamento)
+} CabecalhoLog;
 
 /**
- * @brief Libera a memória alocada para os territórios
- * @param territorios Ponteiro para o array a ser liberado
+ * @brief Uma decisão do jogador, com tamanho fixo de 16 bytes
  */
-void liberarMemoria(Territorio* territorios);
+typedef struct {
+    uint8_t tipo;                       // TipoDecisao
+    uint8_t reservado[3];               // Zero (alinhamento)
+    int32_t valores[3];                 // Parâmetros da decisão (ver TipoDecisao)
+} RegistroDecisao;
 
-// === FUNÇÕES DE COMBATE ===
+// --- Snapshots de Partida ---
 /**
- * @brief Simula um ataque entre dois territórios com sistema de dados
- * @param atacante Ponteiro para o território atacante (modificável)
- * @param defensor Ponteiro para o território defensor (modificável)
- * @return 0=ataque falhou, 1=ataque bem-sucedido, 2=território conquistado
+ * @brief Arrays gravados em um snapshot, na ordem em que aparecem no arquivo
  */
-int simularAtaque(Territorio* atacante, Territorio* defensor);
+typedef enum {
+    ARRAY_TROPAS,                       // int32_t[numTerritorios]
+    ARRAY_NOME_ID,                      // uint32_t[numTerritorios]
+    ARRAY_DONO,                         // uint8_t[numTerritorios]
+    ARRAY_INICIO_VIZINHOS,              // int32_t[numTerritorios + 1]
+    ARRAY_VIZINHOS,                     // int32_t[total de vizinhos]
+    ARRAY_CONTINENTE,                   // uint16_t[numTerritorios]
+    ARRAY_CONTADORES_CONTINENTE,        // int32_t[numContinentes * (MAX_CORES + 1)]
+    NUM_ARRAYS_SNAPSHOT
+} ArraySnapshot;
 
 /**
- * @brief Gerencia a fase de ataques do jogo
- * @param territorios Array de territórios (modificável)
- * @param numTerritorios Número de territórios no jogo
+ * @brief Cabeçalho de um snapshot de partida
+ *
+ * Layout fixo (o da própria plataforma, como a struct em memória): o
+ * cabeçalho é seguido pelos arrays do mapa, cada um alinhado a
+ * ALINHAMENTO_MAPA bytes. Ao carregar, o arquivo é mapeado em memória e os
+ * arrays são usados diretamente como armazenamento do Mapa, sem cópia.
  */
-void faseDeAtaque(Territorio* territorios, int numTerritorios);
+typedef struct {
+    char assinatura[8];                 // ASSINATURA_SNAPSHOT
+    uint32_t versao;                    // VERSAO_SNAPSHOT
+    uint32_t tamanhoCabecalho;          // sizeof(CabecalhoSnapshot)
+    uint64_t tamanhoArquivo;            // Tamanho total do arquivo em bytes
+    int32_t numTerritorios;             // Territórios do mapa salvo
+    int32_t numContinentes;             // Continentes cobertos pelos contadores
+    int32_t turno;                      // Próximo turno a ser jogado
+    uint32_t numTerritoriosMapa;        // Territórios da definição usada (conferido na carga)
+    uint32_t numFronteirasMapa;         // Fronteiras da definição usada (conferido na carga)
+    int32_t corJogador;                 // Cor comandada pelo jogador
+    EstadoRNG rng;                      // Estado do gerador ao salvar
+    uint32_t missoesAtivas;             // Cores com missão (um bit por cor)
+    Missao missoes[MAX_CORES];          // Missão de cada cor (inscrições refeitas na carga)
+    int32_t territoriosPorDono[MAX_CORES];  // Contadores incrementais do mapa
+    int64_t tropasPorDono[MAX_CORES];
+    uint64_t deslocamento[NUM_ARRAYS_SNAPSHOT]; // Início de cada array no arquivo
+    uint64_t tamanho[NUM_ARRAYS_SNAPSHOT];      // Bytes de cada array
+} CabecalhoSnapshot;
 
-// === FUNÇÕES DO NÍVEL MASTER ===
+// --- Inteligência Artificial (MCTS) ---
 /**
- * @brief Implementa o Nível Master com territórios dinâmicos e sistema de reforços
+ * @brief Parâmetros dos exércitos controlados pelo computador (--ia)
  */
-void nivelMaster(void);
+typedef struct {
+    int tempoMs;                        // Prazo de decisão por jogada, em milissegundos
+    int numThreads;                     // Buscas paralelas (uma árvore por thread)
+    uint64_t semente;                   // Semente própria (não consome o gerador da partida)
+    uint64_t jogadas;                   // Jogadas decididas (deriva a semente de cada busca)
+} ConfigIA;
 
 /**
- * @brief Implementa a fase de reforços baseada no controle territorial
- * @param territorios Array de territórios (modificável)
- * @param numTerritorios Número de territórios no jogo
+ * @brief Ação do turno da IA: uma rodada de combate ou encerrar os ataques
  */
-void faseDeReforcos(Territorio* territorios, int numTerritorios);
+typedef struct {
+    int32_t atacante;                   // -1 = encerrar ataques
+    int32_t defensor;
+    int32_t indice;                     // Identificador estável (0 = encerrar; demais: aresta do mapa + 1)
+} AcaoIA;
 
 /**
- * @brief Solicita ao usuário o número de territórios para o jogo
- * @return Número de territórios selecionado (entre MIN_TERRITORIOS e MAX_TERRITORIOS)
+ * @brief Nó da árvore de busca
+ *
+ * Árvore em laço aberto: um nó representa a sequência de ações até ele, e os
+ * dados são sorteados de novo a cada iteração. Por isso um filho pode ser
+ * inválido no estado sorteado e é ignorado nessa iteração.
  */
-int selecionarNumeroTerritorios(void);
+typedef struct {
+    AcaoIA acao;                        // Ação que leva a este nó
+    int32_t primeiroFilho;              // Índice no pool da árvore (-1 = folha)
+    int32_t proximoIrmao;               // Próximo filho do mesmo pai (-1 = último)
+    uint32_t visitas;                   // Iterações que passaram pelo nó
+    double somaRecompensas;             // Soma das recompensas (0 a 1) da cor da IA
+} NoMCTS;
 
-// === FUNÇÕES DE CONTROLE DE JOGO ===
 /**
- * @brief Verifica se o jogo terminou (todos territórios da mesma cor)
- * @param territorios Array de territórios (somente leitura)
- * @param numTerritorios Número de territórios no jogo
- * @return 1 se o jogo terminou, 0 caso contrário
+ * @brief Entrada da tabela de transposição: a chave é guardada com XOR dos dados
+ *
+ * Escritas concorrentes podem intercalar chave e dados de duas posições; a
+ * leitura confere (chave ^ dados) == hash e descarta a entrada rasgada.
  */
-int verificarFimDeJogo(const Territorio territorios[], int numTerritorios);
+typedef struct {
+    _Atomic uint64_t chave;             // Hash da posição XOR dados
+    _Atomic uint64_t dados;             // Simulações (32 bits altos) e soma das recompensas (ponto fixo, 16 bits)
+} EntradaTransposicao;
 
-// === FUNÇÕES DO SISTEMA DE MISSÕES ===
 /**
- * @brief Gera uma missão aleatória para o jogador
- * @param missao Ponteiro para a estrutura Missao a ser preenchida
- * @param territorios Array de territórios (para análise das cores disponíveis)
- * @param numTerritorios Número de territórios no jogo
+ * @brief Tabela de transposição de tamanho fixo, compartilhada sem travas pelas threads da IA
  */
-void gerarMissaoAleatoria(Missao* missao, const Territorio territorios[], int numTerritorios);
+typedef struct {
+    EntradaTransposicao* entradas;
+    uint64_t mascara;                   // Entradas - 1 (potência de 2)
+} TabelaTransposicao;
 
 /**
- * @brief Verifica se a missão atual foi cumprida
- * @param missao Ponteiro para a missão a ser verificada (somente leitura)
- * @param territorios Array de territórios (somente leitura)
- * @param numTerritorios Número de territórios no jogo
- * @param turnoAtual Turno atual do jogo
- * @return 1 se a missão foi cumprida, 0 caso contrário
+ * @brief Estado de uma busca; cada thread tem a sua árvore (paralelismo na raiz)
  */
-int verificarMissao(const Missao* missao, const Territorio territorios[], int numTerritorios, int turnoAtual);
+typedef struct {
+    const Mapa* raiz;                   // Posição atual (somente leitura, compartilhada)
+    uint64_t hashRaiz;                  // Hash de Zobrist da raiz
+    TabelaTransposicao* transposicao;   // Avaliações de posições repetidas (compartilhada)
+    long reaproveitadas;                // Iterações avaliadas pela tabela, sem simulação
+    int cor;                            // Cor controlada pela IA
+    double prazo;                       // Instante limite (tempoAtualSegundos)
+    uint64_t semente;                   // Semente desta thread
+    NoMCTS* nos;                        // Pool de nós (índice 0 = raiz)
+    int32_t numNos;
+    int32_t capacidadeNos;
+    long iteracoes;                     // Iterações completadas
+} BuscaMCTS;
 
 /**
- * @brief Exibe a missão atual do jogador
- * @param missao Ponteiro para a missão a ser exibida (somente leitura)
+ * @brief Jogada escolhida pela IA
  */
-void exibirMissao(const Missao* missao);
+typedef struct {
+    int atacante;                       // -1 = encerrar ataques
+    int defensor;
+    long visitas;                       // Visitas da jogada somadas entre as threads
+    double valorEsperado;               // Recompensa média estimada (0 a 1)
+    long iteracoes;                     // Iterações de todas as threads
+    long reaproveitadas;                // Iterações avaliadas pela tabela de transposição
+} JogadaIA;
 
-// --- Função Principal (main) ---
-// Função principal que orquestra o fluxo do jogo, chamando as outras funções em ordem.
-int main() {
-    // 1) Setup básico
-    setlocale(LC_ALL, "Portuguese_Brazil.1252"); // Configurar para português brasileiro
-    srand((unsigned int)time(NULL)); // Inicializar gerador de números aleatórios
+// --- Log de Eventos da Simulação (--eventos) ---
+/**
+ * @brief Tipos de evento do log binário de --eventos
+ */
+typedef enum {
+    EVENTO_ATAQUE = 1,          // Rodada ou batalha blitz: cor atacante, corAlvo defensora, detalhe ModoAtaque;
+                                // valores: tropas do atacante e do defensor antes, perdas do atacante e do defensor
+    EVENTO_REFORCO,             // Reforço de uma cor: valores[0] tropas recebidas, valores[1] territórios da cor
+    EVENTO_MISSAO_ATRIBUIDA,    // Missão de uma cor no início da partida: detalhe TipoMissao, valores[0] turno
+    EVENTO_MISSAO_VERIFICADA,   // Verificação: detalhe TipoMissao, valores[0] turno, valores[1] 1 se cumprida
+    EVENTO_FIM_PARTIDA          // Fim: cor vencedora, detalhe TipoFimPartida, valores[0] turnos jogados,
+                                // valores[1] TipoMissao cumprida (-1 se a partida terminou de outra forma)
+} TipoEvento;
 
-    // Menu de seleção de nível
-    int opcao;
-    printf("\n%s================ JOGO WAR - SELECAO DE NIVEL ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
-    printf("Escolha o nivel de dificuldade:\n");
-    printf("%s1%s - %sNivel Aventureiro (Basico)%s\n", COR_VERDE_NEGRITO, COR_RESET, COR_VERDE, COR_RESET);
-    printf("%s2%s - %sNivel Master (Cartas e Missoes)%s\n", COR_AZUL, COR_RESET, COR_AZUL, COR_RESET);
-    printf("%s=========================================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
-    printf(">> Digite sua opcao (1 ou 2): ");
-    scanf("%d", &opcao);
-    limparBufferEntrada();
+/**
+ * @brief Cabeçalho do log de eventos (início do arquivo, seguido dos registros)
+ */
+typedef struct {
+    char assinatura[8];                 // ASSINATURA_EVENTOS
+    uint32_t versao;                    // VERSAO_EVENTOS
+    uint32_t tamanhoRegistro;           // sizeof(RegistroEvento), conferido na leitura
+    uint64_t numRegistros;              // Eventos no arquivo (gravado ao fechar; 0 = arquivo incompleto)
+    uint64_t semente;                   // Semente do lote
+    int32_t numTerritorios;             // Parâmetros do lote, repetidos no relatório da análise
+    int32_t numJogadores;
+    int32_t maxTurnos;
+    int32_t blitz;
+} CabecalhoEventos;
 
-    if (opcao == 2) {
-        nivelMaster();
-        return 0;
-    }
+/**
+ * @brief Um evento da simulação, com tamanho fixo de 24 bytes
+ *
+ * Cada registro é completo por si só (traz a partida e as tropas de antes),
+ * então qualquer trecho do arquivo pode ser analisado sem os vizinhos.
+ */
+typedef struct {
+    uint8_t tipo;                       // TipoEvento
+    uint8_t cor;                        // Cor que age (COR_EVENTO_NENHUMA se nenhuma)
+    uint8_t corAlvo;                    // Cor defensora ou alvo da missão (COR_EVENTO_NENHUMA se não se aplica)
+    uint8_t detalhe;                    // Ver TipoEvento
+    uint32_t partida;                   // Índice da partida no lote
+    int32_t valores[4];                 // Ver TipoEvento
+} RegistroEvento;
 
-    // Nível Aventureiro (código original)
-    // 2) Alocação dinâmica de memória para territórios
-    Territorio* territorios = alocarMapa(5);  // Nível básico usa 5 territórios fixos
+/**
+ * @brief Arquivo de --eventos compartilhado pelos trabalhadores
+ *
+ * Cada trabalhador acumula eventos no seu próprio buffer e, quando ele
+ * enche, reserva o trecho seguinte do arquivo com um único fetch_add e o
+ * grava com pwrite: as threads escrevem em paralelo, sem travas. A ordem dos
+ * blocos no arquivo não é determinística; a dos eventos de uma partida, sim.
+ */
+typedef struct {
+    const char* caminho;
+#ifdef WAR_TEM_THREADS
+    int descritor;
+#else
+    FILE* arquivo;
+#endif
+    _Atomic uint64_t fim;               // Próximo byte livre do arquivo
+    _Atomic uint64_t numRegistros;      // Eventos já gravados
+    _Atomic int erro;                   // 1 se alguma escrita falhou
+    CabecalhoEventos cabecalho;
+} ArquivoEventos;
 
-    // 3) Cadastro dos territórios
-    cadastrarTerritorios(territorios, 5);
+/**
+ * @brief Buffer de eventos de um trabalhador (uma thread)
+ */
+typedef struct {
+    ArquivoEventos* arquivo;
+    uint32_t partida;                   // Partida em curso na thread
+    int numRegistros;                   // Eventos no buffer
+    RegistroEvento registros[TAM_BUFFER_EVENTOS];
+} GravadorEventos;
 
-    // 4) Exibir o mapa inicial
-    printf("\n[*] INICIANDO JOGO WAR - NIVEL AVENTUREIRO [*]\n");
-    exibirMapa(territorios, 5);
+// --- Simulação em Lote (modo headless) ---
+/**
+ * @brief Parâmetros do modo de simulação em lote (--simular)
+ */
+typedef struct {
+    long numPartidas;                   // Quantidade de partidas a simular
+    int numTerritorios;                 // Territórios por partida
+    int numJogadores;                   // Jogadores (cores) por partida
+    int maxTurnos;                      // Limite de turnos por partida
+    uint64_t semente;                   // Semente do lote (partida i usa sementeDaPartida(semente, i))
+    const DefinicaoMapa* definicao;     // Mapa de --mapa (NULL = mapa gerado, sem fronteiras)
+    const Mapa* posicaoInicial;         // Snapshot de partida (--carregar); NULL = mapa aleatório
+    MotorMissoes missoesIniciais;       // Missões do snapshot
+    int turnoInicial;                   // Turno do snapshot
+    int numThreads;                     // Trabalhadores do pool (--threads)
+    int blitz;                          // 1 = jogadores automáticos resolvem cada batalha de uma vez (--blitz)
+    const char* arquivoEventos;         // Log binário de eventos (--eventos); NULL = não gravar
+} ConfigSimulacao;
 
-    // 5) Fase de ataques (Nível Aventureiro)
-    faseDeAtaque(territorios, 5);
+/**
+ * @brief Forma como uma partida automática terminou
+ */
+typedef enum {
+    FIM_SEM_VENCEDOR,           // Limite de turnos atingido
+    FIM_DOMINACAO,              // Todos os territórios com a mesma cor
+    FIM_MISSAO                  // Missão do jogador cumprida
+} TipoFimPartida;
 
-    // 6) Exibir o mapa final
-    printf("\n[*] RESULTADO FINAL DA BATALHA [*]\n");
-    exibirMapa(territorios, 5);
+/**
+ * @brief Resultado de uma única partida automática
+ */
+typedef struct {
+    TipoFimPartida tipoFim;             // Como a partida terminou
+    int corVencedora;                   // Índice da cor vencedora (-1 se nenhuma)
+    int turnos;                         // Turnos jogados
+    int missaoCumprida;                 // 1 se a missão do jogador foi cumprida
+} ResultadoPartida;
 
-    // 7) Liberar memória alocada
-    liberarMemoria(territorios);
+/**
+ * @brief Estatísticas agregadas de um lote de partidas
+ */
+typedef struct {
+    long partidas;                                  // Partidas jogadas
+    long vitoriasPorCor[MAX_CORES];                 // Vitórias de cada cor
+    long fimPorTipo[3];                             // Partidas por TipoFimPartida
+    long missoesCumpridas;                          // Partidas com missão cumprida
+    long totalTurnos;                               // Soma dos turnos jogados
+    int minTurnos;                                  // Menor duração observada
+    int maxTurnos;                                  // Maior duração observada
+    int threads;                                    // Trabalhadores que jogaram o lote
+    long roubos;                                    // Intervalos de partidas roubados entre trabalhadores
+    long minPartidasThread;                         // Menor número de partidas de um trabalhador
+    long maxPartidasThread;                         // Maior número de partidas de um trabalhador
+} EstatisticasSimulacao;
 
-    printf("\n[*] PARABENS! Voce completou o nivel Aventureiro com sucesso! [*]\n");
-    printf("[*] Proximo desafio: Evolua o codigo para o nivel Mestre!\n");
-    printf("[*] Sugestoes para o nivel Mestre:\n");
-    printf("   - Sistema de cartas e missoes\n");
-    printf("   - Multiplos jogadores\n");
-    printf("   - Inteligencia artificial\n");
-    printf("   - Interface grafica\n");
-    return 0;
-}
+/**
+ * @brief Trabalhador do pool da simulação em lote (uma thread)
+ *
+ * As partidas ainda não iniciadas do trabalhador formam um intervalo
+ * [início, fim) guardado em uma única palavra atômica (início nos 32 bits
+ * altos). O dono retira lotes do início e os trabalhadores sem partidas
+ * roubam a metade final, ambos por compare-and-swap, sem travas. Cada
+ * trabalhador ocupa linhas de cache próprias.
+ */
+typedef struct TrabalhadorSimulacao {
+    _Alignas(ALINHAMENTO_MAPA) _Atomic uint64_t intervalo;  // Partidas [início, fim) ainda não iniciadas
+    const ConfigSimulacao* config;                   // Parâmetros do lote (somente leitura)
+    struct TrabalhadorSimulacao* grupo;              // Todos os trabalhadores (vítimas de roubo)
+    int numTrabalhadores;
+    int indice;                                      // Posição no grupo
+    GravadorEventos* eventos;                        // Buffer de --eventos (NULL = não gravar)
+    EstatisticasSimulacao estatisticas;              // Estatísticas próprias, somadas no fim
+} TrabalhadorSimulacao;
 
-// --- Implementação das Funções ---
+// --- Instrumentação (Métricas) ---
+/**
+ * @brief Fases do turno cronometradas no Nível Master
+ */
+typedef enum {
+    FASE_PREPARACAO = 0,        // Cadastro (ou carga do snapshot) e sorteio da missão
+    FASE_REFORCOS,              // faseDeReforcos
+    FASE_ATAQUES,               // Ataques do jogador e da IA
+    FASE_MISSOES,               // Verificação de missão e de fim de jogo
+    NUM_FASES
+} FaseJogo;
 
-void limparBufferEntrada(void) {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF) {}
-}
+/**
+ * @brief Métricas acumuladas por uma thread (e, somadas, pelo programa)
+ *
+ * Uma batalha é uma sequência de rodadas consecutivas entre o mesmo par
+ * (atacante, defensor); termina na conquista, com o atacante reduzido a 1
+ * tropa ou quando a thread passa a outro par. Batalhas blitz contam nos
+ * histogramas de perdas, mas não no de rodadas (o número de rodadas não é
+ * sorteado). Histogramas em faixas de potência de 2: faixa 0 = valor 0,
+ * faixa k = valores de 2^(k-1) a 2^k - 1, a última acumula o resto.
+ */
+typedef struct {
+    uint64_t ataques;                   // Batalhas iniciadas (rodada a rodada ou blitz)
+    uint64_t rodadas;                   // Rodadas de dados (resolverCombate)
+    uint64_t batalhasBlitz;             // Batalhas resolvidas de uma vez (resolverBatalha)
+    uint64_t conquistas;                // Territórios conquistados
+    uint64_t reforcos;                  // Aplicações de reforço (uma por turno)
+    uint64_t tropasReforco;             // Tropas distribuídas nos reforços
+    uint64_t vezesFase[NUM_FASES];      // Execuções de cada fase
+    double segundosFase[NUM_FASES];     // Tempo total em cada fase
+    double maxSegundosFase[NUM_FASES];  // Execução mais longa de cada fase
+    uint64_t rodadasPorBatalha[NUM_FAIXAS_HISTOGRAMA];
+    uint64_t perdasAtacantePorBatalha[NUM_FAIXAS_HISTOGRAMA];
+    uint64_t perdasDefensorPorBatalha[NUM_FAIXAS_HISTOGRAMA];
+    // Batalha em curso (não somada entre threads)
+    const Mapa* mapaEmCurso;
+    int atacanteEmCurso;
+    int defensorEmCurso;
+    int rodadasEmCurso;                 // 0 = nenhuma batalha em curso
+    int perdasAtacanteEmCurso;
+    int perdasDefensorEmCurso;
+} MetricasJogo;
 
-void lerString(char* destino, int tamanhoMax) {
-    if (fgets(destino, tamanhoMax, stdin)) {
-        size_t len = strlen(destino);
-        if (len > 0 && destino[len - 1] == '\n') {
-            destino[len - 1] = '\0';
-        } else {
-            // remove excesso até nova linha
-            limparBufferEntrada();
-        }
-    }
-}
+// --- Servidor de Partidas ---
+/**
+ * @brief Etapa de uma sessão do servidor (máquina de estados do Nível Master)
+ */
+typedef enum {
+    SESSAO_TERRITORIOS,         // Aguardando o número de territórios
+    SESSAO_JOGADORES,           // Aguardando o número de exércitos
+    SESSAO_ATAQUES,             // Fase de ataques do jogador (aceita comandos)
+    SESSAO_ENCERRADA            // Partida terminada; só consultas e SAIR
+} EstadoSessao;
 
-void cadastrarTerritorios(Territorio territorios[], int tamanho) {
-    // Lista de territórios predefinidos para referência
-    const char* territoriosPredefinidos[NUM_TERRITORIOS_PREDEFINIDOS] = {
-        "Brasil", "Argentina", "Chile", "Peru", "Colombia"
-    };
-    
-    // Arrays para rastrear territórios e cores já utilizados
-    int territoriosUsados[MAX_TERRITORIOS];
-    int coresUsadas[MAX_TERRITORIOS];
-    int numTerritoriosUsados = 0;
-    int numCoresUsadas = 0;
-    
-    printf("\n================ CADASTRO DE TERRITORIOS ================\n");
-    printf("Configure os %d territorios do mapa de guerra:\n", tamanho);
-    printf("Agora com selecao dinamica e validacao de duplicatas!\n");
-    printf("=========================================================\n");
+/**
+ * @brief Uma partida do Nível Master hospedada pelo servidor
+ *
+ * Em vez de bloquear em scanf, a partida avança uma linha de cada vez
+ * (processarLinhaSessao) e guarda entre as linhas o que o laço do
+ * nivelMaster guardaria na pilha. As respostas se acumulam em 'saida' até
+ * que o socket aceite a escrita.
+ *
+ * Sessões encerradas não são liberadas: voltam para uma lista de livres com
+ * a arena reiniciada e o buffer de saída, e a próxima conexão as reaproveita.
+ */
+typedef struct SessaoServidor {
+    int fd;                             // Socket do cliente
+    uint64_t id;                        // Número da sessão (deriva a semente)
+    EstadoSessao estado;
+    EstadoRNG rng;                      // Gerador próprio da partida
+    ArenaPartida arena;                 // Memória da partida (mapa e arrays auxiliares)
+    Mapa* mapa;                         // NULL até a configuração (vive na arena)
+    MotorMissoes missoes;               // Missões de todas as cores
+    int numTerritorios;
+    int corJogador;                     // Cor do cliente; as demais jogam por script
+    int turno;
+    char entrada[TAM_LINHA_PROTOCOLO];  // Linha recebida ainda incompleta
+    size_t tamanhoEntrada;
+    char* saida;                        // Respostas ainda não enviadas
+    size_t tamanhoSaida;
+    size_t capacidadeSaida;
+    size_t enviados;                    // Bytes de 'saida' já escritos no socket
+    int aguardandoEscrita;              // 1 = EPOLLOUT registrado
+    int encerrar;                       // 1 = fechar assim que a saída for enviada
+    struct SessaoServidor* anterior;    // Sessões abertas (lista para o encerramento)
+    struct SessaoServidor* proxima;     // ... ou a próxima livre, na lista de livres
+} SessaoServidor;
 
-    for (int i = 0; i < tamanho; i++) {
-        printf("\n[*] TERRITORIO %d/%d\n", i + 1, tamanho);
-        printf("---------------------------------------------------------\n");
+// --- Opções de Linha de Comando ---
+/**
+ * @brief Opções reconhecidas na linha de comando
+ */
+typedef struct {
+    int modoSimulacao;                  // 1 = executar --simular em vez do jogo interativo
+    ConfigSimulacao simulacao;          // Parâmetros do modo de simulação
+    int limiteTabelaBatalha;            // > 0 = exibir a tabela de batalhas até esse limite
+    int rodadasConferencia;             // > 0 = conferir os combates em lote com essas rodadas
+    uint64_t semente;                   // Semente do gerador (--seed ou derivada do relógio)
+    int relatorioMemoria;               // 1 = exibir a memória ocupada pelo mapa e sair
+    const char* arquivoMapa;            // Arquivo de --mapa (NULL = mapa embutido)
+    int verbosidade;                    // Nível de detalhe da saída interativa (--verbosidade)
+    const char* arquivoGravacao;        // Log a gravar durante o jogo (--gravar)
+    const char* arquivoReplay;          // Log a reproduzir (--replay)
+    int ateTurno;                       // > 0 = parar o replay no início desse turno
+    int passoAPasso;                    // 1 = replay exibindo e pausando a cada decisão
+    const char* arquivoSalvar;          // Snapshot salvo ao fim de cada turno (--salvar)
+    const char* arquivoCarregar;        // Snapshot de onde retomar ou simular (--carregar)
+    const char* arquivoConfig;          // Posição inicial declarada (--config)
+    int iaAtiva;                        // 1 = demais exércitos do Nível Master jogam pela IA
+    ConfigIA ia;                        // Prazo e threads da IA (--ia-tempo, --ia-threads)
+    const char* arquivoMetricas;        // JSON de métricas gravado ao sair (--metricas-json)
+    const char* enderecoServidor;       // Endereço de --servidor (NULL = sem servidor)
+} OpcoesPrograma;
 
-        // Seleção dinâmica de território com validação de duplicatas
-        int indiceTerritorioEscolhido = selecionarTerritorio(territoriosUsados, numTerritoriosUsados);
-        strcpy(territorios[i].nome, territoriosPredefinidos[indiceTerritorioEscolhido]);
-        territoriosUsados[numTerritoriosUsados++] = indiceTerritorioEscolhido;
+// --- Protótipos das Funções ---
+// Declarações antecipadas de todas as funções que serão usadas no programa, organizadas por categoria.
 
-        // Seleção dinâmica de cor com validação de duplicatas
-        int indiceCorEscolhida = selecionarCor(territorios[i].corExercito, coresUsadas, numCoresUsadas);
-        coresUsadas[numCoresUsadas++] = indiceCorEscolhida;
+// === FUNÇÕES UTILITÁRIAS ===
+/**
+ * @brief Limpa o buffer de entrada para evitar problemas com scanf
+ */
+void limparBufferEntrada(void);
 
-        // Seleção dinâmica de tropas
-        territorios[i].tropas = selecionarTropas();
-        
-        printf("\n[OK] Territorio '%s' cadastrado com sucesso!\n", territorios[i].nome);
-        printf("     Exercito: %s | Tropas: %d\n", territorios[i].corExercito, territorios[i].tropas);
-    }
-    
-    // DISTRIBUIÇÃO ADICIONAL DE TROPAS PARA TORNAR O JOGO JOGÁVEL
-    printf("\n================ DISTRIBUICAO ADICIONAL DE TROPAS ================\n");
-    printf("Adicionando tropas extras para garantir combates interessantes...\n");
-    
-    srand(time(NULL));
-    int tropasExtras = 10; // Total de tropas extras para distribuir
-    
-    for (int i = 0; i < tropasExtras; i++) {
-        int territorioAleatorio = rand() % tamanho;
-        territorios[territorioAleatorio].tropas++;
-        printf("[+] %s recebeu +1 tropa (Total: %d)\n", 
-               territorios[territorioAleatorio].nome, 
-               territorios[territorioAleatorio].tropas);
-    }
-    
-    printf("\n[*] Cadastro concluido! Todos os territorios foram configurados.\n");
-    printf("[*] Sistema de validacao garante territorios e cores unicos!\n");
-    printf("[*] Tropas extras distribuidas para garantir combates emocionantes!\n");
-}
+/**
+ * @brief Lê uma string de forma segura, removendo quebras de linha
+ * @param destino Ponteiro para onde armazenar a string
+ * @param tamanhoMax Tamanho máximo da string
+ */
+void lerString(char* destino, int tamanhoMax);
 
-void exibirMapa(const Territorio territorios[], int tamanho) {
-    printf("\n[MAP] MAPA DOS TERRITORIOS\n");
-    printf("=======================================================================\n");
-    printf("%-4s | %-20s | %-15s | %-8s\n", "#", "TERRITORIO", "EXERCITO", "TROPAS");
-    printf("-----+----------------------+-----------------+----------\n");
-    for (int i = 0; i < tamanho; i++) {
-        printf("%-4d | %-20s | %-15s | %-8d\n", 
-               i + 1, 
-               territorios[i].nome, 
-               territorios[i].corExercito, 
-               territorios[i].tropas);
-    }
-    printf("=======================================================================\n");
-}
+// === FUNÇÕES DO GERADOR DE NÚMEROS ALEATÓRIOS ===
+/**
+ * @brief Inicializa o gerador a partir de uma semente de 64 bits (via SplitMix64)
+ * @param rng Estado a ser inicializado
+ * @param semente Semente; a mesma semente sempre produz a mesma sequência
+ */
+void inicializarRNG(EstadoRNG* rng, uint64_t semente);
 
-// --- Funções do Nível Aventureiro ---
+/**
+ * @brief Gera o próximo número de 64 bits da sequência
+ * @param rng Estado do gerador (modificável)
+ * @return Número pseudoaleatório uniforme em [0, 2^64)
+ */
+uint64_t proximoAleatorio(EstadoRNG* rng);
 
-Territorio* alocarMapa(int numTerritorios) {
-    // Usar calloc para inicialização automática com zeros
-    Territorio* territorios = (Territorio*)calloc(numTerritorios, sizeof(Territorio));
-    if (territorios == NULL) {
-        printf("Erro: Não foi possível alocar memória para os territórios.\n");
-        exit(1);
-    }
-    return territorios;
-}
+/**
+ * @brief Gera um inteiro uniforme em [0, limite) sem viés (método de Lemire)
+ * @param rng Estado do gerador (modificável)
+ * @param limite Limite superior exclusivo (maior que zero)
+ * @return Número pseudoaleatório em [0, limite)
+ */
+uint32_t aleatorioIntervalo(EstadoRNG* rng, uint32_t limite);
 
-void liberarMemoria(Territorio* territorios) {
-    if (territorios != NULL) {
-        free(territorios);
+/**
+ * @brief Avança o gerador 2^128 passos, equivalente a outro fluxo independente
+ * @param rng Estado do gerador (modificável)
+ */
+void saltarRNG(EstadoRNG* rng);
+
+/**
+ * @brief Cria o fluxo independente de número 'indice' a partir de um estado base
+ * @param base Estado base (somente leitura)
+ * @param indice Número do fluxo (0 = o próprio estado base)
+ * @param fluxo Estado resultante (base avançado indice * 2^128 passos)
+ */
+void criarFluxoRNG(const EstadoRNG* base, int indice, EstadoRNG* fluxo);
+
+/**
+ * @brief Deriva a semente de uma partida de um lote a partir da semente do lote
+ * @param semente Semente do lote
+ * @param indicePartida Número da partida dentro do lote
+ * @return Semente que reproduz exatamente aquela partida
+ */
+uint64_t sementeDaPartida(uint64_t semente, uint64_t indicePartida);
+
+// === FUNÇÕES DE HASH DE POSIÇÕES (ZOBRIST) ===
+/**
+ * @brief Calcula do zero o hash de Zobrist de um mapa
+ * @param mapa Mapa de territórios (somente leitura)
+ * @return XOR das chaves (território, dono, faixa de tropas) de todos os territórios
+ *
+ * As chaves não ficam em tabela: cada uma é o SplitMix64 do trio, então o
+ * hash serve para mapas de qualquer tamanho. Tropas entram por faixa (0 a 7
+ * exatas, depois potências de 2): posições que só diferem dentro de uma
+ * faixa de um exército grande têm o mesmo hash.
+ */
+uint64_t calcularHashZobrist(const Mapa* mapa);
+
+/**
+ * @brief Passa a manter o hash do mapa a cada alteração de tropas ou de dono
+ * @param mapa Mapa de territórios (modificável)
+ * @note restaurarPosicao não copia o hash: quem restaura recoloca o da origem
+ */
+void ativarHashZobrist(Mapa* mapa);
+
+/**
+ * @brief Atualiza o hash de um mapa com comHash após uma mudança de tropas
+ * @param mapa Mapa de territórios (modificável)
+ * @param territorio Índice do território
+ * @param antes Tropas antes da mudança
+ * @param depois Tropas depois da mudança
+ */
+static inline void atualizarHashTropas(Mapa* mapa, int territorio, int32_t antes, int32_t depois);
+
+/**
+ * @brief Atualiza o hash de um mapa com comHash após uma troca de dono
+ * @param mapa Mapa de territórios (modificável)
+ * @param territorio Índice do território
+ * @param donoAnterior Cor que perdeu o território
+ * @param novoDono Cor que ganhou o território
+ */
+static inline void atualizarHashDono(Mapa* mapa, int territorio, int donoAnterior, int novoDono);
+
+// === FUNÇÕES DO REGISTRO DE CORES ===
+/**
+ * @brief Retorna o ID de uma cor, registrando-a se ainda não existir
+ * @param nome Nome da cor
+ * @return ID da cor, ou SEM_COR se o registro estiver cheio
+ */
+int registrarCor(const char* nome);
+
+/**
+ * @brief Procura o ID de uma cor pelo nome (usado apenas na configuração)
+ * @param nome Nome da cor
+ * @return ID da cor, ou SEM_COR se não estiver registrada
+ */
+int buscarCor(const char* nome);
+
+/**
+ * @brief Retorna o nome de exibição de uma cor
+ * @param cor ID da cor
+ * @return Nome da cor ("-" para IDs inválidos)
+ */
+const char* nomeDaCor(int cor);
+
+// === FUNÇÕES DE RENDERIZAÇÃO ===
+/**
+ * @brief Acrescenta texto formatado (como printf) ao quadro em construção
+ * @param formato Formato no estilo printf
+ */
+void escreverQuadro(const char* formato, ...);
+
+/**
+ * @brief Envia o quadro montado ao terminal em uma única escrita e o esvazia
+ */
+void enviarQuadro(void);
+
+/**
+ * @brief Define o nível de detalhe da saída interativa
+ * @param verbosidade 0 = resumo (sem dados), 1 = dados e duelos, 2 = mapa completo sempre
+ */
+void definirVerbosidade(int verbosidade);
+
+/**
+ * @brief Libera os buffers do renderizador
+ */
+void liberarRenderizador(void);
+
+// === FUNÇÕES DE CADASTRO E EXIBIÇÃO ===
+/**
+ * @brief Cadastra territórios com seleção dinâmica e validação de duplicatas
+ * @param mapa Mapa a ser preenchido (todos os seus territórios são cadastrados)
+ * @param definicao Mapa de onde os territórios são escolhidos (somente leitura)
+ * @param rng Gerador usado na distribuição adicional de tropas
+ */
+void cadastrarTerritorios(Mapa* mapa, const DefinicaoMapa* definicao, EstadoRNG* rng);
+
+/**
+ * @brief Distribui as tropas extras do cadastro em territórios sorteados
+ * @param mapa Mapa de territórios (modificável)
+ * @param rng Gerador da partida
+ * @param sorteados Território sorteado para cada tropa extra (pode ser NULL)
+ * @note Escreve direto em 'tropas': chamar recalcularContadores em seguida
+ */
+void distribuirTropasExtras(Mapa* mapa, EstadoRNG* rng, int sorteados[]);
+
+/**
+ * @brief Exibe o mapa atual com todos os territórios e suas informações
+ * @param mapa Mapa de territórios (somente leitura)
+ */
+void exibirMapa(const Mapa* mapa);
+
+/**
+ * @brief Exibe apenas os territórios que mudaram desde o último mapa exibido
+ * @param mapa Mapa de territórios (somente leitura)
+ * @note Na verbosidade 2, ou sem mapa anterior, exibe o mapa completo
+ */
+void exibirAlteracoesMapa(const Mapa* mapa);
+
+/**
+ * @brief Retorna o nome de exibição de um território
+ * @param mapa Mapa de territórios (somente leitura)
+ * @param territorio Índice do território
+ * @return Nome da definição do mapa, ou "Territorio N" para mapas gerados
+ */
+const char* nomeDoTerritorio(const Mapa* mapa, int territorio);
+
+/**
+ * @brief Retorna o nome do continente de um território
+ * @param mapa Mapa de territórios (somente leitura)
+ * @param territorio Índice do território
+ * @return Nome do continente ("-" para mapas sem continentes)
+ */
+const char* nomeDoContinente(const Mapa* mapa, int territorio);
+
+// === FUNÇÕES DE DEFINIÇÃO DE MAPAS E FRONTEIRAS ===
+/**
+ * @brief Carrega um arquivo de mapa (continentes, territórios e fronteiras)
+ * @param caminho Caminho do arquivo
+ * @return Definição carregada, ou NULL em caso de erro (mensagem já exibida)
+ * @note Lê o arquivo em uma única passada e monta as fronteiras em tempo linear
+ */
+DefinicaoMapa* carregarDefinicaoMapa(const char* caminho);
+
+/**
+ * @brief Monta o mapa embutido (Américas), usado quando não há --mapa
+ * @return Definição do mapa embutido
+ */
+DefinicaoMapa* carregarMapaPadrao(void);
+
+/**
+ * @brief Retorna o nome de um território da definição
+ * @param definicao Definição do mapa (somente leitura)
+ * @param territorio Índice do território na definição
+ * @return Nome declarado no arquivo do mapa
+ */
+const char* nomeNaDefinicao(const DefinicaoMapa* definicao, int territorio);
+
+/**
+ * @brief Libera uma definição de mapa
+ * @param definicao Definição a ser liberada (pode ser NULL)
+ */
+void liberarDefinicaoMapa(DefinicaoMapa* definicao);
+
+/**
+ * @brief Usa a definição inteira como mapa do jogo (território i = território i)
+ * @param mapa Mapa com definicao->numTerritorios territórios
+ * @param definicao Definição de origem (deve viver mais que o mapa)
+ * @note As fronteiras são compartilhadas com a definição, sem cópia
+ */
+void associarMapaCompleto(Mapa* mapa, const DefinicaoMapa* definicao);
+
+/**
+ * @brief Monta as fronteiras entre os territórios escolhidos no cadastro
+ * @param mapa Mapa com nomeId já preenchido com índices da definição
+ * @param definicao Definição de origem (deve viver mais que o mapa)
+ */
+void associarSubmapa(Mapa* mapa, const DefinicaoMapa* definicao);
+
+/**
+ * @brief Verifica se dois territórios fazem fronteira
+ * @param mapa Mapa de territórios (somente leitura)
+ * @param a Índice do primeiro território
+ * @param b Índice do segundo território
+ * @return 1 se são vizinhos (sempre, em mapas sem fronteiras), 0 caso contrário
+ */
+int saoVizinhos(const Mapa* mapa, int a, int b);
+
+// === FUNÇÕES DE SELEÇÃO DINÂMICA ===
+/**
+ * @brief Permite seleção de território com validação de duplicatas
+ * @param definicao Mapa cujos territórios são listados (somente leitura)
+ * @param territoriosUsados Array com índices dos territórios já utilizados
+ * @param numUsados Número de territórios já utilizados
+ * @return Índice do território selecionado na definição
+ */
+int selecionarTerritorio(const DefinicaoMapa* definicao, int territoriosUsados[], int numUsados);
+
+/**
+ * @brief Permite seleção de cor com validação de duplicatas
+ * @param coresUsadas Array com IDs das cores já utilizadas
+ * @param numUsadas Número de cores já utilizadas
+ * @return ID da cor selecionada
+ */
+int selecionarCor(int coresUsadas[], int numUsadas);
+
+/**
+ * @brief Permite seleção do número inicial de tropas
+ * @return Número de tropas selecionado
+ */
+int selecionarTropas(void);
+
+// === FUNÇÕES DE GERENCIAMENTO DE MEMÓRIA ===
+/**
+ * @brief Aloca memória dinamicamente para o mapa de territórios
+ * @param numTerritorios Número de territórios a alocar (sem limite fixo)
+ * @return Ponteiro para o mapa alocado, com todos os arrays zerados
+ */
+Mapa* alocarMapa(int numTerritorios);
+
+/**
+ * @brief Cria um mapa, com todos os arrays zerados, dentro de uma arena
+ * @param arena Arena da partida; o mapa vive até o próximo reiniciarArena
+ * @param numTerritorios Número de territórios
+ * @return Mapa cujos arrays auxiliares também serão reservados na arena
+ */
+Mapa* alocarMapaNaArena(ArenaPartida* arena, int numTerritorios);
+
+/**
+ * @brief Libera a memória alocada para o mapa
+ * @param mapa Ponteiro para o mapa a ser liberado
+ * @note Em um mapa da arena, não libera nada (ver reiniciarArena)
+ */
+void liberarMemoria(Mapa* mapa);
+
+/**
+ * @brief Prepara uma arena vazia com um bloco inicial
+ * @param arena Arena a inicializar
+ * @param capacidade Tamanho do bloco inicial em bytes
+ */
+void inicializarArena(ArenaPartida* arena, size_t capacidade);
+
+/**
+ * @brief Reserva memória da partida (alinhada a ALINHAMENTO_MAPA, não zerada)
+ * @param arena Arena da partida
+ * @param bytes Tamanho da reserva
+ * @return Memória válida até o próximo reiniciarArena
+ */
+void* reservarNaArena(ArenaPartida* arena, size_t bytes);
+
+/**
+ * @brief Reserva memória temporária do fim do bloco (alinhada, não zerada)
+ * @param arena Arena da partida
+ * @param bytes Tamanho da reserva
+ * @return Memória válida até liberarTemporariosDaArena (ou reiniciarArena)
+ */
+void* reservarTemporarioNaArena(ArenaPartida* arena, size_t bytes);
+
+/**
+ * @brief Libera de uma vez todas as reservas temporárias
+ * @param arena Arena da partida
+ */
+void liberarTemporariosDaArena(ArenaPartida* arena);
+
+/**
+ * @brief Devolve toda a memória da partida em O(1) para reaproveitar o bloco
+ * @param arena Arena da partida
+ * @note Se a partida precisou de blocos extras, o bloco principal cresce para o total usado (no mínimo dobra)
+ */
+void reiniciarArena(ArenaPartida* arena);
+
+/**
+ * @brief Libera o bloco da arena e os extras
+ * @param arena Arena a liberar (pode ser reinicializada depois)
+ */
+void liberarArena(ArenaPartida* arena);
+
+/**
+ * @brief Recalcula do zero os contadores por dono e por continente
+ * @param mapa Mapa recém-configurado (modificável)
+ * @note Chamada após montar o mapa; depois disso os contadores são incrementais
+ */
+void recalcularContadores(Mapa* mapa);
+
+/**
+ * @brief Remonta o índice de territórios por cor (cada grupo em ordem de índice)
+ * @param mapa Mapa com o array 'dono' preenchido (modificável)
+ * @note Chamada por recalcularContadores e ao carregar um snapshot
+ */
+void montarIndicePorDono(Mapa* mapa);
+
+/**
+ * @brief Troca o dono de um território, atualizando os contadores e o índice por dono
+ * @param mapa Mapa de territórios (modificável)
+ * @param territorio Índice do território
+ * @param novoDono ID da nova cor controladora
+ */
+void transferirTerritorio(Mapa* mapa, int territorio, int novoDono);
+
+/**
+ * @brief Soma (ou subtrai) tropas de um território, atualizando os contadores
+ * @param mapa Mapa de territórios (modificável)
+ * @param territorio Índice do território
+ * @param delta Tropas a somar (negativo para remover)
+ */
+void alterarTropas(Mapa* mapa, int territorio, int delta);
+
+/**
+ * @brief Aplica o resultado de um ataque: perdas de cada lado e, se o defensor
+ *        ficar sem tropas, a conquista (troca de dono e tropas movidas)
+ * @param mapa Mapa de territórios (modificável)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param perdasAtacante Tropas perdidas pelo atacante
+ * @param perdasDefensor Tropas perdidas pelo defensor
+ * @return 1=ataque sem conquista, 2=território conquistado
+ * @note Com uma pilha ligada ao mapa, desfazerAte reverte tudo isso exatamente
+ */
+int aplicarResultadoAtaque(Mapa* mapa, int atacante, int defensor, int perdasAtacante, int perdasDefensor);
+
+/**
+ * @brief Esvazia uma pilha de desfazer
+ * @param pilha Pilha a esvaziar
+ */
+void iniciarPilhaDesfazer(PilhaDesfazer* pilha);
+
+/**
+ * @brief Reverte as alterações registradas depois de uma marca
+ * @param mapa Mapa ao qual a pilha está ligada (modificável)
+ * @param marca Valor de pilha->numAlteracoes no estado a recuperar
+ * @return 1 se o mapa voltou exatamente ao estado da marca; 0 se a pilha
+ *         transbordou (o mapa e a pilha não são tocados, e toda marca devolve
+ *         0 até o dono chamar iniciarPilhaDesfazer: o chamador restaura a
+ *         posição por cópia)
+ * @note As missões ligadas ao mapa recebem as trocas de dono inversas como
+ *       eventos (no pior caso, uma reavaliação a mais)
+ */
+int desfazerAte(Mapa* mapa, int32_t marca);
+
+/**
+ * @brief Exibe quantos bytes o mapa ocupa, por array e por território
+ * @param mapa Mapa a ser analisado (somente leitura)
+ */
+void exibirRelatorioMemoria(const Mapa* mapa);
+
+// === FUNÇÕES DE COMBATE ===
+/**
+ * @brief Simula um ataque entre dois territórios com sistema de dados
+ * @param mapa Mapa de territórios (modificável)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param rng Gerador usado para rolar os dados
+ * @return 0=ataque falhou, 1=ataque bem-sucedido, 2=território conquistado
+ */
+int simularAtaque(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng);
+
+/**
+ * @brief Núcleo silencioso do combate: rola os dados, aplica perdas e conquista
+ * @param mapa Mapa de territórios (modificável)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param rng Gerador usado para rolar os dados
+ * @param resultado Detalhes da rodada para exibição (pode ser NULL)
+ * @return 1=ataque sem conquista, 2=território conquistado
+ * @note Não faz validação nem E/S; o chamador garante atacante >= 2 e defensor >= 1
+ */
+int resolverCombate(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng, ResultadoCombate* resultado);
+
+/**
+ * @brief Ataque blitz: resolve a batalha inteira e exibe o resultado
+ * @param mapa Mapa de territórios (modificável)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param rng Gerador usado para sortear o desfecho
+ * @return 0=ataque falhou, 1=atacante esgotado, 2=território conquistado
+ */
+int simularBlitz(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng);
+
+/**
+ * @brief Núcleo silencioso do blitz: sorteia o estado final da batalha e o aplica
+ *
+ * Equivale a repetir resolverCombate até a conquista ou até o atacante ficar
+ * com 1 tropa, mas sorteia o desfecho direto da distribuição exata (custo
+ * constante dentro de TAM_TABELA_BATALHA; acima disso, blocos de rodadas de
+ * 2 dados contra 2 sorteados de uma vez até os dois lados caberem na tabela).
+ * @param mapa Mapa de territórios (modificável)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param rng Gerador usado para sortear o desfecho
+ * @param resultado Perdas de cada lado para exibição (pode ser NULL)
+ * @return 1=atacante esgotado, 2=território conquistado
+ * @note Não faz validação nem E/S; o chamador garante atacante >= 2 e defensor >= 1
+ */
+int resolverBatalha(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng, ResultadoBatalha* resultado);
+
+/**
+ * @brief Gerencia a fase de ataques do jogo
+ * @param mapa Mapa de territórios (modificável)
+ * @param rng Gerador usado nos combates
+ * @param corJogador Única cor que o jogador pode comandar (SEM_COR = qualquer uma)
+ */
+void faseDeAtaque(Mapa* mapa, EstadoRNG* rng, int corJogador);
+
+/**
+ * @brief Prepara o gerador dos combates em lote (um fluxo saltado por lane)
+ * @param gerador Gerador a inicializar
+ * @param semente Mesma semente = mesmos dados, com ou sem SIMD
+ */
+void inicializarGeradorDados(GeradorDados* gerador, uint64_t semente);
+
+/**
+ * @brief Resolve n rodadas de combate independentes de uma vez
+ *
+ * Mesmas regras de resolverCombate (até 2 dados por lado, empates favorecem
+ * o defensor), sem alterar nenhum mapa: apenas as perdas de cada rodada são
+ * gravadas. Usa AVX2 quando a CPU oferece; senão, o caminho escalar.
+ * @param gerador Gerador dos dados (avança)
+ * @param tropasAtacante Tropas do atacante em cada rodada (>= 2)
+ * @param tropasDefensor Tropas do defensor em cada rodada (>= 1)
+ * @param n Número de rodadas
+ * @param perdasAtacante Saída: tropas perdidas pelo atacante (0 a 2)
+ * @param perdasDefensor Saída: tropas perdidas pelo defensor (0 a 2)
+ */
+void resolverCombatesEmLote(GeradorDados* gerador, const int32_t* tropasAtacante, const int32_t* tropasDefensor,
+                            int n, uint8_t* perdasAtacante, uint8_t* perdasDefensor);
+
+/**
+ * @brief Caminho escalar de resolverCombatesEmLote (referência do caminho vetorial)
+ */
+void resolverCombatesEmLoteEscalar(GeradorDados* gerador, const int32_t* tropasAtacante, const int32_t* tropasDefensor,
+                                   int n, uint8_t* perdasAtacante, uint8_t* perdasDefensor);
+
+/**
+ * @brief Informa se resolverCombatesEmLote usa o caminho vetorial nesta CPU
+ * @return 1 se AVX2 estiver em uso, 0 caso contrário
+ */
+int combatesEmLoteVetoriais(void);
+
+/**
+ * @brief Confere os caminhos escalar e vetorial dos combates em lote (modo --conferir-dados)
+ *
+ * Resolve as mesmas rodadas pelos dois caminhos com a mesma semente, exige
+ * resultados idênticos, mede a vazão de cada um e compara as frequências
+ * de perdas com as probabilidades exatas da tabela de batalhas.
+ * @param numRodadas Rodadas a resolver
+ * @param semente Semente do gerador
+ * @return 1 se os caminhos coincidirem, 0 caso contrário
+ */
+int conferirCombatesEmLote(int numRodadas, uint64_t semente);
+
+// === FUNÇÕES DE PROBABILIDADE DE BATALHA ===
+/**
+ * @brief Resolve a cadeia de Markov das batalhas e preenche a tabela exata
+ *
+ * Chamada no início do programa; as consultas de batalha a chamam sozinhas se
+ * a tabela ainda não estiver pronta. Só a primeira chamada calcula (as demais,
+ * mesmo de outras threads, esperam por ela). A tabela cobre todos os pares
+ * (atacante, defensor) até TAM_TABELA_BATALHA tropas.
+ */
+void inicializarTabelaBatalha(void);
+
+/**
+ * @brief Consulta em O(1) o resultado esperado de uma batalha completa
+ * @param tropasAtacante Tropas atuais do território atacante
+ * @param tropasDefensor Tropas atuais do território defensor
+ * @return Ponteiro para a entrada da tabela, ou NULL se fora dos limites
+ */
+const ProbabilidadeBatalha* consultarProbabilidadeBatalha(int tropasAtacante, int tropasDefensor);
+
+/**
+ * @brief Exibe a tabela de batalhas em formato CSV (modo --tabela-batalha)
+ * @param limite Maior número de tropas por lado a exibir
+ */
+void exibirTabelaBatalha(int limite);
+
+/**
+ * @brief Distribuição exata do estado final de uma batalha (montada na primeira consulta)
+ *
+ * Segura entre threads: a tabela é publicada com compare-and-swap e a
+ * thread que perder a corrida descarta a sua cópia.
+ * @param tropasAtacante Tropas do atacante (2 a TAM_TABELA_BATALHA)
+ * @param tropasDefensor Tropas do defensor (1 a TAM_TABELA_BATALHA)
+ * @return Tabela de alias, ou NULL se fora dos limites ou sem memória
+ */
+const DistribuicaoBatalha* consultarDistribuicaoBatalha(int tropasAtacante, int tropasDefensor);
+
+/**
+ * @brief Sorteia o estado final de uma batalha a partir de (atacante, defensor)
+ *
+ * Dentro de TAM_TABELA_BATALHA: um sorteio na tabela de alias. Acima dela,
+ * enquanto os dois lados seguem com 2 dados, as contagens de cada desfecho
+ * nas k rodadas seguras sorteadas de uma vez (duas binomiais); nas últimas
+ * rodadas fora da tabela, uma rodada por vez. O número de passos cresce com
+ * o logaritmo das tropas, não com as tropas.
+ * @param tropasAtacante Entrada: tropas atuais (>= 2); saída: tropas finais
+ * @param tropasDefensor Entrada: tropas atuais (>= 1); saída: tropas finais (0 = conquista)
+ * @param rng Gerador usado no sorteio
+ */
+void sortearFimDeBatalha(int* tropasAtacante, int* tropasDefensor, EstadoRNG* rng);
+
+// === FUNÇÕES DO NÍVEL MASTER ===
+/**
+ * @brief Implementa o Nível Master com territórios dinâmicos e sistema de reforços
+ * @param definicao Mapa de onde os territórios são escolhidos
+ * @param rng Gerador da partida (toda a aleatoriedade do jogo vem dele)
+ * @param arquivoSalvar Snapshot salvo ao fim de cada turno (NULL = não salvar)
+ * @param arquivoCarregar Snapshot de onde retomar a partida (NULL = partida nova)
+ * @param arquivoConfig Posição inicial declarada em arquivo, sem cadastro (NULL = cadastro interativo)
+ * @param ia Configuração da IA que comanda os demais exércitos (NULL = só o jogador ataca)
+ * @param resultado Recebe como a partida terminou (NULL = não usado)
+ */
+void nivelMaster(const DefinicaoMapa* definicao, EstadoRNG* rng, const char* arquivoSalvar, const char* arquivoCarregar,
+                 const char* arquivoConfig, ConfigIA* ia, ResultadoPartida* resultado);
+
+/**
+ * @brief Implementa a fase de reforços baseada no controle territorial
+ * @param mapa Mapa de territórios (modificável)
+ */
+void faseDeReforcos(Mapa* mapa);
+
+/**
+ * @brief Núcleo silencioso da fase de reforços
+ * @param mapa Mapa de territórios (modificável)
+ * @param reforcosRecebidos Tropas recebidas por território (pode ser NULL)
+ */
+void aplicarReforcos(Mapa* mapa, int reforcosRecebidos[]);
+
+/**
+ * @brief Solicita ao usuário o número de territórios para o jogo
+ * @param maximo Maior número aceito (limitado pelo tamanho do mapa)
+ * @return Número de territórios selecionado (entre MIN_TERRITORIOS e maximo)
+ */
+int selecionarNumeroTerritorios(int maximo);
+
+// === FUNÇÕES DE CONTROLE DE JOGO ===
+/**
+ * @brief Verifica se o jogo terminou (todos territórios da mesma cor)
+ * @param mapa Mapa de territórios (somente leitura)
+ * @return 1 se o jogo terminou, 0 caso contrário
+ */
+int verificarFimDeJogo(const Mapa* mapa);
+
+/**
+ * @brief Versão silenciosa de verificarFimDeJogo (sem mensagens)
+ * @param mapa Mapa de territórios (somente leitura)
+ * @return 1 se todos os territórios pertencem à mesma cor, 0 caso contrário
+ */
+int jogoTerminou(const Mapa* mapa);
+
+// === FUNÇÕES DO SISTEMA DE MISSÕES ===
+/**
+ * @brief Gera uma missão aleatória para uma cor
+ * @param missao Ponteiro para a estrutura Missao a ser preenchida
+ * @param mapa Mapa de territórios (para análise das cores disponíveis)
+ * @param cor Cor que recebe a missão
+ * @param rng Gerador usado no sorteio da missão
+ */
+void gerarMissaoAleatoria(Missao* missao, const Mapa* mapa, int cor, EstadoRNG* rng);
+
+/**
+ * @brief Verifica se a missão foi cumprida pela sua cor
+ * @param missao Ponteiro para a missão a ser verificada (somente leitura)
+ * @param mapa Mapa de territórios (somente leitura)
+ * @param turnoAtual Turno atual do jogo
+ * @return 1 se a missão foi cumprida, 0 caso contrário (sempre 0 se a cor foi eliminada)
+ */
+int verificarMissao(const Missao* missao, const Mapa* mapa, int turnoAtual);
+
+/**
+ * @brief Sorteia uma missão para cada cor em jogo e a inscreve no motor
+ * @param motor Motor de missões a ser (re)iniciado
+ * @param mapa Mapa recém-configurado (somente leitura)
+ * @param turno Turno em que a partida começa
+ * @param rng Gerador usado nos sorteios (cores em ordem crescente)
+ */
+void gerarMissoesDosJogadores(MotorMissoes* motor, const Mapa* mapa, int turno, EstadoRNG* rng);
+
+/**
+ * @brief Inscreve a missão de uma cor nos eventos que podem cumpri-la
+ * @param motor Motor de missões (modificável)
+ * @param missao Missão a copiar para o motor (missao->cor identifica a cor)
+ * @note A missão fica pendente: a próxima avaliação já a verifica
+ */
+void atribuirMissao(MotorMissoes* motor, const Missao* missao);
+
+/**
+ * @brief Evento de troca de dono: marca como pendentes as missões afetadas
+ * @param motor Motor de missões (modificável)
+ * @param donoAnterior Cor que perdeu o território
+ * @param novoDono Cor que ganhou o território
+ * @note Chamada por transferirTerritorio quando o mapa tem um motor ligado
+ */
+static inline void notificarTrocaDeDono(MotorMissoes* motor, int donoAnterior, int novoDono);
+
+/**
+ * @brief Evento de fim de turno: avança o turno e marca as missões de duração
+ * @param motor Motor de missões (modificável)
+ * @param proximoTurno Turno que vai começar
+ */
+void notificarFimDeTurno(MotorMissoes* motor, int proximoTurno);
+
+/**
+ * @brief Reavalia apenas as missões pendentes
+ * @param motor Motor de missões (modificável)
+ * @param mapa Mapa de territórios (somente leitura)
+ * @return Menor cor com missão cumprida, ou SEM_COR se nenhuma foi cumprida
+ */
+int avaliarMissoes(MotorMissoes* motor, const Mapa* mapa);
+
+/**
+ * @brief Exibe a missão atual do jogador
+ * @param missao Ponteiro para a missão a ser exibida (somente leitura)
+ */
+void exibirMissao(const Missao* missao);
+
+// === FUNÇÕES DE GRAVAÇÃO E REPLAY ===
+/**
+ * @brief Cria o log da partida e grava o cabeçalho
+ * @param caminho Arquivo a ser criado (sobrescrito se existir)
+ * @param semente Semente da partida
+ * @param definicao Mapa em uso (para conferência no replay)
+ * @return 1 se o arquivo foi criado, 0 caso contrário
+ */
+int iniciarGravacao(const char* caminho, uint64_t semente, const DefinicaoMapa* definicao);
+
+/**
+ * @brief Acrescenta uma decisão ao log (sem efeito se não há gravação ativa)
+ * @param tipo Tipo da decisão
+ * @param a Primeiro parâmetro
+ * @param b Segundo parâmetro
+ * @param c Terceiro parâmetro
+ */
+void registrarDecisao(TipoDecisao tipo, int a, int b, int c);
+
+/**
+ * @brief Fecha o log da partida, se houver um aberto
+ */
+void encerrarGravacao(void);
+
+/**
+ * @brief Reexecuta uma partida gravada usando apenas o motor silencioso
+ * @param caminho Log gravado com --gravar
+ * @param definicao Mapa em uso (deve ser o mesmo da gravação)
+ * @param ateTurno > 0 para parar no início desse turno
+ * @param passoAPasso 1 para exibir e pausar a cada decisão
+ * @param resultado Recebe como a partida reproduzida terminou, com os mesmos
+ *        passos de fim de turno do nivelMaster (NULL = não usado)
+ * @return 1 se o log foi reproduzido, 0 em caso de erro
+ */
+int reproduzirPartida(const char* caminho, const DefinicaoMapa* definicao, int ateTurno, int passoAPasso,
+                      ResultadoPartida* resultado);
+
+// === FUNÇÕES DE SNAPSHOT (SALVAR/CARREGAR) ===
+/**
+ * @brief Salva o estado completo de uma partida em um snapshot binário
+ * @param caminho Arquivo a ser criado (sobrescrito se existir)
+ * @param mapa Mapa da partida (somente leitura)
+ * @param missoes Missões de todas as cores (somente leitura)
+ * @param corJogador Cor comandada pelo jogador
+ * @param turno Próximo turno a ser jogado
+ * @param rng Estado do gerador (somente leitura)
+ * @return 1 se o arquivo foi gravado, 0 caso contrário
+ */
+int salvarSnapshot(const char* caminho, const Mapa* mapa, const MotorMissoes* missoes, int corJogador, int turno,
+                   const EstadoRNG* rng);
+
+/**
+ * @brief Mapeia um snapshot em memória e o usa diretamente como mapa
+ * @param caminho Arquivo gravado por salvarSnapshot
+ * @param definicao Mapa em uso (deve ser o mesmo do salvamento)
+ * @param missoes Recebe as missões salvas, já inscritas nos eventos
+ * @param corJogador Recebe a cor comandada pelo jogador
+ * @param turno Recebe o próximo turno a ser jogado
+ * @param rng Recebe o estado do gerador salvo
+ * @return Mapa apoiado no arquivo mapeado, ou NULL em caso de erro
+ * @note Mapeamento privado: alterações no jogo não modificam o arquivo
+ */
+Mapa* carregarSnapshot(const char* caminho, const DefinicaoMapa* definicao, MotorMissoes* missoes, int* corJogador,
+                       int* turno, EstadoRNG* rng);
+
+// === FUNÇÕES DE CONFIGURAÇÃO DE PARTIDA ===
+/**
+ * @brief Monta a posição inicial do Nível Master declarada em um arquivo, sem perguntas
+ * @param caminho Arquivo com territorio/jogador/extras/missao (uma declaração por linha)
+ * @param definicao Mapa de onde vêm os nomes dos territórios
+ * @param missoes Recebe as missões de todas as cores, já inscritas nos eventos
+ * @param corJogador Recebe a cor do jogador (padrão: dona do primeiro território)
+ * @param rng Gerador da partida (tropas extras e missões não declaradas)
+ * @return Mapa pronto para o turno 1, ou NULL (com a linha do erro exibida)
+ * @note Uma única passada pelo arquivo; nomes resolvidos por tabela hash
+ */
+Mapa* carregarConfigPartida(const char* caminho, const DefinicaoMapa* definicao, MotorMissoes* missoes,
+                            int* corJogador, EstadoRNG* rng);
+
+/**
+ * @brief Copia o estado de um mapa (dono, tropas e contadores) para outro
+ * @param destino Mapa com o mesmo número de territórios (modificável)
+ * @param origem Posição de partida (somente leitura; fronteiras compartilhadas)
+ * @note O hash de Zobrist do destino não é tocado (ver ativarHashZobrist)
+ */
+void restaurarPosicao(Mapa* destino, const Mapa* origem);
+
+// === FUNÇÕES DA INTELIGÊNCIA ARTIFICIAL (MCTS) ===
+/**
+ * @brief Escolhe a próxima ação de um exército por busca em árvore Monte Carlo
+ * @param mapa Posição atual (somente leitura)
+ * @param cor Cor controlada pela IA
+ * @param ia Prazo, threads e semente da IA
+ * @return Jogada escolhida (atacante -1 = encerrar os ataques)
+ *
+ * Cada thread constrói a sua árvore até o prazo; as visitas das ações da
+ * raiz são somadas entre as threads e vence a mais visitada. Cada iteração
+ * sorteia os dados das ações da árvore, completa o turno e mais HORIZONTE_IA
+ * turnos com os jogadores por script e avalia a fatia de territórios e
+ * tropas da cor. As threads compartilham uma tabela de transposição: uma
+ * posição alcançada por outra ordem de ataques (ou outros dados) depois de
+ * AMOSTRAS_TRANSPOSICAO simulações passa a valer a média delas.
+ */
+JogadaIA escolherJogadaIA(const Mapa* mapa, int cor, ConfigIA* ia);
+
+/**
+ * @brief Fase de ataques de um exército controlado pela IA, com saída no console
+ * @param mapa Mapa de territórios (modificável)
+ * @param cor Cor controlada pela IA
+ * @param rng Gerador da partida (usado só nos combates reais)
+ * @param ia Configuração da IA
+ */
+void faseDeAtaqueIA(Mapa* mapa, int cor, EstadoRNG* rng, ConfigIA* ia);
+
+/**
+ * @brief Número de processadores disponíveis (padrão de --ia-threads e --threads)
+ */
+int numeroDeNucleos(void);
+
+// === FUNÇÕES DE SIMULAÇÃO EM LOTE (MODO HEADLESS) ===
+/**
+ * @brief Distribui territórios, cores e tropas aleatoriamente, sem interação
+ * @param mapa Mapa a ser preenchido
+ * @param numJogadores Número de cores em jogo (IDs 0 a numJogadores - 1)
+ * @param rng Gerador da partida
+ */
+void prepararMapaAleatorio(Mapa* mapa, int numJogadores, EstadoRNG* rng);
+
+/**
+ * @brief Executa a fase de ataque de um jogador controlado por script
+ * @param mapa Mapa de territórios (modificável)
+ * @param dono ID da cor do jogador que está atacando
+ * @param rng Gerador da partida
+ * @param blitz 1 = cada ataque escolhido é levado até o fim com resolverBatalha
+ *
+ * Estratégia: escolhe, entre os pares (território próprio, vizinho inimigo),
+ * o de maior chance exata de conquista e ataca enquanto ela for de pelo menos
+ * 50%. Em mapas sem fronteiras, ataca com o território mais forte o inimigo
+ * mais fraco. Com blitz, cada ataque escolhido vai até a conquista ou até o
+ * atacante ficar com 1 tropa, sorteado de uma só vez.
+ */
+void faseDeAtaqueScriptada(Mapa* mapa, int dono, EstadoRNG* rng, int blitz);
+
+/**
+ * @brief Joga uma partida completa sem nenhuma E/S de console
+ * @param mapa Buffer do mapa (reutilizado entre partidas)
+ * @param config Parâmetros da simulação
+ * @param rng Gerador da partida (a mesma semente reproduz a mesma partida)
+ * @param resultado Resultado da partida
+ */
+void jogarPartidaAutomatica(Mapa* mapa, const ConfigSimulacao* config, EstadoRNG* rng, ResultadoPartida* resultado);
+
+/**
+ * @brief Executa o modo --simular e exibe as estatísticas agregadas
+ * @param config Parâmetros da simulação
+ * @return 1 em caso de sucesso, 0 se o log de eventos não pôde ser gravado
+ */
+int executarSimulacao(const ConfigSimulacao* config);
+
+/**
+ * @brief Exibe o relatório agregado de um lote de partidas
+ * @param config Parâmetros usados na simulação
+ * @param estatisticas Estatísticas acumuladas
+ * @param segundos Tempo total gasto nas partidas
+ */
+void exibirEstatisticasSimulacao(const ConfigSimulacao* config, const EstatisticasSimulacao* estatisticas, double segundos);
+
+/**
+ * @brief Retorna um instante de relógio de parede em segundos
+ */
+double tempoAtualSegundos(void);
+
+// === FUNÇÕES DO LOG DE EVENTOS ===
+/**
+ * @brief Cria o arquivo de --eventos e grava um cabeçalho provisório
+ * @param caminho Arquivo de saída (deve continuar válido até o fechamento)
+ * @param config Parâmetros do lote, copiados para o cabeçalho
+ * @return Arquivo aberto, ou NULL em caso de erro (já informado)
+ */
+ArquivoEventos* abrirArquivoEventos(const char* caminho, const ConfigSimulacao* config);
+
+/**
+ * @brief Completa o cabeçalho com o número de eventos e fecha o arquivo
+ * @param arquivo Arquivo aberto por abrirArquivoEventos (liberado aqui)
+ * @return 1 se todas as escritas deram certo, 0 caso contrário (já informado)
+ */
+int fecharArquivoEventos(ArquivoEventos* arquivo);
+
+/**
+ * @brief Grava no arquivo os eventos acumulados no buffer e o esvazia
+ * @param gravador Buffer da thread
+ */
+void descarregarEventos(GravadorEventos* gravador);
+
+/**
+ * @brief Acrescenta um evento ao buffer da thread atual (nada faz sem --eventos)
+ * @param tipo Tipo do evento
+ * @param cor Cor que age (SEM_COR se nenhuma)
+ * @param corAlvo Cor defensora ou alvo (SEM_COR se não se aplica)
+ * @param detalhe Modo do ataque, tipo de missão ou tipo de fim (ver TipoEvento)
+ * @param valor0 Primeiro valor do evento (ver TipoEvento); os demais seguem a mesma tabela
+ */
+static inline void registrarEvento(TipoEvento tipo, int cor, int corAlvo, int detalhe,
+                                   int32_t valor0, int32_t valor1, int32_t valor2, int32_t valor3);
+
+// Buffer de eventos da thread atual; só os trabalhadores de --simular com --eventos têm um
+static _Thread_local GravadorEventos* eventosLocais;
+
+// === FUNÇÕES DE INSTRUMENTAÇÃO (MÉTRICAS) ===
+// Chamadas pelo motor apenas através das macros METRICA_*, que somem com
+// -DWAR_SEM_METRICAS; as funções abaixo só existem com WAR_COM_METRICAS.
+#ifdef WAR_COM_METRICAS
+/**
+ * @brief Registra uma rodada de dados na batalha em curso da thread
+ * @param mapa Mapa do combate (identifica a batalha junto com o par)
+ * @param atacante Índice do território atacante
+ * @param defensor Índice do território defensor
+ * @param perdasAtacante Tropas perdidas pelo atacante na rodada
+ * @param perdasDefensor Tropas perdidas pelo defensor na rodada
+ * @param fimDaBatalha 1 se a rodada conquistou o território ou esgotou o atacante
+ */
+static inline void registrarRodadaMetricas(const Mapa* mapa, int atacante, int defensor, int perdasAtacante,
+                                           int perdasDefensor, int fimDaBatalha);
+
+/**
+ * @brief Registra uma batalha blitz completa
+ * @param perdasAtacante Tropas perdidas pelo atacante
+ * @param perdasDefensor Tropas perdidas pelo defensor
+ * @param conquistou 1 se o território foi conquistado
+ */
+static inline void registrarBatalhaMetricas(int perdasAtacante, int perdasDefensor, int conquistou);
+
+/**
+ * @brief Soma a duração de uma execução de fase
+ * @param fase Fase cronometrada
+ * @param inicio Instante de início (tempoAtualSegundos)
+ */
+void encerrarFaseMetricas(FaseJogo fase, double inicio);
+
+/**
+ * @brief Soma as métricas da thread atual ao total do programa e as zera
+ *
+ * Chamada por cada trabalhador de --simular ao terminar; a thread principal
+ * é somada por gravarMetricasJson.
+ */
+void acumularMetricasDaThread(void);
+
+/**
+ * @brief Grava todas as métricas do programa em JSON
+ * @param caminho Arquivo de saída
+ * @return 1 em caso de sucesso, 0 em caso de erro
+ */
+int gravarMetricasJson(const char* caminho);
+
+/**
+ * @brief Agenda (atexit) a gravação das métricas ao fim do programa
+ * @param caminho Arquivo de saída (deve continuar válido até a saída)
+ */
+void agendarMetricasJson(const char* caminho);
+
+// Métricas da thread atual (cada thread acumula sem travas)
+static _Thread_local MetricasJogo metricasLocais;
+
+#define METRICA_CONTAR(campo, n) (metricasLocais.campo += (uint64_t)(n))
+#define METRICA_RODADA(mapa, atacante, defensor, perdasAtacante, perdasDefensor, fim) \
+    registrarRodadaMetricas(mapa, atacante, defensor, perdasAtacante, perdasDefensor, fim)
+#define METRICA_BATALHA(perdasAtacante, perdasDefensor, conquistou) \
+    registrarBatalhaMetricas(perdasAtacante, perdasDefensor, conquistou)
+#define METRICA_INICIAR_FASE(inicio) double inicio = tempoAtualSegundos()
+#define METRICA_ENCERRAR_FASE(fase, inicio) encerrarFaseMetricas(fase, inicio)
+#define METRICA_ACUMULAR_THREAD() acumularMetricasDaThread()
+// A busca da IA joga milhares de partidas imaginárias: as métricas da thread são
+// guardadas antes e restauradas depois, para contar só as jogadas reais
+#define METRICA_SUSPENDER(copia) MetricasJogo copia = metricasLocais
+#define METRICA_RETOMAR(copia) (metricasLocais = copia)
+#else
+#define METRICA_CONTAR(campo, n) ((void)0)
+#define METRICA_RODADA(mapa, atacante, defensor, perdasAtacante, perdasDefensor, fim) ((void)0)
+#define METRICA_BATALHA(perdasAtacante, perdasDefensor, conquistou) ((void)0)
+#define METRICA_INICIAR_FASE(inicio) ((void)0)
+#define METRICA_ENCERRAR_FASE(fase, inicio) ((void)0)
+#define METRICA_ACUMULAR_THREAD() ((void)0)
+#define METRICA_SUSPENDER(copia) ((void)0)
+#define METRICA_RETOMAR(copia) ((void)0)
+#endif
+
+// === FUNÇÕES DO SERVIDOR DE PARTIDAS ===
+/**
+ * @brief Hospeda partidas do Nível Master para clientes de um socket local
+ * @param endereco "unix:CAMINHO" (socket Unix) ou uma porta TCP em 127.0.0.1
+ * @param definicao Mapa usado por todas as sessões (somente leitura)
+ * @param semente Semente do servidor (a sessão i usa sementeDaPartida(semente, i))
+ * @return 1 ao encerrar normalmente (SIGINT/SIGTERM), 0 em caso de erro
+ * @note Uma única thread atende todas as sessões com epoll; nenhuma chamada bloqueia
+ */
+int executarServidor(const char* endereco, const DefinicaoMapa* definicao, uint64_t semente);
+
+/**
+ * @brief Avança uma sessão com uma linha do cliente
+ * @param sessao Sessão (modificável); as respostas vão para sessao->saida
+ * @param definicao Mapa usado na configuração da partida
+ * @param linha Linha recebida, sem o '\n' (modificável: é separada em palavras)
+ */
+void processarLinhaSessao(SessaoServidor* sessao, const DefinicaoMapa* definicao, char* linha);
+
+// === FUNÇÕES DE LINHA DE COMANDO ===
+/**
+ * @brief Interpreta os argumentos de linha de comando
+ * @param argc Número de argumentos
+ * @param argv Vetor de argumentos
+ * @param opcoes Estrutura a ser preenchida com as opções reconhecidas
+ * @return 1 se os argumentos são válidos, 0 caso contrário
+ */
+int processarArgumentos(int argc, char* argv[], OpcoesPrograma* opcoes);
+
+/**
+ * @brief Converte um argumento numérico validando o intervalo permitido
+ * @param texto Texto a ser convertido
+ * @param minimo Menor valor aceito
+ * @param maximo Maior valor aceito
+ * @param destino Onde armazenar o valor convertido
+ * @return 1 se a conversão foi bem-sucedida, 0 caso contrário
+ */
+int lerArgumentoInteiro(const char* texto, long minimo, long maximo, long* destino);
+
+/**
+ * @brief Exibe a ajuda de linha de comando
+ * @param nomePrograma Nome do executável (argv[0])
+ */
+void exibirUso(const char* nomePrograma);
+
+// WAR_SEM_MAIN permite incluir este arquivo em outro programa (ex.: bench_war.c)
+#ifndef WAR_SEM_MAIN
+// --- Função Principal (main) ---
+// Função principal que orquestra o fluxo do jogo, chamando as outras funções em ordem.
+int main(int argc, char* argv[]) {
+    // 1) Setup básico
+    setlocale(LC_ALL, "Portuguese_Brazil.1252"); // Configurar para português brasileiro
+
+    // Opções de linha de comando (modos não interativos)
+    OpcoesPrograma opcoes;
+    if (!processarArgumentos(argc, argv, &opcoes)) {
+        exibirUso(argv[0]);
+        return 1;
+    }
+
+    definirVerbosidade(opcoes.verbosidade);
+
+    // Métricas do motor gravadas em JSON ao sair, qualquer que seja o modo
+    if (opcoes.arquivoMetricas != NULL) {
+#ifdef WAR_COM_METRICAS
+        agendarMetricasJson(opcoes.arquivoMetricas);
+#else
+        printf("%s[ERRO] Este executavel foi compilado sem metricas (WAR_SEM_METRICAS).%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+        return 1;
+#endif
+    }
+
+    // Inicializar o gerador de números aleatórios (mesma semente = mesma partida)
+    EstadoRNG rng;
+    inicializarRNG(&rng, opcoes.semente);
+
+    // Probabilidades exatas de batalha (usadas pelo combate e pelos jogadores automáticos)
+    inicializarTabelaBatalha();
+
+    if (opcoes.limiteTabelaBatalha > 0) {
+        exibirTabelaBatalha(opcoes.limiteTabelaBatalha);
+        return 0;
+    }
+
+    if (opcoes.rodadasConferencia > 0) {
+        return conferirCombatesEmLote(opcoes.rodadasConferencia, opcoes.semente) ? 0 : 1;
+    }
+
+    // Definição do mapa: arquivo de --mapa ou o mapa embutido das Américas
+    DefinicaoMapa* definicao = (opcoes.arquivoMapa != NULL)
+        ? carregarDefinicaoMapa(opcoes.arquivoMapa)
+        : carregarMapaPadrao();
+    if (definicao == NULL) {
+        return 1;
+    }
+    if (opcoes.arquivoMapa != NULL) {
+        // Com --mapa, a simulação joga no mapa carregado (com fronteiras)
+        opcoes.simulacao.definicao = definicao;
+        opcoes.simulacao.numTerritorios = definicao->numTerritorios;
+        if (opcoes.simulacao.numJogadores > definicao->numTerritorios) {
+            opcoes.simulacao.numJogadores = definicao->numTerritorios;
+        }
+    }
+
+    if (opcoes.relatorioMemoria) {
+        Mapa* mapa = alocarMapa(opcoes.simulacao.numTerritorios);
+        if (opcoes.simulacao.definicao != NULL) {
+            associarMapaCompleto(mapa, opcoes.simulacao.definicao);
+        }
+        exibirRelatorioMemoria(mapa);
+        liberarMemoria(mapa);
+        liberarDefinicaoMapa(definicao);
+        return 0;
+    }
+
+    if (opcoes.enderecoServidor != NULL) {
+        int servido = executarServidor(opcoes.enderecoServidor, definicao, opcoes.semente);
+        liberarDefinicaoMapa(definicao);
+        return servido ? 0 : 1;
+    }
+
+    if (opcoes.modoSimulacao) {
+        Mapa* posicao = NULL;
+        if (opcoes.arquivoCarregar != NULL || opcoes.arquivoConfig != NULL) {
+            // Posição compartilhada (snapshot mapeado ou configuração): cada partida copia dela
+            EstadoRNG rngSalvo;
+            int corJogador;
+            if (opcoes.arquivoCarregar != NULL) {
+                posicao = carregarSnapshot(opcoes.arquivoCarregar, definicao, &opcoes.simulacao.missoesIniciais,
+                                           &corJogador, &opcoes.simulacao.turnoInicial, &rngSalvo);
+            } else {
+                posicao = carregarConfigPartida(opcoes.arquivoConfig, definicao, &opcoes.simulacao.missoesIniciais,
+                                                &corJogador, &rng);
+                opcoes.simulacao.turnoInicial = 1;
+            }
+            if (posicao == NULL) {
+                liberarDefinicaoMapa(definicao);
+                return 1;
+            }
+            opcoes.simulacao.posicaoInicial = posicao;
+            opcoes.simulacao.numTerritorios = posicao->numTerritorios;
+            opcoes.simulacao.numJogadores = 0;
+            for (int cor = 0; cor < MAX_CORES; cor++) {
+                if (posicao->territoriosPorDono[cor] > 0) {
+                    opcoes.simulacao.numJogadores = cor + 1;
+                }
+            }
+        }
+        int simulado = executarSimulacao(&opcoes.simulacao);
+        liberarMemoria(posicao);
+        liberarDefinicaoMapa(definicao);
+        return simulado ? 0 : 1;
+    }
+
+    if (opcoes.arquivoReplay != NULL) {
+        int reproduzido = reproduzirPartida(opcoes.arquivoReplay, definicao, opcoes.ateTurno, opcoes.passoAPasso, NULL);
+        liberarDefinicaoMapa(definicao);
+        liberarRenderizador();
+        return reproduzido ? 0 : 1;
+    }
+
+    if (opcoes.arquivoGravacao != NULL &&
+        !iniciarGravacao(opcoes.arquivoGravacao, opcoes.semente, definicao)) {
+        liberarDefinicaoMapa(definicao);
+        return 1;
+    }
+
+    // Partida configurada em arquivo: direto no Nível Master, sem menu nem cadastro
+    if (opcoes.arquivoConfig != NULL) {
+        printf("[SEED] Semente desta partida: %" PRIu64 " (use --seed para repeti-la)\n", opcoes.semente);
+        nivelMaster(definicao, &rng, opcoes.arquivoSalvar, NULL, opcoes.arquivoConfig, opcoes.iaAtiva ? &opcoes.ia : NULL, NULL);
+        liberarDefinicaoMapa(definicao);
+        liberarRenderizador();
+        return 0;
+    }
+
+    // Partida salva: retomar direto no Nível Master
+    if (opcoes.arquivoCarregar != NULL) {
+        nivelMaster(definicao, &rng, opcoes.arquivoSalvar, opcoes.arquivoCarregar, NULL, opcoes.iaAtiva ? &opcoes.ia : NULL, NULL);
+        liberarDefinicaoMapa(definicao);
+        liberarRenderizador();
+        return 0;
+    }
+
+    // Menu de seleção de nível
+    int opcao;
+    printf("\n%s================ JOGO WAR - SELECAO DE NIVEL ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf("Escolha o nivel de dificuldade:\n");
+    printf("%s1%s - %sNivel Aventureiro (Basico)%s\n", COR_VERDE_NEGRITO, COR_RESET, COR_VERDE, COR_RESET);
+    printf("%s2%s - %sNivel Master (Cartas e Missoes)%s\n", COR_AZUL, COR_RESET, COR_AZUL, COR_RESET);
+    printf("%s=========================================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf(">> Digite sua opcao (1 ou 2): ");
+    scanf("%d", &opcao);
+    limparBufferEntrada();
+
+    printf("[SEED] Semente desta partida: %" PRIu64 " (use --seed para repeti-la)\n", opcoes.semente);
+    registrarDecisao(DECISAO_NIVEL, opcao == 2 ? 2 : 1, 0, 0);
+
+    if (opcao == 2) {
+        nivelMaster(definicao, &rng, opcoes.arquivoSalvar, NULL, NULL, opcoes.iaAtiva ? &opcoes.ia : NULL, NULL);
+        encerrarGravacao();
+        liberarDefinicaoMapa(definicao);
+        liberarRenderizador();
+        return 0;
+    }
+
+    // Nível Aventureiro (código original)
+    // 2) Alocação dinâmica de memória para territórios
+    int numTerritorios = NUM_TERRITORIOS_PREDEFINIDOS;  // Nível básico usa 5 territórios
+    if (numTerritorios > definicao->numTerritorios) {
+        numTerritorios = definicao->numTerritorios;
+    }
+    Mapa* mapa = alocarMapa(numTerritorios);
+
+    // 3) Cadastro dos territórios
+    cadastrarTerritorios(mapa, definicao, &rng);
+
+    // 4) Exibir o mapa inicial
+    printf("\n[*] INICIANDO JOGO WAR - NIVEL AVENTUREIRO [*]\n");
+    exibirMapa(mapa);
+
+    // 5) Fase de ataques (Nível Aventureiro)
+    faseDeAtaque(mapa, &rng, SEM_COR);
+
+    // 6) Exibir o mapa final
+    printf("\n[*] RESULTADO FINAL DA BATALHA [*]\n");
+    exibirMapa(mapa);
+
+    // 7) Liberar memória alocada
+    liberarMemoria(mapa);
+    encerrarGravacao();
+    liberarDefinicaoMapa(definicao);
+    liberarRenderizador();
+
+    printf("\n[*] PARABENS! Voce completou o nivel Aventureiro com sucesso! [*]\n");
+    printf("[*] Proximo desafio: Evolua o codigo para o nivel Mestre!\n");
+    printf("[*] Sugestoes para o nivel Mestre:\n");
+    printf("   - Sistema de cartas e missoes\n");
+    printf("   - Multiplos jogadores\n");
+    printf("   - Inteligencia artificial\n");
+    printf("   - Interface grafica\n");
+    return 0;
+}
+#endif // WAR_SEM_MAIN
+
+// --- Implementação das Funções ---
+
+// Registro global de cores: preenchido na configuração e apenas lido durante o jogo
+static RegistroCores registroCores = {
+    NUM_CORES_PREDEFINIDAS,
+    { "Azul", "Vermelho", "Verde", "Amarelo", "Roxo" }
+};
+
+// Renderizador global da saída interativa (o modo --simular não o utiliza)
+static Renderizador renderizador = { NULL, 0, 0, VERBOSIDADE_PADRAO, NULL, 0, NULL, NULL };
+
+int registrarCor(const char* nome) {
+    int cor = buscarCor(nome);
+    if (cor != SEM_COR) {
+        return cor;
+    }
+    if (registroCores.numCores >= MAX_CORES) {
+        return SEM_COR;
+    }
+    cor = registroCores.numCores++;
+    strncpy(registroCores.nomes[cor], nome, TAM_MAX_COR - 1);
+    registroCores.nomes[cor][TAM_MAX_COR - 1] = '\0';
+    return cor;
+}
+
+int buscarCor(const char* nome) {
+    for (int i = 0; i < registroCores.numCores; i++) {
+        if (strcmp(registroCores.nomes[i], nome) == 0) {
+            return i;
+        }
+    }
+    return SEM_COR;
+}
+
+const char* nomeDaCor(int cor) {
+    if (cor < 0 || cor >= registroCores.numCores) {
+        return "-";
+    }
+    return registroCores.nomes[cor];
+}
+
+void limparBufferEntrada(void) {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF) {}
+}
+
+void lerString(char* destino, int tamanhoMax) {
+    if (fgets(destino, tamanhoMax, stdin)) {
+        size_t len = strlen(destino);
+        if (len > 0 && destino[len - 1] == '\n') {
+            destino[len - 1] = '\0';
+        } else {
+            // remove excesso até nova linha
+            limparBufferEntrada();
+        }
+    }
+}
+
+void cadastrarTerritorios(Mapa* mapa, const DefinicaoMapa* definicao, EstadoRNG* rng) {
+    int tamanho = mapa->numTerritorios;
+    
+    // Arrays para rastrear territórios e cores já utilizados
+    int territoriosUsados[MAX_TERRITORIOS];
+    int coresUsadas[MAX_TERRITORIOS];
+    int numTerritoriosUsados = 0;
+    int numCoresUsadas = 0;
+    
+    printf("\n================ CADASTRO DE TERRITORIOS ================\n");
+    printf("Configure os %d territorios do mapa de guerra:\n", tamanho);
+    printf("Agora com selecao dinamica e validacao de duplicatas!\n");
+    printf("=========================================================\n");
+
+    for (int i = 0; i < tamanho; i++) {
+        printf("\n[*] TERRITORIO %d/%d\n", i + 1, tamanho);
+        printf("---------------------------------------------------------\n");
+
+        // Seleção dinâmica de território com validação de duplicatas
+        int indiceTerritorioEscolhido = selecionarTerritorio(definicao, territoriosUsados, numTerritoriosUsados);
+        mapa->nomeId[i] = (uint32_t)indiceTerritorioEscolhido;
+        territoriosUsados[numTerritoriosUsados++] = indiceTerritorioEscolhido;
+
+        // Seleção dinâmica de cor com validação de duplicatas
+        // (com mais territórios que cores, as cores voltam a ficar livres a cada rodada)
+        if (numCoresUsadas == NUM_CORES_PREDEFINIDAS) {
+            numCoresUsadas = 0;
+        }
+        mapa->dono[i] = selecionarCor(coresUsadas, numCoresUsadas);
+        coresUsadas[numCoresUsadas++] = mapa->dono[i];
+
+        // Seleção dinâmica de tropas
+        mapa->tropas[i] = selecionarTropas();
+        
+        registrarDecisao(DECISAO_TERRITORIO, indiceTerritorioEscolhido, mapa->dono[i], mapa->tropas[i]);
+        
+        printf("\n[OK] Territorio '%s' cadastrado com sucesso!\n", nomeNaDefinicao(definicao, indiceTerritorioEscolhido));
+        printf("     Exercito: %s | Tropas: %d\n", nomeDaCor(mapa->dono[i]), mapa->tropas[i]);
+    }
+    
+    // Fronteiras entre os territórios escolhidos (nomes e continentes vêm da definição)
+    associarSubmapa(mapa, definicao);
+    printf("\n[MAPA] %d fronteira(s) entre os territorios escolhidos.\n",
+           mapa->inicioVizinhos[tamanho] / 2);
+    
+    // DISTRIBUIÇÃO ADICIONAL DE TROPAS PARA TORNAR O JOGO JOGÁVEL
+    printf("\n================ DISTRIBUICAO ADICIONAL DE TROPAS ================\n");
+    printf("Adicionando tropas extras para garantir combates interessantes...\n");
+    
+    int sorteados[TROPAS_EXTRAS_CADASTRO];
+    distribuirTropasExtras(mapa, rng, sorteados);
+    recalcularContadores(mapa);
+    
+    for (int i = 0; i < TROPAS_EXTRAS_CADASTRO; i++) {
+        // Total logo após esta tropa: descontar as sorteadas depois dela
+        int total = mapa->tropas[sorteados[i]];
+        for (int j = i + 1; j < TROPAS_EXTRAS_CADASTRO; j++) {
+            if (sorteados[j] == sorteados[i]) total--;
+        }
+        printf("[+] %s recebeu +1 tropa (Total: %d)\n", nomeDoTerritorio(mapa, sorteados[i]), total);
+    }
+    
+    printf("\n[*] Cadastro concluido! Todos os territorios foram configurados.\n");
+    printf("[*] Sistema de validacao garante territorios e cores unicos!\n");
+    printf("[*] Tropas extras distribuidas para garantir combates emocionantes!\n");
+}
+
+void distribuirTropasExtras(Mapa* mapa, EstadoRNG* rng, int sorteados[]) {
+    for (int i = 0; i < TROPAS_EXTRAS_CADASTRO; i++) {
+        int territorio = (int)aleatorioIntervalo(rng, (uint32_t)mapa->numTerritorios);
+        mapa->tropas[territorio]++;
+        if (sorteados != NULL) {
+            sorteados[i] = territorio;
+        }
+    }
+}
+
+// Linha da tabela do mapa para um território
+static void escreverLinhaMapa(const Mapa* mapa, int i) {
+    escreverQuadro("%-4d | %-20s | %-16s | %-15s | %-8d\n", 
+                   i + 1, 
+                   nomeDoTerritorio(mapa, i), 
+                   nomeDoContinente(mapa, i), 
+                   nomeDaCor(mapa->dono[i]), 
+                   mapa->tropas[i]);
+}
+
+// Guarda dono e tropas do mapa exibido, base do próximo exibirAlteracoesMapa
+static void registrarMapaExibido(const Mapa* mapa) {
+    int n = mapa->numTerritorios;
+    if (renderizador.numExibidos != n) {
+        free(renderizador.donoExibido);
+        free(renderizador.tropasExibidas);
+        renderizador.donoExibido = (uint8_t*)malloc((size_t)n * sizeof(uint8_t));
+        renderizador.tropasExibidas = (int32_t*)malloc((size_t)n * sizeof(int32_t));
+        if (renderizador.donoExibido == NULL || renderizador.tropasExibidas == NULL) {
+            printf("Erro: Não foi possível alocar memória para o renderizador.\n");
+            exit(1);
+        }
+        renderizador.numExibidos = n;
+    }
+    memcpy(renderizador.donoExibido, mapa->dono, (size_t)n * sizeof(uint8_t));
+    memcpy(renderizador.tropasExibidas, mapa->tropas, (size_t)n * sizeof(int32_t));
+    renderizador.mapaExibido = mapa;
+}
+
+void exibirMapa(const Mapa* mapa) {
+    escreverQuadro("\n[MAP] MAPA DOS TERRITORIOS\n");
+    escreverQuadro("=======================================================================\n");
+    escreverQuadro("%-4s | %-20s | %-16s | %-15s | %-8s\n", "#", "TERRITORIO", "CONTINENTE", "EXERCITO", "TROPAS");
+    escreverQuadro("-----+----------------------+------------------+-----------------+----------\n");
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        escreverLinhaMapa(mapa, i);
+    }
+    escreverQuadro("=======================================================================\n");
+    registrarMapaExibido(mapa);
+    enviarQuadro();
+}
+
+void exibirAlteracoesMapa(const Mapa* mapa) {
+    if (renderizador.verbosidade >= 2 || renderizador.mapaExibido != mapa ||
+        renderizador.numExibidos != mapa->numTerritorios) {
+        exibirMapa(mapa);
+        return;
+    }
+    
+    // Comparar com o último quadro e redesenhar só as linhas alteradas
+    int alterados = 0;
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        uint8_t donoAntes = renderizador.donoExibido[i];
+        int32_t tropasAntes = renderizador.tropasExibidas[i];
+        if (mapa->dono[i] == donoAntes && mapa->tropas[i] == tropasAntes) continue;
+        
+        if (alterados == 0) {
+            escreverQuadro("\n[MAP] ALTERACOES NO MAPA\n");
+            escreverQuadro("-----+----------------------+------------------+-----------------+----------\n");
+        }
+        alterados++;
+        escreverQuadro("%-4d | %-20s | %-16s | %-15s | %-8d (antes: %s, %d)\n", 
+                       i + 1, 
+                       nomeDoTerritorio(mapa, i), 
+                       nomeDoContinente(mapa, i), 
+                       nomeDaCor(mapa->dono[i]), 
+                       mapa->tropas[i], 
+                       nomeDaCor(donoAntes), tropasAntes);
+    }
+    if (alterados == 0) {
+        escreverQuadro("\n[MAP] Nenhuma alteracao no mapa desde a ultima exibicao.\n");
+    } else {
+        escreverQuadro("-----+----------------------+------------------+-----------------+----------\n");
+        escreverQuadro("%d de %d territorio(s) alterado(s).\n", alterados, mapa->numTerritorios);
+    }
+    registrarMapaExibido(mapa);
+    enviarQuadro();
+}
+
+const char* nomeDoTerritorio(const Mapa* mapa, int territorio) {
+    static _Thread_local char nomeGerado[TAM_MAX_NOME];
+    
+    uint32_t id = mapa->nomeId[territorio];
+    if (mapa->definicao != NULL) {
+        return nomeNaDefinicao(mapa->definicao, (int)id);
+    }
+    snprintf(nomeGerado, sizeof(nomeGerado), "Territorio %" PRIu32, id + 1);
+    return nomeGerado;
+}
+
+const char* nomeDoContinente(const Mapa* mapa, int territorio) {
+    if (mapa->definicao == NULL || mapa->continente == NULL) {
+        return "-";
+    }
+    return mapa->definicao->nomesContinentes[mapa->continente[territorio]];
+}
+
+// ============================================================================
+// RENDERIZACAO EM BUFFER
+// Os quadros são montados com escreverQuadro e enviados por enviarQuadro em
+// uma única escrita, em vez de um printf por linha.
+// ============================================================================
+
+void escreverQuadro(const char* formato, ...) {
+    while (1) {
+        size_t livre = renderizador.capacidade - renderizador.tamanho;
+        va_list argumentos;
+        va_start(argumentos, formato);
+        int escritos = vsnprintf(renderizador.quadro != NULL ? renderizador.quadro + renderizador.tamanho : NULL,
+                                 livre, formato, argumentos);
+        va_end(argumentos);
+        if (escritos < 0) {
+            return;
+        }
+        if ((size_t)escritos < livre) {
+            renderizador.tamanho += (size_t)escritos;
+            return;
+        }
+        
+        // Não coube: dobrar a capacidade e formatar de novo
+        size_t capacidade = renderizador.capacidade > 0 ? renderizador.capacidade : TAM_INICIAL_QUADRO;
+        while (capacidade - renderizador.tamanho <= (size_t)escritos) {
+            capacidade *= 2;
+        }
+        char* novo = (char*)realloc(renderizador.quadro, capacidade);
+        if (novo == NULL) {
+            printf("Erro: Não foi possível alocar memória para o renderizador.\n");
+            exit(1);
+        }
+        renderizador.quadro = novo;
+        renderizador.capacidade = capacidade;
+    }
+}
+
+void enviarQuadro(void) {
+    if (renderizador.tamanho > 0) {
+        // O que já estava no buffer do stdout sai antes, preservando a ordem
+        fflush(stdout);
+#ifdef WAR_TEM_WRITE
+        // O quadro vai direto ao descritor, sem passar pelo buffer do stdio (que o
+        // dividiria em pedaços do tamanho do buffer); só escritas parciais repetem
+        const char* resto = renderizador.quadro;
+        size_t faltam = renderizador.tamanho;
+        while (faltam > 0) {
+            ssize_t escritos = write(STDOUT_FILENO, resto, faltam);
+            if (escritos < 0 && errno == EINTR) {
+                continue;
+            }
+            if (escritos <= 0) {
+                break; // Saída fechada ou com erro: o quadro é descartado
+            }
+            resto += escritos;
+            faltam -= (size_t)escritos;
+        }
+#else
+        fwrite(renderizador.quadro, 1, renderizador.tamanho, stdout);
+        fflush(stdout);
+#endif
+        renderizador.tamanho = 0;
+    }
+}
+
+void definirVerbosidade(int verbosidade) {
+    renderizador.verbosidade = verbosidade;
+}
+
+void liberarRenderizador(void) {
+    free(renderizador.quadro);
+    free(renderizador.donoExibido);
+    free(renderizador.tropasExibidas);
+    memset(&renderizador, 0, sizeof(renderizador));
+    renderizador.verbosidade = VERBOSIDADE_PADRAO;
+}
+
+// --- Funções do Nível Aventureiro ---
+
+// Arredonda um deslocamento para o próximo múltiplo de ALINHAMENTO_MAPA
+static size_t alinharMapa(size_t deslocamento) {
+    return (deslocamento + ALINHAMENTO_MAPA - 1) & ~(size_t)(ALINHAMENTO_MAPA - 1);
+}
+
+#ifdef WAR_TEM_MMAP
+// Mapeia um arquivo inteiro em memória (privado: escritas não chegam ao disco)
+static void* mapearArquivo(const char* caminho, size_t* tamanho) {
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        return NULL;
+    }
+    struct stat info;
+    void* base = MAP_FAILED;
+    if (fstat(descritor, &info) == 0 && info.st_size > 0) {
+        base = mmap(NULL, (size_t)info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descritor, 0);
+    }
+    close(descritor); // O mapeamento continua válido sem o descritor
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+    *tamanho = (size_t)info.st_size;
+    return base;
+}
+
+static void liberarMapeamento(void* base, size_t tamanho) {
+    munmap(base, tamanho);
+}
+#else
+// Sem mmap: o arquivo é lido de uma vez para um único bloco (ainda sem interpretação)
+static void* mapearArquivo(const char* caminho, size_t* tamanho) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        return NULL;
+    }
+    char* base = NULL;
+    long bytes = (fseek(arquivo, 0, SEEK_END) == 0) ? ftell(arquivo) : -1;
+    if (bytes > 0 && fseek(arquivo, 0, SEEK_SET) == 0) {
+        base = (char*)malloc((size_t)bytes);
+        if (base != NULL && fread(base, 1, (size_t)bytes, arquivo) != (size_t)bytes) {
+            free(base);
+            base = NULL;
+        }
+    }
+    fclose(arquivo);
+    if (base != NULL) {
+        *tamanho = (size_t)bytes;
+    }
+    return base;
+}
+
+static void liberarMapeamento(void* base, size_t tamanho) {
+    (void)tamanho;
+    free(base);
+}
+#endif
+
+// --- Arena da Partida (ver ArenaPartida) ---
+
+// Bloco extra do heap: ponteiro para o próximo extra, seguido da reserva alinhada
+static void* reservarExcedente(ArenaPartida* arena, size_t bytes) {
+    char* bloco = (char*)malloc(sizeof(void*) + ALINHAMENTO_MAPA - 1 + bytes);
+    if (bloco == NULL) {
+        printf("Erro: Não foi possível alocar memória para a partida.\n");
+        exit(1);
+    }
+    *(void**)bloco = arena->excedentes;
+    arena->excedentes = bloco;
+    arena->bytesExcedentes += bytes;
+    uintptr_t inicio = (uintptr_t)(bloco + sizeof(void*));
+    return (void*)((inicio + ALINHAMENTO_MAPA - 1) & ~(uintptr_t)(ALINHAMENTO_MAPA - 1));
+}
+
+static void liberarExcedentes(ArenaPartida* arena) {
+    while (arena->excedentes != NULL) {
+        void* proximo = *(void**)arena->excedentes;
+        free(arena->excedentes);
+        arena->excedentes = proximo;
+    }
+    arena->bytesExcedentes = 0;
+}
+
+void inicializarArena(ArenaPartida* arena, size_t capacidade) {
+    capacidade = alinharMapa(capacidade);
+    arena->bruto = (char*)malloc(capacidade + ALINHAMENTO_MAPA - 1);
+    if (arena->bruto == NULL) {
+        printf("Erro: Não foi possível alocar memória para a partida.\n");
+        exit(1);
+    }
+    uintptr_t inicio = (uintptr_t)arena->bruto;
+    arena->base = (char*)((inicio + ALINHAMENTO_MAPA - 1) & ~(uintptr_t)(ALINHAMENTO_MAPA - 1));
+    arena->capacidade = capacidade;
+    arena->usado = 0;
+    arena->topo = capacidade;
+    arena->excedentes = NULL;
+    arena->bytesExcedentes = 0;
+}
+
+void* reservarNaArena(ArenaPartida* arena, size_t bytes) {
+    bytes = alinharMapa(bytes);
+    if (bytes > arena->topo - arena->usado) {
+        return reservarExcedente(arena, bytes);
+    }
+    void* memoria = arena->base + arena->usado;
+    arena->usado += bytes;
+    return memoria;
+}
+
+void* reservarTemporarioNaArena(ArenaPartida* arena, size_t bytes) {
+    bytes = alinharMapa(bytes);
+    if (bytes > arena->topo - arena->usado) {
+        return reservarExcedente(arena, bytes); // Só volta no reinício
+    }
+    arena->topo -= bytes;
+    return arena->base + arena->topo;
+}
+
+void liberarTemporariosDaArena(ArenaPartida* arena) {
+    arena->topo = arena->capacidade;
+}
+
+void reiniciarArena(ArenaPartida* arena) {
+    if (arena->excedentes != NULL) {
+        // A partida não coube: um bloco só com o total (no mínimo o dobro), para a próxima caber inteira
+        size_t capacidade = arena->capacidade + arena->bytesExcedentes;
+        if (capacidade < 2 * arena->capacidade) {
+            capacidade = 2 * arena->capacidade;
+        }
+        liberarExcedentes(arena);
+        free(arena->bruto);
+        inicializarArena(arena, capacidade);
+        return;
+    }
+    arena->usado = 0;
+    arena->topo = arena->capacidade;
+}
+
+void liberarArena(ArenaPartida* arena) {
+    liberarExcedentes(arena);
+    free(arena->bruto);
+    memset(arena, 0, sizeof(*arena));
+}
+
+// Memória de um array auxiliar do mapa: da arena da partida, se houver, ou do heap
+static void* reservarParaMapa(Mapa* mapa, size_t bytes) {
+    return mapa->arena != NULL ? reservarNaArena(mapa->arena, bytes) : malloc(bytes);
+}
+
+// Contraparte de reservarParaMapa (na arena, a memória só volta no reinício)
+static void devolverDoMapa(Mapa* mapa, void* memoria) {
+    if (mapa->arena == NULL) {
+        free(memoria);
+    }
+}
+
+// Bloco de territórios: os arrays em sequência, cada um alinhado à linha de cache
+static size_t tamanhoBlocoMapa(size_t n) {
+    size_t inicioNomes = alinharMapa(n * sizeof(int32_t));
+    size_t inicioDonos = alinharMapa(inicioNomes + n * sizeof(uint32_t));
+    return alinharMapa(inicioDonos + n * sizeof(uint8_t));
+}
+
+static void apontarBlocoMapa(Mapa* mapa, char* bloco, int numTerritorios) {
+    size_t n = (size_t)numTerritorios;
+    size_t inicioTropas = 0;
+    size_t inicioNomes = alinharMapa(inicioTropas + n * sizeof(int32_t));
+    size_t inicioDonos = alinharMapa(inicioNomes + n * sizeof(uint32_t));
+    mapa->numTerritorios = numTerritorios;
+    mapa->tropas = (int32_t*)(bloco + inicioTropas);
+    mapa->nomeId = (uint32_t*)(bloco + inicioNomes);
+    mapa->dono = (uint8_t*)(bloco + inicioDonos);
+    mapa->bloco = bloco;
+    mapa->tamanhoBloco = tamanhoBlocoMapa(n);
+}
+
+Mapa* alocarMapa(int numTerritorios) {
+    Mapa* mapa = (Mapa*)calloc(1, sizeof(Mapa));
+    if (mapa == NULL) {
+        printf("Erro: Não foi possível alocar memória para os territórios.\n");
+        exit(1);
+    }
+    
+    // Bloco alinhado à linha de cache (calloc só garante 16 bytes); o tamanho
+    // já é múltiplo de ALINHAMENTO_MAPA, como aligned_alloc exige
+    size_t tamanho = tamanhoBlocoMapa((size_t)numTerritorios);
+    char* bloco = (char*)aligned_alloc(ALINHAMENTO_MAPA, tamanho > 0 ? tamanho : ALINHAMENTO_MAPA);
+    if (bloco == NULL) {
+        printf("Erro: Não foi possível alocar memória para os territórios.\n");
+        exit(1);
+    }
+    memset(bloco, 0, tamanho);
+    apontarBlocoMapa(mapa, bloco, numTerritorios);
+    return mapa;
+}
+
+Mapa* alocarMapaNaArena(ArenaPartida* arena, int numTerritorios) {
+    Mapa* mapa = (Mapa*)reservarNaArena(arena, sizeof(Mapa));
+    memset(mapa, 0, sizeof(Mapa));
+    size_t tamanho = tamanhoBlocoMapa((size_t)numTerritorios);
+    char* bloco = (char*)reservarNaArena(arena, tamanho);
+    memset(bloco, 0, tamanho);
+    apontarBlocoMapa(mapa, bloco, numTerritorios);
+    mapa->arena = arena;
+    return mapa;
+}
+
+void liberarMemoria(Mapa* mapa) {
+    if (mapa != NULL) {
+        if (renderizador.mapaExibido == mapa) {
+            renderizador.mapaExibido = NULL; // O próximo mapa no mesmo endereço será exibido por completo
+        }
+        if (mapa->arena != NULL) {
+            return; // Estrutura e arrays voltam com reiniciarArena
+        }
+        free(mapa->territoriosPorCor);
+        if (mapa->mapeamento != NULL) {
+            liberarMapeamento(mapa->mapeamento, mapa->tamanhoMapeamento); // Arrays e contadores vivem no snapshot
+        } else {
+            free(mapa->territoriosPorContinente);
+            free(mapa->blocoFronteiras);
+            free(mapa->bloco);
+        }
+        free(mapa);
+    }
+}
+
+// ============================================================================
+// CONJUNTOS DE TERRITORIOS EM BITS
+// ============================================================================
+
+static inline void marcarBit(Bitboard* conjunto, int32_t territorio) {
+    conjunto->palavras[territorio >> 6] |= 1ULL << (territorio & 63);
+}
+
+static inline void limparBit(Bitboard* conjunto, int32_t territorio) {
+    conjunto->palavras[territorio >> 6] &= ~(1ULL << (territorio & 63));
+}
+
+static inline int testarBit(const Bitboard* conjunto, int32_t territorio) {
+    return (int)((conjunto->palavras[territorio >> 6] >> (territorio & 63)) & 1);
+}
+
+// Índice do bit 1 menos significativo (palavra diferente de zero)
+static inline int menorBit(uint64_t palavra) {
+#ifdef __GNUC__
+    return __builtin_ctzll(palavra);
+#else
+    int bit = 0;
+    while (!(palavra & 1)) {
+        palavra >>= 1;
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+// Bits válidos da palavra w em um mapa de n territórios
+static inline uint64_t mascaraDaPalavra(int32_t n, int w) {
+    int32_t restantes = n - 64 * w;
+    return restantes >= 64 ? ~0ULL : (1ULL << restantes) - 1;
+}
+
+// O território faz fronteira com algum território que não é de 'proprios'?
+static inline int temVizinhoInimigo(const Bitboard* vizinhos, const Bitboard* proprios, int numPalavras) {
+    uint64_t inimigos = 0;
+    for (int w = 0; w < numPalavras; w++) {
+        inimigos |= vizinhos->palavras[w] & ~proprios->palavras[w];
+    }
+    return inimigos != 0;
+}
+
+void recalcularContadores(Mapa* mapa) {
+    memset(mapa->territoriosPorDono, 0, sizeof(mapa->territoriosPorDono));
+    memset(mapa->tropasPorDono, 0, sizeof(mapa->tropasPorDono));
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        mapa->territoriosPorDono[mapa->dono[i]]++;
+        mapa->tropasPorDono[mapa->dono[i]] += mapa->tropas[i];
+    }
+    montarIndicePorDono(mapa);
+    
+    if (mapa->continente == NULL) {
+        return; // Mapa sem continentes
+    }
+    
+    // Contagem por (continente, dono) e tamanho de cada continente, em uma única alocação
+    int numContinentes = mapa->definicao->numContinentes;
+    if (mapa->territoriosPorContinente == NULL || mapa->numContinentes != numContinentes) {
+        devolverDoMapa(mapa, mapa->territoriosPorContinente);
+        mapa->territoriosPorContinente = (int32_t*)reservarParaMapa(mapa, (size_t)numContinentes * (MAX_CORES + 1) * sizeof(int32_t));
+        if (mapa->territoriosPorContinente == NULL) {
+            printf("Erro: Não foi possível alocar memória para os contadores do mapa.\n");
+            exit(1);
+        }
+        mapa->tamanhoContinente = mapa->territoriosPorContinente + (size_t)numContinentes * MAX_CORES;
+        mapa->numContinentes = numContinentes;
+    }
+    memset(mapa->territoriosPorContinente, 0, (size_t)numContinentes * (MAX_CORES + 1) * sizeof(int32_t));
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        mapa->territoriosPorContinente[(size_t)mapa->continente[i] * MAX_CORES + mapa->dono[i]]++;
+        mapa->tamanhoContinente[mapa->continente[i]]++;
+    }
+}
+
+// Vizinhos em bits reservados junto com o índice por dono (mapas pequenos), depois das posições
+static inline Bitboard* vizinhosBitsReservados(const Mapa* mapa) {
+    return (Bitboard*)(mapa->territoriosPorCor + 2 * ((size_t)mapa->numTerritorios + 1));
+}
+
+// Reserva territoriosPorCor e posicaoPorCor (e, em mapas pequenos, os vizinhos em bits) em uma única alocação
+static void reservarIndicePorDono(Mapa* mapa) {
+    size_t n = (size_t)mapa->numTerritorios;
+    size_t bytesVizinhos = n <= MAX_TERRITORIOS_BITBOARD ? n * sizeof(Bitboard) : 0;
+    mapa->territoriosPorCor = (int32_t*)reservarParaMapa(mapa, 2 * (n + 1) * sizeof(int32_t) + bytesVizinhos);
+    if (mapa->territoriosPorCor == NULL) {
+        printf("Erro: Não foi possível alocar memória para o índice do mapa.\n");
+        exit(1);
+    }
+    mapa->posicaoPorCor = mapa->territoriosPorCor + n;
+}
+
+void montarIndicePorDono(Mapa* mapa) {
+    int32_t n = mapa->numTerritorios;
+    if (mapa->territoriosPorCor == NULL) {
+        reservarIndicePorDono(mapa);
+    }
+    
+    // Ordenação por contagem: início de cada grupo e preenchimento em ordem de índice
+    int32_t proximaPosicao[MAX_CORES];
+    int32_t inicio = 0;
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        mapa->inicioDoDono[cor] = inicio;
+        proximaPosicao[cor] = inicio;
+        inicio += mapa->territoriosPorDono[cor];
+    }
+    mapa->inicioDoDono[MAX_CORES] = inicio;
+    for (int32_t i = 0; i < n; i++) {
+        int32_t posicao = proximaPosicao[mapa->dono[i]]++;
+        mapa->territoriosPorCor[posicao] = i;
+        mapa->posicaoPorCor[i] = posicao;
+    }
+    
+    // Mapas pequenos: os mesmos grupos em bits, e as fronteiras atuais em bits
+    mapa->vizinhosBits = NULL;
+    if (n > MAX_TERRITORIOS_BITBOARD) {
+        return;
+    }
+    memset(mapa->bitsDoDono, 0, sizeof(mapa->bitsDoDono));
+    for (int32_t i = 0; i < n; i++) {
+        marcarBit(&mapa->bitsDoDono[mapa->dono[i]], i);
+    }
+    if (mapa->inicioVizinhos != NULL) {
+        Bitboard* vizinhosBits = vizinhosBitsReservados(mapa);
+        memset(vizinhosBits, 0, (size_t)n * sizeof(Bitboard));
+        for (int32_t i = 0; i < n; i++) {
+            for (int32_t k = mapa->inicioVizinhos[i]; k < mapa->inicioVizinhos[i + 1]; k++) {
+                marcarBit(&vizinhosBits[i], mapa->vizinhos[k]);
+            }
+        }
+        mapa->vizinhosBits = vizinhosBits;
+    }
+}
+
+// Troca dois territórios de posição no índice por dono
+static inline void trocarPosicoesPorCor(Mapa* mapa, int32_t a, int32_t b) {
+    int32_t ta = mapa->territoriosPorCor[a];
+    int32_t tb = mapa->territoriosPorCor[b];
+    mapa->territoriosPorCor[a] = tb;
+    mapa->territoriosPorCor[b] = ta;
+    mapa->posicaoPorCor[tb] = a;
+    mapa->posicaoPorCor[ta] = b;
+}
+
+// Guarda uma alteração na pilha de desfazer do mapa, se houver uma (cheia: marca o transbordo)
+static inline void registrarAlteracao(Mapa* mapa, TipoAlteracao tipo, int territorio, int valor, int32_t posicao) {
+    PilhaDesfazer* pilha = mapa->desfazer;
+    if (pilha == NULL) {
+        return;
+    }
+    if (pilha->numAlteracoes == TAM_PILHA_DESFAZER) {
+        pilha->transbordou = 1;
+        return;
+    }
+    AlteracaoMapa* alteracao = &pilha->alteracoes[pilha->numAlteracoes++];
+    alteracao->tipo = tipo;
+    alteracao->territorio = territorio;
+    alteracao->valor = valor;
+    alteracao->posicao = posicao;
+}
+
+void transferirTerritorio(Mapa* mapa, int territorio, int novoDono) {
+    int donoAnterior = mapa->dono[territorio];
+    
+    // Levar o território até o grupo do novo dono: em cada fronteira de grupo
+    // no caminho, troca com o elemento da ponta e a fronteira anda uma posição
+    int32_t posicao = mapa->posicaoPorCor[territorio];
+    registrarAlteracao(mapa, ALTERACAO_DONO, territorio, donoAnterior, posicao);
+    if (mapa->comHash) {
+        atualizarHashDono(mapa, territorio, donoAnterior, novoDono);
+    }
+    for (int cor = donoAnterior; cor < novoDono; cor++) {
+        int32_t ultimo = mapa->inicioDoDono[cor + 1] - 1;
+        trocarPosicoesPorCor(mapa, posicao, ultimo);
+        mapa->inicioDoDono[cor + 1] = ultimo; // Agora é o primeiro do grupo seguinte
+        posicao = ultimo;
+    }
+    for (int cor = donoAnterior; cor > novoDono; cor--) {
+        int32_t primeiro = mapa->inicioDoDono[cor];
+        trocarPosicoesPorCor(mapa, posicao, primeiro);
+        mapa->inicioDoDono[cor] = primeiro + 1; // Agora é o último do grupo anterior
+        posicao = primeiro;
+    }
+    
+    mapa->territoriosPorDono[donoAnterior]--;
+    mapa->territoriosPorDono[novoDono]++;
+    mapa->tropasPorDono[donoAnterior] -= mapa->tropas[territorio];
+    mapa->tropasPorDono[novoDono] += mapa->tropas[territorio];
+    if (mapa->territoriosPorContinente != NULL) {
+        int32_t* linha = mapa->territoriosPorContinente + (size_t)mapa->continente[territorio] * MAX_CORES;
+        linha[donoAnterior]--;
+        linha[novoDono]++;
+    }
+    mapa->dono[territorio] = (uint8_t)novoDono;
+    if (mapa->numTerritorios <= MAX_TERRITORIOS_BITBOARD) {
+        limparBit(&mapa->bitsDoDono[donoAnterior], territorio);
+        marcarBit(&mapa->bitsDoDono[novoDono], territorio);
+    }
+    if (mapa->missoes != NULL) {
+        notificarTrocaDeDono(mapa->missoes, donoAnterior, novoDono);
+    }
+}
+
+void alterarTropas(Mapa* mapa, int territorio, int delta) {
+    mapa->tropas[territorio] += delta;
+    mapa->tropasPorDono[mapa->dono[territorio]] += delta;
+    if (delta != 0) {
+        registrarAlteracao(mapa, ALTERACAO_TROPAS, territorio, delta, 0);
+        if (mapa->comHash) {
+            atualizarHashTropas(mapa, territorio, mapa->tropas[territorio] - delta, mapa->tropas[territorio]);
+        }
+    }
+}
+
+int aplicarResultadoAtaque(Mapa* mapa, int atacante, int defensor, int perdasAtacante, int perdasDefensor) {
+    alterarTropas(mapa, atacante, -perdasAtacante);
+    alterarTropas(mapa, defensor, -perdasDefensor);
+    if (mapa->tropas[defensor] > 0) {
+        return 1;
+    }
+    
+    // Território conquistado: transferir controle e mover tropas
+    int tropasMovidas = mapa->tropas[atacante] - 1;
+    transferirTerritorio(mapa, defensor, mapa->dono[atacante]);
+    alterarTropas(mapa, defensor, tropasMovidas);
+    alterarTropas(mapa, atacante, -tropasMovidas);
+    return 2;
+}
+
+void iniciarPilhaDesfazer(PilhaDesfazer* pilha) {
+    pilha->numAlteracoes = 0;
+    pilha->transbordou = 0;
+}
+
+// Inverso exato de transferirTerritorio: desfaz as trocas do índice por dono na
+// ordem contrária, então cada grupo volta à ordem que tinha antes da conquista
+static void desfazerTransferencia(Mapa* mapa, int territorio, int donoAnterior, int32_t posicaoAnterior) {
+    int donoAtual = mapa->dono[territorio];
+    for (int cor = donoAtual - 1; cor >= donoAnterior; cor--) {
+        // A ida trocou a posição anterior com a última do grupo 'cor' e recuou a fronteira
+        int32_t ultimo = mapa->inicioDoDono[cor + 1];
+        int32_t anterior = (cor == donoAnterior) ? posicaoAnterior : mapa->inicioDoDono[cor];
+        trocarPosicoesPorCor(mapa, ultimo, anterior);
+        mapa->inicioDoDono[cor + 1] = ultimo + 1;
+    }
+    for (int cor = donoAtual + 1; cor <= donoAnterior; cor++) {
+        // A ida trocou a posição anterior com a primeira do grupo 'cor' e avançou a fronteira
+        int32_t primeiro = mapa->inicioDoDono[cor] - 1;
+        int32_t anterior = (cor == donoAnterior) ? posicaoAnterior : mapa->inicioDoDono[cor + 1] - 1;
+        trocarPosicoesPorCor(mapa, primeiro, anterior);
+        mapa->inicioDoDono[cor] = primeiro;
+    }
+    
+    mapa->territoriosPorDono[donoAtual]--;
+    mapa->territoriosPorDono[donoAnterior]++;
+    mapa->tropasPorDono[donoAtual] -= mapa->tropas[territorio];
+    mapa->tropasPorDono[donoAnterior] += mapa->tropas[territorio];
+    if (mapa->territoriosPorContinente != NULL) {
+        int32_t* linha = mapa->territoriosPorContinente + (size_t)mapa->continente[territorio] * MAX_CORES;
+        linha[donoAtual]--;
+        linha[donoAnterior]++;
+    }
+    mapa->dono[territorio] = (uint8_t)donoAnterior;
+    if (mapa->numTerritorios <= MAX_TERRITORIOS_BITBOARD) {
+        limparBit(&mapa->bitsDoDono[donoAtual], territorio);
+        marcarBit(&mapa->bitsDoDono[donoAnterior], territorio);
+    }
+    if (mapa->comHash) {
+        atualizarHashDono(mapa, territorio, donoAtual, donoAnterior);
+    }
+    if (mapa->missoes != NULL) {
+        notificarTrocaDeDono(mapa->missoes, donoAtual, donoAnterior);
+    }
+}
+
+int desfazerAte(Mapa* mapa, int32_t marca) {
+    PilhaDesfazer* pilha = mapa->desfazer;
+    if (pilha->transbordou) {
+        // Alterações se perderam: nenhuma marca volta com exatidão até o dono esvaziar a pilha
+        return 0;
+    }
+    while (pilha->numAlteracoes > marca) {
+        const AlteracaoMapa* alteracao = &pilha->alteracoes[--pilha->numAlteracoes];
+        int territorio = alteracao->territorio;
+        if (alteracao->tipo == ALTERACAO_TROPAS) {
+            mapa->tropas[territorio] -= alteracao->valor;
+            mapa->tropasPorDono[mapa->dono[territorio]] -= alteracao->valor;
+            if (mapa->comHash) {
+                atualizarHashTropas(mapa, territorio, mapa->tropas[territorio] + alteracao->valor,
+                                    mapa->tropas[territorio]);
+            }
+        } else {
+            desfazerTransferencia(mapa, territorio, alteracao->valor, alteracao->posicao);
+        }
+    }
+    return 1;
+}
+
+void exibirRelatorioMemoria(const Mapa* mapa) {
+    double n = mapa->numTerritorios > 0 ? (double)mapa->numTerritorios : 1.0;
+    size_t bytesDono = (size_t)mapa->numTerritorios * sizeof(mapa->dono[0]);
+    size_t bytesTropas = (size_t)mapa->numTerritorios * sizeof(mapa->tropas[0]);
+    size_t bytesNomes = (size_t)mapa->numTerritorios * sizeof(mapa->nomeId[0]);
+    
+    printf("\n%s================ MEMORIA DO MAPA ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf("Territorios: %d\n", mapa->numTerritorios);
+    printf("%-10s %14s %12s\n", "ARRAY", "BYTES", "BYTES/TERR.");
+    printf("%-10s %14zu %12.2f\n", "dono", bytesDono, bytesDono / n);
+    printf("%-10s %14zu %12.2f\n", "tropas", bytesTropas, bytesTropas / n);
+    printf("%-10s %14zu %12.2f\n", "nomeId", bytesNomes, bytesNomes / n);
+    printf("%-10s %14zu %12.2f\n", "bloco", mapa->tamanhoBloco, mapa->tamanhoBloco / n);
+    // Índice por dono: reservado por recalcularContadores, fora do bloco
+    size_t bytesIndice = 2 * (size_t)mapa->numTerritorios * sizeof(int32_t);
+    printf("%-10s %14zu %12.2f  (territorios por cor)\n", "indice", bytesIndice, bytesIndice / n);
+    if (mapa->numTerritorios <= MAX_TERRITORIOS_BITBOARD) {
+        // Mapas pequenos: vizinhos em bits (junto ao índice) e territórios de cada cor em bits (na estrutura)
+        size_t bytesBits = (size_t)mapa->numTerritorios * sizeof(Bitboard) + sizeof(mapa->bitsDoDono);
+        printf("%-10s %14zu %12.2f  (cores e vizinhos em bits)\n", "bits", bytesBits, bytesBits / n);
+    }
+    if (mapa->inicioVizinhos != NULL) {
+        size_t numVizinhos = (size_t)mapa->inicioVizinhos[mapa->numTerritorios];
+        size_t bytesFronteiras = ((size_t)mapa->numTerritorios + 1 + numVizinhos) * sizeof(int32_t);
+        size_t bytesContinentes = (size_t)mapa->numTerritorios * sizeof(uint16_t);
+        printf("%-10s %14zu %12.2f  (%zu fronteiras, CSR)\n", "fronteiras", bytesFronteiras, bytesFronteiras / n, numVizinhos / 2);
+        printf("%-10s %14zu %12.2f\n", "continente", bytesContinentes, bytesContinentes / n);
+    }
+    printf("Varreduras de fim de jogo/missoes leem %zu byte(s) por territorio.\n", sizeof(mapa->dono[0]));
+    printf("%s=================================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+}
+
+// Validação comum a simularAtaque e simularBlitz (exibe o motivo da recusa)
+static int ataquePermitido(const Mapa* mapa, int atacante, int defensor) {
+    if (mapa->tropas[atacante] <= 1) {
+        printf("%s[!] ERRO: O atacante precisa ter pelo menos 2 tropas para atacar.%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+        return 0;
+    }
+    
+    if (mapa->tropas[defensor] <= 0) {
+        printf("%s[!] ERRO: O defensor nao possui tropas para defender.%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+        return 0;
+    }
+    
+    if (!saoVizinhos(mapa, atacante, defensor)) {
+        printf("%s[!] ERRO: %s nao faz fronteira com %s.%s\n", COR_VERMELHO_NEGRITO,
+               nomeDoTerritorio(mapa, atacante), nomeDoTerritorio(mapa, defensor), COR_RESET);
+        return 0;
+    }
+    return 1;
+}
+
+int simularAtaque(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng) {
+    if (!ataquePermitido(mapa, atacante, defensor)) {
+        return 0; // Ataque falhou
+    }
+    
+    // Guardar a cor original do defensor (a conquista a substitui)
+    int corDefensor = mapa->dono[defensor];
+    
+    // Resolver a rodada (dados, perdas e conquista) sem E/S
+    ResultadoCombate r;
+    int conquistou = (resolverCombate(mapa, atacante, defensor, rng, &r) == 2);
+    
+    // Montar o relatório do combate em um único quadro
+    escreverQuadro("\n%s[*] COMBATE EM ANDAMENTO!%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    escreverQuadro("---------------------------------------------------------------------\n");
+    escreverQuadro("%s[ATK] ATACANTE:%s %s (Exercito %s) | Tropas: %d\n", COR_AZUL, COR_RESET, nomeDoTerritorio(mapa, atacante), nomeDaCor(mapa->dono[atacante]), r.tropasAtacanteAntes);
+    escreverQuadro("%s[DEF] DEFENSOR:%s %s (Exercito %s) | Tropas: %d\n", COR_MAGENTA, COR_RESET, nomeDoTerritorio(mapa, defensor), nomeDaCor(corDefensor), r.tropasDefensorAntes);
+    
+    // Dados e duelos (omitidos na verbosidade 0)
+    if (renderizador.verbosidade >= 1) {
+        escreverQuadro("---------------------------------------------------------------------\n");
+        escreverQuadro("      Dados do atacante (%d): ", r.dadosAtacante);
+        for (int i = 0; i < r.dadosAtacante; i++) {
+            escreverQuadro("%s%d%s ", COR_AZUL, r.resultadosAtacante[i], COR_RESET);
+        }
+        escreverQuadro("\n      Dados do defensor (%d): ", r.dadosDefensor);
+        for (int i = 0; i < r.dadosDefensor; i++) {
+            escreverQuadro("%s%d%s ", COR_MAGENTA, r.resultadosDefensor[i], COR_RESET);
+        }
+        escreverQuadro("\n");
+        
+        // Uma comparação por par de dados (a segunda só se ambos têm 2 dados)
+        int duelos = (r.dadosAtacante == 2 && r.dadosDefensor == 2) ? 2 : 1;
+        for (int i = 0; i < duelos; i++) {
+            escreverQuadro("[DUELO %d] Atacante: %s%d%s vs Defensor: %s%d%s -> %s\n", i + 1,
+                           COR_AZUL, r.resultadosAtacante[i], COR_RESET, 
+                           COR_MAGENTA, r.resultadosDefensor[i], COR_RESET,
+                           r.resultadosAtacante[i] > r.resultadosDefensor[i]
+                               ? COR_VERDE_NEGRITO "Atacante vence!" COR_RESET
+                               : COR_VERMELHO_NEGRITO "Defensor vence!" COR_RESET);
+        }
+    }
+    escreverQuadro("---------------------------------------------------------------------\n");
+    
+    escreverQuadro("%s[RESULTADO]%s Perdas: Atacante %s-%d%s, Defensor %s-%d%s\n", 
+                   COR_AMARELO_NEGRITO, COR_RESET,
+                   COR_VERMELHO, r.perdasAtacante, COR_RESET,
+                   COR_VERMELHO, r.perdasDefensor, COR_RESET);
+    
+    int retorno;
+    if (conquistou) {
+        // Território conquistado
+        escreverQuadro("\n%s[***] CONQUISTA TOTAL! [***]%s\n", COR_VERDE_NEGRITO, COR_RESET);
+        escreverQuadro("      %s%s conquistou completamente %s!%s\n", COR_VERDE, nomeDoTerritorio(mapa, atacante), nomeDoTerritorio(mapa, defensor), COR_RESET);
+        escreverQuadro("      %s%s agora pertence ao exercito %s com %d tropas!%s\n", 
+                       COR_VERDE, nomeDoTerritorio(mapa, defensor), nomeDaCor(mapa->dono[defensor]), mapa->tropas[defensor], COR_RESET);
+        retorno = 2; // Território conquistado
+    } else if (mapa->tropas[atacante] <= 1) {
+        escreverQuadro("      %sAtacante nao tem mais tropas suficientes para continuar.%s\n", COR_VERMELHO, COR_RESET);
+        escreverQuadro("      %s%s mantem o controle com %d tropa(s).%s\n", COR_CIANO, nomeDoTerritorio(mapa, defensor), mapa->tropas[defensor], COR_RESET);
+        retorno = 0; // Ataque falhou
+    } else {
+        escreverQuadro("      %s%s ainda pode continuar atacando com %d tropa(s).%s\n", COR_AZUL, nomeDoTerritorio(mapa, atacante), mapa->tropas[atacante], COR_RESET);
+        escreverQuadro("      %s%s mantem o controle com %d tropa(s).%s\n", COR_MAGENTA, nomeDoTerritorio(mapa, defensor), mapa->tropas[defensor], COR_RESET);
+        retorno = 1; // Ataque bem-sucedido
+    }
+    enviarQuadro();
+    return retorno;
+}
+
+int resolverCombate(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng, ResultadoCombate* resultado) {
+    // Sistema de combate simplificado - máximo 2 dados por jogador
+    int dadosAtacante = (mapa->tropas[atacante] >= 3) ? 2 : 1;
+    int dadosDefensor = (mapa->tropas[defensor] >= 2) ? 2 : 1;
+    
+    // Arrays para armazenar os resultados dos dados
+    int resultadosAtacante[2] = {0, 0};
+    int resultadosDefensor[2] = {0, 0};
+    
+    // Rolar dados do atacante
+    for (int i = 0; i < dadosAtacante; i++) {
+        resultadosAtacante[i] = (int)aleatorioIntervalo(rng, 6) + 1;
+    }
+    
+    // Rolar dados do defensor
+    for (int i = 0; i < dadosDefensor; i++) {
+        resultadosDefensor[i] = (int)aleatorioIntervalo(rng, 6) + 1;
+    }
+    
+    // Ordenar dados em ordem decrescente (maior primeiro)
+    if (dadosAtacante == 2 && resultadosAtacante[0] < resultadosAtacante[1]) {
+        int temp = resultadosAtacante[0];
+        resultadosAtacante[0] = resultadosAtacante[1];
+        resultadosAtacante[1] = temp;
+    }
+    
+    if (dadosDefensor == 2 && resultadosDefensor[0] < resultadosDefensor[1]) {
+        int temp = resultadosDefensor[0];
+        resultadosDefensor[0] = resultadosDefensor[1];
+        resultadosDefensor[1] = temp;
+    }
+    
+    // Comparar dados (maior dado vs maior dado); empates favorecem o defensor
+    int perdas_atacante = 0;
+    int perdas_defensor = 0;
+    
+    if (resultadosAtacante[0] > resultadosDefensor[0]) {
+        perdas_defensor++;
+    } else {
+        perdas_atacante++;
+    }
+    
+    // Segunda comparação (se ambos têm 2 dados)
+    if (dadosAtacante == 2 && dadosDefensor == 2) {
+        if (resultadosAtacante[1] > resultadosDefensor[1]) {
+            perdas_defensor++;
+        } else {
+            perdas_atacante++;
+        }
+    }
+    
+    if (resultado != NULL) {
+        resultado->dadosAtacante = dadosAtacante;
+        resultado->dadosDefensor = dadosDefensor;
+        resultado->resultadosAtacante[0] = resultadosAtacante[0];
+        resultado->resultadosAtacante[1] = resultadosAtacante[1];
+        resultado->resultadosDefensor[0] = resultadosDefensor[0];
+        resultado->resultadosDefensor[1] = resultadosDefensor[1];
+        resultado->tropasAtacanteAntes = mapa->tropas[atacante];
+        resultado->tropasDefensorAntes = mapa->tropas[defensor];
+        resultado->perdasAtacante = perdas_atacante;
+        resultado->perdasDefensor = perdas_defensor;
+    }
+    
+    registrarEvento(EVENTO_ATAQUE, mapa->dono[atacante], mapa->dono[defensor], ATAQUE_RODADA,
+                    mapa->tropas[atacante], mapa->tropas[defensor], perdas_atacante, perdas_defensor);
+    
+    // Aplicar perdas e, se o defensor ficou sem tropas, a conquista
+    int retorno = aplicarResultadoAtaque(mapa, atacante, defensor, perdas_atacante, perdas_defensor);
+    METRICA_RODADA(mapa, atacante, defensor, perdas_atacante, perdas_defensor, mapa->tropas[atacante] <= 1);
+    METRICA_CONTAR(conquistas, retorno == 2);
+    return retorno;
+}
+
+int simularBlitz(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng) {
+    if (!ataquePermitido(mapa, atacante, defensor)) {
+        return 0; // Ataque falhou
+    }
+    
+    int corDefensor = mapa->dono[defensor];
+    ResultadoBatalha r;
+    int retorno = resolverBatalha(mapa, atacante, defensor, rng, &r);
+    
+    escreverQuadro("\n%s[*] BLITZ: BATALHA ATE O FIM!%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    escreverQuadro("---------------------------------------------------------------------\n");
+    escreverQuadro("%s[ATK] ATACANTE:%s %s (Exercito %s) | Tropas: %d\n", COR_AZUL, COR_RESET, nomeDoTerritorio(mapa, atacante), nomeDaCor(mapa->dono[atacante]), r.tropasAtacanteAntes);
+    escreverQuadro("%s[DEF] DEFENSOR:%s %s (Exercito %s) | Tropas: %d\n", COR_MAGENTA, COR_RESET, nomeDoTerritorio(mapa, defensor), nomeDaCor(corDefensor), r.tropasDefensorAntes);
+    escreverQuadro("---------------------------------------------------------------------\n");
+    escreverQuadro("%s[RESULTADO]%s Perdas: Atacante %s-%d%s, Defensor %s-%d%s\n",
+                   COR_AMARELO_NEGRITO, COR_RESET,
+                   COR_VERMELHO, r.perdasAtacante, COR_RESET,
+                   COR_VERMELHO, r.perdasDefensor, COR_RESET);
+    if (r.conquistou) {
+        escreverQuadro("\n%s[***] CONQUISTA TOTAL! [***]%s\n", COR_VERDE_NEGRITO, COR_RESET);
+        escreverQuadro("      %s%s agora pertence ao exercito %s com %d tropas!%s\n",
+                       COR_VERDE, nomeDoTerritorio(mapa, defensor), nomeDaCor(mapa->dono[defensor]), mapa->tropas[defensor], COR_RESET);
+    } else {
+        escreverQuadro("      %sAtacante nao tem mais tropas suficientes para continuar.%s\n", COR_VERMELHO, COR_RESET);
+        escreverQuadro("      %s%s mantem o controle com %d tropa(s).%s\n", COR_CIANO, nomeDoTerritorio(mapa, defensor), mapa->tropas[defensor], COR_RESET);
+    }
+    enviarQuadro();
+    return retorno;
+}
+
+int resolverBatalha(Mapa* mapa, int atacante, int defensor, EstadoRNG* rng, ResultadoBatalha* resultado) {
+    int tropasAtacante = mapa->tropas[atacante];
+    int tropasDefensor = mapa->tropas[defensor];
+    int finalAtacante = tropasAtacante;
+    int finalDefensor = tropasDefensor;
+    sortearFimDeBatalha(&finalAtacante, &finalDefensor, rng);
+    METRICA_BATALHA(tropasAtacante - finalAtacante, tropasDefensor - finalDefensor, finalDefensor == 0);
+    registrarEvento(EVENTO_ATAQUE, mapa->dono[atacante], mapa->dono[defensor], ATAQUE_BLITZ, tropasAtacante,
+                    tropasDefensor, tropasAtacante - finalAtacante, tropasDefensor - finalDefensor);
+    
+    if (resultado != NULL) {
+        resultado->tropasAtacanteAntes = tropasAtacante;
+        resultado->tropasDefensorAntes = tropasDefensor;
+        resultado->perdasAtacante = tropasAtacante - finalAtacante;
+        resultado->perdasDefensor = tropasDefensor - finalDefensor;
+        resultado->conquistou = (finalDefensor == 0);
+    }
+    
+    // Aplicar o estado final de uma só vez (mesma conquista de resolverCombate)
+    return aplicarResultadoAtaque(mapa, atacante, defensor, tropasAtacante - finalAtacante, tropasDefensor - finalDefensor);
+}
+
+void faseDeAtaque(Mapa* mapa, EstadoRNG* rng, int corJogador) {
+    printf("\n[*] FASE DE COMBATE [*]\n");
+    printf("=======================================================================\n");
+    printf("[*] INSTRUCOES:\n");
+    printf("   - Escolha um territorio atacante (deve ter pelo menos 2 tropas)\n");
+    printf("   - Escolha um territorio defensor (cor diferente, fazendo fronteira com o atacante)\n");
+    printf("   - Digite -1 para encerrar a fase de ataques\n");
+    printf("=======================================================================\n");
+    
+    int numTerritorios = mapa->numTerritorios;
+    int atacanteIdx, defensorIdx;
+    
+    while (1) {
+        // Verificar se o jogo terminou
+        if (verificarFimDeJogo(mapa)) {
+            printf("\n[***] FIM DE JOGO! [***]\n");
+            printf("Todos os territorios pertencem ao mesmo exercito!\n");
+            break;
+        }
+        
+        printf("\n[INFO] SITUACAO ATUAL DO CAMPO DE BATALHA:\n");
+        exibirAlteracoesMapa(mapa);
+        
+        printf("\n[ATK] Escolha o territorio ATACANTE (1-%d) ou -1 para parar: ", numTerritorios);
+        if (scanf("%d", &atacanteIdx) != 1) {
+            limparBufferEntrada();
+            printf("[!] Entrada invalida!\n");
+            continue;
+        }
+        limparBufferEntrada();
+        
+        if (atacanteIdx == -1) {
+            printf("\n[END] Fase de ataques encerrada.\n");
+            break;
+        }
+        
+        if (atacanteIdx < 1 || atacanteIdx > numTerritorios) {
+            printf("[!] Territorio invalido!\n");
+            continue;
+        }
+        
+        if (corJogador != SEM_COR && mapa->dono[atacanteIdx - 1] != corJogador) {
+            printf("[!] O territorio '%s' pertence a outro exercito (voce comanda o %s)!\n",
+                   nomeDoTerritorio(mapa, atacanteIdx - 1), nomeDaCor(corJogador));
+            continue;
+        }
+        
+        if (mapa->tropas[atacanteIdx - 1] <= 1) {
+            printf("[!] O territorio '%s' nao tem tropas suficientes para atacar!\n", nomeDoTerritorio(mapa, atacanteIdx - 1));
+            continue;
+        }
+        
+        // Listar os alvos possíveis: vizinhos de outra cor
+        if (mapa->inicioVizinhos != NULL) {
+            int alvos = 0;
+            printf("[FRONTEIRAS] Alvos de %s:", nomeDoTerritorio(mapa, atacanteIdx - 1));
+            for (int k = mapa->inicioVizinhos[atacanteIdx - 1]; k < mapa->inicioVizinhos[atacanteIdx]; k++) {
+                int v = mapa->vizinhos[k];
+                if (mapa->dono[v] != mapa->dono[atacanteIdx - 1]) {
+                    printf(" %d-%s (%d)", v + 1, nomeDoTerritorio(mapa, v), mapa->tropas[v]);
+                    alvos++;
+                }
+            }
+            printf("%s\n", alvos > 0 ? "" : " nenhum");
+            if (alvos == 0) {
+                printf("[!] O territorio '%s' nao faz fronteira com nenhum inimigo!\n", nomeDoTerritorio(mapa, atacanteIdx - 1));
+                continue;
+            }
+        }
+        
+        printf("[DEF] Escolha o territorio DEFENSOR (1-%d): ", numTerritorios);
+        if (scanf("%d", &defensorIdx) != 1) {
+            limparBufferEntrada();
+            printf("[!] Entrada invalida!\n");
+            continue;
+        }
+        limparBufferEntrada();
+        
+        if (defensorIdx < 1 || defensorIdx > numTerritorios) {
+            printf("[!] Territorio invalido!\n");
+            continue;
+        }
+        
+        if (atacanteIdx == defensorIdx) {
+            printf("[!] Um territorio nao pode atacar a si mesmo!\n");
+            continue;
+        }
+        
+        if (mapa->dono[atacanteIdx - 1] == mapa->dono[defensorIdx - 1]) {
+            printf("[!] Territorios aliados nao podem se atacar!\n");
+            continue;
+        }
+        
+        if (!saoVizinhos(mapa, atacanteIdx - 1, defensorIdx - 1)) {
+            printf("[!] '%s' nao faz fronteira com '%s'!\n",
+                   nomeDoTerritorio(mapa, atacanteIdx - 1), nomeDoTerritorio(mapa, defensorIdx - 1));
+            continue;
+        }
+        
+        // Chance exata de conquista se o ataque for levado até o fim
+        const ProbabilidadeBatalha* chance = consultarProbabilidadeBatalha(
+            mapa->tropas[atacanteIdx - 1], mapa->tropas[defensorIdx - 1]);
+        if (chance != NULL) {
+            printf("\n[INFO] Chance de conquista atacando ate o fim: %s%.1f%%%s\n",
+                   COR_AMARELO, 100.0 * chance->probVitoria, COR_RESET);
+        }
+        
+        int modo;
+        printf("[MODO] 1 = uma rodada de dados | 2 = blitz (ate a conquista ou 1 tropa): ");
+        if (scanf("%d", &modo) != 1) {
+            limparBufferEntrada();
+            printf("[!] Entrada invalida!\n");
+            continue;
+        }
+        limparBufferEntrada();
+        
+        if (modo != 1 && modo != 2) {
+            printf("[!] Modo invalido!\n");
+            continue;
+        }
+        
+        // Executar o ataque
+        if (modo == 2) {
+            registrarDecisao(DECISAO_ATAQUE, atacanteIdx - 1, defensorIdx - 1, ATAQUE_BLITZ);
+            simularBlitz(mapa, atacanteIdx - 1, defensorIdx - 1, rng);
+        } else {
+            registrarDecisao(DECISAO_ATAQUE, atacanteIdx - 1, defensorIdx - 1, ATAQUE_RODADA);
+            printf("\n[*] INICIANDO COMBATE...\n");
+            simularAtaque(mapa, atacanteIdx - 1, defensorIdx - 1, rng);
+        }
+        
+        printf("\n[PAUSE] Pressione Enter para continuar...");
+        getchar();
+    }
+}
+
+// ============================================================================
+// DEFINICAO DE MAPAS E FRONTEIRAS (CSR)
+// Formato do arquivo de mapa (uma declaração por linha, '#' inicia comentário):
+//   continente <nome>                  -> continentes numerados a partir de 0
+//   territorio <continente> <nome>     -> territórios numerados a partir de 0
+//   fronteira <territorio> <territorio>
+// O arquivo é lido em uma única passada; as fronteiras são acumuladas como
+// pares e convertidas em CSR por contagem, em tempo O(territórios + fronteiras).
+// ============================================================================
+
+// Estado do carregamento: a definição em construção e as fronteiras ainda em pares
+typedef struct {
+    DefinicaoMapa* definicao;
+    size_t tamanhoNomes;                // Bytes usados em definicao->nomes
+    size_t capacidadeNomes;             // Bytes alocados em definicao->nomes
+    size_t capacidadeTerritorios;       // Entradas alocadas em inicioNome/continente
+    size_t capacidadeContinentes;       // Entradas alocadas em nomesContinentes
+    int32_t* pares;                     // Fronteiras: pares[2k] e pares[2k + 1]
+    size_t numPares;                    // Fronteiras lidas
+    size_t capacidadePares;             // Fronteiras alocadas
+    char mensagem[2 * TAM_MAX_NOME + 64]; // Erros da finalização que citam territórios
+} CarregadorMapa;
+
+// Mapa embutido (mesmo formato dos arquivos): as Américas com 23 territórios
+static const char* const MAPA_PADRAO[] = {
+    "continente America do Sul",
+    "continente America Central",
+    "continente America do Norte",
+    "territorio 0 Brasil",
+    "territorio 0 Argentina",
+    "territorio 0 Chile",
+    "territorio 0 Peru",
+    "territorio 0 Colombia",
+    "territorio 0 Venezuela",
+    "territorio 0 Equador",
+    "territorio 0 Bolivia",
+    "territorio 0 Paraguai",
+    "territorio 0 Uruguai",
+    "territorio 0 Guiana",
+    "territorio 0 Suriname",
+    "territorio 0 Guiana Francesa",
+    "territorio 1 Panama",
+    "territorio 1 Costa Rica",
+    "territorio 1 Nicaragua",
+    "territorio 1 Honduras",
+    "territorio 1 El Salvador",
+    "territorio 1 Guatemala",
+    "territorio 1 Belize",
+    "territorio 2 Mexico",
+    "territorio 2 Estados Unidos",
+    "territorio 2 Canada",
+    "fronteira 0 1", "fronteira 0 3", "fronteira 0 4", "fronteira 0 5",
+    "fronteira 0 7", "fronteira 0 8", "fronteira 0 9", "fronteira 0 10",
+    "fronteira 0 11", "fronteira 0 12",
+    "fronteira 1 2", "fronteira 1 7", "fronteira 1 8", "fronteira 1 9",
+    "fronteira 2 3", "fronteira 2 7",
+    "fronteira 3 4", "fronteira 3 6", "fronteira 3 7",
+    "fronteira 4 5", "fronteira 4 6", "fronteira 4 13",
+    "fronteira 5 10", "fronteira 7 8", "fronteira 10 11", "fronteira 11 12",
+    "fronteira 13 14", "fronteira 14 15", "fronteira 15 16", "fronteira 16 17",
+    "fronteira 16 18", "fronteira 17 18", "fronteira 18 19", "fronteira 18 20",
+    "fronteira 19 20", "fronteira 20 21", "fronteira 21 22",
+    NULL
+};
+
+// Garante espaço para 'necessario' itens, dobrando a capacidade (crescimento amortizado O(1))
+static int garantirCapacidade(void** dados, size_t* capacidade, size_t necessario, size_t tamanhoItem) {
+    if (necessario <= *capacidade) {
+        return 1;
+    }
+    size_t novaCapacidade = *capacidade > 0 ? *capacidade : 16;
+    while (novaCapacidade < necessario) {
+        novaCapacidade *= 2;
+    }
+    void* novo = realloc(*dados, novaCapacidade * tamanhoItem);
+    if (novo == NULL) {
+        return 0;
+    }
+    *dados = novo;
+    *capacidade = novaCapacidade;
+    return 1;
+}
+
+// Remove espaços do início e do fim de um texto (modifica o próprio texto)
+static char* aparar(char* texto) {
+    while (*texto == ' ' || *texto == '\t') texto++;
+    size_t len = strlen(texto);
+    while (len > 0 && (texto[len - 1] == ' ' || texto[len - 1] == '\t' ||
+                       texto[len - 1] == '\r' || texto[len - 1] == '\n')) {
+        texto[--len] = '\0';
+    }
+    return texto;
+}
+
+// Lê um inteiro não negativo e avança o cursor; retorna 0 se não houver número
+static int lerIndiceMapa(char** cursor, long* valor) {
+    char* fim;
+    *valor = strtol(*cursor, &fim, 10);
+    if (fim == *cursor || *valor < 0) {
+        return 0;
+    }
+    *cursor = fim;
+    return 1;
+}
+
+// Interpreta uma linha do mapa; retorna a mensagem de erro ou NULL se a linha é válida
+static const char* interpretarLinhaMapa(CarregadorMapa* c, char* linha) {
+    DefinicaoMapa* d = c->definicao;
+    char* texto = aparar(linha);
+    if (*texto == '\0' || *texto == '#') {
+        return NULL; // Linha vazia ou comentário
+    }
+    
+    if (strncmp(texto, "continente ", 11) == 0) {
+        char* nome = aparar(texto + 11);
+        if (*nome == '\0') return "continente sem nome";
+        if (d->numContinentes >= MAX_CONTINENTES) return "continentes demais";
+        if (!garantirCapacidade((void**)&d->nomesContinentes, &c->capacidadeContinentes,
+                                (size_t)d->numContinentes + 1, sizeof(d->nomesContinentes[0]))) {
+            return "memoria insuficiente";
+        }
+        strncpy(d->nomesContinentes[d->numContinentes], nome, TAM_MAX_NOME - 1);
+        d->nomesContinentes[d->numContinentes][TAM_MAX_NOME - 1] = '\0';
+        d->numContinentes++;
+        return NULL;
+    }
+    
+    if (strncmp(texto, "territorio ", 11) == 0) {
+        char* cursor = texto + 11;
+        long continente;
+        if (!lerIndiceMapa(&cursor, &continente)) return "continente do territorio ausente";
+        if (continente >= d->numContinentes) return "continente do territorio nao declarado";
+        char* nome = aparar(cursor);
+        if (*nome == '\0') return "territorio sem nome";
+        if (d->numTerritorios >= MAX_TERRITORIOS_SIMULACAO) return "territorios demais";
+        
+        size_t tamanho = strlen(nome);
+        if (tamanho > TAM_MAX_NOME - 1) tamanho = TAM_MAX_NOME - 1;
+        size_t n = (size_t)d->numTerritorios + 1;
+        if (!garantirCapacidade((void**)&d->nomes, &c->capacidadeNomes, c->tamanhoNomes + tamanho + 1, 1)) {
+            return "memoria insuficiente";
+        }
+        if (n > c->capacidadeTerritorios) {
+            // inicioNome e continente crescem juntos
+            size_t capacidade = c->capacidadeTerritorios;
+            if (!garantirCapacidade((void**)&d->inicioNome, &capacidade, n, sizeof(uint32_t)) ||
+                !garantirCapacidade((void**)&d->continente, &c->capacidadeTerritorios, n, sizeof(uint16_t))) {
+                return "memoria insuficiente";
+            }
+        }
+        memcpy(d->nomes + c->tamanhoNomes, nome, tamanho);
+        d->nomes[c->tamanhoNomes + tamanho] = '\0';
+        d->inicioNome[d->numTerritorios] = (uint32_t)c->tamanhoNomes;
+        d->continente[d->numTerritorios] = (uint16_t)continente;
+        c->tamanhoNomes += tamanho + 1;
+        d->numTerritorios++;
+        return NULL;
+    }
+    
+    if (strncmp(texto, "fronteira ", 10) == 0) {
+        char* cursor = texto + 10;
+        long a, b;
+        if (!lerIndiceMapa(&cursor, &a) || !lerIndiceMapa(&cursor, &b)) return "fronteira precisa de dois territorios";
+        if (*aparar(cursor) != '\0') return "texto extra apos a fronteira";
+        if (a == b) return "territorio nao pode fazer fronteira consigo mesmo";
+        if (a >= MAX_TERRITORIOS_SIMULACAO || b >= MAX_TERRITORIOS_SIMULACAO) return "territorio da fronteira fora do limite";
+        if (!garantirCapacidade((void**)&c->pares, &c->capacidadePares, 2 * (c->numPares + 1), sizeof(int32_t))) {
+            return "memoria insuficiente";
+        }
+        c->pares[2 * c->numPares] = (int32_t)a;
+        c->pares[2 * c->numPares + 1] = (int32_t)b;
+        c->numPares++;
+        return NULL;
+    }
+    
+    return "declaracao desconhecida (use continente, territorio ou fronteira)";
+}
+
+// FNV-1a de 32 bits do nome de um território
+static uint32_t espalharNome(const char* nome) {
+    uint32_t h = 2166136261u;
+    while (*nome != '\0') {
+        h = (h ^ (uint8_t)*nome++) * 16777619u;
+    }
+    return h;
+}
+
+// Nomes de território repetidos, por uma tabela hash de endereçamento aberto; retorna o erro ou NULL
+static const char* conferirNomesRepetidos(CarregadorMapa* c) {
+    const DefinicaoMapa* d = c->definicao;
+    size_t tamanho = 16;
+    while (tamanho < 2 * (size_t)d->numTerritorios) tamanho *= 2;
+    int32_t* tabela = (int32_t*)calloc(tamanho, sizeof(int32_t)); // Território + 1 (0 = vazio)
+    if (tabela == NULL) return "memoria insuficiente";
+    const char* erro = NULL;
+    for (int t = 0; t < d->numTerritorios && erro == NULL; t++) {
+        const char* nome = nomeNaDefinicao(d, t);
+        size_t i = espalharNome(nome) & (tamanho - 1);
+        while (tabela[i] != 0 && strcmp(nomeNaDefinicao(d, tabela[i] - 1), nome) != 0) {
+            i = (i + 1) & (tamanho - 1);
+        }
+        if (tabela[i] != 0) {
+            snprintf(c->mensagem, sizeof(c->mensagem), "territorio '%s' declarado duas vezes (%d e %d)",
+                     nome, tabela[i] - 1, t);
+            erro = c->mensagem;
+        }
+        tabela[i] = t + 1;
+    }
+    free(tabela);
+    return erro;
+}
+
+// Fronteiras repetidas (em qualquer ordem), já em CSR: cada lista marca os seus
+// vizinhos com o número do território, e uma marca já presente é repetição
+static const char* conferirFronteirasRepetidas(CarregadorMapa* c) {
+    const DefinicaoMapa* d = c->definicao;
+    int32_t* marca = (int32_t*)malloc((size_t)d->numTerritorios * sizeof(int32_t));
+    if (marca == NULL) return "memoria insuficiente";
+    for (int t = 0; t < d->numTerritorios; t++) marca[t] = -1;
+    const char* erro = NULL;
+    for (int t = 0; t < d->numTerritorios && erro == NULL; t++) {
+        for (int32_t k = d->inicioVizinhos[t]; k < d->inicioVizinhos[t + 1]; k++) {
+            int32_t v = d->vizinhos[k];
+            if (marca[v] == t) {
+                snprintf(c->mensagem, sizeof(c->mensagem), "fronteira entre os territorios %d e %d repetida",
+                         t < v ? t : v, t < v ? v : t);
+                erro = c->mensagem;
+                break;
+            }
+            marca[v] = t;
+        }
+    }
+    free(marca);
+    return erro;
+}
+
+// Converte os pares de fronteiras em CSR (contagem de graus + soma de prefixos)
+static const char* finalizarDefinicaoMapa(CarregadorMapa* c) {
+    DefinicaoMapa* d = c->definicao;
+    int n = d->numTerritorios;
+    if (n < MIN_TERRITORIOS) return "o mapa precisa de pelo menos 3 territorios";
+    if (c->numPares > (size_t)INT32_MAX / 2) return "fronteiras demais";
+    
+    for (size_t k = 0; k < 2 * c->numPares; k++) {
+        if (c->pares[k] >= n) return "fronteira com territorio nao declarado";
+    }
+    
+    d->numFronteiras = (int)c->numPares;
+    d->inicioVizinhos = (int32_t*)calloc((size_t)n + 1, sizeof(int32_t));
+    d->vizinhos = (int32_t*)malloc((2 * c->numPares > 0 ? 2 * c->numPares : 1) * sizeof(int32_t));
+    if (d->inicioVizinhos == NULL || d->vizinhos == NULL) return "memoria insuficiente";
+    
+    // 1) Grau de cada território (deslocado em uma posição)
+    for (size_t k = 0; k < 2 * c->numPares; k++) {
+        d->inicioVizinhos[c->pares[k] + 1]++;
+    }
+    // 2) Soma de prefixos: início da lista de cada território
+    for (int t = 0; t < n; t++) {
+        d->inicioVizinhos[t + 1] += d->inicioVizinhos[t];
+    }
+    // 3) Preencher as listas, usando o início de cada uma como cursor
+    for (size_t k = 0; k < c->numPares; k++) {
+        int32_t a = c->pares[2 * k];
+        int32_t b = c->pares[2 * k + 1];
+        d->vizinhos[d->inicioVizinhos[a]++] = b;
+        d->vizinhos[d->inicioVizinhos[b]++] = a;
+    }
+    // 4) Cada cursor parou no início da lista seguinte: deslocar de volta
+    for (int t = n; t > 0; t--) {
+        d->inicioVizinhos[t] = d->inicioVizinhos[t - 1];
+    }
+    d->inicioVizinhos[0] = 0;
+    
+    // 5) Cada nome e cada fronteira uma única vez
+    const char* erro = conferirNomesRepetidos(c);
+    return erro != NULL ? erro : conferirFronteirasRepetidas(c);
+}
+
+// Cria um carregador com uma definição vazia
+static int iniciarCarregador(CarregadorMapa* c) {
+    memset(c, 0, sizeof(*c));
+    c->definicao = (DefinicaoMapa*)calloc(1, sizeof(DefinicaoMapa));
+    return c->definicao != NULL;
+}
+
+// Conclui o carregamento; em caso de erro libera tudo e retorna NULL
+static DefinicaoMapa* concluirCarregador(CarregadorMapa* c, const char* erro, const char* origem, long numLinha) {
+    if (erro == NULL) {
+        erro = finalizarDefinicaoMapa(c);
+        numLinha = 0;
+    }
+    free(c->pares);
+    if (erro != NULL) {
+        if (numLinha > 0) {
+            printf("%s[ERRO] %s:%ld: %s.%s\n", COR_VERMELHO_NEGRITO, origem, numLinha, erro, COR_RESET);
+        } else {
+            printf("%s[ERRO] %s: %s.%s\n", COR_VERMELHO_NEGRITO, origem, erro, COR_RESET);
+        }
+        liberarDefinicaoMapa(c->definicao);
+        return NULL;
+    }
+    return c->definicao;
+}
+
+DefinicaoMapa* carregarDefinicaoMapa(const char* caminho) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        printf("%s[ERRO] Nao foi possivel abrir o mapa '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        return NULL;
+    }
+    setvbuf(arquivo, NULL, _IOFBF, 1 << 20); // Leitura sequencial em blocos grandes
+    
+    CarregadorMapa c;
+    if (!iniciarCarregador(&c)) {
+        fclose(arquivo);
+        printf("Erro: Não foi possível alocar memória para o mapa.\n");
+        exit(1);
+    }
+    
+    double inicio = tempoAtualSegundos();
+    char linha[TAM_LINHA_MAPA];
+    long numLinha = 0;
+    const char* erro = NULL;
+    while (erro == NULL && fgets(linha, sizeof(linha), arquivo) != NULL) {
+        numLinha++;
+        if (strchr(linha, '\n') == NULL && !feof(arquivo)) {
+            erro = "linha longa demais";
+            break;
+        }
+        erro = interpretarLinhaMapa(&c, linha);
+    }
+    fclose(arquivo);
+    
+    DefinicaoMapa* definicao = concluirCarregador(&c, erro, caminho, numLinha);
+    if (definicao != NULL) {
+        printf("[MAPA] '%s': %d territorios, %d continentes, %d fronteiras (%.3f s)\n",
+               caminho, definicao->numTerritorios, definicao->numContinentes,
+               definicao->numFronteiras, tempoAtualSegundos() - inicio);
+    }
+    return definicao;
+}
+
+DefinicaoMapa* carregarMapaPadrao(void) {
+    CarregadorMapa c;
+    if (!iniciarCarregador(&c)) {
+        printf("Erro: Não foi possível alocar memória para o mapa.\n");
+        exit(1);
+    }
+    
+    char linha[TAM_LINHA_MAPA];
+    const char* erro = NULL;
+    long numLinha = 0;
+    for (int i = 0; erro == NULL && MAPA_PADRAO[i] != NULL; i++) {
+        numLinha = i + 1;
+        strncpy(linha, MAPA_PADRAO[i], sizeof(linha) - 1);
+        linha[sizeof(linha) - 1] = '\0';
+        erro = interpretarLinhaMapa(&c, linha);
+    }
+    return concluirCarregador(&c, erro, "mapa embutido", numLinha);
+}
+
+void liberarDefinicaoMapa(DefinicaoMapa* definicao) {
+    if (definicao != NULL) {
+        free(definicao->nomes);
+        free(definicao->inicioNome);
+        free(definicao->continente);
+        free(definicao->nomesContinentes);
+        free(definicao->inicioVizinhos);
+        free(definicao->vizinhos);
+        free(definicao);
+    }
+}
+
+const char* nomeNaDefinicao(const DefinicaoMapa* definicao, int territorio) {
+    return definicao->nomes + definicao->inicioNome[territorio];
+}
+
+void associarMapaCompleto(Mapa* mapa, const DefinicaoMapa* definicao) {
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        mapa->nomeId[i] = (uint32_t)i;
+    }
+    mapa->definicao = definicao;
+    mapa->inicioVizinhos = definicao->inicioVizinhos;
+    mapa->vizinhos = definicao->vizinhos;
+    mapa->vizinhosBits = NULL; // Montados de novo com o índice (recalcularContadores)
+    mapa->continente = definicao->continente;
+}
+
+void associarSubmapa(Mapa* mapa, const DefinicaoMapa* definicao) {
+    int n = mapa->numTerritorios;
+    
+    // Posição de cada território da definição no mapa (-1 = fora do jogo)
+    size_t bytesPosicao = (size_t)definicao->numTerritorios * sizeof(int32_t);
+    int32_t* posicao = (int32_t*)(mapa->arena != NULL ? reservarTemporarioNaArena(mapa->arena, bytesPosicao)
+                                                      : malloc(bytesPosicao));
+    if (posicao == NULL) {
+        printf("Erro: Não foi possível alocar memória para as fronteiras.\n");
+        exit(1);
+    }
+    for (int t = 0; t < definicao->numTerritorios; t++) {
+        posicao[t] = -1;
+    }
+    for (int i = 0; i < n; i++) {
+        posicao[mapa->nomeId[i]] = i;
+    }
+    
+    // Contar as fronteiras que ligam dois territórios escolhidos
+    size_t numVizinhos = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t t = mapa->nomeId[i];
+        for (int k = definicao->inicioVizinhos[t]; k < definicao->inicioVizinhos[t + 1]; k++) {
+            if (posicao[definicao->vizinhos[k]] >= 0) numVizinhos++;
+        }
+    }
+    
+    // Um bloco próprio: início das listas | vizinhos | continente
+    size_t inicioListas = 0;
+    size_t inicioVizinhos = alinharMapa(inicioListas + ((size_t)n + 1) * sizeof(int32_t));
+    size_t inicioContinentes = alinharMapa(inicioVizinhos + numVizinhos * sizeof(int32_t));
+    size_t tamanho = alinharMapa(inicioContinentes + (size_t)n * sizeof(uint16_t));
+    char* bloco = (char*)reservarParaMapa(mapa, tamanho);
+    if (bloco == NULL) {
+        printf("Erro: Não foi possível alocar memória para as fronteiras.\n");
+        exit(1);
+    }
+    int32_t* listas = (int32_t*)(bloco + inicioListas);
+    int32_t* vizinhos = (int32_t*)(bloco + inicioVizinhos);
+    uint16_t* continente = (uint16_t*)(bloco + inicioContinentes);
+    
+    int32_t total = 0;
+    for (int i = 0; i < n; i++) {
+        uint32_t t = mapa->nomeId[i];
+        listas[i] = total;
+        continente[i] = definicao->continente[t];
+        for (int k = definicao->inicioVizinhos[t]; k < definicao->inicioVizinhos[t + 1]; k++) {
+            int32_t v = posicao[definicao->vizinhos[k]];
+            if (v >= 0) vizinhos[total++] = v;
+        }
+    }
+    listas[n] = total;
+    if (mapa->arena != NULL) {
+        liberarTemporariosDaArena(mapa->arena);
+    } else {
+        free(posicao);
+    }
+    
+    devolverDoMapa(mapa, mapa->blocoFronteiras);
+    mapa->definicao = definicao;
+    mapa->inicioVizinhos = listas;
+    mapa->vizinhos = vizinhos;
+    mapa->vizinhosBits = NULL; // Montados de novo com o índice (recalcularContadores)
+    mapa->continente = continente;
+    mapa->blocoFronteiras = bloco;
+}
+
+int saoVizinhos(const Mapa* mapa, int a, int b) {
+    if (mapa->inicioVizinhos == NULL) {
+        return a != b; // Mapa sem fronteiras: todos se enfrentam
+    }
+    if (mapa->vizinhosBits != NULL) {
+        return testarBit(&mapa->vizinhosBits[a], b);
+    }
+    for (int k = mapa->inicioVizinhos[a]; k < mapa->inicioVizinhos[a + 1]; k++) {
+        if (mapa->vizinhos[k] == b) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// ============================================================================
+// GERADOR DE NUMEROS ALEATORIOS (xoshiro256**)
+// Estado explícito passado pelo motor do jogo; a semente reproduz a partida e
+// saltarRNG cria fluxos independentes para simulações paralelas.
+// ============================================================================
+
+static inline uint64_t rotacionarEsquerda(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// SplitMix64: espalha uma semente qualquer pelos 256 bits de estado
+static uint64_t proximoSplitMix(uint64_t* estado) {
+    uint64_t z = (*estado += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+void inicializarRNG(EstadoRNG* rng, uint64_t semente) {
+    uint64_t estado = semente;
+    for (int i = 0; i < 4; i++) {
+        rng->s[i] = proximoSplitMix(&estado);
+    }
+}
+
+uint64_t proximoAleatorio(EstadoRNG* rng) {
+    uint64_t* s = rng->s;
+    const uint64_t resultado = rotacionarEsquerda(s[1] * 5, 7) * 9;
+    const uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionarEsquerda(s[3], 45);
+    
+    return resultado;
+}
+
+uint32_t aleatorioIntervalo(EstadoRNG* rng, uint32_t limite) {
+    // Multiplicação de 32x32 bits; rejeita apenas a pequena faixa que causaria viés
+    uint64_t m = (proximoAleatorio(rng) >> 32) * (uint64_t)limite;
+    uint32_t baixo = (uint32_t)m;
+    if (baixo < limite) {
+        uint32_t limiar = (uint32_t)(-limite) % limite;
+        while (baixo < limiar) {
+            m = (proximoAleatorio(rng) >> 32) * (uint64_t)limite;
+            baixo = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+void saltarRNG(EstadoRNG* rng) {
+    static const uint64_t SALTO[4] = {
+        0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL,
+        0xA9582618E03FC9AAULL, 0x39ABDC4529B1661CULL
+    };
+    
+    uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+    for (int i = 0; i < 4; i++) {
+        for (int b = 0; b < 64; b++) {
+            if (SALTO[i] & (1ULL << b)) {
+                s0 ^= rng->s[0];
+                s1 ^= rng->s[1];
+                s2 ^= rng->s[2];
+                s3 ^= rng->s[3];
+            }
+            proximoAleatorio(rng);
+        }
+    }
+    rng->s[0] = s0;
+    rng->s[1] = s1;
+    rng->s[2] = s2;
+    rng->s[3] = s3;
+}
+
+void criarFluxoRNG(const EstadoRNG* base, int indice, EstadoRNG* fluxo) {
+    *fluxo = *base;
+    for (int i = 0; i < indice; i++) {
+        saltarRNG(fluxo);
+    }
+}
+
+uint64_t sementeDaPartida(uint64_t semente, uint64_t indicePartida) {
+    uint64_t estado = semente ^ (indicePartida * 0xD1B54A32D192ED03ULL);
+    return proximoSplitMix(&estado);
+}
+
+// ============================================================================
+// HASH DE POSICOES (ZOBRIST)
+// Chaves derivadas do SplitMix64 em vez de tabeladas; o hash é atualizado por
+// XOR nas mesmas funções que mantêm os contadores do mapa.
+// ============================================================================
+
+// Faixa de tropas do hash: 0 a 7 exatas; depois uma faixa por potência de 2 (8-15, 16-31, ...)
+static inline int baldeDeTropas(int32_t tropas) {
+    if (tropas < 8) {
+        return tropas > 0 ? tropas : 0;
+    }
+#ifdef __GNUC__
+    int bits = 32 - __builtin_clz((unsigned)tropas);
+#else
+    int bits = 0;
+    for (unsigned v = (unsigned)tropas; v != 0; v >>= 1) bits++;
+#endif
+    return bits + 4;
+}
+
+static inline uint64_t chaveZobrist(int territorio, int dono, int balde) {
+    uint64_t estado = ((uint64_t)(uint32_t)territorio << 16) | ((uint64_t)(uint8_t)dono << 8) | (uint64_t)balde;
+    return proximoSplitMix(&estado);
+}
+
+uint64_t calcularHashZobrist(const Mapa* mapa) {
+    uint64_t hash = 0;
+    for (int32_t i = 0; i < mapa->numTerritorios; i++) {
+        hash ^= chaveZobrist(i, mapa->dono[i], baldeDeTropas(mapa->tropas[i]));
+    }
+    return hash;
+}
+
+void ativarHashZobrist(Mapa* mapa) {
+    mapa->hash = calcularHashZobrist(mapa);
+    mapa->comHash = 1;
+}
+
+static inline void atualizarHashTropas(Mapa* mapa, int territorio, int32_t antes, int32_t depois) {
+    int baldeAntes = baldeDeTropas(antes);
+    int baldeDepois = baldeDeTropas(depois);
+    if (baldeAntes != baldeDepois) {
+        int dono = mapa->dono[territorio];
+        mapa->hash ^= chaveZobrist(territorio, dono, baldeAntes) ^ chaveZobrist(territorio, dono, baldeDepois);
+    }
+}
+
+static inline void atualizarHashDono(Mapa* mapa, int territorio, int donoAnterior, int novoDono) {
+    int balde = baldeDeTropas(mapa->tropas[territorio]);
+    mapa->hash ^= chaveZobrist(territorio, donoAnterior, balde) ^ chaveZobrist(territorio, novoDono, balde);
+}
+
+// ============================================================================
+// TABELA EXATA DE PROBABILIDADES DE BATALHA
+// Solução da cadeia de Markov das regras de simularAtaque: até 2 dados para o
+// atacante (com 3 ou mais tropas), até 2 para o defensor, empates favorecem o
+// defensor. Calculada uma única vez; consultas em O(1).
+// ============================================================================
+
+// Probabilidade de o atacante perder 0, 1 ou 2 tropas em uma rodada,
+// indexada por [dados do atacante][dados do defensor][perdas do atacante]
+static double probRodada[3][3][3];
+
+// Resultado esperado de cada batalha, indexado por [tropas atacante][tropas defensor]
+static ProbabilidadeBatalha tabelaBatalha[TAM_TABELA_BATALHA + 1][TAM_TABELA_BATALHA + 1];
+
+// Estado de probRodada e tabelaBatalha: 0 = vazias, 1 = em cálculo, 2 = prontas
+static _Atomic int estadoTabelaBatalha;
+
+// Garante as tabelas antes de uma consulta (depois da primeira vez, uma leitura)
+static inline void garantirTabelaBatalha(void) {
+    if (atomic_load_explicit(&estadoTabelaBatalha, memory_order_acquire) != 2) {
+        inicializarTabelaBatalha();
+    }
+}
+
+void inicializarTabelaBatalha(void) {
+    int vazia = 0;
+    if (!atomic_compare_exchange_strong_explicit(&estadoTabelaBatalha, &vazia, 1,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        // Já pronta, ou outra thread está calculando: esperar por ela
+        while (atomic_load_explicit(&estadoTabelaBatalha, memory_order_acquire) != 2) {
+        }
+        return;
+    }
+    
+    // 1) Distribuição de uma rodada: enumerar todas as combinações de dados
+    for (int na = 1; na <= 2; na++) {
+        for (int nd = 1; nd <= 2; nd++) {
+            int total = 0;
+            int contagem[3] = {0, 0, 0};
+            int combinacoes = 1;
+            for (int k = 0; k < na + nd; k++) combinacoes *= 6;
+            
+            for (int c = 0; c < combinacoes; c++) {
+                int dados[4];
+                int resto = c;
+                for (int k = 0; k < na + nd; k++) {
+                    dados[k] = resto % 6 + 1;
+                    resto /= 6;
+                }
+                
+                // Ordenar cada lado em ordem decrescente
+                int a0 = dados[0], a1 = (na == 2) ? dados[1] : 0;
+                int d0 = dados[na], d1 = (nd == 2) ? dados[na + 1] : 0;
+                if (a1 > a0) { int t = a0; a0 = a1; a1 = t; }
+                if (d1 > d0) { int t = d0; d0 = d1; d1 = t; }
+                
+                int perdasAtacante = (a0 > d0) ? 0 : 1;
+                if (na == 2 && nd == 2) {
+                    perdasAtacante += (a1 > d1) ? 0 : 1;
+                }
+                contagem[perdasAtacante]++;
+                total++;
+            }
+            for (int p = 0; p < 3; p++) {
+                probRodada[na][nd][p] = (double)contagem[p] / total;
+            }
+        }
+    }
+    
+    // 2) Cadeia de Markov: cada estado depende apenas de estados com menos tropas
+    for (int a = 0; a <= TAM_TABELA_BATALHA; a++) {
+        for (int d = 0; d <= TAM_TABELA_BATALHA; d++) {
+            ProbabilidadeBatalha* estado = &tabelaBatalha[a][d];
+            
+            if (d == 0) {            // Defensor eliminado: conquista
+                estado->probVitoria = 1.0;
+                estado->atacantesRestantes = a;
+                estado->defensoresRestantes = 0;
+                continue;
+            }
+            if (a <= 1) {            // Atacante não pode mais atacar
+                estado->probVitoria = 0.0;
+                estado->atacantesRestantes = a;
+                estado->defensoresRestantes = d;
+                continue;
+            }
+            
+            int na = (a >= 3) ? 2 : 1;
+            int nd = (d >= 2) ? 2 : 1;
+            int comparacoes = (na < nd) ? na : nd;
+            
+            estado->probVitoria = 0.0;
+            estado->atacantesRestantes = 0.0;
+            estado->defensoresRestantes = 0.0;
+            for (int perdasAtacante = 0; perdasAtacante <= comparacoes; perdasAtacante++) {
+                double p = probRodada[na][nd][perdasAtacante];
+                const ProbabilidadeBatalha* proximo =
+                    &tabelaBatalha[a - perdasAtacante][d - (comparacoes - perdasAtacante)];
+                estado->probVitoria += p * proximo->probVitoria;
+                estado->atacantesRestantes += p * proximo->atacantesRestantes;
+                estado->defensoresRestantes += p * proximo->defensoresRestantes;
+            }
+        }
+    }
+    atomic_store_explicit(&estadoTabelaBatalha, 2, memory_order_release);
+}
+
+const ProbabilidadeBatalha* consultarProbabilidadeBatalha(int tropasAtacante, int tropasDefensor) {
+    if (tropasAtacante < 0 || tropasDefensor < 0 ||
+        tropasAtacante > TAM_TABELA_BATALHA || tropasDefensor > TAM_TABELA_BATALHA) {
+        return NULL;
+    }
+    garantirTabelaBatalha();
+    return &tabelaBatalha[tropasAtacante][tropasDefensor];
+}
+
+void exibirTabelaBatalha(int limite) {
+    printf("atacante,defensor,prob_vitoria,atacantes_restantes,defensores_restantes\n");
+    for (int a = 2; a <= limite; a++) {
+        for (int d = 1; d <= limite; d++) {
+            const ProbabilidadeBatalha* estado = consultarProbabilidadeBatalha(a, d);
+            printf("%d,%d,%.10f,%.6f,%.6f\n", a, d,
+                   estado->probVitoria, estado->atacantesRestantes, estado->defensoresRestantes);
+        }
+    }
+}
+
+// Distribuições de estado final já montadas, indexadas como tabelaBatalha
+static _Atomic(DistribuicaoBatalha*) distribuicoesBatalha[TAM_TABELA_BATALHA + 1][TAM_TABELA_BATALHA + 1];
+
+// Propaga a probabilidade de (a, d) pelos estados da batalha e monta a tabela de alias
+static DistribuicaoBatalha* montarDistribuicaoBatalha(int a, int d) {
+    int n = a + d;
+    DistribuicaoBatalha* distribuicao = (DistribuicaoBatalha*)malloc(
+        sizeof(DistribuicaoBatalha) + (size_t)n * (sizeof(double) + sizeof(int32_t)));
+    double* massa = (double*)calloc((size_t)(a + 1) * (d + 1), sizeof(double));
+    int32_t* pilha = (int32_t*)malloc((size_t)n * sizeof(int32_t));
+    if (distribuicao == NULL || massa == NULL || pilha == NULL) {
+        free(distribuicao);
+        free(massa);
+        free(pilha);
+        return NULL;
+    }
+    distribuicao->numResultados = n;
+    distribuicao->probabilidade = (double*)(distribuicao + 1);
+    distribuicao->alias = (int32_t*)(distribuicao->probabilidade + n);
+    
+    // 1) Cada rodada só diminui tropas: varrer (x, y) em ordem decrescente
+    //    visita todo estado depois de todos os seus predecessores
+    size_t largura = (size_t)d + 1;
+    massa[(size_t)a * largura + d] = 1.0;
+    for (int x = a; x >= 2; x--) {
+        for (int y = d; y >= 1; y--) {
+            double p = massa[(size_t)x * largura + y];
+            if (p == 0.0) continue;
+            int na = (x >= 3) ? 2 : 1;
+            int nd = (y >= 2) ? 2 : 1;
+            int comparacoes = (na < nd) ? na : nd;
+            for (int perdasAtacante = 0; perdasAtacante <= comparacoes; perdasAtacante++) {
+                size_t proximo = (size_t)(x - perdasAtacante) * largura + (y - (comparacoes - perdasAtacante));
+                massa[proximo] += p * probRodada[na][nd][perdasAtacante];
+            }
+        }
+    }
+    
+    // 2) Resultados absorventes, multiplicados por n para o método de Vose
+    double* escala = distribuicao->probabilidade;
+    for (int x = 1; x <= a; x++) escala[x - 1] = massa[(size_t)x * largura] * n;
+    for (int y = 1; y <= d; y++) escala[a + y - 1] = massa[largura + y] * n;
+    
+    // 3) Vose: colunas abaixo da média (do início da pilha) completadas pelas acima (do fim)
+    int pequenos = 0, grandes = n;
+    for (int k = 0; k < n; k++) {
+        if (escala[k] < 1.0) pilha[pequenos++] = k;
+        else pilha[--grandes] = k;
+    }
+    for (int k = 0; k < n; k++) distribuicao->alias[k] = k;
+    while (pequenos > 0 && grandes < n) {
+        int menor = pilha[--pequenos];
+        int maior = pilha[grandes];
+        distribuicao->alias[menor] = maior;
+        escala[maior] -= 1.0 - escala[menor];
+        if (escala[maior] < 1.0) {
+            grandes++;
+            pilha[pequenos++] = maior;
+        }
+    }
+    // Sobras (apenas arredondamento) ficam com a própria coluna
+    while (pequenos > 0) escala[pilha[--pequenos]] = 1.0;
+    while (grandes < n) escala[pilha[grandes++]] = 1.0;
+    
+    free(massa);
+    free(pilha);
+    return distribuicao;
+}
+
+const DistribuicaoBatalha* consultarDistribuicaoBatalha(int tropasAtacante, int tropasDefensor) {
+    if (tropasAtacante < 2 || tropasDefensor < 1 ||
+        tropasAtacante > TAM_TABELA_BATALHA || tropasDefensor > TAM_TABELA_BATALHA) {
+        return NULL;
+    }
+    _Atomic(DistribuicaoBatalha*)* entrada = &distribuicoesBatalha[tropasAtacante][tropasDefensor];
+    DistribuicaoBatalha* distribuicao = atomic_load_explicit(entrada, memory_order_acquire);
+    if (distribuicao != NULL) {
+        return distribuicao;
+    }
+    garantirTabelaBatalha(); // A distribuição é montada a partir de probRodada
+    DistribuicaoBatalha* nova = montarDistribuicaoBatalha(tropasAtacante, tropasDefensor);
+    if (nova == NULL) {
+        return NULL;
+    }
+    if (!atomic_compare_exchange_strong_explicit(entrada, &distribuicao, nova,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        free(nova); // Outra thread publicou primeiro (distribuicao recebeu a dela)
+        return distribuicao;
+    }
+    return nova;
+}
+
+// Real uniforme em [0, 1) com 53 bits
+static inline double sortearUniforme(EstadoRNG* rng) {
+    return (double)(proximoAleatorio(rng) >> 11) * 0x1.0p-53;
+}
+
+// Correção de Stirling: log(k!) - [(k + 1/2) log(k + 1) - (k + 1) + log(2 pi) / 2]
+static double correcaoStirling(int k) {
+    static const double tabela[10] = {
+        0.08106146679532726, 0.04134069595540929, 0.02767792568499834, 0.02079067210376509,
+        0.01664469118982119, 0.01387612882307075, 0.01189670994589177, 0.01041126526197209,
+        0.009255462182712733, 0.008330563433362871
+    };
+    if (k < 10) {
+        return tabela[k];
+    }
+    double r = 1.0 / (k + 1);
+    double r2 = r * r;
+    return (1.0 / 12.0 - (1.0 / 360.0 - r2 / 1260.0) * r2) * r;
+}
+
+// Sorteio exato de Binomial(n, p) em tempo esperado constante: inversão
+// quando n*p é pequeno; acima disso, o BTRD de Hörmann (rejeição transformada
+// com decomposição), que aceita a maioria dos sorteios na primeira tentativa
+static int sortearBinomial(EstadoRNG* rng, int n, double p) {
+    if (p > 0.5) {
+        return n - sortearBinomial(rng, n, 1.0 - p);
+    }
+    double q = 1.0 - p;
+    if (n * p < 10.0) {
+        // Percorre a distribuição a partir de 0: em média n*p passos
+        double s = p / q;
+        double a = (n + 1) * s;
+        for (;;) {
+            double r = pow(q, n);
+            double u = sortearUniforme(rng);
+            int x = 0;
+            while (u > r && x <= n) {
+                u -= r;
+                x++;
+                r *= a / x - s;
+            }
+            if (x <= n) {
+                return x;
+            }
+        }
+    }
+    
+    double npq = n * p * q;
+    double raizNpq = sqrt(npq);
+    double b = 1.15 + 2.53 * raizNpq;
+    double a = -0.0873 + 0.0248 * b + 0.01 * p;
+    double c = n * p + 0.5;
+    double alfa = (2.83 + 5.1 / b) * raizNpq;
+    double vr = 0.92 - 4.2 / b;
+    double urvr = 0.86 * vr;
+    int m = (int)((n + 1) * p); // Moda
+    double r = p / q;
+    double nr = (n + 1) * r;
+    for (;;) {
+        double v = sortearUniforme(rng);
+        double u;
+        if (v <= urvr) {
+            // Miolo da distribuição: aceito sem teste
+            u = v / vr - 0.43;
+            return (int)floor((2.0 * a / (0.5 - fabs(u)) + b) * u + c);
+        }
+        if (v >= vr) {
+            u = sortearUniforme(rng) - 0.5;
+        } else {
+            u = v / vr - 0.93;
+            u = copysign(0.5, u) - u;
+            v = sortearUniforme(rng) * vr;
+        }
+        double us = 0.5 - fabs(u);
+        double candidato = floor((2.0 * a / us + b) * u + c);
+        if (candidato < 0.0 || candidato > n) {
+            continue;
+        }
+        int k = (int)candidato;
+        v = v * alfa / (a / (us * us) + b);
+        int km = abs(k - m);
+        if (km <= 15) {
+            // Perto da moda: razão f(k)/f(m) pelo produto das razões sucessivas
+            double f = 1.0;
+            for (int i = m + 1; i <= k; i++) f *= nr / i - r;
+            for (int i = k + 1; i <= m; i++) v *= nr / i - r;
+            if (v <= f) {
+                return k;
+            }
+            continue;
+        }
+        // Longe da moda: limites rápidos de log f(k)/f(m) e, só entre eles, o valor exato
+        v = log(v);
+        double rho = (km / npq) * (((km / 3.0 + 0.625) * km + 1.0 / 6.0) / npq + 0.5);
+        double t = -(double)km * km / (2.0 * npq);
+        if (v < t - rho) {
+            return k;
+        }
+        if (v > t + rho) {
+            continue;
+        }
+        double nm = n - m + 1;
+        double h = (m + 0.5) * log((m + 1) / (r * nm)) + correcaoStirling(m) + correcaoStirling(n - m);
+        double nk = n - k + 1;
+        if (v <= h + (n + 1) * log(nm / nk) + (k + 0.5) * log(nk * r / (k + 1)) -
+                  correcaoStirling(k) - correcaoStirling(n - k)) {
+            return k;
+        }
+    }
+}
+
+void sortearFimDeBatalha(int* tropasAtacante, int* tropasDefensor, EstadoRNG* rng) {
+    int a = *tropasAtacante;
+    int d = *tropasDefensor;
+    garantirTabelaBatalha(); // Fora da tabela as rodadas também usam probRodada
+    while (a > 1 && d > 0) {
+        const DistribuicaoBatalha* distribuicao = consultarDistribuicaoBatalha(a, d);
+        if (distribuicao != NULL) {
+            int coluna = (int)aleatorioIntervalo(rng, (uint32_t)distribuicao->numResultados);
+            double u = sortearUniforme(rng);
+            int k = (u < distribuicao->probabilidade[coluna]) ? coluna : distribuicao->alias[coluna];
+            if (k < a) {
+                a = k + 1;
+                d = 0;
+            } else {
+                d = k - a + 1;
+                a = 1;
+            }
+            break;
+        }
+        
+        // Fora da tabela, com os dois lados grandes: nas próximas k rodadas nenhum
+        // resultado tira a batalha do regime de 2 dados contra 2, então elas são
+        // independentes e iguais, e as contagens de 0-2, 1-1 e 2-0 (perdas do
+        // atacante 0, 1 e 2) saem de uma vez de duas binomiais
+        // (logo acima da tabela, poucas rodadas comuns chegam a ela mais barato)
+        int rodadasSeguras = ((a - 1) / 2 < d / 2) ? (a - 1) / 2 : d / 2;
+        int excesso = ((a > d) ? a : d) - TAM_TABELA_BATALHA;
+        if (rodadasSeguras >= MIN_RODADAS_EM_BLOCO && excesso > 2 * MIN_RODADAS_EM_BLOCO) {
+            const double* perdas = probRodada[2][2];
+            int semPerda = sortearBinomial(rng, rodadasSeguras, perdas[0]);
+            int umaPerda = sortearBinomial(rng, rodadasSeguras - semPerda, perdas[1] / (perdas[1] + perdas[2]));
+            int duasPerdas = rodadasSeguras - semPerda - umaPerda;
+            a -= umaPerda + 2 * duasPerdas;
+            d -= 2 * semPerda + umaPerda;
+            continue;
+        }
+        
+        // Fora da tabela (ou sem memória), perto do fim: uma rodada sorteada das perdas exatas
+        int na = (a >= 3) ? 2 : 1;
+        int nd = (d >= 2) ? 2 : 1;
+        int comparacoes = (na < nd) ? na : nd;
+        double u = sortearUniforme(rng);
+        int perdasAtacante = 0;
+        while (perdasAtacante < comparacoes && u >= probRodada[na][nd][perdasAtacante]) {
+            u -= probRodada[na][nd][perdasAtacante];
+            perdasAtacante++;
+        }
+        a -= perdasAtacante;
+        d -= comparacoes - perdasAtacante;
+    }
+    *tropasAtacante = a;
+    *tropasDefensor = d;
+}
+
+// ============================================================================
+// COMBATES EM LOTE (DADOS VETORIZADOS)
+// Muitas rodadas independentes resolvidas de uma vez. Cada rodada consome dois
+// números do seu fluxo: as metades de 32 bits do primeiro são os dados do
+// atacante e as do segundo, os do defensor (sempre 4 dados, mesmo que nem
+// todos entrem na comparação). Um dado é sorteado pela multiplicação de
+// Lemire; se qualquer um dos 4 cair na faixa rejeitada, a rodada inteira é
+// sorteada de novo no mesmo fluxo. O caminho AVX2 avança os 4 fluxos juntos
+// e, nas raras rejeições, termina a lane afetada pelo caminho escalar.
+// ============================================================================
+
+// 2^32 mod 6: produtos cuja metade baixa fica abaixo disso seriam enviesados
+#define REJEICAO_DADO 4u
+
+void inicializarGeradorDados(GeradorDados* gerador, uint64_t semente) {
+    EstadoRNG base;
+    inicializarRNG(&base, semente);
+    for (int p = 0; p < LANES_DADOS; p++) {
+        EstadoRNG fluxo;
+        criarFluxoRNG(&base, p, &fluxo);
+        for (int k = 0; k < 4; k++) {
+            gerador->s[k][p] = fluxo.s[k];
+        }
+    }
+}
+
+// xoshiro256** sobre a coluna p do estado intercalado
+static inline uint64_t proximoDaLane(GeradorDados* gerador, int p) {
+    uint64_t s0 = gerador->s[0][p], s1 = gerador->s[1][p], s2 = gerador->s[2][p], s3 = gerador->s[3][p];
+    const uint64_t resultado = rotacionarEsquerda(s1 * 5, 7) * 9;
+    const uint64_t t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = rotacionarEsquerda(s3, 45);
+    gerador->s[0][p] = s0;
+    gerador->s[1][p] = s1;
+    gerador->s[2][p] = s2;
+    gerador->s[3][p] = s3;
+    return resultado;
+}
+
+// Sorteia os 4 dados de uma rodada (ataque maior/menor posição, defesa idem)
+static void rolarRodadaDados(GeradorDados* gerador, int p, uint32_t dados[4]) {
+    uint32_t rejeitado;
+    do {
+        uint64_t x = proximoDaLane(gerador, p);
+        uint64_t y = proximoDaLane(gerador, p);
+        const uint32_t bits[4] = { (uint32_t)(x >> 32), (uint32_t)x, (uint32_t)(y >> 32), (uint32_t)y };
+        rejeitado = 0;
+        for (int k = 0; k < 4; k++) {
+            uint64_t m = (uint64_t)bits[k] * 6;
+            rejeitado |= ((uint32_t)m < REJEICAO_DADO);
+            dados[k] = (uint32_t)(m >> 32) + 1;
+        }
+    } while (rejeitado);
+}
+
+// Ordena e compara sem desvios; empates favorecem o defensor
+static inline void compararDadosRodada(const uint32_t dados[4], int32_t tropasAtacante, int32_t tropasDefensor,
+                                       uint8_t* perdasAtacante, uint8_t* perdasDefensor) {
+    uint32_t doisA = (uint32_t)(tropasAtacante >= 3);
+    uint32_t doisD = (uint32_t)(tropasDefensor >= 2);
+    uint32_t a0 = dados[0], a1 = dados[1] & (0u - doisA);
+    uint32_t d0 = dados[2], d1 = dados[3] & (0u - doisD);
+    uint32_t altoA = a0 > a1 ? a0 : a1, baixoA = a0 > a1 ? a1 : a0;
+    uint32_t altoD = d0 > d1 ? d0 : d1, baixoD = d0 > d1 ? d1 : d0;
+    uint32_t ambos = doisA & doisD;
+    uint32_t vence1 = (uint32_t)(altoA > altoD);
+    uint32_t vence2 = (uint32_t)(baixoA > baixoD) & ambos;
+    *perdasDefensor = (uint8_t)(vence1 + vence2);
+    *perdasAtacante = (uint8_t)((1u - vence1) + (ambos - vence2));
+}
+
+void resolverCombatesEmLoteEscalar(GeradorDados* gerador, const int32_t* tropasAtacante, const int32_t* tropasDefensor,
+                                   int n, uint8_t* perdasAtacante, uint8_t* perdasDefensor) {
+    for (int i = 0; i < n; i++) {
+        uint32_t dados[4];
+        rolarRodadaDados(gerador, i % LANES_DADOS, dados);
+        compararDadosRodada(dados, tropasAtacante[i], tropasDefensor[i], &perdasAtacante[i], &perdasDefensor[i]);
+    }
+}
+
+#ifdef WAR_TEM_AVX2
+#define ALVO_AVX2 __attribute__((target("avx2")))
+
+ALVO_AVX2 static inline __m256i rotacionarEsquerdaAVX2(__m256i x, int k) {
+    return _mm256_or_si256(_mm256_slli_epi64(x, k), _mm256_srli_epi64(x, 64 - k));
+}
+
+// Um passo do xoshiro256** nos 4 fluxos (x*5 e x*9 por deslocamento e soma)
+ALVO_AVX2 static inline __m256i proximoAVX2(__m256i* s0, __m256i* s1, __m256i* s2, __m256i* s3) {
+    __m256i vezes5 = _mm256_add_epi64(_mm256_slli_epi64(*s1, 2), *s1);
+    __m256i r = rotacionarEsquerdaAVX2(vezes5, 7);
+    __m256i resultado = _mm256_add_epi64(_mm256_slli_epi64(r, 3), r);
+    __m256i t = _mm256_slli_epi64(*s1, 17);
+    *s2 = _mm256_xor_si256(*s2, *s0);
+    *s3 = _mm256_xor_si256(*s3, *s1);
+    *s1 = _mm256_xor_si256(*s1, *s2);
+    *s0 = _mm256_xor_si256(*s0, *s3);
+    *s2 = _mm256_xor_si256(*s2, t);
+    *s3 = rotacionarEsquerdaAVX2(*s3, 45);
+    return resultado;
+}
+
+// Dado de 1 a 6 a partir dos 32 bits baixos de cada lane; acumula lanes rejeitadas
+ALVO_AVX2 static inline __m256i dadoAVX2(__m256i bits, __m256i* rejeitadas) {
+    const __m256i seis = _mm256_set1_epi64x(6);
+    const __m256i mascaraFaixa = _mm256_set1_epi64x((long long)(0xFFFFFFFFu & ~(REJEICAO_DADO - 1)));
+    __m256i m = _mm256_mul_epu32(bits, seis);
+    __m256i faixa = _mm256_and_si256(m, mascaraFaixa);
+    *rejeitadas = _mm256_or_si256(*rejeitadas, _mm256_cmpeq_epi64(faixa, _mm256_setzero_si256()));
+    return _mm256_add_epi64(_mm256_srli_epi64(m, 32), _mm256_set1_epi64x(1));
+}
+
+ALVO_AVX2 static void resolverCombatesEmLoteAVX2(GeradorDados* gerador, const int32_t* tropasAtacante,
+                                                 const int32_t* tropasDefensor, int n,
+                                                 uint8_t* perdasAtacante, uint8_t* perdasDefensor) {
+    const __m256i um = _mm256_set1_epi64x(1);
+    int grupos = n / LANES_DADOS;
+    for (int g = 0; g < grupos; g++) {
+        int base = g * LANES_DADOS;
+        // Acesso sem exigir alinhamento: o gerador pode estar em memória de malloc (16 bytes)
+        __m256i s0 = _mm256_loadu_si256((const __m256i*)gerador->s[0]);
+        __m256i s1 = _mm256_loadu_si256((const __m256i*)gerador->s[1]);
+        __m256i s2 = _mm256_loadu_si256((const __m256i*)gerador->s[2]);
+        __m256i s3 = _mm256_loadu_si256((const __m256i*)gerador->s[3]);
+        __m256i x = proximoAVX2(&s0, &s1, &s2, &s3);
+        __m256i y = proximoAVX2(&s0, &s1, &s2, &s3);
+        _mm256_storeu_si256((__m256i*)gerador->s[0], s0);
+        _mm256_storeu_si256((__m256i*)gerador->s[1], s1);
+        _mm256_storeu_si256((__m256i*)gerador->s[2], s2);
+        _mm256_storeu_si256((__m256i*)gerador->s[3], s3);
+        
+        __m256i rejeitadas = _mm256_setzero_si256();
+        __m256i a0 = dadoAVX2(_mm256_srli_epi64(x, 32), &rejeitadas);
+        __m256i a1 = dadoAVX2(x, &rejeitadas);
+        __m256i d0 = dadoAVX2(_mm256_srli_epi64(y, 32), &rejeitadas);
+        __m256i d1 = dadoAVX2(y, &rejeitadas);
+        
+        int mascara = _mm256_movemask_pd(_mm256_castsi256_pd(rejeitadas));
+        if (mascara != 0) {
+            // Rejeição (~4 em 10^9 por rodada): a lane continua pelo caminho escalar
+            _Alignas(32) uint64_t dados[4][LANES_DADOS];
+            _mm256_store_si256((__m256i*)dados[0], a0);
+            _mm256_store_si256((__m256i*)dados[1], a1);
+            _mm256_store_si256((__m256i*)dados[2], d0);
+            _mm256_store_si256((__m256i*)dados[3], d1);
+            for (int p = 0; p < LANES_DADOS; p++) {
+                if (mascara & (1 << p)) {
+                    uint32_t novos[4];
+                    rolarRodadaDados(gerador, p, novos);
+                    for (int k = 0; k < 4; k++) dados[k][p] = novos[k];
+                }
+            }
+            a0 = _mm256_load_si256((const __m256i*)dados[0]);
+            a1 = _mm256_load_si256((const __m256i*)dados[1]);
+            d0 = _mm256_load_si256((const __m256i*)dados[2]);
+            d1 = _mm256_load_si256((const __m256i*)dados[3]);
+        }
+        
+        // Dados de 1 a 6 nos 32 bits baixos: comparações de 32 bits bastam
+        __m256i tA = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&tropasAtacante[base]));
+        __m256i tD = _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i*)&tropasDefensor[base]));
+        __m256i doisA = _mm256_cmpgt_epi64(tA, _mm256_set1_epi64x(2));
+        __m256i doisD = _mm256_cmpgt_epi64(tD, um);
+        a1 = _mm256_and_si256(a1, doisA);
+        d1 = _mm256_and_si256(d1, doisD);
+        __m256i altoA = _mm256_max_epu32(a0, a1), baixoA = _mm256_min_epu32(a0, a1);
+        __m256i altoD = _mm256_max_epu32(d0, d1), baixoD = _mm256_min_epu32(d0, d1);
+        __m256i ambos = _mm256_and_si256(_mm256_and_si256(doisA, doisD), um);
+        __m256i vence1 = _mm256_and_si256(_mm256_cmpgt_epi32(altoA, altoD), um);
+        __m256i vence2 = _mm256_and_si256(_mm256_cmpgt_epi32(baixoA, baixoD), ambos);
+        __m256i perdasDef = _mm256_add_epi64(vence1, vence2);
+        __m256i perdasAtk = _mm256_add_epi64(_mm256_sub_epi64(um, vence1), _mm256_sub_epi64(ambos, vence2));
+        
+        _Alignas(32) uint64_t saida[2][LANES_DADOS];
+        _mm256_store_si256((__m256i*)saida[0], perdasAtk);
+        _mm256_store_si256((__m256i*)saida[1], perdasDef);
+        for (int p = 0; p < LANES_DADOS; p++) {
+            perdasAtacante[base + p] = (uint8_t)saida[0][p];
+            perdasDefensor[base + p] = (uint8_t)saida[1][p];
+        }
+    }
+    
+    // Rodadas restantes (menos que LANES_DADOS): mesmo fluxo i % LANES_DADOS
+    int feitas = grupos * LANES_DADOS;
+    resolverCombatesEmLoteEscalar(gerador, tropasAtacante + feitas, tropasDefensor + feitas, n - feitas,
+                                  perdasAtacante + feitas, perdasDefensor + feitas);
+}
+#endif
+
+int combatesEmLoteVetoriais(void) {
+#ifdef WAR_TEM_AVX2
+    static int suportado = -1;
+    if (suportado < 0) {
+        __builtin_cpu_init();
+        suportado = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+    return suportado;
+#else
+    return 0;
+#endif
+}
+
+void resolverCombatesEmLote(GeradorDados* gerador, const int32_t* tropasAtacante, const int32_t* tropasDefensor,
+                            int n, uint8_t* perdasAtacante, uint8_t* perdasDefensor) {
+#ifdef WAR_TEM_AVX2
+    if (combatesEmLoteVetoriais()) {
+        resolverCombatesEmLoteAVX2(gerador, tropasAtacante, tropasDefensor, n, perdasAtacante, perdasDefensor);
+        return;
+    }
+#endif
+    resolverCombatesEmLoteEscalar(gerador, tropasAtacante, tropasDefensor, n, perdasAtacante, perdasDefensor);
+}
+
+int conferirCombatesEmLote(int numRodadas, uint64_t semente) {
+    int32_t* tropasAtacante = (int32_t*)malloc((size_t)numRodadas * sizeof(int32_t));
+    int32_t* tropasDefensor = (int32_t*)malloc((size_t)numRodadas * sizeof(int32_t));
+    uint8_t* perdas = (uint8_t*)malloc((size_t)numRodadas * 4);
+    if (tropasAtacante == NULL || tropasDefensor == NULL || perdas == NULL) {
+        printf("%s[ERRO] Memoria insuficiente para %d rodadas.%s\n", COR_VERMELHO_NEGRITO, numRodadas, COR_RESET);
+        free(tropasAtacante);
+        free(tropasDefensor);
+        free(perdas);
+        return 0;
+    }
+    uint8_t* perdasAtacanteEscalar = perdas;
+    uint8_t* perdasDefensorEscalar = perdas + numRodadas;
+    uint8_t* perdasAtacanteLote = perdas + 2 * (size_t)numRodadas;
+    uint8_t* perdasDefensorLote = perdas + 3 * (size_t)numRodadas;
+    
+    // Tropas de 2 a 4 no ataque e de 1 a 3 na defesa: cobrem as 4 combinações de dados
+    EstadoRNG rng;
+    inicializarRNG(&rng, semente);
+    for (int i = 0; i < numRodadas; i++) {
+        tropasAtacante[i] = 2 + (int32_t)aleatorioIntervalo(&rng, 3);
+        tropasDefensor[i] = 1 + (int32_t)aleatorioIntervalo(&rng, 3);
+    }
+    
+    GeradorDados escalar, lote;
+    inicializarGeradorDados(&escalar, semente);
+    inicializarGeradorDados(&lote, semente);
+    
+    double inicio = tempoAtualSegundos();
+    resolverCombatesEmLoteEscalar(&escalar, tropasAtacante, tropasDefensor, numRodadas,
+                                  perdasAtacanteEscalar, perdasDefensorEscalar);
+    double segundosEscalar = tempoAtualSegundos() - inicio;
+    inicio = tempoAtualSegundos();
+    resolverCombatesEmLote(&lote, tropasAtacante, tropasDefensor, numRodadas, perdasAtacanteLote, perdasDefensorLote);
+    double segundosLote = tempoAtualSegundos() - inicio;
+    
+    int divergencias = 0;
+    for (int i = 0; i < numRodadas; i++) {
+        if (perdasAtacanteEscalar[i] != perdasAtacanteLote[i] || perdasDefensorEscalar[i] != perdasDefensorLote[i]) {
+            if (divergencias < 5) {
+                printf("%s[ERRO] Rodada %d: escalar %d/%d, lote %d/%d%s\n", COR_VERMELHO_NEGRITO, i,
+                       perdasAtacanteEscalar[i], perdasDefensorEscalar[i],
+                       perdasAtacanteLote[i], perdasDefensorLote[i], COR_RESET);
+            }
+            divergencias++;
+        }
+    }
+    int mesmoEstado = (memcmp(escalar.s, lote.s, sizeof(escalar.s)) == 0);
+    
+    // Frequência das perdas do atacante por combinação de dados x probabilidade exata
+    long contagem[3][3][3];
+    memset(contagem, 0, sizeof(contagem));
+    for (int i = 0; i < numRodadas; i++) {
+        int na = tropasAtacante[i] >= 3 ? 2 : 1;
+        int nd = tropasDefensor[i] >= 2 ? 2 : 1;
+        contagem[na][nd][perdasAtacanteEscalar[i]]++;
+    }
+    
+    printf("\n%s============== COMBATES EM LOTE ==============%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf("Rodadas: %d | Semente: %" PRIu64 "\n", numRodadas, semente);
+    printf("Escalar: %.3f s (%.0f rodadas/s)\n", segundosEscalar,
+           segundosEscalar > 0.0 ? numRodadas / segundosEscalar : 0.0);
+    printf("Lote (%s): %.3f s (%s%.0f rodadas/s%s)\n", combatesEmLoteVetoriais() ? "AVX2" : "escalar", segundosLote,
+           COR_VERDE_NEGRITO, segundosLote > 0.0 ? numRodadas / segundosLote : 0.0, COR_RESET);
+    printf("\n[PERDAS DO ATACANTE] dados ataque x defesa: observado (exato)\n");
+    for (int na = 1; na <= 2; na++) {
+        for (int nd = 1; nd <= 2; nd++) {
+            long total = contagem[na][nd][0] + contagem[na][nd][1] + contagem[na][nd][2];
+            double divisor = total > 0 ? (double)total : 1.0;
+            printf("  %dx%d:", na, nd);
+            for (int perdidas = 0; perdidas <= ((na == 2 && nd == 2) ? 2 : 1); perdidas++) {
+                printf("  %d -> %.4f (%.4f)", perdidas, contagem[na][nd][perdidas] / divisor, probRodada[na][nd][perdidas]);
+            }
+            printf("\n");
+        }
+    }
+    
+    int ok = (divergencias == 0 && mesmoEstado);
+    if (ok) {
+        printf("\n%s[OK] Caminhos escalar e em lote identicos (perdas e estado final do gerador).%s\n",
+               COR_VERDE_NEGRITO, COR_RESET);
+    } else {
+        printf("\n%s[ERRO] %d rodada(s) divergente(s)%s.%s\n", COR_VERMELHO_NEGRITO, divergencias,
+               mesmoEstado ? "" : "; estado final do gerador diferente", COR_RESET);
+    }
+    printf("%s==============================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    
+    free(tropasAtacante);
+    free(tropasDefensor);
+    free(perdas);
+    return ok;
+}
+
+// ============================================================================
+// FUNCOES DO NIVEL MASTER - SISTEMA DE CARTAS E MISSOES
+// ============================================================================
+
+void nivelMaster(const DefinicaoMapa* definicao, EstadoRNG* rng, const char* arquivoSalvar, const char* arquivoCarregar,
+                 const char* arquivoConfig, ConfigIA* ia, ResultadoPartida* resultado) {
+    printf("\n================ JOGO WAR - NIVEL MASTER ================\n");
+    printf("Bem-vindo ao nivel Master com sistema de missoes!\n");
+    printf("=========================================================\n");
+    
+    Mapa* mapa;
+    MotorMissoes missoes;
+    int corJogador;
+    int turno = 1;
+    ResultadoPartida fim = { FIM_SEM_VENCEDOR, -1, 0, 0 };
+    
+    METRICA_INICIAR_FASE(inicioPreparacao);
+    if (arquivoCarregar != NULL) {
+        // Retomar: mapa, missões, cor do jogador, turno e gerador vêm do snapshot, sem cadastro
+        mapa = carregarSnapshot(arquivoCarregar, definicao, &missoes, &corJogador, &turno, rng);
+        if (mapa == NULL) {
+            return;
+        }
+        printf("[LOAD] Partida retomada de '%s' no turno %d.\n", arquivoCarregar, turno);
+    } else if (arquivoConfig != NULL) {
+        // Posição inicial declarada: territórios, donos, tropas e missão sem nenhuma pergunta
+        mapa = carregarConfigPartida(arquivoConfig, definicao, &missoes, &corJogador, rng);
+        if (mapa == NULL) {
+            return;
+        }
+    } else {
+        // Solicitar número de territórios
+        int maximo = definicao->numTerritorios < MAX_TERRITORIOS ? definicao->numTerritorios : MAX_TERRITORIOS;
+        int numTerritorios = selecionarNumeroTerritorios(maximo);
+        registrarDecisao(DECISAO_NUM_TERRITORIOS, numTerritorios, 0, 0);
+        
+        // Alocação dinâmica de memória para territórios
+        mapa = alocarMapa(numTerritorios);
+        
+        // Cadastro dos territórios
+        cadastrarTerritorios(mapa, definicao, rng);
+        
+        // O jogador é a primeira cor cadastrada; com --ia, as demais são do computador
+        corJogador = mapa->dono[0];
+        
+        // Uma missão secreta para cada cor em jogo
+        gerarMissoesDosJogadores(&missoes, mapa, turno, rng);
+    }
+    METRICA_ENCERRAR_FASE(FASE_PREPARACAO, inicioPreparacao);
+    int numTerritorios = mapa->numTerritorios;
+    const Missao* missaoJogador = &missoes.missoes[corJogador];
+    mapa->missoes = &missoes; // Conquistas passam a notificar o motor de missões
+    
+    if (ia != NULL) {
+        printf("[IA] Voce comanda o exercito %s; os demais sao controlados pelo computador.\n", nomeDaCor(corJogador));
+    }
+    
+    printf("\n" COR_AMARELO_NEGRITO "================ SUA MISSAO ================\n" COR_RESET);
+    exibirMissao(missaoJogador);
+    printf(COR_AMARELO_NEGRITO "============================================\n" COR_RESET);
+    
+    printf("\n[PAUSE] Pressione Enter para iniciar o jogo...");
+    getchar();
+    
+    // Loop principal do jogo Master com sistema de missões
+    while (turno <= MAX_TURNOS_MASTER) {  // Máximo de turnos (ajustado para mais territórios)
+        printf("\n================ TURNO %d - NIVEL MASTER ================\n", turno);
+        
+        // Exibir mapa atual (apenas o que mudou desde a última exibição)
+        exibirAlteracoesMapa(mapa);
+        
+        // Exibir missão atual
+        printf("\n" COR_CIANO "--- SUA MISSAO ATUAL ---\n" COR_RESET);
+        exibirMissao(missaoJogador);
+        
+        // Verificar se alguma missão foi cumprida (só as afetadas desde a última verificação)
+        // ou se o jogo terminou por dominação total
+        METRICA_INICIAR_FASE(inicioMissoes);
+        int corCumpriu = avaliarMissoes(&missoes, mapa);
+        int dominacao = corCumpriu == SEM_COR && jogoTerminou(mapa);
+        METRICA_ENCERRAR_FASE(FASE_MISSOES, inicioMissoes);
+        
+        if (corCumpriu != SEM_COR) {
+            fim.tipoFim = FIM_MISSAO;
+            fim.corVencedora = corCumpriu;
+            fim.missaoCumprida = 1;
+        } else if (dominacao) {
+            fim.tipoFim = FIM_DOMINACAO;
+            fim.corVencedora = mapa->dono[0];
+        }
+        
+        if (corCumpriu == corJogador) {
+            printf("\n" COR_VERDE_NEGRITO "[***] PARABENS! MISSAO CUMPRIDA! [***]\n" COR_RESET);
+            printf(COR_VERDE "Voce venceu o jogo completando sua missao!\n" COR_RESET);
+            break;
+        }
+        if (corCumpriu != SEM_COR) {
+            printf("\n" COR_VERMELHO_NEGRITO "[***] O exercito %s cumpriu a sua missao e venceu o jogo! [***]\n" COR_RESET,
+                   nomeDaCor(corCumpriu));
+            printf("Missao cumprida: %s\n", missoes.missoes[corCumpriu].descricao);
+            break;
+        }
+        
+        if (dominacao && verificarFimDeJogo(mapa)) {
+            printf("\n[***] FIM DE JOGO POR DOMINACAO TOTAL! [***]\n");
+            printf("Todos os territorios pertencem ao mesmo exercito!\n");
+            break;
+        }
+        
+        // Daqui em diante o turno tem ações: marcar a fronteira do turno no log
+        registrarDecisao(DECISAO_TURNO, turno, 0, 0);
+        
+        // Fase de reforços (a partir do turno 2)
+        if (turno > 1) {
+            METRICA_INICIAR_FASE(inicioReforcos);
+            faseDeReforcos(mapa);
+            METRICA_ENCERRAR_FASE(FASE_REFORCOS, inicioReforcos);
+        }
+        
+        // Fase de ataques
+        METRICA_INICIAR_FASE(inicioAtaques);
+        printf("\n[FASE DE ATAQUES]\n");
+        faseDeAtaque(mapa, rng, ia != NULL ? corJogador : SEM_COR);
+        
+        // Exércitos do computador, na ordem das cores
+        for (int cor = 0; ia != NULL && cor < MAX_CORES && !jogoTerminou(mapa); cor++) {
+            if (cor != corJogador && mapa->territoriosPorDono[cor] > 0) {
+                faseDeAtaqueIA(mapa, cor, rng, ia);
+            }
+        }
+        METRICA_ENCERRAR_FASE(FASE_ATAQUES, inicioAtaques);
+        
+        turno++;
+        notificarFimDeTurno(&missoes, turno);
+        
+        // Fim de turno: ponto de salvamento (o arquivo é regravado a cada turno)
+        if (arquivoSalvar != NULL && salvarSnapshot(arquivoSalvar, mapa, &missoes, corJogador, turno, rng)) {
+            printf("[SAVE] Partida salva em '%s' (retoma no turno %d com --carregar).\n", arquivoSalvar, turno);
+        }
+        
+        printf("\n[PAUSE] Pressione Enter para continuar para o proximo turno...");
+        getchar();
+    }
+    
+    // Resultado final
+    printf("\n================ RESULTADO FINAL - NIVEL MASTER ================\n");
+    exibirMapa(mapa);
+    
+    printf("\n[ESTATISTICAS FINAIS]\n");
+    fim.turnos = turno - 1;
+    printf("- Turnos jogados: %d\n", fim.turnos);
+    printf("- Territorios no jogo: %d\n", numTerritorios);
+    
+    if (verificarFimDeJogo(mapa)) {
+        printf("\n[*] PARABENS! Voce dominou o nivel Master! [*]\n");
+        printf("[*] Voce e um verdadeiro estrategista de guerra! [*]\n");
+    } else {
+        printf("\n[*] Bom jogo! Continue praticando para dominar o nivel Master! [*]\n");
+    }
+    
+    if (resultado != NULL) {
+        *resultado = fim;
+    }
+    
+    // Liberar memória
+    mapa->missoes = NULL;
+    liberarMemoria(mapa);
+}
+
+// ============================================================================
+// FUNÇÃO PARA VERIFICAR FIM DE JOGO
+// ============================================================================
+
+int verificarFimDeJogo(const Mapa* mapa) {
+    if (!jogoTerminou(mapa)) {
+        return 0; // Jogo continua
+    }
+    
+    // Todos os territórios têm a mesma cor
+    printf("\n[VITORIA] O exercito %s conquistou todos os territorios!\n", nomeDaCor(mapa->dono[0]));
+    return 1; // Fim de jogo
+}
+
+int jogoTerminou(const Mapa* mapa) {
+    // Validação de entrada
+    if (mapa == NULL || mapa->numTerritorios <= 0) {
+        return 0;
+    }
+    
+    // Todos os territórios têm a cor do primeiro território (contador incremental, O(1))
+    return mapa->territoriosPorDono[mapa->dono[0]] == mapa->numTerritorios;
+}
+
+// ============================================================================
+// FUNÇÃO: faseDeReforcos
+// Implementa a fase de reforços onde cada exército recebe tropas adicionais
+// baseado no número de territórios que controla
+// ============================================================================
+void faseDeReforcos(Mapa* mapa) {
+    escreverQuadro("\n%s================ FASE DE REFORCOS ================%s\n", COR_CIANO_NEGRITO, COR_RESET);
+    
+    // Aplicar os reforços e registrar quanto cada território recebeu
+    int numTerritorios = mapa->numTerritorios;
+    int* recebidos = (int*)calloc((size_t)numTerritorios, sizeof(int));
+    if (recebidos == NULL) {
+        printf("Erro: Não foi possível alocar memória para os reforços.\n");
+        exit(1);
+    }
+    aplicarReforcos(mapa, recebidos);
+    
+    // Exibir os reforços agrupados por exército, na ordem das cores, percorrendo
+    // só os territórios de cada cor (o detalhe por território é omitido na verbosidade 0)
+    const int32_t* controlados = mapa->territoriosPorDono;
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        if (controlados[cor] == 0) continue;
+        const int32_t* grupo = mapa->territoriosPorCor + mapa->inicioDoDono[cor];
+        int reforcos = 0;
+        for (int32_t k = 0; k < controlados[cor]; k++) {
+            reforcos += recebidos[grupo[k]];
+        }
+        
+        escreverQuadro("\n%s[REFORCO]%s Exercito %s%s%s controla %s%d%s territorio(s) -> %s+%d tropas%s de reforco (total: %" PRId64 ")\n", 
+                       COR_VERDE_NEGRITO, COR_RESET, COR_AMARELO, nomeDaCor(cor), COR_RESET, 
+                       COR_CIANO, controlados[cor], COR_RESET, COR_VERDE, reforcos, COR_RESET,
+                       mapa->tropasPorDono[cor]);
+        
+        for (int32_t k = 0; renderizador.verbosidade >= 1 && k < controlados[cor]; k++) {
+            int32_t j = grupo[k];
+            escreverQuadro("  %s+%s %s%s%s recebeu %s%d%s tropa(s) (total: %s%d%s)\n", 
+                           COR_VERDE, COR_RESET, COR_BRANCO, nomeDoTerritorio(mapa, j), COR_RESET,
+                           COR_VERDE, recebidos[j], COR_RESET, COR_AMARELO, mapa->tropas[j], COR_RESET);
+        }
+    }
+    
+    escreverQuadro("%s==================================================%s\n", COR_CIANO_NEGRITO, COR_RESET);
+    enviarQuadro();
+    free(recebidos);
+}
+
+void aplicarReforcos(Mapa* mapa, int reforcosRecebidos[]) {
+    // Territórios por cor de exército: contadores incrementais do mapa
+    const int32_t* contadores = mapa->territoriosPorDono;
+    // Lidos uma vez: as escritas em mapa->tropas obrigariam a relê-los a cada território
+    const int registrar = mapa->desfazer != NULL;
+    const int comHash = mapa->comHash;
+    
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        if (contadores[cor] == 0) continue;
+        
+        // Reforços do exército: 1 por território controlado, mínimo de 2 por turno
+        int reforcos = contadores[cor];
+        if (reforcos < 2) reforcos = 2;
+        int reforcosPorTerritorio = reforcos / contadores[cor];
+        int reforcosSobrando = reforcos % contadores[cor];
+        mapa->tropasPorDono[cor] += reforcos; // Total da cor atualizado de uma vez
+        METRICA_CONTAR(tropasReforco, reforcos);
+        registrarEvento(EVENTO_REFORCO, cor, SEM_COR, 0, reforcos, contadores[cor], 0, 0);
+        
+        // Percorrer só o grupo da cor no índice por dono; a sobra vai para os primeiros
+        // do grupo (escrita direta: o total da cor já foi somado acima)
+        const int32_t* grupo = mapa->territoriosPorCor + mapa->inicioDoDono[cor];
+        for (int32_t k = 0; k < contadores[cor]; k++) {
+            int32_t j = grupo[k];
+            int reforcoAtual = reforcosPorTerritorio;
+            if (reforcosSobrando > 0) {
+                reforcoAtual++;
+                reforcosSobrando--;
+            }
+            mapa->tropas[j] += reforcoAtual;
+            if (registrar) {
+                registrarAlteracao(mapa, ALTERACAO_TROPAS, j, reforcoAtual, 0);
+            }
+            if (comHash) {
+                atualizarHashTropas(mapa, j, mapa->tropas[j] - reforcoAtual, mapa->tropas[j]);
+            }
+            if (reforcosRecebidos != NULL) {
+                reforcosRecebidos[j] = reforcoAtual;
+            }
+        }
+    }
+    METRICA_CONTAR(reforcos, 1);
+}
+
+// ============================================================================
+// FUNÇÃO: selecionarNumeroTerritorios
+// Solicita ao usuário o número de territórios para o jogo
+// ============================================================================
+int selecionarNumeroTerritorios(int maximo) {
+    int numTerritorios;
+    
+    printf("\n================ CONFIGURACAO DO JOGO ================\n");
+    printf("Quantos territorios voce deseja no jogo?\n");
+    printf("Minimo: %d territorios\n", MIN_TERRITORIOS);
+    printf("Maximo: %d territorios\n", maximo);
+    printf("Recomendado: 5-10 territorios para melhor jogabilidade\n");
+    printf("======================================================\n");
+    
+    do {
+        printf(">> Digite o numero de territorios (%d-%d): ", MIN_TERRITORIOS, maximo);
+        
+        if (scanf("%d", &numTerritorios) != 1) {
+            printf("[ERRO] Entrada invalida! Digite apenas numeros.\n");
+            limparBufferEntrada();
+            continue;
+        }
+        
+        limparBufferEntrada();
+        
+        if (numTerritorios < MIN_TERRITORIOS || numTerritorios > maximo) {
+            printf("[ERRO] Numero invalido! Deve estar entre %d e %d territorios.\n", 
+                   MIN_TERRITORIOS, maximo);
+        }
+        
+    } while (numTerritorios < MIN_TERRITORIOS || numTerritorios > maximo);
+    
+    printf("\n[CONFIGURADO] Jogo sera jogado com %d territorios!\n", numTerritorios);
+    
+    return numTerritorios;
+}
+
+// ============================================================================
+// FUNCOES DE SELECAO DINAMICA
+// ============================================================================
+
+int selecionarTerritorio(const DefinicaoMapa* definicao, int territoriosUsados[], int numUsados) {
+    int numOpcoes = definicao->numTerritorios;
+    
+    printf("\n================ SELECAO DE TERRITORIO ================\n");
+    printf("Escolha um territorio da lista:\n");
+    printf("======================================================\n");
+    
+    for (int i = 0; i < numOpcoes; i++) {
+        // Verificar se o território já foi usado
+        int jaUsado = 0;
+        for (int j = 0; j < numUsados; j++) {
+            if (territoriosUsados[j] == i) {
+                jaUsado = 1;
+                break;
+            }
+        }
+        
+        const char* continente = definicao->nomesContinentes[definicao->continente[i]];
+        if (jaUsado) {
+            printf("%2d - %-20s (%s) [JA USADO]\n", i + 1, nomeNaDefinicao(definicao, i), continente);
+        } else {
+            printf("%2d - %-20s (%s)\n", i + 1, nomeNaDefinicao(definicao, i), continente);
+        }
+    }
+    
+    printf("======================================================\n");
+    printf(">> Digite o numero do territorio (1-%d): ", numOpcoes);
+    
+    int opcao;
+    while (1) {
+        if (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > numOpcoes) {
+            printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", numOpcoes);
+            limparBufferEntrada();
+            continue;
+        }
+        
+        // Verificar se o território já foi usado
+        int jaUsado = 0;
+        for (int j = 0; j < numUsados; j++) {
+            if (territoriosUsados[j] == (opcao - 1)) {
+                jaUsado = 1;
+                break;
+            }
+        }
+        
+        if (jaUsado) {
+            printf("[!] Este territorio ja foi escolhido! Selecione outro: ");
+            limparBufferEntrada();
+            continue;
+        }
+        
+        break;
+    }
+    limparBufferEntrada();
+    
+    return opcao - 1; // Retorna índice (0-based)
+}
+
+int selecionarCor(int coresUsadas[], int numUsadas) {
+    
+    printf("\n================ SELECAO DE COR ================\n");
+    printf("Escolha uma cor para o exercito:\n");
+    printf("===============================================\n");
+    
+    for (int i = 0; i < NUM_CORES_PREDEFINIDAS; i++) {
+        // Verificar se a cor já foi usada
+        int jaUsada = 0;
+        for (int j = 0; j < numUsadas; j++) {
+            if (coresUsadas[j] == i) {
+                jaUsada = 1;
+                break;
+            }
+        }
+        
+        if (jaUsada) {
+            printf("%2d - %s [JA USADA]\n", i + 1, nomeDaCor(i));
+        } else {
+            printf("%2d - %s\n", i + 1, nomeDaCor(i));
+        }
+    }
+    
+    printf("===============================================\n");
+    printf(">> Digite o numero da cor (1-%d): ", NUM_CORES_PREDEFINIDAS);
+    
+    int opcao;
+    while (1) {
+        if (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > NUM_CORES_PREDEFINIDAS) {
+            printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", NUM_CORES_PREDEFINIDAS);
+            limparBufferEntrada();
+            continue;
+        }
+        
+        // Verificar se a cor já foi usada
+        int jaUsada = 0;
+        for (int j = 0; j < numUsadas; j++) {
+            if (coresUsadas[j] == (opcao - 1)) {
+                jaUsada = 1;
+                break;
+            }
+        }
+        
+        if (jaUsada) {
+            printf("[!] Esta cor ja foi escolhida! Selecione outra: ");
+            limparBufferEntrada();
+            continue;
+        }
+        
+        break;
+    }
+    limparBufferEntrada();
+    
+    return opcao - 1; // Retorna o ID da cor (as cores predefinidas ocupam os primeiros IDs)
+}
+
+int selecionarTropas(void) {
+    // Opções de tropas predefinidas
+    const int opcoesTropas[NUM_OPCOES_TROPAS] = {1, 2, 3, 4, 5};
+    
+    printf("\n================ SELECAO DE TROPAS ================\n");
+    printf("Escolha o numero inicial de tropas:\n");
+    printf("==================================================\n");
+    
+    for (int i = 0; i < NUM_OPCOES_TROPAS; i++) {
+        printf("%d - %d tropa%s\n", i + 1, opcoesTropas[i], opcoesTropas[i] > 1 ? "s" : "");
+    }
+    
+    printf("==================================================\n");
+    printf(">> Digite o numero da opcao (1-%d): ", NUM_OPCOES_TROPAS);
+    
+    int opcao;
+    while (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > NUM_OPCOES_TROPAS) {
+        printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", NUM_OPCOES_TROPAS);
+        limparBufferEntrada();
+    }
+    limparBufferEntrada();
+    
+    return opcoesTropas[opcao - 1]; // Retorna o número de tropas
+}
+
+// === IMPLEMENTAÇÃO DAS FUNÇÕES DO SISTEMA DE MISSÕES ===
+
+void gerarMissaoAleatoria(Missao* missao, const Mapa* mapa, int cor, EstadoRNG* rng) {
+    int numTerritorios = mapa->numTerritorios;
+    
+    // Inicializar missão
+    missao->cumprida = 0;
+    missao->corAlvo = SEM_COR;
+    missao->valorAlvo = 0;
+    missao->cor = cor;
+    
+    // Gerar tipo de missão aleatório
+    missao->tipo = (TipoMissao)aleatorioIntervalo(rng, 4);
+    
+    switch (missao->tipo) {
+        case CONQUISTAR_CONTINENTE: {
+            // Sortear um continente do mapa com pelo menos 2 territórios
+            int continenteEncontrado = 0;
+            int tentativas = 0;
+            while (mapa->continente != NULL && !continenteEncontrado && tentativas < 10) {
+                int indiceAleatorio = (int)aleatorioIntervalo(rng, (uint32_t)numTerritorios);
+                missao->valorAlvo = mapa->continente[indiceAleatorio];
+                
+                if (mapa->tamanhoContinente[missao->valorAlvo] >= 2) {
+                    continenteEncontrado = 1;
+                    snprintf(missao->descricao, sizeof(missao->descricao), "Conquistar todo o continente %s",
+                             nomeDoContinente(mapa, indiceAleatorio));
+                }
+                tentativas++;
+            }
+            if (!continenteEncontrado) {
+                // Fallback para missão de controlar territórios
+                missao->tipo = CONTROLAR_TERRITORIOS;
+                missao->valorAlvo = (numTerritorios * 60) / 100; // 60% dos territórios
+                sprintf(missao->descricao, "Controlar pelo menos %d territorios", missao->valorAlvo);
+            }
+            break;
+        }
+        
+        case ELIMINAR_COR: {
+            // Alvo: a próxima cor em jogo depois da própria (em ordem circular)
+            for (int passo = 1; passo < MAX_CORES && missao->corAlvo == SEM_COR; passo++) {
+                int candidata = (cor + passo) % MAX_CORES;
+                if (mapa->territoriosPorDono[candidata] > 0) {
+                    missao->corAlvo = candidata;
+                }
+            }
+            if (missao->corAlvo == SEM_COR) {
+                // Nenhuma outra cor no mapa: controlar territórios
+                missao->tipo = CONTROLAR_TERRITORIOS;
+                missao->valorAlvo = (numTerritorios * 70) / 100;
+                if (missao->valorAlvo < 3) missao->valorAlvo = 3;
+                sprintf(missao->descricao, "Controlar pelo menos %d territorios", missao->valorAlvo);
+                break;
+            }
+            sprintf(missao->descricao, "Eliminar completamente a cor %s do mapa", nomeDaCor(missao->corAlvo));
+            break;
+        }
+        
+        case CONTROLAR_TERRITORIOS: {
+            // Controlar uma porcentagem dos territórios
+            missao->valorAlvo = (numTerritorios * 70) / 100; // 70% dos territórios
+            if (missao->valorAlvo < 3) missao->valorAlvo = 3; // Mínimo 3 territórios
+            sprintf(missao->descricao, "Controlar pelo menos %d territorios", missao->valorAlvo);
+            break;
+        }
+        
+        case SOBREVIVER_TURNOS: {
+            // Sobreviver por um número de turnos
+            missao->valorAlvo = 8 + (int)aleatorioIntervalo(rng, 5); // Entre 8 e 12 turnos
+            sprintf(missao->descricao, "Sobreviver por pelo menos %d turnos", missao->valorAlvo);
+            break;
+        }
+    }
+}
+
+int verificarMissao(const Missao* missao, const Mapa* mapa, int turnoAtual) {
+    if (missao->cumprida) {
+        return 1; // Já foi cumprida
+    }
+    
+    int corJogador = missao->cor;
+    if (mapa->territoriosPorDono[corJogador] == 0) {
+        return 0; // Cor eliminada: a missão não pode mais ser cumprida
+    }
+    
+    // Todas as verificações são leituras dos contadores incrementais do mapa (O(1))
+    switch (missao->tipo) {
+        case CONQUISTAR_CONTINENTE: {
+            // Todos os territórios do continente alvo pertencem ao jogador
+            int alvo = missao->valorAlvo;
+            return mapa->territoriosPorContinente[(size_t)alvo * MAX_CORES + corJogador] == mapa->tamanhoContinente[alvo];
+        }
+        
+        case ELIMINAR_COR: {
+            // A cor alvo não controla mais nenhum território
+            return mapa->territoriosPorDono[missao->corAlvo] == 0;
+        }
+        
+        case CONTROLAR_TERRITORIOS: {
+            // Territórios controlados pela cor da missão
+            return (mapa->territoriosPorDono[corJogador] >= missao->valorAlvo);
+        }
+        
+        case SOBREVIVER_TURNOS: {
+            return (turnoAtual >= missao->valorAlvo);
+        }
+        
+        default:
+            return 0;
+    }
+}
+
+void gerarMissoesDosJogadores(MotorMissoes* motor, const Mapa* mapa, int turno, EstadoRNG* rng) {
+    memset(motor, 0, sizeof(*motor));
+    motor->turno = turno;
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        if (mapa->territoriosPorDono[cor] > 0) {
+            Missao missao;
+            gerarMissaoAleatoria(&missao, mapa, cor, rng);
+            atribuirMissao(motor, &missao);
+        }
+    }
+}
+
+void atribuirMissao(MotorMissoes* motor, const Missao* missao) {
+    int cor = missao->cor;
+    uint32_t bit = 1u << cor;
+    motor->missoes[cor] = *missao;
+    motor->ativas |= bit;
+    if (missao->cumprida) {
+        motor->cumpridas |= bit;
+    }
+    motor->pendentes |= bit;
+    
+    // Eventos que podem mudar o resultado de verificarMissao
+    switch (missao->tipo) {
+        case CONQUISTAR_CONTINENTE:
+        case CONTROLAR_TERRITORIOS:
+            motor->inscritasGanho[cor] |= bit;
+            break;
+        case ELIMINAR_COR:
+            motor->inscritasPerda[missao->corAlvo] |= bit;
+            break;
+        case SOBREVIVER_TURNOS:
+            motor->inscritasFimDeTurno |= bit;
+            break;
+    }
+}
+
+static inline void notificarTrocaDeDono(MotorMissoes* motor, int donoAnterior, int novoDono) {
+    motor->pendentes |= motor->inscritasGanho[novoDono] | motor->inscritasPerda[donoAnterior];
+}
+
+void notificarFimDeTurno(MotorMissoes* motor, int proximoTurno) {
+    motor->turno = proximoTurno;
+    motor->pendentes |= motor->inscritasFimDeTurno;
+}
+
+int avaliarMissoes(MotorMissoes* motor, const Mapa* mapa) {
+    uint32_t pendentes = motor->pendentes & motor->ativas & ~motor->cumpridas;
+    motor->pendentes = 0;
+    while (pendentes != 0) {
+        int cor = 0;
+        while (!(pendentes & (1u << cor))) cor++;
+        pendentes &= pendentes - 1;
+        int cumprida = verificarMissao(&motor->missoes[cor], mapa, motor->turno);
+        registrarEvento(EVENTO_MISSAO_VERIFICADA, cor, motor->missoes[cor].corAlvo, motor->missoes[cor].tipo,
+                        motor->turno, cumprida, 0, 0);
+        if (cumprida) {
+            motor->missoes[cor].cumprida = 1;
+            motor->cumpridas |= 1u << cor;
+        }
+    }
+    if (motor->cumpridas == 0) {
+        return SEM_COR;
+    }
+    int cor = 0;
+    while (!(motor->cumpridas & (1u << cor))) cor++;
+    return cor;
+}
+
+void exibirMissao(const Missao* missao) {
+    printf("\n%s================ MISSAO ATUAL ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    
+    if (missao->cumprida) {
+        printf("%s[MISSAO CUMPRIDA!]%s %s\n", COR_VERDE_NEGRITO, COR_RESET, missao->descricao);
+        printf("%s=============================================%s\n", COR_VERDE_NEGRITO, COR_RESET);
+    } else {
+        printf("%s[OBJETIVO:]%s %s\n", COR_CIANO, COR_RESET, missao->descricao);
+        
+        // Informações adicionais baseadas no tipo
+        switch (missao->tipo) {
+            case CONQUISTAR_CONTINENTE:
+                printf("%s[DICA:]%s Avance pelas fronteiras ate dominar %stodo o continente%s\n", 
+                       COR_AMARELO, COR_RESET, COR_MAGENTA, COR_RESET);
+                break;
+            case ELIMINAR_COR:
+                printf("%s[DICA:]%s Elimine todos os territorios da cor %s%s%s\n", 
+                       COR_AMARELO, COR_RESET, COR_MAGENTA, nomeDaCor(missao->corAlvo), COR_RESET);
+                break;
+            case CONTROLAR_TERRITORIOS:
+                printf("%s[DICA:]%s Expanda seu territorio conquistando %s%d%s territorios\n", 
+                       COR_AMARELO, COR_RESET, COR_VERDE, missao->valorAlvo, COR_RESET);
+                break;
+            case SOBREVIVER_TURNOS:
+                printf("%s[DICA:]%s Defenda seus territorios por %s%d%s turnos\n", 
+                       COR_AMARELO, COR_RESET, COR_VERDE, missao->valorAlvo, COR_RESET);
+                break;
+        }
+        printf("%s=============================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    }
+}
+
+// ============================================================================
+// GRAVACAO E REPLAY DE PARTIDAS
+// O log guarda a semente e apenas as decisões aceitas pelo jogo (registros de
+// 16 bytes, acrescentados um a um). Como toda a aleatoriedade vem da semente,
+// o replay reexecuta as decisões no motor silencioso e chega ao mesmo estado.
+// ============================================================================
+
+// Log da partida em gravação (NULL = sem --gravar)
+static FILE* logGravacao = NULL;
+
+int iniciarGravacao(const char* caminho, uint64_t semente, const DefinicaoMapa* definicao) {
+    logGravacao = fopen(caminho, "wb");
+    if (logGravacao == NULL) {
+        printf("%s[ERRO] Nao foi possivel criar o log '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        return 0;
+    }
+    
+    CabecalhoLog cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_LOG, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_LOG;
+    cabecalho.numTerritoriosMapa = (uint32_t)definicao->numTerritorios;
+    cabecalho.numFronteirasMapa = (uint32_t)definicao->numFronteiras;
+    cabecalho.semente = semente;
+    fwrite(&cabecalho, sizeof(cabecalho), 1, logGravacao);
+    fflush(logGravacao);
+    printf("[LOG] Gravando a partida em '%s'.\n", caminho);
+    return 1;
+}
+
+void registrarDecisao(TipoDecisao tipo, int a, int b, int c) {
+    if (logGravacao == NULL) {
+        return;
+    }
+    RegistroDecisao registro;
+    memset(&registro, 0, sizeof(registro));
+    registro.tipo = (uint8_t)tipo;
+    registro.valores[0] = a;
+    registro.valores[1] = b;
+    registro.valores[2] = c;
+    
+    // Acrescentar e descarregar: se o jogo for interrompido, o log vale até aqui
+    fwrite(&registro, sizeof(registro), 1, logGravacao);
+    fflush(logGravacao);
+}
+
+void encerrarGravacao(void) {
+    if (logGravacao != NULL) {
+        fclose(logGravacao);
+        logGravacao = NULL;
+    }
+}
+
+// Lê o próximo registro; retorna 0 no fim do arquivo
+static int lerRegistroLog(FILE* arquivo, RegistroDecisao* registro) {
+    return fread(registro, sizeof(*registro), 1, arquivo) == 1;
+}
+
+// Pausa do modo passo a passo
+static void pausarReplay(void) {
+    printf("[PASSO] Pressione Enter para a proxima decisao...");
+    fflush(stdout);
+    limparBufferEntrada();
+}
+
+int reproduzirPartida(const char* caminho, const DefinicaoMapa* definicao, int ateTurno, int passoAPasso,
+                      ResultadoPartida* resultado) {
+    FILE* arquivo = fopen(caminho, "rb");
+    if (arquivo == NULL) {
+        printf("%s[ERRO] Nao foi possivel abrir o log '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        return 0;
+    }
+    
+    // 1) Cabeçalho: formato, mapa e semente
+    CabecalhoLog cabecalho;
+    if (fread(&cabecalho, sizeof(cabecalho), 1, arquivo) != 1 ||
+        memcmp(cabecalho.assinatura, ASSINATURA_LOG, sizeof(cabecalho.assinatura)) != 0 ||
+        cabecalho.versao != VERSAO_LOG) {
+        printf("%s[ERRO] '%s' nao e um log de partida valido.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        fclose(arquivo);
+        return 0;
+    }
+    if (cabecalho.numTerritoriosMapa != (uint32_t)definicao->numTerritorios ||
+        cabecalho.numFronteirasMapa != (uint32_t)definicao->numFronteiras) {
+        printf("%s[ERRO] O log foi gravado com outro mapa (%" PRIu32 " territorios); use o mesmo --mapa.%s\n",
+               COR_VERMELHO_NEGRITO, cabecalho.numTerritoriosMapa, COR_RESET);
+        fclose(arquivo);
+        return 0;
+    }
+    
+    EstadoRNG rng;
+    inicializarRNG(&rng, cabecalho.semente);
+    printf("[REPLAY] '%s' | semente %" PRIu64 "\n", caminho, cabecalho.semente);
+    
+    // 2) Configuração: nível, número de territórios e cadastro
+    RegistroDecisao registro;
+    const char* erro = NULL;
+    Mapa* mapa = NULL;
+    int master = 0;
+    int numTerritorios = NUM_TERRITORIOS_PREDEFINIDOS < definicao->numTerritorios
+        ? NUM_TERRITORIOS_PREDEFINIDOS : definicao->numTerritorios;
+    
+    if (!lerRegistroLog(arquivo, &registro) || registro.tipo != DECISAO_NIVEL) {
+        erro = "nivel da partida ausente";
+    } else {
+        master = (registro.valores[0] == 2);
+    }
+    if (erro == NULL && master) {
+        if (!lerRegistroLog(arquivo, &registro) || registro.tipo != DECISAO_NUM_TERRITORIOS ||
+            registro.valores[0] < MIN_TERRITORIOS || registro.valores[0] > definicao->numTerritorios) {
+            erro = "numero de territorios ausente ou invalido";
+        } else {
+            numTerritorios = registro.valores[0];
+        }
+    }
+    if (erro == NULL) {
+        mapa = alocarMapa(numTerritorios);
+        for (int i = 0; i < numTerritorios && erro == NULL; i++) {
+            if (!lerRegistroLog(arquivo, &registro) || registro.tipo != DECISAO_TERRITORIO ||
+                registro.valores[0] < 0 || registro.valores[0] >= definicao->numTerritorios ||
+                registro.valores[1] < 0 || registro.valores[1] >= NUM_CORES_PREDEFINIDAS ||
+                registro.valores[2] < 1) {
+                erro = "cadastro de territorio ausente ou invalido";
+                break;
+            }
+            mapa->nomeId[i] = (uint32_t)registro.valores[0];
+            mapa->dono[i] = (uint8_t)registro.valores[1];
+            mapa->tropas[i] = registro.valores[2];
+        }
+    }
+    if (erro != NULL) {
+        printf("%s[ERRO] Log '%s': %s.%s\n", COR_VERMELHO_NEGRITO, caminho, erro, COR_RESET);
+        liberarMemoria(mapa);
+        fclose(arquivo);
+        return 0;
+    }
+    
+    // Mesmos passos (e mesmos sorteios) do cadastro e do início do Nível Master
+    associarSubmapa(mapa, definicao);
+    distribuirTropasExtras(mapa, &rng, NULL);
+    recalcularContadores(mapa);
+    MotorMissoes missoes;
+    if (master) {
+        gerarMissoesDosJogadores(&missoes, mapa, 1, &rng);
+        mapa->missoes = &missoes; // Conquistas notificam o motor de missões, como no nivelMaster
+    }
+    if (passoAPasso) {
+        exibirMapa(mapa);
+        pausarReplay();
+    }
+    
+    // 3) Turnos e ataques, no motor silencioso
+    int turno = master ? 0 : 1;
+    int corCumpriu = SEM_COR;
+    long decisoes = 0;
+    int interrompido = 0;
+    double inicio = tempoAtualSegundos();
+    
+    while (lerRegistroLog(arquivo, &registro)) {
+        if (registro.tipo == DECISAO_TURNO && master) {
+            // O nivelMaster avança o turno e avalia as missões antes de marcar o turno no log
+            turno = registro.valores[0];
+            if (turno > 1) {
+                notificarFimDeTurno(&missoes, turno);
+            }
+            avaliarMissoes(&missoes, mapa);
+            if (ateTurno > 0 && turno >= ateTurno) {
+                interrompido = 1;
+                break;
+            }
+            if (turno > 1) {
+                aplicarReforcos(mapa, NULL);
+            }
+            if (passoAPasso) {
+                printf("\n[REPLAY] ===== Turno %d =====%s\n", turno, turno > 1 ? " (reforcos aplicados)" : "");
+                exibirAlteracoesMapa(mapa);
+                pausarReplay();
+            }
+        } else if (registro.tipo == DECISAO_ATAQUE) {
+            int atacante = registro.valores[0];
+            int defensor = registro.valores[1];
+            int modo = registro.valores[2];
+            if (atacante < 0 || atacante >= numTerritorios || defensor < 0 || defensor >= numTerritorios ||
+                mapa->dono[atacante] == mapa->dono[defensor] || mapa->tropas[atacante] <= 1 ||
+                !saoVizinhos(mapa, atacante, defensor)) {
+                erro = "ataque invalido para o estado reproduzido";
+                break;
+            }
+            if (modo != ATAQUE_RODADA && modo != ATAQUE_BLITZ) {
+                erro = "modo de ataque desconhecido";
+                break;
+            }
+            int tropasAtacante = mapa->tropas[atacante];
+            int tropasDefensor = mapa->tropas[defensor];
+            int conquistou = (modo == ATAQUE_BLITZ)
+                ? (resolverBatalha(mapa, atacante, defensor, &rng, NULL) == 2)
+                : (resolverCombate(mapa, atacante, defensor, &rng, NULL) == 2);
+            if (passoAPasso) {
+                printf("\n[REPLAY] #%ld %s (%d) %s %s (%d) -> %s\n", decisoes + 1,
+                       nomeDoTerritorio(mapa, atacante), tropasAtacante,
+                       modo == ATAQUE_BLITZ ? "ataca em blitz" : "ataca",
+                       nomeDoTerritorio(mapa, defensor), tropasDefensor,
+                       conquistou ? "CONQUISTADO" : "sem conquista");
+                exibirAlteracoesMapa(mapa);
+                pausarReplay();
+            }
+        } else {
+            erro = "registro inesperado";
+            break;
+        }
+        decisoes++;
+    }
+    double segundos = tempoAtualSegundos() - inicio;
+    fclose(arquivo);
+    
+    // Fim do log: o turno gravado por último terminou e o nivelMaster abriu o
+    // seguinte, onde avaliou as missões (a não ser que o limite de turnos tenha
+    // encerrado a partida antes)
+    if (master && erro == NULL && !interrompido) {
+        turno++;
+        notificarFimDeTurno(&missoes, turno);
+        if (turno <= MAX_TURNOS_MASTER) {
+            corCumpriu = avaliarMissoes(&missoes, mapa);
+        }
+    }
+    
+    if (erro != NULL) {
+        printf("%s[ERRO] Log '%s', decisao %ld: %s.%s\n", COR_VERMELHO_NEGRITO, caminho, decisoes + 1, erro, COR_RESET);
+    }
+    
+    // 4) Estado reproduzido
+    printf("\n[REPLAY] %s apos %ld decisao(oes) em %.6f s%s\n",
+           interrompido ? "Parado no inicio do turno solicitado" : "Fim do log",
+           decisoes, segundos, master ? "" : " (Nivel Aventureiro)");
+    exibirMapa(mapa);
+    ResultadoPartida fim = { FIM_SEM_VENCEDOR, -1, turno - 1, 0 };
+    if (master) {
+        printf("- Turno: %d\n", turno);
+        for (int cor = 0; cor < MAX_CORES; cor++) {
+            if (missoes.ativas & (1u << cor)) {
+                printf("- Missao de %s: %s -> %s\n", nomeDaCor(cor), missoes.missoes[cor].descricao,
+                       (missoes.cumpridas & (1u << cor)) ? "cumprida" : "nao cumprida");
+            }
+        }
+    }
+    if (corCumpriu != SEM_COR) {
+        printf("- O exercito %s cumpriu a sua missao e venceu o jogo\n", nomeDaCor(corCumpriu));
+        fim.tipoFim = FIM_MISSAO;
+        fim.corVencedora = corCumpriu;
+        fim.missaoCumprida = 1;
+    } else if (jogoTerminou(mapa) && (!master || turno <= MAX_TURNOS_MASTER)) {
+        printf("- Dominacao total do exercito %s\n", nomeDaCor(mapa->dono[0]));
+        fim.tipoFim = FIM_DOMINACAO;
+        fim.corVencedora = mapa->dono[0];
+    } else if (master && turno > MAX_TURNOS_MASTER) {
+        printf("- Limite de %d turnos atingido sem vencedor\n", MAX_TURNOS_MASTER);
+    }
+    if (resultado != NULL) {
+        *resultado = fim;
+    }
+    
+    mapa->missoes = NULL;
+    liberarMemoria(mapa);
+    return erro == NULL;
+}
+
+// ============================================================================
+// SNAPSHOTS DE PARTIDA
+// Um snapshot é o cabeçalho seguido dos arrays do mapa no mesmo layout
+// alinhado de alocarMapa. Carregar é só mapear o arquivo e apontar o Mapa
+// para dentro dele: nenhuma interpretação ou cópia de território.
+// ============================================================================
+
+// Grava um array no próximo deslocamento alinhado e o registra no cabeçalho
+static int escreverArraySnapshot(FILE* arquivo, CabecalhoSnapshot* cabecalho, ArraySnapshot array,
+                                 const void* dados, size_t bytes, size_t* posicao) {
+    static const char zeros[ALINHAMENTO_MAPA] = {0};
+    size_t inicio = alinharMapa(*posicao);
+    if (fwrite(zeros, 1, inicio - *posicao, arquivo) != inicio - *posicao ||
+        (bytes > 0 && fwrite(dados, 1, bytes, arquivo) != bytes)) {
+        return 0;
+    }
+    cabecalho->deslocamento[array] = inicio;
+    cabecalho->tamanho[array] = bytes;
+    *posicao = inicio + bytes;
+    return 1;
+}
+
+int salvarSnapshot(const char* caminho, const Mapa* mapa, const MotorMissoes* missoes, int corJogador, int turno,
+                   const EstadoRNG* rng) {
+    size_t n = (size_t)mapa->numTerritorios;
+    
+    CabecalhoSnapshot cabecalho;
+    memset(&cabecalho, 0, sizeof(cabecalho));
+    memcpy(cabecalho.assinatura, ASSINATURA_SNAPSHOT, sizeof(cabecalho.assinatura));
+    cabecalho.versao = VERSAO_SNAPSHOT;
+    cabecalho.tamanhoCabecalho = (uint32_t)sizeof(cabecalho);
+    cabecalho.numTerritorios = mapa->numTerritorios;
+    cabecalho.numContinentes = (mapa->territoriosPorContinente != NULL) ? mapa->numContinentes : 0;
+    cabecalho.turno = turno;
+    if (mapa->definicao != NULL) {
+        cabecalho.numTerritoriosMapa = (uint32_t)mapa->definicao->numTerritorios;
+        cabecalho.numFronteirasMapa = (uint32_t)mapa->definicao->numFronteiras;
+    }
+    cabecalho.corJogador = corJogador;
+    cabecalho.rng = *rng;
+    cabecalho.missoesAtivas = missoes->ativas;
+    memcpy(cabecalho.missoes, missoes->missoes, sizeof(cabecalho.missoes));
+    memcpy(cabecalho.territoriosPorDono, mapa->territoriosPorDono, sizeof(cabecalho.territoriosPorDono));
+    memcpy(cabecalho.tropasPorDono, mapa->tropasPorDono, sizeof(cabecalho.tropasPorDono));
+    
+    size_t totalVizinhos = (mapa->inicioVizinhos != NULL) ? (size_t)mapa->inicioVizinhos[n] : 0;
+    
+    // Gravar em um arquivo temporário e renomear: um snapshot ainda mapeado
+    // (--carregar e --salvar no mesmo arquivo) nunca é alterado no lugar
+    char* temporario = (char*)malloc(strlen(caminho) + sizeof(".tmp"));
+    if (temporario == NULL) {
+        printf("Erro: Não foi possível alocar memória para o snapshot.\n");
+        exit(1);
+    }
+    sprintf(temporario, "%s.tmp", caminho);
+    FILE* arquivo = fopen(temporario, "wb");
+    if (arquivo == NULL) {
+        printf("%s[ERRO] Nao foi possivel criar o snapshot '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        free(temporario);
+        return 0;
+    }
+    
+    // Cabeçalho provisório; os deslocamentos são preenchidos durante a escrita
+    size_t posicao = sizeof(cabecalho);
+    int ok = fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1 &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_TROPAS, mapa->tropas, n * sizeof(int32_t), &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_NOME_ID, mapa->nomeId, n * sizeof(uint32_t), &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_DONO, mapa->dono, n * sizeof(uint8_t), &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_INICIO_VIZINHOS, mapa->inicioVizinhos,
+                              mapa->inicioVizinhos != NULL ? (n + 1) * sizeof(int32_t) : 0, &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_VIZINHOS, mapa->vizinhos,
+                              totalVizinhos * sizeof(int32_t), &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_CONTINENTE, mapa->continente,
+                              mapa->continente != NULL ? n * sizeof(uint16_t) : 0, &posicao) &&
+        escreverArraySnapshot(arquivo, &cabecalho, ARRAY_CONTADORES_CONTINENTE, mapa->territoriosPorContinente,
+                              (size_t)cabecalho.numContinentes * (MAX_CORES + 1) * sizeof(int32_t), &posicao);
+    
+    // Completar o último alinhamento e regravar o cabeçalho definitivo
+    static const char zeros[ALINHAMENTO_MAPA] = {0};
+    size_t fim = alinharMapa(posicao);
+    cabecalho.tamanhoArquivo = fim;
+    ok = ok && fwrite(zeros, 1, fim - posicao, arquivo) == fim - posicao &&
+         fseek(arquivo, 0, SEEK_SET) == 0 &&
+         fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo) == 1;
+    ok = (fclose(arquivo) == 0) && ok;
+    
+    if (ok && rename(temporario, caminho) != 0) {
+        remove(caminho); // Sistemas em que rename não substitui um arquivo existente
+        ok = rename(temporario, caminho) == 0;
+    }
+    if (!ok) {
+        remove(temporario);
+        printf("%s[ERRO] Falha ao gravar o snapshot '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+    }
+    free(temporario);
+    return ok;
+}
+
+// Confere o cabeçalho, os limites de cada array, os valores usados como índice
+// e os contadores contra os arrays; retorna NULL se válido
+static const char* validarSnapshot(const CabecalhoSnapshot* cabecalho, size_t tamanho, const DefinicaoMapa* definicao) {
+    if (tamanho < sizeof(cabecalho->assinatura) ||
+        memcmp(cabecalho->assinatura, ASSINATURA_SNAPSHOT, sizeof(cabecalho->assinatura)) != 0) {
+        return "arquivo nao e um snapshot de partida";
+    }
+    if (tamanho < sizeof(*cabecalho)) {
+        return "snapshot truncado";
+    }
+    if (cabecalho->versao != VERSAO_SNAPSHOT || cabecalho->tamanhoCabecalho != sizeof(*cabecalho)) {
+        return "versao de snapshot incompativel";
+    }
+    if (cabecalho->tamanhoArquivo != tamanho) {
+        return "snapshot truncado";
+    }
+    if (cabecalho->numTerritoriosMapa != (uint32_t)definicao->numTerritorios ||
+        cabecalho->numFronteirasMapa != (uint32_t)definicao->numFronteiras) {
+        return "snapshot salvo com outro mapa; use o mesmo --mapa";
+    }
+    if (cabecalho->numTerritorios < 1 || cabecalho->numTerritorios > definicao->numTerritorios ||
+        cabecalho->numContinentes < 0 || cabecalho->numContinentes > definicao->numContinentes ||
+        cabecalho->turno < 1) {
+        return "cabecalho de snapshot invalido";
+    }
+    if (cabecalho->corJogador < 0 || cabecalho->corJogador >= MAX_CORES ||
+        (cabecalho->missoesAtivas >> MAX_CORES) != 0) {
+        return "cabecalho de snapshot invalido";
+    }
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        const Missao* missao = &cabecalho->missoes[cor];
+        if (!(cabecalho->missoesAtivas & (1u << cor))) {
+            continue;
+        }
+        if (missao->cor != cor || (unsigned)missao->tipo > SOBREVIVER_TURNOS ||
+            memchr(missao->descricao, '\0', sizeof(missao->descricao)) == NULL ||
+            (missao->tipo == ELIMINAR_COR && (missao->corAlvo < 0 || missao->corAlvo >= MAX_CORES)) ||
+            (missao->tipo == CONQUISTAR_CONTINENTE &&
+             (missao->valorAlvo < 0 || missao->valorAlvo >= cabecalho->numContinentes))) {
+            return "missoes do snapshot invalidas";
+        }
+    }
+    
+    // Tamanho esperado de cada array (os opcionais podem estar vazios)
+    size_t n = (size_t)cabecalho->numTerritorios;
+    size_t esperado[NUM_ARRAYS_SNAPSHOT] = {
+        n * sizeof(int32_t), n * sizeof(uint32_t), n * sizeof(uint8_t),
+        (n + 1) * sizeof(int32_t), cabecalho->tamanho[ARRAY_VIZINHOS], n * sizeof(uint16_t),
+        (size_t)cabecalho->numContinentes * (MAX_CORES + 1) * sizeof(int32_t)
+    };
+    for (int i = 0; i < NUM_ARRAYS_SNAPSHOT; i++) {
+        uint64_t inicio = cabecalho->deslocamento[i];
+        uint64_t bytes = cabecalho->tamanho[i];
+        int opcional = (i == ARRAY_INICIO_VIZINHOS || i == ARRAY_VIZINHOS || i == ARRAY_CONTINENTE);
+        if ((bytes != esperado[i] && !(opcional && bytes == 0)) ||
+            inicio < sizeof(*cabecalho) || inicio % ALINHAMENTO_MAPA != 0 ||
+            inicio > tamanho || bytes > tamanho - inicio) {
+            return "arrays do snapshot fora do arquivo";
+        }
+    }
+    // Sem lista de adjacência não há vizinhos; com ela, o total precisa bater
+    const int32_t* inicioVizinhos = (const int32_t*)((const char*)cabecalho + cabecalho->deslocamento[ARRAY_INICIO_VIZINHOS]);
+    uint64_t bytesVizinhos = (cabecalho->tamanho[ARRAY_INICIO_VIZINHOS] > 0)
+        ? (uint64_t)(uint32_t)inicioVizinhos[n] * sizeof(int32_t) : 0;
+    if (cabecalho->tamanho[ARRAY_VIZINHOS] != bytesVizinhos ||
+        (cabecalho->tamanho[ARRAY_CONTINENTE] == 0) != (cabecalho->numContinentes == 0)) {
+        return "arrays do snapshot inconsistentes";
+    }
+    // Tudo o que vira índice de array é conferido antes de o mapa apontar para o arquivo
+    const char* base = (const char*)cabecalho;
+    const uint8_t* dono = (const uint8_t*)(base + cabecalho->deslocamento[ARRAY_DONO]);
+    const int32_t* tropas = (const int32_t*)(base + cabecalho->deslocamento[ARRAY_TROPAS]);
+    const uint32_t* nomeId = (const uint32_t*)(base + cabecalho->deslocamento[ARRAY_NOME_ID]);
+    int32_t territoriosPorDono[MAX_CORES] = {0};
+    int64_t tropasPorDono[MAX_CORES] = {0};
+    for (size_t i = 0; i < n; i++) {
+        if (dono[i] >= MAX_CORES) {
+            return "donos do snapshot invalidos";
+        }
+        if (tropas[i] < 1 || nomeId[i] >= (uint32_t)definicao->numTerritorios) {
+            return "territorios do snapshot invalidos";
+        }
+        territoriosPorDono[dono[i]]++;
+        tropasPorDono[dono[i]] += tropas[i];
+    }
+    // Os contadores do cabeçalho posicionam os grupos do índice por dono
+    if (memcmp(territoriosPorDono, cabecalho->territoriosPorDono, sizeof(territoriosPorDono)) != 0 ||
+        memcmp(tropasPorDono, cabecalho->tropasPorDono, sizeof(tropasPorDono)) != 0) {
+        return "contadores do snapshot nao conferem com os territorios";
+    }
+    if (cabecalho->tamanho[ARRAY_INICIO_VIZINHOS] > 0) {
+        const int32_t* vizinhos = (const int32_t*)(base + cabecalho->deslocamento[ARRAY_VIZINHOS]);
+        if (inicioVizinhos[0] != 0) {
+            return "fronteiras do snapshot invalidas";
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (inicioVizinhos[i + 1] < inicioVizinhos[i]) {
+                return "fronteiras do snapshot invalidas";
+            }
+        }
+        for (int32_t k = 0; k < inicioVizinhos[n]; k++) {
+            if (vizinhos[k] < 0 || (size_t)vizinhos[k] >= n) {
+                return "fronteiras do snapshot invalidas";
+            }
+        }
+    }
+    if (cabecalho->numContinentes > 0) {
+        // Contagem por (continente, dono) e tamanho de cada continente, como em recalcularContadores
+        const uint16_t* continente = (const uint16_t*)(base + cabecalho->deslocamento[ARRAY_CONTINENTE]);
+        const int32_t* salvos = (const int32_t*)(base + cabecalho->deslocamento[ARRAY_CONTADORES_CONTINENTE]);
+        size_t numContadores = (size_t)cabecalho->numContinentes * (MAX_CORES + 1);
+        int32_t* contadores = (int32_t*)calloc(numContadores, sizeof(int32_t));
+        if (contadores == NULL) {
+            printf("Erro: Não foi possível alocar memória para conferir o snapshot.\n");
+            exit(1);
+        }
+        int32_t* tamanhoContinente = contadores + (size_t)cabecalho->numContinentes * MAX_CORES;
+        const char* erro = NULL;
+        for (size_t i = 0; i < n; i++) {
+            if (continente[i] >= cabecalho->numContinentes) {
+                erro = "continentes do snapshot invalidos";
+                break;
+            }
+            contadores[(size_t)continente[i] * MAX_CORES + dono[i]]++;
+            tamanhoContinente[continente[i]]++;
+        }
+        if (erro == NULL && memcmp(contadores, salvos, numContadores * sizeof(int32_t)) != 0) {
+            erro = "contadores do snapshot nao conferem com os territorios";
+        }
+        free(contadores);
+        return erro;
+    }
+    return NULL;
+}
+
+Mapa* carregarSnapshot(const char* caminho, const DefinicaoMapa* definicao, MotorMissoes* missoes, int* corJogador,
+                       int* turno, EstadoRNG* rng) {
+    size_t tamanho = 0;
+    char* base = (char*)mapearArquivo(caminho, &tamanho);
+    if (base == NULL) {
+        printf("%s[ERRO] Nao foi possivel abrir o snapshot '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        return NULL;
+    }
+    
+    const CabecalhoSnapshot* cabecalho = (const CabecalhoSnapshot*)base;
+    const char* erro = validarSnapshot(cabecalho, tamanho, definicao);
+    if (erro != NULL) {
+        printf("%s[ERRO] '%s': %s.%s\n", COR_VERMELHO_NEGRITO, caminho, erro, COR_RESET);
+        liberarMapeamento(base, tamanho);
+        return NULL;
+    }
+    
+    Mapa* mapa = (Mapa*)calloc(1, sizeof(Mapa));
+    if (mapa == NULL) {
+        printf("Erro: Não foi possível alocar memória para os territórios.\n");
+        exit(1);
+    }
+    
+    // Os arrays do arquivo mapeado são o próprio armazenamento do mapa
+    mapa->numTerritorios = cabecalho->numTerritorios;
+    mapa->tropas = (int32_t*)(base + cabecalho->deslocamento[ARRAY_TROPAS]);
+    mapa->nomeId = (uint32_t*)(base + cabecalho->deslocamento[ARRAY_NOME_ID]);
+    mapa->dono = (uint8_t*)(base + cabecalho->deslocamento[ARRAY_DONO]);
+    mapa->definicao = definicao;
+    if (cabecalho->tamanho[ARRAY_INICIO_VIZINHOS] > 0) {
+        mapa->inicioVizinhos = (const int32_t*)(base + cabecalho->deslocamento[ARRAY_INICIO_VIZINHOS]);
+        mapa->vizinhos = (const int32_t*)(base + cabecalho->deslocamento[ARRAY_VIZINHOS]);
+    }
+    if (cabecalho->numContinentes > 0) {
+        mapa->continente = (const uint16_t*)(base + cabecalho->deslocamento[ARRAY_CONTINENTE]);
+        mapa->territoriosPorContinente = (int32_t*)(base + cabecalho->deslocamento[ARRAY_CONTADORES_CONTINENTE]);
+        mapa->tamanhoContinente = mapa->territoriosPorContinente + (size_t)cabecalho->numContinentes * MAX_CORES;
+        mapa->numContinentes = cabecalho->numContinentes;
+    }
+    memcpy(mapa->territoriosPorDono, cabecalho->territoriosPorDono, sizeof(mapa->territoriosPorDono));
+    memcpy(mapa->tropasPorDono, cabecalho->tropasPorDono, sizeof(mapa->tropasPorDono));
+    mapa->mapeamento = base;
+    mapa->tamanhoMapeamento = tamanho;
+    montarIndicePorDono(mapa); // O índice por dono não faz parte do arquivo
+    
+    // As inscrições de eventos são refeitas a partir das missões salvas
+    memset(missoes, 0, sizeof(*missoes));
+    missoes->turno = cabecalho->turno;
+    for (int cor = 0; cor < MAX_CORES; cor++) {
+        if (cabecalho->missoesAtivas & (1u << cor)) {
+            atribuirMissao(missoes, &cabecalho->missoes[cor]);
+        }
+    }
+    *corJogador = cabecalho->corJogador;
+    *turno = cabecalho->turno;
+    *rng = cabecalho->rng;
+    return mapa;
+}
+
+void restaurarPosicao(Mapa* destino, const Mapa* origem) {
+    size_t n = (size_t)origem->numTerritorios;
+    memcpy(destino->tropas, origem->tropas, n * sizeof(int32_t));
+    memcpy(destino->nomeId, origem->nomeId, n * sizeof(uint32_t));
+    memcpy(destino->dono, origem->dono, n * sizeof(uint8_t));
+    
+    // Fronteiras e continentes não mudam durante a partida: compartilhados
+    destino->definicao = origem->definicao;
+    destino->inicioVizinhos = origem->inicioVizinhos;
+    destino->vizinhos = origem->vizinhos;
+    destino->vizinhosBits = origem->vizinhosBits;
+    destino->continente = origem->continente;
+    
+    memcpy(destino->territoriosPorDono, origem->territoriosPorDono, sizeof(destino->territoriosPorDono));
+    memcpy(destino->tropasPorDono, origem->tropasPorDono, sizeof(destino->tropasPorDono));
+    memcpy(destino->inicioDoDono, origem->inicioDoDono, sizeof(destino->inicioDoDono));
+    if (n <= MAX_TERRITORIOS_BITBOARD) {
+        memcpy(destino->bitsDoDono, origem->bitsDoDono, sizeof(destino->bitsDoDono));
+    }
+    if (destino->territoriosPorCor == NULL) {
+        reservarIndicePorDono(destino);
+    }
+    memcpy(destino->territoriosPorCor, origem->territoriosPorCor, 2 * n * sizeof(int32_t));
+    if (origem->territoriosPorContinente == NULL) {
+        return;
+    }
+    size_t contadores = (size_t)origem->numContinentes * (MAX_CORES + 1);
+    if (destino->territoriosPorContinente == NULL || destino->numContinentes != origem->numContinentes) {
+        devolverDoMapa(destino, destino->territoriosPorContinente);
+        destino->territoriosPorContinente = (int32_t*)reservarParaMapa(destino, contadores * sizeof(int32_t));
+        if (destino->territoriosPorContinente == NULL) {
+            printf("Erro: Não foi possível alocar memória para os contadores do mapa.\n");
+            exit(1);
+        }
+        destino->tamanhoContinente = destino->territoriosPorContinente + (size_t)origem->numContinentes * MAX_CORES;
+        destino->numContinentes = origem->numContinentes;
+    }
+    memcpy(destino->territoriosPorContinente, origem->territoriosPorContinente, contadores * sizeof(int32_t));
+}
+
+// ============================================================================
+// CONFIGURACAO DE PARTIDA (--config)
+// A posição inicial do Nível Master declarada em arquivo, no mesmo estilo dos
+// arquivos de mapa. Cada linha é validada quando é lida: nomes de território
+// são resolvidos por uma tabela hash da definição e repetições, por um array
+// de marcas, sem varrer o que já foi declarado.
+// ============================================================================
+
+/**
+ * @brief Estado da leitura de um arquivo de configuração
+ */
+typedef struct {
+    const DefinicaoMapa* definicao;
+    int32_t* tabelaNomes;               // Endereçamento aberto: território + 1 (0 = vazio)
+    uint32_t mascaraTabela;             // Tamanho da tabela - 1 (potência de 2)
+    uint8_t* declarado;                 // 1 = território da definição já declarado
+    uint32_t* nomeId;                   // Territórios declarados, na ordem do arquivo
+    uint8_t* dono;
+    int32_t* tropas;
+    size_t numTerritorios;
+    size_t capacidade;
+    int corJogador;                     // SEM_COR = dona do primeiro território
+    int sortearExtras;                  // 1 = TROPAS_EXTRAS_CADASTRO sorteadas, como no cadastro
+    int temMissao;                      // 1 = missão do jogador declarada
+    Missao missao;                      // Tipo e alvo declarados (validados no fim)
+    long linhaMissao;                   // Linha da declaração da missão
+} CarregadorConfig;
+
+// Tabela de nomes da definição (o carregador do mapa já recusou nomes repetidos)
+static int montarTabelaNomes(CarregadorConfig* c) {
+    const DefinicaoMapa* d = c->definicao;
+    size_t tamanho = 16;
+    while (tamanho < 2 * (size_t)d->numTerritorios) tamanho *= 2;
+    c->tabelaNomes = (int32_t*)calloc(tamanho, sizeof(int32_t));
+    if (c->tabelaNomes == NULL) {
+        return 0;
+    }
+    c->mascaraTabela = (uint32_t)(tamanho - 1);
+    for (int t = 0; t < d->numTerritorios; t++) {
+        const char* nome = nomeNaDefinicao(d, t);
+        uint32_t i = espalharNome(nome) & c->mascaraTabela;
+        while (c->tabelaNomes[i] != 0 && strcmp(nomeNaDefinicao(d, c->tabelaNomes[i] - 1), nome) != 0) {
+            i = (i + 1) & c->mascaraTabela;
+        }
+        if (c->tabelaNomes[i] == 0) {
+            c->tabelaNomes[i] = t + 1;
+        }
+    }
+    return 1;
+}
+
+// Índice do território com esse nome na definição, ou -1
+static int buscarTerritorioPorNome(const CarregadorConfig* c, const char* nome) {
+    uint32_t i = espalharNome(nome) & c->mascaraTabela;
+    while (c->tabelaNomes[i] != 0) {
+        if (strcmp(nomeNaDefinicao(c->definicao, c->tabelaNomes[i] - 1), nome) == 0) {
+            return c->tabelaNomes[i] - 1;
+        }
+        i = (i + 1) & c->mascaraTabela;
+    }
+    return -1;
+}
+
+// Separa a próxima palavra do cursor (termina a palavra com '\0')
+static char* proximaPalavra(char** cursor) {
+    char* palavra = *cursor;
+    while (*palavra == ' ' || *palavra == '\t') palavra++;
+    if (*palavra == '\0') {
+        return NULL;
+    }
+    char* fim = palavra;
+    while (*fim != '\0' && *fim != ' ' && *fim != '\t') fim++;
+    *cursor = (*fim != '\0') ? fim + 1 : fim;
+    *fim = '\0';
+    return palavra;
+}
+
+// Interpreta uma linha da configuração; retorna a mensagem de erro ou NULL se a linha é válida
+static const char* interpretarLinhaConfig(CarregadorConfig* c, char* linha, long numLinha) {
+    char* texto = aparar(linha);
+    if (*texto == '\0' || *texto == '#') {
+        return NULL; // Linha vazia ou comentário
+    }
+    char* cursor = texto;
+    char* declaracao = proximaPalavra(&cursor);
+    
+    if (strcmp(declaracao, "territorio") == 0) {
+        long tropas;
+        if (!lerIndiceMapa(&cursor, &tropas)) return "tropas do territorio ausentes";
+        if (tropas < 1 || tropas > MAX_TROPAS_CONFIG) return "tropas do territorio fora do intervalo";
+        char* nomeCor = proximaPalavra(&cursor);
+        if (nomeCor == NULL) return "cor do territorio ausente";
+        int cor = buscarCor(nomeCor);
+        if (cor == SEM_COR) return "cor desconhecida";
+        char* nome = aparar(cursor);
+        if (*nome == '\0') return "territorio sem nome";
+        int territorio = buscarTerritorioPorNome(c, nome);
+        if (territorio < 0) return "territorio nao existe no mapa";
+        if (c->declarado[territorio]) return "territorio declarado duas vezes";
+        
+        size_t n = c->numTerritorios + 1;
+        if (n > c->capacidade) {
+            // nomeId, dono e tropas crescem juntos
+            size_t capacidadeNomes = c->capacidade;
+            size_t capacidadeDonos = c->capacidade;
+            if (!garantirCapacidade((void**)&c->nomeId, &capacidadeNomes, n, sizeof(uint32_t)) ||
+                !garantirCapacidade((void**)&c->dono, &capacidadeDonos, n, sizeof(uint8_t)) ||
+                !garantirCapacidade((void**)&c->tropas, &c->capacidade, n, sizeof(int32_t))) {
+                return "memoria insuficiente";
+            }
+        }
+        c->declarado[territorio] = 1;
+        c->nomeId[c->numTerritorios] = (uint32_t)territorio;
+        c->dono[c->numTerritorios] = (uint8_t)cor;
+        c->tropas[c->numTerritorios] = (int32_t)tropas;
+        c->numTerritorios = n;
+        return NULL;
+    }
+    
+    if (strcmp(declaracao, "jogador") == 0) {
+        char* nomeCor = proximaPalavra(&cursor);
+        if (nomeCor == NULL || *aparar(cursor) != '\0') return "jogador precisa de exatamente uma cor";
+        c->corJogador = buscarCor(nomeCor);
+        if (c->corJogador == SEM_COR) return "cor desconhecida";
+        return NULL;
+    }
+    
+    if (strcmp(declaracao, "extras") == 0) {
+        char* politica = proximaPalavra(&cursor);
+        if (politica == NULL || *aparar(cursor) != '\0') return "extras precisa de uma politica (sorteio ou nenhuma)";
+        if (strcmp(politica, "sorteio") == 0) {
+            c->sortearExtras = 1;
+        } else if (strcmp(politica, "nenhuma") == 0) {
+            c->sortearExtras = 0;
+        } else {
+            return "politica de extras desconhecida (use sorteio ou nenhuma)";
+        }
+        return NULL;
+    }
+    
+    if (strcmp(declaracao, "missao") == 0) {
+        char* tipo = proximaPalavra(&cursor);
+        if (tipo == NULL) return "tipo de missao ausente";
+        Missao* missao = &c->missao;
+        memset(missao, 0, sizeof(*missao));
+        missao->corAlvo = SEM_COR;
+        if (strcmp(tipo, "continente") == 0) {
+            // O continente é o resto da linha (nomes de continente têm espaços)
+            const char* nome = aparar(cursor);
+            missao->tipo = CONQUISTAR_CONTINENTE;
+            missao->valorAlvo = -1;
+            for (int k = 0; k < c->definicao->numContinentes && missao->valorAlvo < 0; k++) {
+                if (strcmp(c->definicao->nomesContinentes[k], nome) == 0) missao->valorAlvo = k;
+            }
+            if (missao->valorAlvo < 0) return "continente nao existe no mapa";
+        } else if (strcmp(tipo, "eliminar") == 0) {
+            char* nomeCor = proximaPalavra(&cursor);
+            if (nomeCor == NULL || *aparar(cursor) != '\0') return "eliminar precisa de exatamente uma cor";
+            missao->tipo = ELIMINAR_COR;
+            missao->corAlvo = buscarCor(nomeCor);
+            if (missao->corAlvo == SEM_COR) return "cor desconhecida";
+        } else if (strcmp(tipo, "controlar") == 0 || strcmp(tipo, "sobreviver") == 0) {
+            long valor;
+            if (!lerIndiceMapa(&cursor, &valor) || *aparar(cursor) != '\0') return "missao precisa de um numero";
+            if (valor < 1 || valor > INT32_MAX) return "numero da missao fora do intervalo";
+            missao->tipo = (tipo[0] == 'c') ? CONTROLAR_TERRITORIOS : SOBREVIVER_TURNOS;
+            missao->valorAlvo = (int)valor;
+        } else {
+            return "tipo de missao desconhecido (use continente, eliminar, controlar ou sobreviver)";
+        }
+        c->temMissao = 1;
+        c->linhaMissao = numLinha;
+        return NULL;
+    }
+    
+    return "declaracao desconhecida (use territorio, jogador, extras ou missao)";
+}
+
+// Confere a missão declarada contra a posição montada e completa a descrição
+static const char* validarMissaoConfig(Missao* missao, const Mapa* mapa, int corJogador) {
+    missao->cor = corJogador;
+    switch (missao->tipo) {
+        case CONQUISTAR_CONTINENTE:
+            if (mapa->continente == NULL || missao->valorAlvo >= mapa->numContinentes ||
+                mapa->tamanhoContinente[missao->valorAlvo] == 0) {
+                return "o continente da missao nao tem territorios na partida";
+            }
+            snprintf(missao->descricao, sizeof(missao->descricao), "Conquistar todo o continente %s",
+                     mapa->definicao->nomesContinentes[missao->valorAlvo]);
+            break;
+        case ELIMINAR_COR:
+            if (missao->corAlvo == corJogador) return "o jogador nao pode eliminar a propria cor";
+            if (mapa->territoriosPorDono[missao->corAlvo] == 0) return "a cor a eliminar nao esta em jogo";
+            snprintf(missao->descricao, sizeof(missao->descricao), "Eliminar completamente a cor %s do mapa",
+                     nomeDaCor(missao->corAlvo));
+            break;
+        case CONTROLAR_TERRITORIOS:
+            if (missao->valorAlvo > mapa->numTerritorios) return "a missao pede mais territorios que os da partida";
+            snprintf(missao->descricao, sizeof(missao->descricao), "Controlar pelo menos %d territorios",
+                     missao->valorAlvo);
+            break;
+        case SOBREVIVER_TURNOS:
+            if (missao->valorAlvo > MAX_TURNOS_MASTER) return "a missao pede mais turnos que os da partida";
+            snprintf(missao->descricao, sizeof(missao->descricao), "Sobreviver por pelo menos %d turnos",
+                     missao->valorAlvo);
+            break;
+    }
+    return NULL;
+}
+
+Mapa* carregarConfigPartida(const char* caminho, const DefinicaoMapa* definicao, MotorMissoes* missoes,
+                            int* corJogador, EstadoRNG* rng) {
+    FILE* arquivo = fopen(caminho, "r");
+    if (arquivo == NULL) {
+        printf("%s[ERRO] Nao foi possivel abrir a configuracao '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        return NULL;
+    }
+    
+    double inicio = tempoAtualSegundos();
+    CarregadorConfig c;
+    memset(&c, 0, sizeof(c));
+    c.definicao = definicao;
+    c.corJogador = SEM_COR;
+    c.sortearExtras = 1;
+    c.declarado = (uint8_t*)calloc((size_t)definicao->numTerritorios, sizeof(uint8_t));
+    if (c.declarado == NULL || !montarTabelaNomes(&c)) {
+        printf("Erro: Não foi possível alocar memória para a configuração.\n");
+        exit(1);
+    }
+    
+    // 1) Uma passada: cada linha é validada por inteiro ao ser lida
+    char linha[TAM_LINHA_MAPA];
+    long numLinha = 0;
+    const char* erro = NULL;
+    while (erro == NULL && fgets(linha, sizeof(linha), arquivo) != NULL) {
+        numLinha++;
+        if (strchr(linha, '\n') == NULL && !feof(arquivo)) {
+            erro = "linha longa demais";
+            break;
+        }
+        erro = interpretarLinhaConfig(&c, linha, numLinha);
+    }
+    fclose(arquivo);
+    
+    // 2) Regras que dependem do arquivo inteiro
+    if (erro == NULL) {
+        numLinha = 0;
+        if (c.numTerritorios < MIN_TERRITORIOS) {
+            erro = "a partida precisa de pelo menos 3 territorios";
+        } else if (c.corJogador == SEM_COR) {
+            c.corJogador = c.dono[0];
+        }
+    }
+    Mapa* mapa = NULL;
+    if (erro == NULL) {
+        int n = (int)c.numTerritorios;
+        mapa = alocarMapa(n);
+        memcpy(mapa->nomeId, c.nomeId, (size_t)n * sizeof(uint32_t));
+        memcpy(mapa->dono, c.dono, (size_t)n * sizeof(uint8_t));
+        memcpy(mapa->tropas, c.tropas, (size_t)n * sizeof(int32_t));
+        associarSubmapa(mapa, definicao);
+        if (c.sortearExtras) {
+            distribuirTropasExtras(mapa, rng, NULL);
+        }
+        recalcularContadores(mapa);
+        
+        if (mapa->territoriosPorDono[c.corJogador] == 0) {
+            erro = "a cor do jogador nao tem territorios";
+        } else if (c.temMissao) {
+            erro = validarMissaoConfig(&c.missao, mapa, c.corJogador);
+            numLinha = c.linhaMissao;
+        }
+    }
+    
+    // 3) Missões: a declarada para o jogador, sorteadas para as demais cores
+    if (erro == NULL) {
+        memset(missoes, 0, sizeof(*missoes));
+        missoes->turno = 1;
+        for (int cor = 0; cor < MAX_CORES; cor++) {
+            if (mapa->territoriosPorDono[cor] == 0) continue;
+            Missao missao = c.missao;
+            if (cor != c.corJogador || !c.temMissao) {
+                gerarMissaoAleatoria(&missao, mapa, cor, rng);
+            }
+            atribuirMissao(missoes, &missao);
+        }
+        *corJogador = c.corJogador;
+        int64_t exercitos = 0;
+        for (int cor = 0; cor < MAX_CORES; cor++) exercitos += mapa->tropasPorDono[cor];
+        printf("[CONFIG] '%s': %d territorios, %lld exercitos, jogador %s (%.6f s)\n", caminho,
+               mapa->numTerritorios, (long long)exercitos, nomeDaCor(c.corJogador), tempoAtualSegundos() - inicio);
+    } else {
+        if (numLinha > 0) {
+            printf("%s[ERRO] %s:%ld: %s.%s\n", COR_VERMELHO_NEGRITO, caminho, numLinha, erro, COR_RESET);
+        } else {
+            printf("%s[ERRO] %s: %s.%s\n", COR_VERMELHO_NEGRITO, caminho, erro, COR_RESET);
+        }
+        liberarMemoria(mapa);
+        mapa = NULL;
+    }
+    
+    free(c.tabelaNomes);
+    free(c.declarado);
+    free(c.nomeId);
+    free(c.dono);
+    free(c.tropas);
+    return mapa;
+}
+
+// ============================================================================
+// SIMULACAO EM LOTE (MODO HEADLESS)
+// Joga partidas completas com jogadores controlados por script, sem nenhuma
+// E/S de console dentro do laço do jogo, e agrega os resultados.
+// ============================================================================
+
+void prepararMapaAleatorio(Mapa* mapa, int numJogadores, EstadoRNG* rng) {
+    int numTerritorios = mapa->numTerritorios;
+    uint8_t* dono = mapa->dono;
+    
+    // Garantir que toda cor comece com pelo menos um território (quando possível)
+    for (int i = 0; i < numTerritorios; i++) {
+        dono[i] = (uint8_t)(i % numJogadores);
+        mapa->nomeId[i] = (uint32_t)i;
+    }
+    
+    // Embaralhar a distribuição (Fisher-Yates)
+    for (int i = numTerritorios - 1; i > 0; i--) {
+        int j = (int)aleatorioIntervalo(rng, (uint32_t)(i + 1));
+        uint8_t temp = dono[i];
+        dono[i] = dono[j];
+        dono[j] = temp;
+    }
+    
+    // Mesmas regras do cadastro interativo: 1 a NUM_OPCOES_TROPAS tropas iniciais
+    for (int i = 0; i < numTerritorios; i++) {
+        mapa->tropas[i] = (int32_t)aleatorioIntervalo(rng, NUM_OPCOES_TROPAS) + 1;
+    }
+    
+    // ... seguidas da distribuição adicional de tropas
+    distribuirTropasExtras(mapa, rng, NULL);
+    
+    recalcularContadores(mapa);
+}
+
+// Chance de conquista usada pelo jogador automático (fora da tabela: proporção de tropas)
+static double chanceDeConquista(int tropasAtacante, int tropasDefensor) {
+    const ProbabilidadeBatalha* chance = consultarProbabilidadeBatalha(tropasAtacante, tropasDefensor);
+    if (chance != NULL) {
+        return chance->probVitoria;
+    }
+    return tropasAtacante > tropasDefensor
+        ? (double)tropasAtacante / (tropasAtacante + tropasDefensor) : 0.0;
+}
+
+// Melhor ataque a partir de i entre os vizinhos inimigos (empates: o último na ordem das
+// fronteiras). Entre atacantes diferentes o empate fica com o de maior índice, então o
+// resultado não depende da ordem em que os territórios da cor são visitados.
+static inline void avaliarAtaquesDe(const Mapa* mapa, int i, int dono, double* melhorChance,
+                                    int* atacante, int* defensor) {
+    for (int k = mapa->inicioVizinhos[i]; k < mapa->inicioVizinhos[i + 1]; k++) {
+        int v = mapa->vizinhos[k];
+        if (mapa->dono[v] == dono) continue;
+        double chance = chanceDeConquista(mapa->tropas[i], mapa->tropas[v]);
+        if (chance > *melhorChance || (chance == *melhorChance && i >= *atacante)) {
+            *melhorChance = chance;
+            *atacante = i;
+            *defensor = v;
+        }
     }
 }
 
-int simularAtaque(Territorio* atacante, Territorio* defensor) {
-    if (atacante->tropas <= 1) {
-        printf("%s[!] ERRO: O atacante precisa ter pelo menos 2 tropas para atacar.%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
-        return 0; // Ataque falhou
+// Monte binário de territórios: no topo, a menor chave (empates: o de menor índice).
+// Com chave = tropas dá o inimigo mais fraco; com chave = -tropas, o próprio mais forte.
+typedef struct {
+    int32_t chave;
+    int32_t territorio;
+} EntradaMonte;
+
+static inline int precedeNoMonte(EntradaMonte a, EntradaMonte b) {
+    return a.chave < b.chave || (a.chave == b.chave && a.territorio < b.territorio);
+}
+
+// Desce a entrada da posição 'i' até o lugar dela
+static void descerNoMonte(EntradaMonte* monte, int tamanho, int i) {
+    EntradaMonte entrada = monte[i];
+    while (2 * i + 1 < tamanho) {
+        int filho = 2 * i + 1;
+        if (filho + 1 < tamanho && precedeNoMonte(monte[filho + 1], monte[filho])) {
+            filho++;
+        }
+        if (!precedeNoMonte(monte[filho], entrada)) break;
+        monte[i] = monte[filho];
+        i = filho;
+    }
+    monte[i] = entrada;
+}
+
+static void inserirNoMonte(EntradaMonte* monte, int* tamanho, EntradaMonte entrada) {
+    int i = (*tamanho)++;
+    while (i > 0 && precedeNoMonte(entrada, monte[(i - 1) / 2])) {
+        monte[i] = monte[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    monte[i] = entrada;
+}
+
+// Acrescenta um trecho de territoriosPorCor ao monte (sem ordenar; ver ordenarMonte)
+static int acrescentarAoMonte(const Mapa* mapa, EntradaMonte* monte, int tamanho, int inicio, int fim, int sinal) {
+    for (int p = inicio; p < fim; p++) {
+        int t = mapa->territoriosPorCor[p];
+        monte[tamanho].chave = sinal * mapa->tropas[t];
+        monte[tamanho].territorio = t;
+        tamanho++;
+    }
+    return tamanho;
+}
+
+static void ordenarMonte(EntradaMonte* monte, int tamanho) {
+    for (int i = tamanho / 2 - 1; i >= 0; i--) {
+        descerNoMonte(monte, tamanho, i);
+    }
+}
+
+// Só insiste no ataque enquanto a conquista for mais provável que a derrota
+static inline int ataqueCompensa(const Mapa* mapa, int atacante, int defensor) {
+    const ProbabilidadeBatalha* chance = consultarProbabilidadeBatalha(mapa->tropas[atacante], mapa->tropas[defensor]);
+    return chance != NULL ? chance->probVitoria >= 0.5 : mapa->tropas[atacante] > mapa->tropas[defensor];
+}
+
+// Ataque sem fronteiras em mapas grandes: o mesmo par do laço por bits (próprio mais
+// forte contra inimigo mais fraco), tirado do topo de dois montes montados uma vez a
+// partir do índice por dono. Cada combate só muda o atacante e o defensor, que são
+// os topos; basta reposicioná-los, sem varrer o mapa a cada rodada.
+static void atacarSemFronteirasComMontes(Mapa* mapa, int dono, EstadoRNG* rng, int blitz) {
+    int n = mapa->numTerritorios;
+    EntradaMonte* proprios = (EntradaMonte*)malloc(2 * (size_t)n * sizeof(EntradaMonte));
+    if (proprios == NULL) {
+        printf("Erro: Não foi possível alocar memória para o ataque automático.\n");
+        exit(1);
     }
+    EntradaMonte* inimigos = proprios + n;
+    int inicio = mapa->inicioDoDono[dono];
+    int fim = mapa->inicioDoDono[dono + 1];
+    int numProprios = acrescentarAoMonte(mapa, proprios, 0, inicio, fim, -1);
+    int numInimigos = acrescentarAoMonte(mapa, inimigos, 0, 0, inicio, 1);
+    numInimigos = acrescentarAoMonte(mapa, inimigos, numInimigos, fim, n, 1);
+    ordenarMonte(proprios, numProprios);
+    ordenarMonte(inimigos, numInimigos);
     
-    if (defensor->tropas <= 0) {
-        printf("%s[!] ERRO: O defensor nao possui tropas para defender.%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
-        return 0; // Ataque falhou
+    while (numProprios > 0 && numInimigos > 0) {
+        int atacante = proprios[0].territorio;
+        int defensor = inimigos[0].territorio;
+        if (mapa->tropas[atacante] <= 1 || !ataqueCompensa(mapa, atacante, defensor)) {
+            break;
+        }
+        if (blitz) {
+            resolverBatalha(mapa, atacante, defensor, rng, NULL);
+        } else {
+            resolverCombate(mapa, atacante, defensor, rng, NULL);
+        }
+        
+        // O atacante só perde tropas: desce no monte dos próprios
+        proprios[0].chave = -mapa->tropas[atacante];
+        descerNoMonte(proprios, numProprios, 0);
+        if (mapa->dono[defensor] == dono) {
+            // Conquistado: sai dos inimigos e entra nos próprios com as tropas movidas
+            inimigos[0] = inimigos[--numInimigos];
+            descerNoMonte(inimigos, numInimigos, 0);
+            EntradaMonte conquistado = { -mapa->tropas[defensor], defensor };
+            inserirNoMonte(proprios, &numProprios, conquistado);
+        } else {
+            // O defensor só perde tropas: continua no topo
+            inimigos[0].chave = mapa->tropas[defensor];
+        }
     }
+    free(proprios);
+}
+
+void faseDeAtaqueScriptada(Mapa* mapa, int dono, EstadoRNG* rng, int blitz) {
+    int numTerritorios = mapa->numTerritorios;
+    int numPalavras = (numTerritorios + 63) / 64;
+    const Bitboard* proprios = &mapa->bitsDoDono[dono];
     
-    // Sistema de combate simplificado - máximo 2 dados por jogador
-    int dadosAtacante = (atacante->tropas >= 3) ? 2 : 1;
-    int dadosDefensor = (defensor->tropas >= 2) ? 2 : 1;
+    // Com fronteiras: melhor par (território próprio, vizinho inimigo)
+    while (mapa->inicioVizinhos != NULL) {
+        int atacante = -1;
+        int defensor = -1;
+        double melhorChance = 0.5;
+        if (mapa->vizinhosBits != NULL) {
+            // Só os territórios da cor, na mesma ordem de índice, sem os cercados por aliados
+            for (int w = 0; w < numPalavras; w++) {
+                for (uint64_t bits = proprios->palavras[w]; bits != 0; bits &= bits - 1) {
+                    int i = 64 * w + menorBit(bits);
+                    if (mapa->tropas[i] <= 1 || !temVizinhoInimigo(&mapa->vizinhosBits[i], proprios, numPalavras)) {
+                        continue;
+                    }
+                    avaliarAtaquesDe(mapa, i, dono, &melhorChance, &atacante, &defensor);
+                }
+            }
+        } else {
+            // Mapas grandes: só o grupo da cor no índice por dono
+            for (int p = mapa->inicioDoDono[dono]; p < mapa->inicioDoDono[dono + 1]; p++) {
+                int i = mapa->territoriosPorCor[p];
+                if (mapa->tropas[i] <= 1) continue;
+                avaliarAtaquesDe(mapa, i, dono, &melhorChance, &atacante, &defensor);
+            }
+        }
+        if (atacante < 0) {
+            return; // Nenhum ataque com chance de pelo menos 50%
+        }
+        if (blitz) {
+            resolverBatalha(mapa, atacante, defensor, rng, NULL);
+        } else {
+            resolverCombate(mapa, atacante, defensor, rng, NULL);
+        }
+    }
     
-    // Arrays para armazenar os resultados dos dados
-    int resultadosAtacante[2] = {0, 0};
-    int resultadosDefensor[2] = {0, 0};
+    if (numTerritorios > MAX_TERRITORIOS_BITBOARD) {
+        atacarSemFronteirasComMontes(mapa, dono, rng, blitz);
+        return;
+    }
+    while (1) {
+        // Território mais forte do jogador e território inimigo mais fraco (empates: o de menor índice)
+        int atacante = -1;
+        int defensor = -1;
+        for (int w = 0; w < numPalavras; w++) {
+            for (uint64_t bits = proprios->palavras[w]; bits != 0; bits &= bits - 1) {
+                int i = 64 * w + menorBit(bits);
+                if (atacante < 0 || mapa->tropas[i] > mapa->tropas[atacante]) {
+                    atacante = i;
+                }
+            }
+        }
+        if (atacante < 0 || mapa->tropas[atacante] <= 1) {
+            return; // Sem tropas suficientes para atacar
+        }
+        for (int w = 0; w < numPalavras; w++) {
+            uint64_t inimigos = ~proprios->palavras[w] & mascaraDaPalavra(numTerritorios, w);
+            for (uint64_t bits = inimigos; bits != 0; bits &= bits - 1) {
+                int i = 64 * w + menorBit(bits);
+                if (defensor < 0 || mapa->tropas[i] < mapa->tropas[defensor]) {
+                    defensor = i;
+                }
+            }
+        }
+        if (defensor < 0 || !ataqueCompensa(mapa, atacante, defensor)) {
+            return; // Nenhum inimigo restante, ou conquista menos provável que a derrota
+        }
+        
+        if (blitz) {
+            resolverBatalha(mapa, atacante, defensor, rng, NULL);
+        } else {
+            resolverCombate(mapa, atacante, defensor, rng, NULL);
+        }
+    }
+}
+
+void jogarPartidaAutomatica(Mapa* mapa, const ConfigSimulacao* config, EstadoRNG* rng, ResultadoPartida* resultado) {
+    MotorMissoes missoes;
+    int turno = 1;
+    if (config->posicaoInicial != NULL) {
+        // Todas as partidas partem da mesma posição salva
+        restaurarPosicao(mapa, config->posicaoInicial);
+        missoes = config->missoesIniciais;
+        turno = config->turnoInicial;
+    } else {
+        prepararMapaAleatorio(mapa, config->numJogadores, rng);
+        gerarMissoesDosJogadores(&missoes, mapa, turno, rng);
+    }
+    mapa->missoes = &missoes;
     
-    // Rolar dados do atacante
-    for (int i = 0; i < dadosAtacante; i++) {
-        resultadosAtacante[i] = (rand() % 6) + 1;
+    // Missões em jogo: a base da taxa de sucesso de cada tipo na análise do log
+    if (eventosLocais != NULL) {
+        for (uint32_t ativas = missoes.ativas; ativas != 0; ativas &= ativas - 1) {
+            int cor = 0;
+            while (!(ativas & (1u << cor))) cor++;
+            registrarEvento(EVENTO_MISSAO_ATRIBUIDA, cor, missoes.missoes[cor].corAlvo, missoes.missoes[cor].tipo,
+                            turno, 0, 0, 0);
+        }
     }
     
-    // Rolar dados do defensor
-    for (int i = 0; i < dadosDefensor; i++) {
-        resultadosDefensor[i] = (rand() % 6) + 1;
+    resultado->tipoFim = FIM_SEM_VENCEDOR;
+    resultado->corVencedora = -1;
+    resultado->missaoCumprida = 0;
+    
+    // Mesmo fluxo de turnos do nivelMaster
+    while (turno <= config->maxTurnos) {
+        int corCumpriu = avaliarMissoes(&missoes, mapa);
+        if (corCumpriu != SEM_COR) {
+            resultado->tipoFim = FIM_MISSAO;
+            resultado->missaoCumprida = 1;
+            resultado->corVencedora = corCumpriu;
+            break;
+        }
+        
+        if (jogoTerminou(mapa)) {
+            resultado->tipoFim = FIM_DOMINACAO;
+            resultado->corVencedora = mapa->dono[0];
+            break;
+        }
+        
+        if (turno > 1) {
+            aplicarReforcos(mapa, NULL);
+        }
+        
+        // Cada cor ataca na ordem da lista de cores
+        for (int j = 0; j < config->numJogadores; j++) {
+            faseDeAtaqueScriptada(mapa, j, rng, config->blitz);
+        }
+        
+        turno++;
+        notificarFimDeTurno(&missoes, turno);
     }
     
-    // Ordenar dados em ordem decrescente (maior primeiro)
-    if (dadosAtacante == 2 && resultadosAtacante[0] < resultadosAtacante[1]) {
-        int temp = resultadosAtacante[0];
-        resultadosAtacante[0] = resultadosAtacante[1];
-        resultadosAtacante[1] = temp;
+    mapa->missoes = NULL; // O buffer do mapa é reaproveitado pela próxima partida
+    resultado->turnos = turno - 1;
+    registrarEvento(EVENTO_FIM_PARTIDA, resultado->corVencedora, SEM_COR, resultado->tipoFim, resultado->turnos,
+                    resultado->missaoCumprida ? (int32_t)missoes.missoes[resultado->corVencedora].tipo : -1, 0, 0);
+}
+
+// Intervalo de partidas empacotado em uma palavra: início nos 32 bits altos, fim nos baixos
+static uint64_t empacotarIntervalo(uint32_t inicio, uint32_t fim) {
+    return ((uint64_t)inicio << 32) | fim;
+}
+
+// Retira do início da própria fila um lote de até LOTE_PARTIDAS partidas
+static int retirarLote(TrabalhadorSimulacao* trabalhador, uint32_t* inicio, uint32_t* fim) {
+    uint64_t atual = atomic_load(&trabalhador->intervalo);
+    while (1) {
+        uint32_t primeiro = (uint32_t)(atual >> 32);
+        uint32_t ultimo = (uint32_t)atual;
+        if (primeiro >= ultimo) {
+            return 0;
+        }
+        uint32_t corte = (ultimo - primeiro > LOTE_PARTIDAS) ? primeiro + LOTE_PARTIDAS : ultimo;
+        if (atomic_compare_exchange_weak(&trabalhador->intervalo, &atual, empacotarIntervalo(corte, ultimo))) {
+            *inicio = primeiro;
+            *fim = corte;
+            return 1;
+        }
+    }
+}
+
+// Rouba a metade final da fila de outro trabalhador; retorna 0 se não há o que roubar
+static int roubarPartidas(TrabalhadorSimulacao* ladrao) {
+    for (int passo = 1; passo < ladrao->numTrabalhadores; passo++) {
+        TrabalhadorSimulacao* vitima = &ladrao->grupo[(ladrao->indice + passo) % ladrao->numTrabalhadores];
+        uint64_t atual = atomic_load(&vitima->intervalo);
+        while (1) {
+            uint32_t primeiro = (uint32_t)(atual >> 32);
+            uint32_t ultimo = (uint32_t)atual;
+            if (primeiro >= ultimo || ultimo - primeiro < 2) {
+                break; // Vazia, ou só a partida que a própria vítima vai jogar
+            }
+            uint32_t meio = primeiro + (ultimo - primeiro) / 2;
+            if (atomic_compare_exchange_weak(&vitima->intervalo, &atual, empacotarIntervalo(primeiro, meio))) {
+                // A fila do ladrão está vazia: ninguém a disputa neste momento
+                atomic_store(&ladrao->intervalo, empacotarIntervalo(meio, ultimo));
+                ladrao->estatisticas.roubos++;
+                return 1;
+            }
+        }
     }
+    return 0;
+}
+
+// Corpo de cada trabalhador: joga as próprias partidas e depois rouba das filas alheias
+static void* executarTrabalhador(void* argumento) {
+    TrabalhadorSimulacao* trabalhador = (TrabalhadorSimulacao*)argumento;
+    const ConfigSimulacao* config = trabalhador->config;
+    EstatisticasSimulacao* estatisticas = &trabalhador->estatisticas;
     
-    if (dadosDefensor == 2 && resultadosDefensor[0] < resultadosDefensor[1]) {
-        int temp = resultadosDefensor[0];
-        resultadosDefensor[0] = resultadosDefensor[1];
-        resultadosDefensor[1] = temp;
+    // Buffer de mapa próprio, reutilizado entre as partidas deste trabalhador
+    Mapa* mapa = alocarMapa(config->numTerritorios);
+    if (config->definicao != NULL && config->posicaoInicial == NULL) {
+        associarMapaCompleto(mapa, config->definicao);
     }
+    eventosLocais = trabalhador->eventos;
     
-    printf("\n%s[*] COMBATE EM ANDAMENTO!%s\n", COR_AMARELO_NEGRITO, COR_RESET);
-    printf("---------------------------------------------------------------------\n");
-    printf("%s[ATK] ATACANTE:%s %s (Exercito %s)\n", COR_AZUL, COR_RESET, atacante->nome, atacante->corExercito);
-    printf("      Tropas disponiveis: %d | Dados (%d): ", atacante->tropas, dadosAtacante);
-    for (int i = 0; i < dadosAtacante; i++) {
-        printf("%s%d%s ", COR_AZUL, resultadosAtacante[i], COR_RESET);
+    while (1) {
+        uint32_t inicio, fim;
+        if (!retirarLote(trabalhador, &inicio, &fim)) {
+            if (roubarPartidas(trabalhador)) {
+                continue;
+            }
+            break; // Nenhuma fila com partidas a roubar: o lote está no fim
+        }
+        for (uint32_t p = inicio; p < fim; p++) {
+            // Cada partida tem a sua própria semente, derivada da semente do lote:
+            // o resultado não depende de qual trabalhador jogou a partida
+            EstadoRNG rng;
+            inicializarRNG(&rng, sementeDaPartida(config->semente, (uint64_t)p));
+            if (eventosLocais != NULL) {
+                eventosLocais->partida = p;
+            }
+            
+            ResultadoPartida resultado;
+            jogarPartidaAutomatica(mapa, config, &rng, &resultado);
+            
+            estatisticas->partidas++;
+            estatisticas->fimPorTipo[resultado.tipoFim]++;
+            if (resultado.corVencedora >= 0) {
+                estatisticas->vitoriasPorCor[resultado.corVencedora]++;
+            }
+            estatisticas->missoesCumpridas += resultado.missaoCumprida;
+            estatisticas->totalTurnos += resultado.turnos;
+            if (resultado.turnos < estatisticas->minTurnos) estatisticas->minTurnos = resultado.turnos;
+            if (resultado.turnos > estatisticas->maxTurnos) estatisticas->maxTurnos = resultado.turnos;
+        }
     }
-    printf("\n");
     
-    printf("\n%s[DEF] DEFENSOR:%s %s (Exercito %s)\n", COR_MAGENTA, COR_RESET, defensor->nome, defensor->corExercito);
-    printf("      Tropas disponiveis: %d | Dados (%d): ", defensor->tropas, dadosDefensor);
-    for (int i = 0; i < dadosDefensor; i++) {
-        printf("%s%d%s ", COR_MAGENTA, resultadosDefensor[i], COR_RESET);
+    if (eventosLocais != NULL) {
+        descarregarEventos(eventosLocais);
+        eventosLocais = NULL;
+    }
+    liberarMemoria(mapa);
+    METRICA_ACUMULAR_THREAD();
+    return NULL;
+}
+
+int executarSimulacao(const ConfigSimulacao* config) {
+    int numThreads = config->numThreads > 0 ? config->numThreads : 1;
+    if (numThreads > config->numPartidas) {
+        numThreads = (int)config->numPartidas;
     }
-    printf("\n");
-    printf("---------------------------------------------------------------------\n");
+#ifndef WAR_TEM_THREADS
+    numThreads = 1;
+#endif
     
-    // Comparar dados (maior dado vs maior dado)
-    int perdas_atacante = 0;
-    int perdas_defensor = 0;
+    ArquivoEventos* eventos = NULL;
+    if (config->arquivoEventos != NULL) {
+        eventos = abrirArquivoEventos(config->arquivoEventos, config);
+        if (eventos == NULL) {
+            return 0;
+        }
+    }
     
-    // Primeira comparação (dados maiores)
-    printf("[DUELO 1] Atacante: %s%d%s vs Defensor: %s%d%s -> ", 
-           COR_AZUL, resultadosAtacante[0], COR_RESET, 
-           COR_MAGENTA, resultadosDefensor[0], COR_RESET);
-    if (resultadosAtacante[0] > resultadosDefensor[0]) {
-        perdas_defensor++;
-        printf("%sAtacante vence!%s\n", COR_VERDE_NEGRITO, COR_RESET);
-    } else {
-        perdas_atacante++;
-        printf("%sDefensor vence!%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+    // Partidas divididas em intervalos contíguos iguais, um por trabalhador
+    static TrabalhadorSimulacao trabalhadores[MAX_THREADS_SIMULACAO];
+    uint32_t total = (uint32_t)config->numPartidas;
+    for (int t = 0; t < numThreads; t++) {
+        TrabalhadorSimulacao* trabalhador = &trabalhadores[t];
+        memset(&trabalhador->estatisticas, 0, sizeof(trabalhador->estatisticas));
+        trabalhador->estatisticas.minTurnos = config->maxTurnos;
+        trabalhador->config = config;
+        trabalhador->grupo = trabalhadores;
+        trabalhador->numTrabalhadores = numThreads;
+        trabalhador->indice = t;
+        trabalhador->eventos = NULL;
+        if (eventos != NULL) {
+            trabalhador->eventos = (GravadorEventos*)malloc(sizeof(GravadorEventos));
+            if (trabalhador->eventos == NULL) {
+                printf("Erro: Não foi possível alocar memória para o log de eventos.\n");
+                exit(1);
+            }
+            trabalhador->eventos->arquivo = eventos;
+            trabalhador->eventos->numRegistros = 0;
+        }
+        atomic_store(&trabalhador->intervalo, empacotarIntervalo(
+            (uint32_t)((uint64_t)total * t / numThreads), (uint32_t)((uint64_t)total * (t + 1) / numThreads)));
     }
     
-    // Segunda comparação (se ambos têm 2 dados)
-    if (dadosAtacante == 2 && dadosDefensor == 2) {
-        printf("[DUELO 2] Atacante: %s%d%s vs Defensor: %s%d%s -> ", 
-               COR_AZUL, resultadosAtacante[1], COR_RESET, 
-               COR_MAGENTA, resultadosDefensor[1], COR_RESET);
-        if (resultadosAtacante[1] > resultadosDefensor[1]) {
-            perdas_defensor++;
-            printf("%sAtacante vence!%s\n", COR_VERDE_NEGRITO, COR_RESET);
+    double inicio = tempoAtualSegundos();
+    
+#ifdef WAR_TEM_THREADS
+    pthread_t threads[MAX_THREADS_SIMULACAO];
+    int criada[MAX_THREADS_SIMULACAO] = {0};
+    for (int t = 1; t < numThreads; t++) {
+        // Se a thread não puder ser criada, a fila dela é roubada pelas demais
+        criada[t] = (pthread_create(&threads[t], NULL, executarTrabalhador, &trabalhadores[t]) == 0);
+    }
+    executarTrabalhador(&trabalhadores[0]);
+    for (int t = 1; t < numThreads; t++) {
+        if (criada[t]) {
+            pthread_join(threads[t], NULL);
+        }
+    }
+#else
+    executarTrabalhador(&trabalhadores[0]);
+#endif
+    
+    double segundos = tempoAtualSegundos() - inicio;
+    
+    int gravado = 1;
+    uint64_t numEventos = 0;
+    if (eventos != NULL) {
+        for (int t = 0; t < numThreads; t++) {
+            free(trabalhadores[t].eventos);
+        }
+        numEventos = atomic_load(&eventos->numRegistros);
+        gravado = fecharArquivoEventos(eventos);
+    }
+    
+    // Somar as estatísticas de cada trabalhador (já encerrados: sem travas)
+    EstatisticasSimulacao estatisticas;
+    memset(&estatisticas, 0, sizeof(estatisticas));
+    estatisticas.minTurnos = config->maxTurnos;
+    estatisticas.threads = numThreads;
+    estatisticas.minPartidasThread = -1;
+    for (int t = 0; t < numThreads; t++) {
+        const EstatisticasSimulacao* parcial = &trabalhadores[t].estatisticas;
+        estatisticas.partidas += parcial->partidas;
+        for (int c = 0; c < MAX_CORES; c++) {
+            estatisticas.vitoriasPorCor[c] += parcial->vitoriasPorCor[c];
+        }
+        for (int f = 0; f < 3; f++) {
+            estatisticas.fimPorTipo[f] += parcial->fimPorTipo[f];
+        }
+        estatisticas.missoesCumpridas += parcial->missoesCumpridas;
+        estatisticas.totalTurnos += parcial->totalTurnos;
+        if (parcial->partidas > 0 && parcial->minTurnos < estatisticas.minTurnos) estatisticas.minTurnos = parcial->minTurnos;
+        if (parcial->maxTurnos > estatisticas.maxTurnos) estatisticas.maxTurnos = parcial->maxTurnos;
+        estatisticas.roubos += parcial->roubos;
+        if (estatisticas.minPartidasThread < 0 || parcial->partidas < estatisticas.minPartidasThread) {
+            estatisticas.minPartidasThread = parcial->partidas;
+        }
+        if (parcial->partidas > estatisticas.maxPartidasThread) {
+            estatisticas.maxPartidasThread = parcial->partidas;
+        }
+    }
+    
+    exibirEstatisticasSimulacao(config, &estatisticas, segundos);
+    if (eventos != NULL && gravado) {
+        printf("[EVENTOS] %" PRIu64 " eventos (%.1f MB) gravados em '%s'\n", numEventos,
+               (double)(sizeof(CabecalhoEventos) + numEventos * sizeof(RegistroEvento)) / 1e6, config->arquivoEventos);
+    }
+    return gravado;
+}
+
+void exibirEstatisticasSimulacao(const ConfigSimulacao* config, const EstatisticasSimulacao* estatisticas, double segundos) {
+    double partidas = estatisticas->partidas > 0 ? (double)estatisticas->partidas : 1.0;
+    
+    printf("\n%s================ RESULTADO DA SIMULACAO ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+    printf("Partidas: %ld | Territorios: %d | Jogadores: %d | Limite de turnos: %d\n",
+           estatisticas->partidas, config->numTerritorios, config->numJogadores, config->maxTurnos);
+    printf("Semente: %" PRIu64 "\n", config->semente);
+    if (config->blitz) {
+        printf("Combate: blitz (estado final de cada batalha sorteado da distribuicao exata)\n");
+    }
+    printf("Tempo total: %.3f s | %s%.0f partidas/s%s\n",
+           segundos, COR_VERDE_NEGRITO, segundos > 0.0 ? estatisticas->partidas / segundos : 0.0, COR_RESET);
+    printf("Threads: %d | %.0f partidas/s por thread | partidas por thread: %ld a %ld | roubos de trabalho: %ld\n",
+           estatisticas->threads, segundos > 0.0 ? estatisticas->partidas / segundos / estatisticas->threads : 0.0,
+           estatisticas->minPartidasThread, estatisticas->maxPartidasThread, estatisticas->roubos);
+    
+    printf("\n[VENCEDORES]\n");
+    for (int i = 0; i < config->numJogadores; i++) {
+        printf("  %-10s %10ld (%5.1f%%)\n", nomeDaCor(i),
+               estatisticas->vitoriasPorCor[i], 100.0 * estatisticas->vitoriasPorCor[i] / partidas);
+    }
+    printf("  %-10s %10ld (%5.1f%%)\n", "Nenhum",
+           estatisticas->fimPorTipo[FIM_SEM_VENCEDOR], 100.0 * estatisticas->fimPorTipo[FIM_SEM_VENCEDOR] / partidas);
+    
+    printf("\n[FIM DE PARTIDA]\n");
+    printf("  Dominacao total:  %10ld (%5.1f%%)\n",
+           estatisticas->fimPorTipo[FIM_DOMINACAO], 100.0 * estatisticas->fimPorTipo[FIM_DOMINACAO] / partidas);
+    printf("  Missao cumprida:  %10ld (%5.1f%%)\n",
+           estatisticas->fimPorTipo[FIM_MISSAO], 100.0 * estatisticas->fimPorTipo[FIM_MISSAO] / partidas);
+    printf("  Limite de turnos: %10ld (%5.1f%%)\n",
+           estatisticas->fimPorTipo[FIM_SEM_VENCEDOR], 100.0 * estatisticas->fimPorTipo[FIM_SEM_VENCEDOR] / partidas);
+    
+    printf("\n[DURACAO]\n");
+    printf("  Turnos por partida: media %.2f | min %d | max %d\n",
+           estatisticas->totalTurnos / partidas, estatisticas->minTurnos, estatisticas->maxTurnos);
+    printf("  Taxa de missoes cumpridas: %.1f%%\n", 100.0 * estatisticas->missoesCumpridas / partidas);
+    printf("%s========================================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+}
+
+double tempoAtualSegundos(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ============================================================================
+// LOG DE EVENTOS (--eventos)
+// Registros de tamanho fixo acumulados no buffer de cada thread e gravados em
+// blocos; o motor só paga, sem --eventos, a consulta a um ponteiro da thread.
+// O formato é lido sem interpretação de texto por analisar_eventos.c.
+// ============================================================================
+
+static int gravarCabecalhoEventos(ArquivoEventos* arquivo) {
+    const CabecalhoEventos cabecalho = arquivo->cabecalho;
+#ifdef WAR_TEM_THREADS
+    return pwrite(arquivo->descritor, &cabecalho, sizeof(cabecalho), 0) == (ssize_t)sizeof(cabecalho);
+#else
+    return fseek(arquivo->arquivo, 0, SEEK_SET) == 0 && fwrite(&cabecalho, sizeof(cabecalho), 1, arquivo->arquivo) == 1 &&
+           fseek(arquivo->arquivo, 0, SEEK_END) == 0;
+#endif
+}
+
+ArquivoEventos* abrirArquivoEventos(const char* caminho, const ConfigSimulacao* config) {
+    ArquivoEventos* arquivo = (ArquivoEventos*)calloc(1, sizeof(ArquivoEventos));
+    if (arquivo == NULL) {
+        printf("Erro: Não foi possível alocar memória para o log de eventos.\n");
+        exit(1);
+    }
+    arquivo->caminho = caminho;
+    CabecalhoEventos* cabecalho = &arquivo->cabecalho;
+    memcpy(cabecalho->assinatura, ASSINATURA_EVENTOS, sizeof(cabecalho->assinatura));
+    cabecalho->versao = VERSAO_EVENTOS;
+    cabecalho->tamanhoRegistro = sizeof(RegistroEvento);
+    cabecalho->semente = config->semente;
+    cabecalho->numTerritorios = config->numTerritorios;
+    cabecalho->numJogadores = config->numJogadores;
+    cabecalho->maxTurnos = config->maxTurnos;
+    cabecalho->blitz = config->blitz;
+    atomic_init(&arquivo->fim, sizeof(CabecalhoEventos));
+    atomic_init(&arquivo->numRegistros, 0);
+    atomic_init(&arquivo->erro, 0);
+    
+#ifdef WAR_TEM_THREADS
+    arquivo->descritor = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    int aberto = (arquivo->descritor >= 0);
+#else
+    arquivo->arquivo = fopen(caminho, "wb");
+    int aberto = (arquivo->arquivo != NULL);
+#endif
+    // Cabeçalho provisório (numRegistros = 0) até o fechamento
+    if (!aberto || !gravarCabecalhoEventos(arquivo)) {
+        printf("%s[ERRO] Nao foi possivel criar o log de eventos '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+        if (aberto) {
+#ifdef WAR_TEM_THREADS
+            close(arquivo->descritor);
+#else
+            fclose(arquivo->arquivo);
+#endif
+        }
+        free(arquivo);
+        return NULL;
+    }
+    return arquivo;
+}
+
+int fecharArquivoEventos(ArquivoEventos* arquivo) {
+    arquivo->cabecalho.numRegistros = atomic_load(&arquivo->numRegistros);
+    int gravado = !atomic_load(&arquivo->erro) && gravarCabecalhoEventos(arquivo);
+#ifdef WAR_TEM_THREADS
+    gravado = (close(arquivo->descritor) == 0) && gravado;
+#else
+    gravado = (fclose(arquivo->arquivo) == 0) && gravado;
+#endif
+    if (!gravado) {
+        printf("%s[ERRO] Falha ao gravar o log de eventos '%s'.%s\n", COR_VERMELHO_NEGRITO, arquivo->caminho, COR_RESET);
+    }
+    free(arquivo);
+    return gravado;
+}
+
+void descarregarEventos(GravadorEventos* gravador) {
+    ArquivoEventos* arquivo = gravador->arquivo;
+    size_t bytes = (size_t)gravador->numRegistros * sizeof(RegistroEvento);
+    if (bytes == 0) {
+        return;
+    }
+#ifdef WAR_TEM_THREADS
+    // O trecho do arquivo é reservado de uma vez; cada thread grava o seu sem esperar as demais
+    uint64_t deslocamento = atomic_fetch_add(&arquivo->fim, (uint64_t)bytes);
+    const char* dados = (const char*)gravador->registros;
+    size_t escritos = 0;
+    while (escritos < bytes) {
+        ssize_t n = pwrite(arquivo->descritor, dados + escritos, bytes - escritos, (off_t)(deslocamento + escritos));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            atomic_store(&arquivo->erro, 1);
+            break;
+        }
+        escritos += (size_t)n;
+    }
+#else
+    if (fwrite(gravador->registros, bytes, 1, arquivo->arquivo) != 1) {
+        atomic_store(&arquivo->erro, 1);
+    }
+#endif
+    atomic_fetch_add(&arquivo->numRegistros, (uint64_t)gravador->numRegistros);
+    gravador->numRegistros = 0;
+}
+
+static inline void registrarEvento(TipoEvento tipo, int cor, int corAlvo, int detalhe,
+                                   int32_t valor0, int32_t valor1, int32_t valor2, int32_t valor3) {
+    GravadorEventos* gravador = eventosLocais;
+    if (gravador == NULL) {
+        return;
+    }
+    RegistroEvento* registro = &gravador->registros[gravador->numRegistros];
+    registro->tipo = (uint8_t)tipo;
+    registro->cor = (uint8_t)cor;       // SEM_COR vira COR_EVENTO_NENHUMA
+    registro->corAlvo = (uint8_t)corAlvo;
+    registro->detalhe = (uint8_t)detalhe;
+    registro->partida = gravador->partida;
+    registro->valores[0] = valor0;
+    registro->valores[1] = valor1;
+    registro->valores[2] = valor2;
+    registro->valores[3] = valor3;
+    if (++gravador->numRegistros == TAM_BUFFER_EVENTOS) {
+        descarregarEventos(gravador);
+    }
+}
+
+// ============================================================================
+// INSTRUMENTACAO (METRICAS)
+// Cada thread acumula na sua cópia de MetricasJogo, sem travas nem atômicos;
+// as cópias são somadas ao total do programa quando a thread termina e o
+// total é gravado em JSON ao sair (--metricas-json).
+// ============================================================================
+
+#ifdef WAR_COM_METRICAS
+
+// Total do programa: threads já encerradas (e a principal, ao gravar)
+static MetricasJogo metricasTotais;
+#ifdef WAR_TEM_THREADS
+static pthread_mutex_t travaMetricas = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+static const char* const NOMES_FASES[NUM_FASES] = { "preparacao", "reforcos", "ataques", "missoes" };
+
+// Faixa de potência de 2 de um valor (0; 1; 2-3; 4-7; ...): número de bits significativos
+static inline int faixaHistograma(int valor) {
+    if (valor <= 0) {
+        return 0;
+    }
+#ifdef __GNUC__
+    int faixa = 32 - __builtin_clz((unsigned)valor);
+#else
+    int faixa = 0;
+    for (unsigned v = (unsigned)valor; v != 0; v >>= 1) faixa++;
+#endif
+    return faixa < NUM_FAIXAS_HISTOGRAMA ? faixa : NUM_FAIXAS_HISTOGRAMA - 1;
+}
+
+static inline void encerrarBatalhaEmCurso(MetricasJogo* metricas) {
+    if (metricas->rodadasEmCurso == 0) {
+        return;
+    }
+    metricas->rodadasPorBatalha[faixaHistograma(metricas->rodadasEmCurso)]++;
+    metricas->perdasAtacantePorBatalha[faixaHistograma(metricas->perdasAtacanteEmCurso)]++;
+    metricas->perdasDefensorPorBatalha[faixaHistograma(metricas->perdasDefensorEmCurso)]++;
+    metricas->rodadasEmCurso = 0;
+}
+
+static inline void registrarRodadaMetricas(const Mapa* mapa, int atacante, int defensor, int perdasAtacante,
+                                           int perdasDefensor, int fimDaBatalha) {
+    MetricasJogo* metricas = &metricasLocais;
+    if (metricas->rodadasEmCurso > 0 &&
+        (metricas->mapaEmCurso != mapa || metricas->atacanteEmCurso != atacante || metricas->defensorEmCurso != defensor)) {
+        encerrarBatalhaEmCurso(metricas); // O jogador passou a outro par
+    }
+    if (metricas->rodadasEmCurso == 0) {
+        metricas->ataques++;
+        metricas->mapaEmCurso = mapa;
+        metricas->atacanteEmCurso = atacante;
+        metricas->defensorEmCurso = defensor;
+        metricas->perdasAtacanteEmCurso = 0;
+        metricas->perdasDefensorEmCurso = 0;
+    }
+    metricas->rodadas++;
+    metricas->rodadasEmCurso++;
+    metricas->perdasAtacanteEmCurso += perdasAtacante;
+    metricas->perdasDefensorEmCurso += perdasDefensor;
+    if (fimDaBatalha) {
+        encerrarBatalhaEmCurso(metricas);
+    }
+}
+
+static inline void registrarBatalhaMetricas(int perdasAtacante, int perdasDefensor, int conquistou) {
+    MetricasJogo* metricas = &metricasLocais;
+    encerrarBatalhaEmCurso(metricas);
+    metricas->ataques++;
+    metricas->batalhasBlitz++;
+    metricas->conquistas += (uint64_t)conquistou;
+    metricas->perdasAtacantePorBatalha[faixaHistograma(perdasAtacante)]++;
+    metricas->perdasDefensorPorBatalha[faixaHistograma(perdasDefensor)]++;
+}
+
+void encerrarFaseMetricas(FaseJogo fase, double inicio) {
+    double segundos = tempoAtualSegundos() - inicio;
+    metricasLocais.vezesFase[fase]++;
+    metricasLocais.segundosFase[fase] += segundos;
+    if (segundos > metricasLocais.maxSegundosFase[fase]) {
+        metricasLocais.maxSegundosFase[fase] = segundos;
+    }
+}
+
+void acumularMetricasDaThread(void) {
+    MetricasJogo* local = &metricasLocais;
+    encerrarBatalhaEmCurso(local);
+#ifdef WAR_TEM_THREADS
+    pthread_mutex_lock(&travaMetricas);
+#endif
+    MetricasJogo* total = &metricasTotais;
+    total->ataques += local->ataques;
+    total->rodadas += local->rodadas;
+    total->batalhasBlitz += local->batalhasBlitz;
+    total->conquistas += local->conquistas;
+    total->reforcos += local->reforcos;
+    total->tropasReforco += local->tropasReforco;
+    for (int f = 0; f < NUM_FASES; f++) {
+        total->vezesFase[f] += local->vezesFase[f];
+        total->segundosFase[f] += local->segundosFase[f];
+        if (local->maxSegundosFase[f] > total->maxSegundosFase[f]) {
+            total->maxSegundosFase[f] = local->maxSegundosFase[f];
+        }
+    }
+    for (int k = 0; k < NUM_FAIXAS_HISTOGRAMA; k++) {
+        total->rodadasPorBatalha[k] += local->rodadasPorBatalha[k];
+        total->perdasAtacantePorBatalha[k] += local->perdasAtacantePorBatalha[k];
+        total->perdasDefensorPorBatalha[k] += local->perdasDefensorPorBatalha[k];
+    }
+#ifdef WAR_TEM_THREADS
+    pthread_mutex_unlock(&travaMetricas);
+#endif
+    memset(local, 0, sizeof(*local));
+}
+
+static void gravarHistogramaJson(FILE* arquivo, const char* nome, const uint64_t* faixas, int ultimo) {
+    fprintf(arquivo, "    \"%s\": [", nome);
+    for (int k = 0; k < NUM_FAIXAS_HISTOGRAMA; k++) {
+        fprintf(arquivo, "%s%" PRIu64, k > 0 ? ", " : "", faixas[k]);
+    }
+    fprintf(arquivo, "]%s\n", ultimo ? "" : ",");
+}
+
+int gravarMetricasJson(const char* caminho) {
+    acumularMetricasDaThread(); // Inclui o que a thread principal acumulou
+    
+    FILE* arquivo = fopen(caminho, "w");
+    if (arquivo == NULL) {
+        fprintf(stderr, "[ERRO] Nao foi possivel criar o arquivo de metricas '%s'.\n", caminho);
+        return 0;
+    }
+    const MetricasJogo* total = &metricasTotais;
+    fprintf(arquivo, "{\n  \"contadores\": {\n");
+    fprintf(arquivo, "    \"ataques\": %" PRIu64 ",\n", total->ataques);
+    fprintf(arquivo, "    \"rodadas\": %" PRIu64 ",\n", total->rodadas);
+    fprintf(arquivo, "    \"batalhas_blitz\": %" PRIu64 ",\n", total->batalhasBlitz);
+    fprintf(arquivo, "    \"conquistas\": %" PRIu64 ",\n", total->conquistas);
+    fprintf(arquivo, "    \"reforcos\": %" PRIu64 ",\n", total->reforcos);
+    fprintf(arquivo, "    \"tropas_reforco\": %" PRIu64 "\n  },\n", total->tropasReforco);
+    
+    fprintf(arquivo, "  \"fases\": {\n");
+    for (int f = 0; f < NUM_FASES; f++) {
+        fprintf(arquivo, "    \"%s\": {\"vezes\": %" PRIu64 ", \"segundos\": %.6f, \"max_segundos\": %.6f}%s\n",
+                NOMES_FASES[f], total->vezesFase[f], total->segundosFase[f], total->maxSegundosFase[f],
+                f + 1 < NUM_FASES ? "," : "");
+    }
+    fprintf(arquivo, "  },\n");
+    
+    fprintf(arquivo, "  \"histogramas\": {\n    \"limites_inferiores\": [0");
+    for (int k = 1; k < NUM_FAIXAS_HISTOGRAMA; k++) {
+        fprintf(arquivo, ", %d", 1 << (k - 1));
+    }
+    fprintf(arquivo, "],\n");
+    gravarHistogramaJson(arquivo, "rodadas_por_batalha", total->rodadasPorBatalha, 0);
+    gravarHistogramaJson(arquivo, "perdas_atacante_por_batalha", total->perdasAtacantePorBatalha, 0);
+    gravarHistogramaJson(arquivo, "perdas_defensor_por_batalha", total->perdasDefensorPorBatalha, 1);
+    fprintf(arquivo, "  }\n}\n");
+    
+    int ok = (fclose(arquivo) == 0);
+    if (!ok) {
+        fprintf(stderr, "[ERRO] Falha ao gravar o arquivo de metricas '%s'.\n", caminho);
+    }
+    return ok;
+}
+
+static const char* arquivoMetricasAoSair = NULL;
+
+static void gravarMetricasAoSair(void) {
+    if (arquivoMetricasAoSair != NULL) {
+        gravarMetricasJson(arquivoMetricasAoSair);
+    }
+}
+
+void agendarMetricasJson(const char* caminho) {
+    if (arquivoMetricasAoSair == NULL) {
+        atexit(gravarMetricasAoSair);
+    }
+    arquivoMetricasAoSair = caminho;
+}
+
+#endif // WAR_COM_METRICAS
+
+// ============================================================================
+// INTELIGENCIA ARTIFICIAL - BUSCA EM ARVORE MONTE CARLO (MCTS)
+// Uma ação é uma rodada de combate (a mesma unidade que o jogador escolhe e
+// que o log grava) ou encerrar os ataques. A IA usa o seu próprio gerador,
+// então as partidas gravadas continuam reproduzíveis.
+// ============================================================================
+
+int numeroDeNucleos(void) {
+#ifdef WAR_TEM_THREADS
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    if (nucleos >= 1) return (int)nucleos;
+#endif
+    return 1;
+}
+
+// Ações possíveis por posição: encerrar + uma por aresta (ou par, sem fronteiras)
+static int32_t numIndicesAcaoIA(const Mapa* mapa) {
+    int32_t n = mapa->numTerritorios;
+    return 1 + (mapa->inicioVizinhos != NULL ? mapa->inicioVizinhos[n] : n * n);
+}
+
+// Lista as ações válidas da cor, começando por encerrar
+static int gerarAcoesIA(const Mapa* mapa, int cor, AcaoIA* acoes) {
+    int32_t n = mapa->numTerritorios;
+    int total = 0;
+    acoes[total++] = (AcaoIA){ -1, -1, 0 };
+    if (n <= MAX_TERRITORIOS_BITBOARD) {
+        // Ações em ordem de índice, percorrendo só os bits da cor
+        int numPalavras = (n + 63) / 64;
+        const Bitboard* proprios = &mapa->bitsDoDono[cor];
+        for (int w = 0; w < numPalavras; w++) {
+            for (uint64_t bits = proprios->palavras[w]; bits != 0; bits &= bits - 1) {
+                int32_t i = 64 * w + menorBit(bits);
+                if (mapa->tropas[i] <= 1) continue;
+                if (mapa->inicioVizinhos != NULL) {
+                    if (mapa->vizinhosBits != NULL &&
+                        !temVizinhoInimigo(&mapa->vizinhosBits[i], proprios, numPalavras)) continue;
+                    for (int32_t k = mapa->inicioVizinhos[i]; k < mapa->inicioVizinhos[i + 1]; k++) {
+                        if (mapa->dono[mapa->vizinhos[k]] != cor) {
+                            acoes[total++] = (AcaoIA){ i, mapa->vizinhos[k], 1 + k };
+                        }
+                    }
+                } else {
+                    for (int x = 0; x < numPalavras; x++) {
+                        uint64_t inimigos = ~proprios->palavras[x] & mascaraDaPalavra(n, x);
+                        for (uint64_t alvos = inimigos; alvos != 0; alvos &= alvos - 1) {
+                            int32_t v = 64 * x + menorBit(alvos);
+                            acoes[total++] = (AcaoIA){ i, v, 1 + i * n + v };
+                        }
+                    }
+                }
+            }
+        }
+        return total;
+    }
+    // Mapas grandes: os territórios da cor e os alvos saem dos grupos do índice por dono
+    // (a ordem das ações segue a do índice, não a dos números dos territórios)
+    int32_t inicio = mapa->inicioDoDono[cor];
+    int32_t fim = mapa->inicioDoDono[cor + 1];
+    for (int32_t p = inicio; p < fim; p++) {
+        int32_t i = mapa->territoriosPorCor[p];
+        if (mapa->tropas[i] <= 1) continue;
+        if (mapa->inicioVizinhos != NULL) {
+            for (int32_t k = mapa->inicioVizinhos[i]; k < mapa->inicioVizinhos[i + 1]; k++) {
+                if (mapa->dono[mapa->vizinhos[k]] != cor) {
+                    acoes[total++] = (AcaoIA){ i, mapa->vizinhos[k], 1 + k };
+                }
+            }
         } else {
-            perdas_atacante++;
-            printf("%sDefensor vence!%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+            // Alvos: os grupos antes e depois do grupo da cor
+            const int32_t trechos[2][2] = { { 0, inicio }, { fim, n } };
+            for (int t = 0; t < 2; t++) {
+                for (int32_t q = trechos[t][0]; q < trechos[t][1]; q++) {
+                    int32_t v = mapa->territoriosPorCor[q];
+                    acoes[total++] = (AcaoIA){ i, v, 1 + i * n + v };
+                }
+            }
         }
     }
-    
-    // Aplicar perdas
-    atacante->tropas -= perdas_atacante;
-    defensor->tropas -= perdas_defensor;
-    
-    printf("\n%s[RESULTADO]%s Perdas: Atacante %s-%d%s, Defensor %s-%d%s\n", 
-           COR_AMARELO_NEGRITO, COR_RESET,
-           COR_VERMELHO, perdas_atacante, COR_RESET,
-           COR_VERMELHO, perdas_defensor, COR_RESET);
-    
-    if (defensor->tropas == 0) {
-        // Território conquistado
-        printf("\n%s[***] CONQUISTA TOTAL! [***]%s\n", COR_VERDE_NEGRITO, COR_RESET);
-        printf("      %s%s conquistou completamente %s!%s\n", COR_VERDE, atacante->nome, defensor->nome, COR_RESET);
-        printf("      Transferindo controle do territorio...\n");
-        
-        strcpy(defensor->corExercito, atacante->corExercito);
-        defensor->tropas = atacante->tropas - 1;
-        atacante->tropas = 1;
-        
-        printf("      %s%s agora pertence ao exercito %s com %d tropas!%s\n", 
-               COR_VERDE, defensor->nome, defensor->corExercito, defensor->tropas, COR_RESET);
-        return 2; // Território conquistado
-    } else if (atacante->tropas <= 1) {
-        printf("      %sAtacante nao tem mais tropas suficientes para continuar.%s\n", COR_VERMELHO, COR_RESET);
-        printf("      %s%s mantem o controle com %d tropa(s).%s\n", COR_CIANO, defensor->nome, defensor->tropas, COR_RESET);
-        return 0; // Ataque falhou
-    } else {
-        printf("      %s%s ainda pode continuar atacando com %d tropa(s).%s\n", COR_AZUL, atacante->nome, atacante->tropas, COR_RESET);
-        printf("      %s%s mantem o controle com %d tropa(s).%s\n", COR_MAGENTA, defensor->nome, defensor->tropas, COR_RESET);
-        return 1; // Ataque bem-sucedido
+    return total;
+}
+
+// Uma ação da árvore continua válida no estado sorteado? (fronteiras não mudam)
+static int acaoValidaIA(const Mapa* mapa, int cor, const AcaoIA* acao) {
+    return acao->atacante < 0 ||
+           (mapa->dono[acao->atacante] == cor && mapa->tropas[acao->atacante] > 1 &&
+            mapa->dono[acao->defensor] != cor);
+}
+
+// Recompensa da cor: 1 = domínio total, 0 = eliminada; senão, fatia de territórios e tropas
+static double avaliarPosicaoIA(const Mapa* mapa, int cor) {
+    int32_t territorios = mapa->territoriosPorDono[cor];
+    if (territorios == 0) return 0.0;
+    if (territorios == mapa->numTerritorios) return 1.0;
+    int64_t tropasTotais = 0;
+    for (int c = 0; c < MAX_CORES; c++) {
+        tropasTotais += mapa->tropasPorDono[c];
     }
+    return 0.5 * territorios / mapa->numTerritorios +
+           0.5 * (double)mapa->tropasPorDono[cor] / (double)(tropasTotais > 0 ? tropasTotais : 1);
 }
 
-void faseDeAtaque(Territorio* territorios, int numTerritorios) {
-    printf("\n[*] FASE DE COMBATE [*]\n");
-    printf("=======================================================================\n");
-    printf("[*] INSTRUCOES:\n");
-    printf("   - Escolha um territorio atacante (deve ter pelo menos 2 tropas)\n");
-    printf("   - Escolha um territorio defensor (cor diferente do atacante)\n");
-    printf("   - Digite -1 para encerrar a fase de ataques\n");
-    printf("=======================================================================\n");
-    
-    int atacanteIdx, defensorIdx;
-    
-    while (1) {
-        // Verificar se o jogo terminou
-        if (verificarFimDeJogo(territorios, numTerritorios)) {
-            printf("\n[***] FIM DE JOGO! [***]\n");
-            printf("Todos os territorios pertencem ao mesmo exercito!\n");
-            break;
-        }
-        
-        printf("\n[INFO] SITUACAO ATUAL DO CAMPO DE BATALHA:\n");
-        exibirMapa(territorios, numTerritorios);
-        
-        printf("\n[ATK] Escolha o territorio ATACANTE (1-%d) ou -1 para parar: ", numTerritorios);
-        if (scanf("%d", &atacanteIdx) != 1) {
-            limparBufferEntrada();
-            printf("[!] Entrada invalida!\n");
-            continue;
-        }
-        limparBufferEntrada();
-        
-        if (atacanteIdx == -1) {
-            printf("\n[END] Fase de ataques encerrada.\n");
-            break;
-        }
-        
-        if (atacanteIdx < 1 || atacanteIdx > numTerritorios) {
-            printf("[!] Territorio invalido!\n");
-            continue;
-        }
-        
-        if (territorios[atacanteIdx - 1].tropas <= 1) {
-            printf("[!] O territorio '%s' nao tem tropas suficientes para atacar!\n", territorios[atacanteIdx - 1].nome);
-            continue;
-        }
-        
-        printf("[DEF] Escolha o territorio DEFENSOR (1-%d): ", numTerritorios);
-        if (scanf("%d", &defensorIdx) != 1) {
-            limparBufferEntrada();
-            printf("[!] Entrada invalida!\n");
-            continue;
-        }
-        limparBufferEntrada();
-        
-        if (defensorIdx < 1 || defensorIdx > numTerritorios) {
-            printf("[!] Territorio invalido!\n");
-            continue;
+// Completa o turno e simula HORIZONTE_IA turnos com os jogadores por script
+static double simularRestanteIA(Mapa* mapa, int cor, int turnoEmAndamento, EstadoRNG* rng) {
+    if (turnoEmAndamento) {
+        faseDeAtaqueScriptada(mapa, cor, rng, 0);
+    }
+    for (int j = cor + 1; j < MAX_CORES && !jogoTerminou(mapa); j++) {
+        if (mapa->territoriosPorDono[j] > 0) {
+            faseDeAtaqueScriptada(mapa, j, rng, 0);
         }
-        
-        if (atacanteIdx == defensorIdx) {
-            printf("[!] Um territorio nao pode atacar a si mesmo!\n");
-            continue;
+    }
+    for (int h = 0; h < HORIZONTE_IA && !jogoTerminou(mapa); h++) {
+        aplicarReforcos(mapa, NULL);
+        for (int j = 0; j < MAX_CORES; j++) {
+            if (mapa->territoriosPorDono[j] > 0) {
+                faseDeAtaqueScriptada(mapa, j, rng, 0);
+            }
         }
-        
-        if (strcmp(territorios[atacanteIdx - 1].corExercito, territorios[defensorIdx - 1].corExercito) == 0) {
-            printf("[!] Territorios aliados nao podem se atacar!\n");
-            continue;
+    }
+    return avaliarPosicaoIA(mapa, cor);
+}
+
+// Acrescenta um nó ao pool e o liga como primeiro filho de pai (índices, não ponteiros: o pool cresce)
+static int32_t novoNoMCTS(BuscaMCTS* busca, int32_t pai, AcaoIA acao) {
+    if (busca->numNos == busca->capacidadeNos) {
+        int32_t capacidade = busca->capacidadeNos > 0 ? busca->capacidadeNos * 2 : 1024;
+        NoMCTS* nos = (NoMCTS*)realloc(busca->nos, (size_t)capacidade * sizeof(NoMCTS));
+        if (nos == NULL) {
+            printf("Erro: Não foi possível alocar memória para a árvore da IA.\n");
+            exit(1);
         }
-        
-        // Executar o ataque
-        printf("\n[*] INICIANDO COMBATE...\n");
-        simularAtaque(&territorios[atacanteIdx - 1], &territorios[defensorIdx - 1]);
-        
-        printf("\n[PAUSE] Pressione Enter para continuar...");
-        getchar();
+        busca->nos = nos;
+        busca->capacidadeNos = capacidade;
     }
+    int32_t indice = busca->numNos++;
+    NoMCTS* no = &busca->nos[indice];
+    no->acao = acao;
+    no->primeiroFilho = -1;
+    no->proximoIrmao = -1;
+    no->visitas = 0;
+    no->somaRecompensas = 0.0;
+    if (pai >= 0) {
+        no->proximoIrmao = busca->nos[pai].primeiroFilho;
+        busca->nos[pai].primeiroFilho = indice;
+    }
+    return indice;
 }
 
-// ============================================================================
-// FUNCOES DO NIVEL MASTER - SISTEMA DE CARTAS E MISSOES
-// ============================================================================
+// Recompensa em ponto fixo de 16 bits: até 65535 simulações somadas cabem nos 32 bits baixos
+#define ESCALA_RECOMPENSA 65535.0
+#define MAX_AMOSTRAS_TRANSPOSICAO 65535u
 
-void nivelMaster(void) {
-    printf("\n================ JOGO WAR - NIVEL MASTER ================\n");
-    printf("Bem-vindo ao nivel Master com sistema de missoes!\n");
-    printf("=========================================================\n");
-    
-    // Solicitar número de territórios
-    int numTerritorios = selecionarNumeroTerritorios();
-    
-    // Alocação dinâmica de memória para territórios
-    Territorio* territorios = alocarMapa(numTerritorios);
-    
-    // Cadastro dos territórios
-    cadastrarTerritorios(territorios, numTerritorios);
-    
-    // Gerar missão aleatória para o jogador
-    Missao missaoJogador;
-    gerarMissaoAleatoria(&missaoJogador, territorios, numTerritorios);
-    
-    printf("\n" COR_AMARELO_NEGRITO "================ SUA MISSAO ================\n" COR_RESET);
-    exibirMissao(&missaoJogador);
-    printf(COR_AMARELO_NEGRITO "============================================\n" COR_RESET);
-    
-    printf("\n[PAUSE] Pressione Enter para iniciar o jogo...");
-    getchar();
+// Média das simulações de uma posição, se já houver AMOSTRAS_TRANSPOSICAO delas
+static int consultarTransposicao(TabelaTransposicao* tabela, uint64_t hash, double* recompensa) {
+    EntradaTransposicao* entrada = &tabela->entradas[hash & tabela->mascara];
+    uint64_t dados = atomic_load_explicit(&entrada->dados, memory_order_relaxed);
+    uint64_t chave = atomic_load_explicit(&entrada->chave, memory_order_relaxed);
+    uint32_t amostras = (uint32_t)(dados >> 32);
+    if ((chave ^ dados) != hash || amostras < AMOSTRAS_TRANSPOSICAO) {
+        return 0;
+    }
+    *recompensa = (double)(uint32_t)dados / ESCALA_RECOMPENSA / amostras;
+    return 1;
+}
+
+// Soma uma simulação à entrada da posição (substitui a entrada de outra posição);
+// corridas entre threads só perdem amostras, nunca misturam posições
+static void registrarTransposicao(TabelaTransposicao* tabela, uint64_t hash, double recompensa) {
+    EntradaTransposicao* entrada = &tabela->entradas[hash & tabela->mascara];
+    uint64_t dados = atomic_load_explicit(&entrada->dados, memory_order_relaxed);
+    uint64_t chave = atomic_load_explicit(&entrada->chave, memory_order_relaxed);
+    if ((chave ^ dados) != hash) {
+        dados = 0;
+    }
+    if ((dados >> 32) >= MAX_AMOSTRAS_TRANSPOSICAO) {
+        return;
+    }
+    dados += (1ULL << 32) + (uint64_t)(recompensa * ESCALA_RECOMPENSA + 0.5);
+    atomic_store_explicit(&entrada->dados, dados, memory_order_relaxed);
+    atomic_store_explicit(&entrada->chave, hash ^ dados, memory_order_relaxed);
+}
+
+// Memória de trabalho de uma thread (reutilizada entre iterações)
+typedef struct {
+    Mapa* mapa;                         // Cópia da raiz com os dados sorteados
+    EstadoRNG rng;                      // Gerador da thread
+    AcaoIA* acoes;                      // Ações válidas no estado atual
+    uint32_t* marca;                    // Ações que já têm filho no nó atual (por carimbo)
+    uint32_t carimbo;
+} TrabalhoMCTS;
+
+// Uma iteração: seleção (UCT) e expansão na árvore, simulação e retropropagação
+static void iterarMCTS(BuscaMCTS* busca, TrabalhoMCTS* trabalho) {
+    Mapa* mapa = trabalho->mapa;
+    restaurarPosicao(mapa, busca->raiz);
+    mapa->hash = busca->hashRaiz;
     
-    // Loop principal do jogo Master com sistema de missões
-    int turno = 1;
+    int32_t caminho[PROFUNDIDADE_MAX_MCTS + 1];
+    int profundidade = 0;
+    int32_t atual = 0;
+    caminho[profundidade++] = atual;
+    int turnoEmAndamento = 1;
     
-    while (turno <= 15) {  // Máximo 15 turnos (ajustado para mais territórios)
-        printf("\n================ TURNO %d - NIVEL MASTER ================\n", turno);
-        
-        // Exibir mapa atual
-        exibirMapa(territorios, numTerritorios);
-        
-        // Exibir missão atual
-        printf("\n" COR_CIANO "--- SUA MISSAO ATUAL ---\n" COR_RESET);
-        exibirMissao(&missaoJogador);
+    while (turnoEmAndamento && profundidade <= PROFUNDIDADE_MAX_MCTS) {
+        int numAcoes = gerarAcoesIA(mapa, busca->cor, trabalho->acoes);
+        uint32_t carimbo = ++trabalho->carimbo;
         
-        // Verificar se a missão foi cumprida
-        if (verificarMissao(&missaoJogador, territorios, numTerritorios, turno)) {
-            printf("\n" COR_VERDE_NEGRITO "[***] PARABENS! MISSAO CUMPRIDA! [***]\n" COR_RESET);
-            printf(COR_VERDE "Voce venceu o jogo completando sua missao!\n" COR_RESET);
-            break;
+        // UCT entre os filhos válidos neste sorteio
+        int32_t escolhido = -1;
+        int filhosValidos = 0;
+        double melhorValor = -1.0;
+        double logPai = log((double)busca->nos[atual].visitas + 1.0);
+        for (int32_t f = busca->nos[atual].primeiroFilho; f >= 0; f = busca->nos[f].proximoIrmao) {
+            const NoMCTS* filho = &busca->nos[f];
+            if (!acaoValidaIA(mapa, busca->cor, &filho->acao)) continue;
+            trabalho->marca[filho->acao.indice] = carimbo;
+            filhosValidos++;
+            double valor = filho->somaRecompensas / filho->visitas +
+                           EXPLORACAO_MCTS * sqrt(logPai / filho->visitas);
+            if (valor > melhorValor) {
+                melhorValor = valor;
+                escolhido = f;
+            }
         }
         
-        // Verificar se o jogo terminou por dominação total
-        if (verificarFimDeJogo(territorios, numTerritorios)) {
-            printf("\n[***] FIM DE JOGO POR DOMINACAO TOTAL! [***]\n");
-            printf("Todos os territorios pertencem ao mesmo exercito!\n");
-            break;
+        // Expansão: a primeira ação válida ainda sem nó
+        int expandiu = 0;
+        if (filhosValidos < numAcoes) {
+            for (int a = 0; a < numAcoes; a++) {
+                if (trabalho->marca[trabalho->acoes[a].indice] != carimbo) {
+                    escolhido = novoNoMCTS(busca, atual, trabalho->acoes[a]);
+                    expandiu = 1;
+                    break;
+                }
+            }
         }
         
-        // Fase de reforços (a partir do turno 2)
-        if (turno > 1) {
-            faseDeReforcos(territorios, numTerritorios);
+        atual = escolhido;
+        caminho[profundidade++] = atual;
+        AcaoIA acao = busca->nos[atual].acao;
+        if (acao.atacante < 0) {
+            turnoEmAndamento = 0;
+        } else {
+            resolverCombate(mapa, acao.atacante, acao.defensor, &trabalho->rng, NULL);
+            turnoEmAndamento = !jogoTerminou(mapa);
+        }
+        if (expandiu) {
+            break;
         }
-        
-        // Fase de ataques
-        printf("\n[FASE DE ATAQUES]\n");
-        faseDeAtaque(territorios, numTerritorios);
-        
-        turno++;
-        
-        printf("\n[PAUSE] Pressione Enter para continuar para o proximo turno...");
-        getchar();
     }
     
-    // Resultado final
-    printf("\n================ RESULTADO FINAL - NIVEL MASTER ================\n");
-    exibirMapa(territorios, numTerritorios);
-    
-    printf("\n[ESTATISTICAS FINAIS]\n");
-    printf("- Turnos jogados: %d\n", turno - 1);
-    printf("- Territorios no jogo: %d\n", numTerritorios);
-    
-    if (verificarFimDeJogo(territorios, numTerritorios)) {
-        printf("\n[*] PARABENS! Voce dominou o nivel Master! [*]\n");
-        printf("[*] Voce e um verdadeiro estrategista de guerra! [*]\n");
+    // A mesma posição com o turno em andamento ou encerrado continua de formas diferentes
+    uint64_t hash = mapa->hash ^ (turnoEmAndamento ? 0x9E3779B97F4A7C15ULL : 0);
+    double recompensa;
+    if (consultarTransposicao(busca->transposicao, hash, &recompensa)) {
+        busca->reaproveitadas++;
     } else {
-        printf("\n[*] Bom jogo! Continue praticando para dominar o nivel Master! [*]\n");
+        recompensa = simularRestanteIA(mapa, busca->cor, turnoEmAndamento, &trabalho->rng);
+        registrarTransposicao(busca->transposicao, hash, recompensa);
+    }
+    for (int i = 0; i < profundidade; i++) {
+        busca->nos[caminho[i]].visitas++;
+        busca->nos[caminho[i]].somaRecompensas += recompensa;
     }
-    
-    // Liberar memória
-    liberarMemoria(territorios);
 }
 
-// ============================================================================
-// FUNÇÃO PARA VERIFICAR FIM DE JOGO
-// ============================================================================
-
-int verificarFimDeJogo(const Territorio territorios[], int numTerritorios) {
-    // Validação de entrada
-    if (numTerritorios <= 0 || territorios == NULL) {
-        return 0;
+// Corpo de cada thread: itera em lotes até o prazo
+static void* executarBuscaMCTS(void* argumento) {
+    BuscaMCTS* busca = (BuscaMCTS*)argumento;
+    TrabalhoMCTS trabalho;
+    trabalho.mapa = alocarMapa(busca->raiz->numTerritorios);
+    inicializarRNG(&trabalho.rng, busca->semente);
+    int32_t numIndices = numIndicesAcaoIA(busca->raiz);
+    trabalho.acoes = (AcaoIA*)malloc((size_t)numIndices * sizeof(AcaoIA));
+    trabalho.marca = (uint32_t*)calloc((size_t)numIndices, sizeof(uint32_t));
+    trabalho.carimbo = 0;
+    if (trabalho.acoes == NULL || trabalho.marca == NULL) {
+        printf("Erro: Não foi possível alocar memória para a busca da IA.\n");
+        exit(1);
     }
+    trabalho.mapa->comHash = 1; // O hash vem da raiz a cada restauração (busca->hashRaiz)
     
-    // Pegar a cor do primeiro território como referência
-    const char* corReferencia = territorios[0].corExercito;
-    
-    // Verificar se todos os territórios têm a mesma cor
-    for (int i = 1; i < numTerritorios; i++) {
-        if (strcmp(territorios[i].corExercito, corReferencia) != 0) {
-            return 0; // Encontrou território de cor diferente, jogo continua
+    METRICA_SUSPENDER(metricasAntesDaBusca);
+    novoNoMCTS(busca, -1, (AcaoIA){ -1, -1, 0 }); // Raiz
+    do {
+        for (int i = 0; i < LOTE_ITERACOES_MCTS; i++) {
+            iterarMCTS(busca, &trabalho);
         }
-    }
+        busca->iteracoes += LOTE_ITERACOES_MCTS;
+    } while (tempoAtualSegundos() < busca->prazo);
+    METRICA_RETOMAR(metricasAntesDaBusca);
     
-    // Todos os territórios têm a mesma cor
-    printf("\n[VITORIA] O exercito %s conquistou todos os territorios!\n", corReferencia);
-    return 1; // Fim de jogo
+    free(trabalho.marca);
+    free(trabalho.acoes);
+    liberarMemoria(trabalho.mapa);
+    return NULL;
 }
 
-// ============================================================================
-// FUNÇÃO: faseDeReforcos
-// Implementa a fase de reforços onde cada exército recebe tropas adicionais
-// baseado no número de territórios que controla
-// ============================================================================
-void faseDeReforcos(Territorio* territorios, int numTerritorios) {
-    printf("\n%s================ FASE DE REFORCOS ================%s\n", COR_CIANO_NEGRITO, COR_RESET);
+JogadaIA escolherJogadaIA(const Mapa* mapa, int cor, ConfigIA* ia) {
+    JogadaIA jogada = { -1, -1, 0, 0.0, 0, 0 };
     
-    // Contar territórios por cor de exército
-    char cores[MAX_TERRITORIOS][TAM_MAX_COR];
-    int contadores[MAX_TERRITORIOS] = {0};
-    int numCores = 0;
+    // Só encerrar é possível: nada a buscar
+    int32_t numIndices = numIndicesAcaoIA(mapa);
+    AcaoIA* acoes = (AcaoIA*)malloc((size_t)numIndices * sizeof(AcaoIA));
+    if (acoes == NULL) {
+        printf("Erro: Não foi possível alocar memória para a busca da IA.\n");
+        exit(1);
+    }
+    int numAcoes = gerarAcoesIA(mapa, cor, acoes);
+    free(acoes);
+    if (numAcoes == 1) {
+        return jogada;
+    }
     
-    // Identificar cores únicas e contar territórios
-    for (int i = 0; i < numTerritorios; i++) {
-        int corEncontrada = 0;
-        for (int j = 0; j < numCores; j++) {
-            if (strcmp(territorios[i].corExercito, cores[j]) == 0) {
-                contadores[j]++;
-                corEncontrada = 1;
-                break;
-            }
-        }
-        if (!corEncontrada) {
-            strcpy(cores[numCores], territorios[i].corExercito);
-            contadores[numCores] = 1;
-            numCores++;
+    // Uma árvore por thread, todas a partir da mesma posição e com o mesmo prazo
+    int numThreads = ia->numThreads;
+    uint64_t sementeBusca = sementeDaPartida(ia->semente, ia->jogadas++);
+    double prazo = tempoAtualSegundos() + ia->tempoMs / 1000.0;
+    TabelaTransposicao transposicao;
+    transposicao.entradas = (EntradaTransposicao*)calloc((size_t)1 << BITS_TRANSPOSICAO, sizeof(EntradaTransposicao));
+    if (transposicao.entradas == NULL) {
+        printf("Erro: Não foi possível alocar memória para a busca da IA.\n");
+        exit(1);
+    }
+    transposicao.mascara = ((uint64_t)1 << BITS_TRANSPOSICAO) - 1;
+    uint64_t hashRaiz = calcularHashZobrist(mapa);
+    BuscaMCTS buscas[MAX_THREADS_IA];
+    memset(buscas, 0, sizeof(buscas));
+    for (int t = 0; t < numThreads; t++) {
+        buscas[t].raiz = mapa;
+        buscas[t].hashRaiz = hashRaiz;
+        buscas[t].transposicao = &transposicao;
+        buscas[t].cor = cor;
+        buscas[t].prazo = prazo;
+        buscas[t].semente = sementeDaPartida(sementeBusca, (uint64_t)t);
+    }
+    
+#ifdef WAR_TEM_THREADS
+    pthread_t threads[MAX_THREADS_IA];
+    int criada[MAX_THREADS_IA] = {0};
+    for (int t = 1; t < numThreads; t++) {
+        criada[t] = (pthread_create(&threads[t], NULL, executarBuscaMCTS, &buscas[t]) == 0);
+    }
+    executarBuscaMCTS(&buscas[0]);
+    for (int t = 1; t < numThreads; t++) {
+        if (criada[t]) {
+            pthread_join(threads[t], NULL);
         }
     }
+#else
+    numThreads = 1;
+    executarBuscaMCTS(&buscas[0]);
+#endif
     
-    // Distribuir reforços para cada exército
-    for (int i = 0; i < numCores; i++) {
-        int reforcos = contadores[i]; // 1 reforço por território controlado
-        if (reforcos < 2) reforcos = 2; // Mínimo de 2 reforços por turno
-        
-        printf("\n%s[REFORCO]%s Exercito %s%s%s controla %s%d%s territorio(s) -> %s+%d tropas%s de reforco\n", 
-               COR_VERDE_NEGRITO, COR_RESET, COR_AMARELO, cores[i], COR_RESET, 
-               COR_CIANO, contadores[i], COR_RESET, COR_VERDE, reforcos, COR_RESET);
-        
-        // Distribuir reforços entre os territórios do exército
-        int reforcosPorTerritorio = reforcos / contadores[i];
-        int reforcosSobrando = reforcos % contadores[i];
-        
-        for (int j = 0; j < numTerritorios; j++) {
-            if (strcmp(territorios[j].corExercito, cores[i]) == 0) {
-                int reforcoAtual = reforcosPorTerritorio;
-                if (reforcosSobrando > 0) {
-                    reforcoAtual++;
-                    reforcosSobrando--;
-                }
-                territorios[j].tropas += reforcoAtual;
-                printf("  %s+%s %s%s%s recebeu %s%d%s tropa(s) (total: %s%d%s)\n", 
-                       COR_VERDE, COR_RESET, COR_BRANCO, territorios[j].nome, COR_RESET,
-                       COR_VERDE, reforcoAtual, COR_RESET, COR_AMARELO, territorios[j].tropas, COR_RESET);
+    // Somar as visitas das ações da raiz de todas as árvores
+    long* visitas = (long*)calloc((size_t)numIndices, sizeof(long));
+    double* recompensas = (double*)calloc((size_t)numIndices, sizeof(double));
+    AcaoIA* acaoDoIndice = (AcaoIA*)malloc((size_t)numIndices * sizeof(AcaoIA));
+    if (visitas == NULL || recompensas == NULL || acaoDoIndice == NULL) {
+        printf("Erro: Não foi possível alocar memória para a busca da IA.\n");
+        exit(1);
+    }
+    int32_t melhor = 0;
+    for (int t = 0; t < numThreads; t++) {
+        jogada.iteracoes += buscas[t].iteracoes;
+        jogada.reaproveitadas += buscas[t].reaproveitadas;
+        for (int32_t f = buscas[t].numNos > 0 ? buscas[t].nos[0].primeiroFilho : -1; f >= 0;
+             f = buscas[t].nos[f].proximoIrmao) {
+            const NoMCTS* filho = &buscas[t].nos[f];
+            visitas[filho->acao.indice] += filho->visitas;
+            recompensas[filho->acao.indice] += filho->somaRecompensas;
+            acaoDoIndice[filho->acao.indice] = filho->acao;
+            if (visitas[filho->acao.indice] > visitas[melhor]) {
+                melhor = filho->acao.indice;
             }
         }
+        free(buscas[t].nos);
     }
-    
-    printf("%s==================================================%s\n", COR_CIANO_NEGRITO, COR_RESET);
+    if (visitas[melhor] > 0) {
+        jogada.atacante = acaoDoIndice[melhor].atacante;
+        jogada.defensor = acaoDoIndice[melhor].defensor;
+        jogada.visitas = visitas[melhor];
+        jogada.valorEsperado = recompensas[melhor] / (double)visitas[melhor];
+    }
+    free(acaoDoIndice);
+    free(recompensas);
+    free(visitas);
+    free(transposicao.entradas);
+    return jogada;
 }
 
-// ============================================================================
-// FUNÇÃO: selecionarNumeroTerritorios
-// Solicita ao usuário o número de territórios para o jogo
-// ============================================================================
-int selecionarNumeroTerritorios(void) {
-    int numTerritorios;
-    
-    printf("\n================ CONFIGURACAO DO JOGO ================\n");
-    printf("Quantos territorios voce deseja no jogo?\n");
-    printf("Minimo: %d territorios\n", MIN_TERRITORIOS);
-    printf("Maximo: %d territorios\n", MAX_TERRITORIOS);
-    printf("Recomendado: 5-10 territorios para melhor jogabilidade\n");
-    printf("======================================================\n");
+void faseDeAtaqueIA(Mapa* mapa, int cor, EstadoRNG* rng, ConfigIA* ia) {
+    printf("\n%s[IA] Vez do exercito %s%s (ate %d ms por jogada, %d thread%s)\n",
+           COR_CIANO, nomeDaCor(cor), COR_RESET, ia->tempoMs, ia->numThreads, ia->numThreads > 1 ? "s" : "");
     
-    do {
-        printf(">> Digite o numero de territorios (%d-%d): ", MIN_TERRITORIOS, MAX_TERRITORIOS);
-        
-        if (scanf("%d", &numTerritorios) != 1) {
-            printf("[ERRO] Entrada invalida! Digite apenas numeros.\n");
-            limparBufferEntrada();
-            continue;
+    while (!jogoTerminou(mapa)) {
+        JogadaIA jogada = escolherJogadaIA(mapa, cor, ia);
+        if (jogada.atacante < 0) {
+            printf("[IA] %s encerra os ataques (%ld iteracoes, %ld pela tabela de transposicao).\n",
+                   nomeDaCor(cor), jogada.iteracoes, jogada.reaproveitadas);
+            return;
         }
+        printf("\n[IA] %s: %s (%d) ataca %s (%d) | valor estimado %.1f%% | %ld iteracoes, %ld pela tabela\n",
+               nomeDaCor(cor), nomeDoTerritorio(mapa, jogada.atacante), mapa->tropas[jogada.atacante],
+               nomeDoTerritorio(mapa, jogada.defensor), mapa->tropas[jogada.defensor],
+               100.0 * jogada.valorEsperado, jogada.iteracoes, jogada.reaproveitadas);
         
-        limparBufferEntrada();
-        
-        if (numTerritorios < MIN_TERRITORIOS || numTerritorios > MAX_TERRITORIOS) {
-            printf("[ERRO] Numero invalido! Deve estar entre %d e %d territorios.\n", 
-                   MIN_TERRITORIOS, MAX_TERRITORIOS);
-        }
-        
-    } while (numTerritorios < MIN_TERRITORIOS || numTerritorios > MAX_TERRITORIOS);
-    
-    printf("\n[CONFIGURADO] Jogo sera jogado com %d territorios!\n", numTerritorios);
-    
-    return numTerritorios;
+        // Mesma decisão que o jogador grava: o replay não precisa da IA
+        registrarDecisao(DECISAO_ATAQUE, jogada.atacante, jogada.defensor, ATAQUE_RODADA);
+        simularAtaque(mapa, jogada.atacante, jogada.defensor, rng);
+    }
 }
 
 // ============================================================================
-// FUNCOES DE SELECAO DINAMICA
+// SERVIDOR DE PARTIDAS (--servidor)
+// Cada conexão é uma partida do Nível Master em forma de máquina de estados:
+// uma linha do cliente avança a partida até a próxima pergunta, sem nunca
+// bloquear. Uma única thread atende todas as sessões com epoll.
+//
+// Protocolo (uma linha por mensagem; respostas em palavras separadas por espaço):
+//   servidor -> WAR 1 sessao <id> semente <s>, PERGUNTA <campo> <min> <max>,
+//               OK ..., ERRO <motivo>, TURNO <n>, REFORCOS <tropas>,
+//               ADVERSARIOS ..., FIM <motivo> <cor>, MAPA <n> + n linhas T ...
+//   cliente  -> um número (em resposta a PERGUNTA), ATACAR a d, BLITZ a d,
+//               PASSAR, MAPA, MISSAO, AJUDA, SAIR
+// Os territórios são numerados a partir de 1, como na interface do jogo.
 // ============================================================================
 
-int selecionarTerritorio(int territoriosUsados[], int numUsados) {
-    // Lista de territórios predefinidos
-    const char* territorios[NUM_TERRITORIOS_PREDEFINIDOS] = {
-        "Brasil", "Argentina", "Chile", "Peru", "Colombia"
-    };
+// Acrescenta uma resposta formatada (terminada em '\n') à saída da sessão
+static void responder(SessaoServidor* sessao, const char* formato, ...) {
+    va_list argumentos;
+    va_start(argumentos, formato);
+    va_list copia;
+    va_copy(copia, argumentos);
+    int tamanho = vsnprintf(NULL, 0, formato, copia);
+    va_end(copia);
+    if (tamanho < 0) {
+        va_end(argumentos);
+        return;
+    }
+    size_t necessario = sessao->tamanhoSaida + (size_t)tamanho + 2;
+    if (necessario > sessao->capacidadeSaida) {
+        size_t capacidade = sessao->capacidadeSaida > 0 ? sessao->capacidadeSaida : TAM_LINHA_PROTOCOLO;
+        while (capacidade < necessario) capacidade *= 2;
+        char* saida = (char*)realloc(sessao->saida, capacidade);
+        if (saida == NULL) {
+            printf("Erro: Não foi possível alocar memória para a sessão.\n");
+            exit(1);
+        }
+        sessao->saida = saida;
+        sessao->capacidadeSaida = capacidade;
+    }
+    vsnprintf(sessao->saida + sessao->tamanhoSaida, (size_t)tamanho + 1, formato, argumentos);
+    va_end(argumentos);
+    sessao->tamanhoSaida += (size_t)tamanho;
+    sessao->saida[sessao->tamanhoSaida++] = '\n';
+}
+
+// Lê um inteiro de uma palavra do protocolo dentro do intervalo [minimo, maximo]
+static int lerInteiroProtocolo(const char* texto, long minimo, long maximo, long* destino) {
+    if (texto == NULL) {
+        return 0;
+    }
+    char* fim;
+    errno = 0;
+    long valor = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '\0' || errno != 0 || valor < minimo || valor > maximo) {
+        return 0;
+    }
+    *destino = valor;
+    return 1;
+}
+
+static int maximoTerritoriosSessao(const DefinicaoMapa* definicao) {
+    return definicao->numTerritorios < MAX_TERRITORIOS ? definicao->numTerritorios : MAX_TERRITORIOS;
+}
+
+static void iniciarSessao(SessaoServidor* sessao, const DefinicaoMapa* definicao, uint64_t semente) {
+    uint64_t sementeSessao = sementeDaPartida(semente, sessao->id);
+    inicializarRNG(&sessao->rng, sementeSessao);
+    sessao->estado = SESSAO_TERRITORIOS;
+    sessao->corJogador = SEM_COR;
+    responder(sessao, "WAR 1 sessao %" PRIu64 " semente %" PRIu64, sessao->id, sementeSessao);
+    responder(sessao, "PERGUNTA territorios %d %d", MIN_TERRITORIOS, maximoTerritoriosSessao(definicao));
+}
+
+// Início de turno do nivelMaster: limite de turnos, missões, dominação e reforços
+static void iniciarTurnoSessao(SessaoServidor* sessao) {
+    Mapa* mapa = sessao->mapa;
+    if (sessao->turno > MAX_TURNOS_MASTER) {
+        responder(sessao, "FIM limite -");
+        sessao->estado = SESSAO_ENCERRADA;
+        return;
+    }
+    int corCumpriu = avaliarMissoes(&sessao->missoes, mapa);
+    if (corCumpriu != SEM_COR) {
+        responder(sessao, "FIM missao %s %s", nomeDaCor(corCumpriu), sessao->missoes.missoes[corCumpriu].descricao);
+        sessao->estado = SESSAO_ENCERRADA;
+        return;
+    }
+    if (jogoTerminou(mapa)) {
+        responder(sessao, "FIM dominacao %s", nomeDaCor(mapa->dono[0]));
+        sessao->estado = SESSAO_ENCERRADA;
+        return;
+    }
     
-    printf("\n================ SELECAO DE TERRITORIO ================\n");
-    printf("Escolha um territorio da lista:\n");
-    printf("======================================================\n");
+    responder(sessao, "TURNO %d", sessao->turno);
+    if (sessao->turno > 1) {
+        int64_t antes = mapa->tropasPorDono[sessao->corJogador];
+        aplicarReforcos(mapa, NULL);
+        responder(sessao, "REFORCOS %" PRId64, mapa->tropasPorDono[sessao->corJogador] - antes);
+    }
+    sessao->estado = SESSAO_ATAQUES;
+}
+
+// Mapa aleatório com os primeiros territórios da definição, como na simulação
+static void configurarPartidaSessao(SessaoServidor* sessao, const DefinicaoMapa* definicao, int numJogadores) {
+    Mapa* mapa = alocarMapaNaArena(&sessao->arena, sessao->numTerritorios);
+    prepararMapaAleatorio(mapa, numJogadores, &sessao->rng);
+    associarSubmapa(mapa, definicao);
+    recalcularContadores(mapa); // De novo, agora com os continentes
+    sessao->mapa = mapa;
+    sessao->corJogador = 0;
+    sessao->turno = 1;
+    gerarMissoesDosJogadores(&sessao->missoes, mapa, sessao->turno, &sessao->rng);
+    mapa->missoes = &sessao->missoes;
     
-    for (int i = 0; i < NUM_TERRITORIOS_PREDEFINIDOS; i++) {
-        // Verificar se o território já foi usado
-        int jaUsado = 0;
-        for (int j = 0; j < numUsados; j++) {
-            if (territoriosUsados[j] == i) {
-                jaUsado = 1;
-                break;
-            }
-        }
-        
-        if (jaUsado) {
-            printf("%2d - %s [JA USADO]\n", i + 1, territorios[i]);
-        } else {
-            printf("%2d - %s\n", i + 1, territorios[i]);
+    responder(sessao, "OK cor %s", nomeDaCor(sessao->corJogador));
+    responder(sessao, "MISSAO %s", sessao->missoes.missoes[sessao->corJogador].descricao);
+    iniciarTurnoSessao(sessao);
+}
+
+static void responderMapa(SessaoServidor* sessao) {
+    const Mapa* mapa = sessao->mapa;
+    responder(sessao, "MAPA %d", mapa->numTerritorios);
+    for (int i = 0; i < mapa->numTerritorios; i++) {
+        responder(sessao, "T %d %s %d %s", i + 1, nomeDaCor(mapa->dono[i]), mapa->tropas[i], nomeDoTerritorio(mapa, i));
+    }
+}
+
+// ATACAR/BLITZ: mesma validação da fase de ataque interativa, com o núcleo silencioso
+static void atacarSessao(SessaoServidor* sessao, int blitz, const char* textoAtacante, const char* textoDefensor) {
+    Mapa* mapa = sessao->mapa;
+    long atacante, defensor;
+    if (!lerInteiroProtocolo(textoAtacante, 1, mapa->numTerritorios, &atacante) ||
+        !lerInteiroProtocolo(textoDefensor, 1, mapa->numTerritorios, &defensor)) {
+        responder(sessao, "ERRO territorios devem ser numeros de 1 a %d", mapa->numTerritorios);
+        return;
+    }
+    int a = (int)atacante - 1;
+    int d = (int)defensor - 1;
+    if (mapa->dono[a] != sessao->corJogador) {
+        responder(sessao, "ERRO o atacante nao e seu");
+    } else if (mapa->dono[d] == sessao->corJogador) {
+        responder(sessao, "ERRO o defensor e seu");
+    } else if (mapa->tropas[a] <= 1) {
+        responder(sessao, "ERRO o atacante precisa de pelo menos 2 tropas");
+    } else if (!saoVizinhos(mapa, a, d)) {
+        responder(sessao, "ERRO os territorios nao fazem fronteira");
+    } else if (blitz) {
+        ResultadoBatalha batalha;
+        int conquistou = resolverBatalha(mapa, a, d, &sessao->rng, &batalha) == 2;
+        responder(sessao, "OK BLITZ perdas %d %d conquistou %d tropas %d %d",
+                  batalha.perdasAtacante, batalha.perdasDefensor, conquistou, mapa->tropas[a], mapa->tropas[d]);
+    } else {
+        ResultadoCombate combate;
+        int conquistou = resolverCombate(mapa, a, d, &sessao->rng, &combate) == 2;
+        responder(sessao, "OK ATAQUE dados %d %d x %d %d perdas %d %d conquistou %d tropas %d %d",
+                  combate.resultadosAtacante[0], combate.dadosAtacante > 1 ? combate.resultadosAtacante[1] : 0,
+                  combate.resultadosDefensor[0], combate.dadosDefensor > 1 ? combate.resultadosDefensor[1] : 0,
+                  combate.perdasAtacante, combate.perdasDefensor, conquistou, mapa->tropas[a], mapa->tropas[d]);
+    }
+}
+
+// PASSAR: os demais exércitos atacam por script e o próximo turno começa
+static void passarVezSessao(SessaoServidor* sessao) {
+    Mapa* mapa = sessao->mapa;
+    int32_t territoriosAntes = mapa->territoriosPorDono[sessao->corJogador];
+    for (int cor = 0; cor < MAX_CORES && !jogoTerminou(mapa); cor++) {
+        if (cor != sessao->corJogador && mapa->territoriosPorDono[cor] > 0) {
+            faseDeAtaqueScriptada(mapa, cor, &sessao->rng, 0);
         }
     }
+    responder(sessao, "ADVERSARIOS perdidos %d", territoriosAntes - mapa->territoriosPorDono[sessao->corJogador]);
+    sessao->turno++;
+    notificarFimDeTurno(&sessao->missoes, sessao->turno);
+    iniciarTurnoSessao(sessao);
+}
+
+void processarLinhaSessao(SessaoServidor* sessao, const DefinicaoMapa* definicao, char* linha) {
+    char* comando = strtok(linha, " \t\r"); // O servidor atende as sessões numa única thread
+    char* argumento1 = strtok(NULL, " \t\r");
+    char* argumento2 = strtok(NULL, " \t\r");
+    if (comando == NULL) {
+        return; // Linha vazia
+    }
     
-    printf("======================================================\n");
-    printf(">> Digite o numero do territorio (1-%d): ", NUM_TERRITORIOS_PREDEFINIDOS);
+    // Comandos aceitos em qualquer etapa
+    if (strcmp(comando, "SAIR") == 0) {
+        responder(sessao, "ATE_LOGO");
+        sessao->encerrar = 1;
+        return;
+    }
+    if (strcmp(comando, "AJUDA") == 0) {
+        responder(sessao, "AJUDA ATACAR a d | BLITZ a d | PASSAR | MAPA | MISSAO | SAIR");
+        return;
+    }
     
-    int opcao;
-    while (1) {
-        if (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > NUM_TERRITORIOS_PREDEFINIDOS) {
-            printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", NUM_TERRITORIOS_PREDEFINIDOS);
-            limparBufferEntrada();
-            continue;
-        }
-        
-        // Verificar se o território já foi usado
-        int jaUsado = 0;
-        for (int j = 0; j < numUsados; j++) {
-            if (territoriosUsados[j] == (opcao - 1)) {
-                jaUsado = 1;
-                break;
+    switch (sessao->estado) {
+        case SESSAO_TERRITORIOS: {
+            long valor;
+            if (!lerInteiroProtocolo(comando, MIN_TERRITORIOS, maximoTerritoriosSessao(definicao), &valor)) {
+                responder(sessao, "ERRO esperado um numero de %d a %d", MIN_TERRITORIOS, maximoTerritoriosSessao(definicao));
+                return;
             }
+            sessao->numTerritorios = (int)valor;
+            sessao->estado = SESSAO_JOGADORES;
+            int maximo = NUM_CORES_PREDEFINIDAS < sessao->numTerritorios ? NUM_CORES_PREDEFINIDAS : sessao->numTerritorios;
+            responder(sessao, "PERGUNTA jogadores 2 %d", maximo);
+            return;
         }
         
-        if (jaUsado) {
-            printf("[!] Este territorio ja foi escolhido! Selecione outro: ");
-            limparBufferEntrada();
-            continue;
+        case SESSAO_JOGADORES: {
+            long valor;
+            int maximo = NUM_CORES_PREDEFINIDAS < sessao->numTerritorios ? NUM_CORES_PREDEFINIDAS : sessao->numTerritorios;
+            if (!lerInteiroProtocolo(comando, 2, maximo, &valor)) {
+                responder(sessao, "ERRO esperado um numero de 2 a %d", maximo);
+                return;
+            }
+            configurarPartidaSessao(sessao, definicao, (int)valor);
+            return;
         }
         
-        break;
+        case SESSAO_ATAQUES:
+        case SESSAO_ENCERRADA:
+            break;
     }
-    limparBufferEntrada();
     
-    return opcao - 1; // Retorna índice (0-based)
+    if (strcmp(comando, "MAPA") == 0) {
+        responderMapa(sessao);
+    } else if (strcmp(comando, "MISSAO") == 0) {
+        const Missao* missao = &sessao->missoes.missoes[sessao->corJogador];
+        responder(sessao, "MISSAO %s", missao->descricao);
+    } else if (sessao->estado == SESSAO_ENCERRADA) {
+        responder(sessao, "ERRO partida encerrada");
+    } else if (strcmp(comando, "ATACAR") == 0 || strcmp(comando, "BLITZ") == 0) {
+        atacarSessao(sessao, comando[0] == 'B', argumento1, argumento2);
+    } else if (strcmp(comando, "PASSAR") == 0) {
+        passarVezSessao(sessao);
+    } else {
+        responder(sessao, "ERRO comando desconhecido (use AJUDA)");
+    }
 }
 
-int selecionarCor(char* corEscolhida, int coresUsadas[], int numUsadas) {
-    // Lista de cores predefinidas
-    const char* cores[NUM_CORES_PREDEFINIDAS] = {
-        "Azul", "Vermelho", "Verde", "Amarelo", "Roxo"
-    };
-    
-    printf("\n================ SELECAO DE COR ================\n");
-    printf("Escolha uma cor para o exercito:\n");
-    printf("===============================================\n");
-    
-    for (int i = 0; i < NUM_CORES_PREDEFINIDAS; i++) {
-        // Verificar se a cor já foi usada
-        int jaUsada = 0;
-        for (int j = 0; j < numUsadas; j++) {
-            if (coresUsadas[j] == i) {
-                jaUsada = 1;
-                break;
-            }
+#ifdef WAR_TEM_SERVIDOR
+
+// Pedido de encerramento (SIGINT/SIGTERM); o laço de eventos termina na próxima volta
+static volatile sig_atomic_t servidorAtivo = 1;
+
+static void pararServidor(int sinal) {
+    (void)sinal;
+    servidorAtivo = 0;
+}
+
+// Cria o socket de escuta não bloqueante; retorna -1 (com a mensagem exibida) em caso de erro
+static int abrirSocketEscuta(const char* endereco) {
+    int fd;
+    if (strncmp(endereco, "unix:", 5) == 0) {
+        const char* caminho = endereco + 5;
+        struct sockaddr_un local;
+        memset(&local, 0, sizeof(local));
+        local.sun_family = AF_UNIX;
+        if (caminho[0] == '\0' || strlen(caminho) >= sizeof(local.sun_path)) {
+            printf("%s[ERRO] Caminho de socket invalido '%s'.%s\n", COR_VERMELHO_NEGRITO, caminho, COR_RESET);
+            return -1;
         }
+        strcpy(local.sun_path, caminho);
         
-        if (jaUsada) {
-            printf("%2d - %s [JA USADA]\n", i + 1, cores[i]);
-        } else {
-            printf("%2d - %s\n", i + 1, cores[i]);
+        // Um socket deixado por uma execução anterior é removido; qualquer outro arquivo, não
+        struct stat info;
+        if (stat(caminho, &info) == 0 && S_ISSOCK(info.st_mode)) {
+            unlink(caminho);
+        }
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+            printf("%s[ERRO] Nao foi possivel abrir o socket '%s': %s.%s\n",
+                   COR_VERMELHO_NEGRITO, caminho, strerror(errno), COR_RESET);
+            if (fd >= 0) close(fd);
+            return -1;
+        }
+    } else {
+        long porta;
+        if (!lerInteiroProtocolo(endereco, 1, 65535, &porta)) {
+            printf("%s[ERRO] Endereco invalido '%s' (use uma porta TCP ou unix:CAMINHO).%s\n",
+                   COR_VERMELHO_NEGRITO, endereco, COR_RESET);
+            return -1;
+        }
+        struct sockaddr_in local;
+        memset(&local, 0, sizeof(local));
+        local.sin_family = AF_INET;
+        local.sin_port = htons((uint16_t)porta);
+        local.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Só conexões locais
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int reutilizar = 1;
+        if (fd < 0 || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reutilizar, sizeof(reutilizar)) != 0 ||
+            bind(fd, (struct sockaddr*)&local, sizeof(local)) != 0) {
+            printf("%s[ERRO] Nao foi possivel abrir a porta %ld: %s.%s\n",
+                   COR_VERMELHO_NEGRITO, porta, strerror(errno), COR_RESET);
+            if (fd >= 0) close(fd);
+            return -1;
         }
     }
-    
-    printf("===============================================\n");
-    printf(">> Digite o numero da cor (1-%d): ", NUM_CORES_PREDEFINIDAS);
-    
-    int opcao;
-    while (1) {
-        if (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > NUM_CORES_PREDEFINIDAS) {
-            printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", NUM_CORES_PREDEFINIDAS);
-            limparBufferEntrada();
+    if (listen(fd, SOMAXCONN) != 0 || fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK) != 0) {
+        printf("%s[ERRO] Nao foi possivel escutar em '%s': %s.%s\n",
+               COR_VERMELHO_NEGRITO, endereco, strerror(errno), COR_RESET);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Envia o que o socket aceitar; retorna 0 se a sessão deve ser fechada
+static int enviarSaidaSessao(SessaoServidor* sessao, int epoll) {
+    while (sessao->enviados < sessao->tamanhoSaida) {
+        ssize_t escritos = send(sessao->fd, sessao->saida + sessao->enviados,
+                                sessao->tamanhoSaida - sessao->enviados, MSG_NOSIGNAL);
+        if (escritos < 0 && errno == EINTR) {
             continue;
         }
-        
-        // Verificar se a cor já foi usada
-        int jaUsada = 0;
-        for (int j = 0; j < numUsadas; j++) {
-            if (coresUsadas[j] == (opcao - 1)) {
-                jaUsada = 1;
-                break;
+        if (escritos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // Cliente lento: esperar EPOLLOUT, sem acumular respostas sem limite
+            if (sessao->tamanhoSaida - sessao->enviados > MAX_SAIDA_SESSAO) {
+                return 0;
             }
+            if (!sessao->aguardandoEscrita) {
+                struct epoll_event evento = { .events = EPOLLIN | EPOLLOUT, .data.ptr = sessao };
+                epoll_ctl(epoll, EPOLL_CTL_MOD, sessao->fd, &evento);
+                sessao->aguardandoEscrita = 1;
+            }
+            return 1;
         }
-        
-        if (jaUsada) {
-            printf("[!] Esta cor ja foi escolhida! Selecione outra: ");
-            limparBufferEntrada();
+        if (escritos <= 0) {
+            return 0;
+        }
+        sessao->enviados += (size_t)escritos;
+    }
+    sessao->tamanhoSaida = 0;
+    sessao->enviados = 0;
+    if (sessao->aguardandoEscrita) {
+        struct epoll_event evento = { .events = EPOLLIN, .data.ptr = sessao };
+        epoll_ctl(epoll, EPOLL_CTL_MOD, sessao->fd, &evento);
+        sessao->aguardandoEscrita = 0;
+    }
+    return !sessao->encerrar;
+}
+
+// Lê o que chegou e processa cada linha completa; retorna 0 se a sessão deve ser fechada
+static int receberEntradaSessao(SessaoServidor* sessao, const DefinicaoMapa* definicao) {
+    char bloco[4096];
+    while (!sessao->encerrar) {
+        ssize_t lidos = recv(sessao->fd, bloco, sizeof(bloco), 0);
+        if (lidos < 0 && errno == EINTR) {
             continue;
         }
-        
-        break;
+        if (lidos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 1;
+        }
+        if (lidos <= 0) {
+            return 0; // Cliente desconectou (ou erro)
+        }
+        for (ssize_t i = 0; i < lidos && !sessao->encerrar; i++) {
+            if (bloco[i] == '\n') {
+                sessao->entrada[sessao->tamanhoEntrada] = '\0';
+                sessao->tamanhoEntrada = 0;
+                processarLinhaSessao(sessao, definicao, sessao->entrada);
+            } else if (sessao->tamanhoEntrada + 1 < sizeof(sessao->entrada)) {
+                sessao->entrada[sessao->tamanhoEntrada++] = bloco[i];
+            } else {
+                responder(sessao, "ERRO linha maior que %d bytes", TAM_LINHA_PROTOCOLO - 1);
+                sessao->encerrar = 1;
+            }
+        }
     }
-    limparBufferEntrada();
-    
-    strcpy(corEscolhida, cores[opcao - 1]);
-    return opcao - 1; // Retorna índice (0-based)
+    return 1;
 }
 
-int selecionarTropas(void) {
-    // Opções de tropas predefinidas
-    const int opcoesTropas[NUM_OPCOES_TROPAS] = {1, 2, 3, 4, 5};
-    
-    printf("\n================ SELECAO DE TROPAS ================\n");
-    printf("Escolha o numero inicial de tropas:\n");
-    printf("==================================================\n");
-    
-    for (int i = 0; i < NUM_OPCOES_TROPAS; i++) {
-        printf("%d - %d tropa%s\n", i + 1, opcoesTropas[i], opcoesTropas[i] > 1 ? "s" : "");
+// Sessão para uma nova conexão: uma livre, se houver, ou uma nova com arena própria
+static SessaoServidor* obterSessao(SessaoServidor** livres) {
+    SessaoServidor* sessao = *livres;
+    if (sessao != NULL) {
+        *livres = sessao->proxima;
+        return sessao;
     }
-    
-    printf("==================================================\n");
-    printf(">> Digite o numero da opcao (1-%d): ", NUM_OPCOES_TROPAS);
-    
-    int opcao;
-    while (scanf("%d", &opcao) != 1 || opcao < 1 || opcao > NUM_OPCOES_TROPAS) {
-        printf("[!] Opcao invalida! Digite um numero entre 1 e %d: ", NUM_OPCOES_TROPAS);
-        limparBufferEntrada();
+    sessao = (SessaoServidor*)calloc(1, sizeof(SessaoServidor));
+    if (sessao == NULL) {
+        printf("Erro: Não foi possível alocar memória para a sessão.\n");
+        exit(1);
     }
-    limparBufferEntrada();
-    
-    return opcoesTropas[opcao - 1]; // Retorna o número de tropas
+    inicializarArena(&sessao->arena, TAM_ARENA_INICIAL);
+    return sessao;
 }
 
-// === IMPLEMENTAÇÃO DAS FUNÇÕES DO SISTEMA DE MISSÕES ===
-
-void gerarMissaoAleatoria(Missao* missao, const Territorio territorios[], int numTerritorios) {
-    // Inicializar missão
-    missao->cumprida = 0;
-    strcpy(missao->corAlvo, "");
-    missao->valorAlvo = 0;
-    
-    // Gerar tipo de missão aleatório
-    missao->tipo = (TipoMissao)(rand() % 4);
+// Fecha a conexão e devolve a sessão à lista de livres, com a arena e o buffer de saída
+static void fecharSessao(SessaoServidor* sessao, SessaoServidor** abertas, SessaoServidor** livres) {
+    if (sessao->anterior != NULL) {
+        sessao->anterior->proxima = sessao->proxima;
+    } else {
+        *abertas = sessao->proxima;
+    }
+    if (sessao->proxima != NULL) {
+        sessao->proxima->anterior = sessao->anterior;
+    }
+    close(sessao->fd); // Também remove o socket do epoll
+    liberarMemoria(sessao->mapa);
+    reiniciarArena(&sessao->arena);
     
-    switch (missao->tipo) {
-        case CONQUISTAR_CONTINENTE: {
-            // Encontrar uma cor aleatória que existe no mapa
-            int corEncontrada = 0;
-            int tentativas = 0;
-            while (!corEncontrada && tentativas < 10) {
-                int indiceAleatorio = rand() % numTerritorios;
-                strcpy(missao->corAlvo, territorios[indiceAleatorio].corExercito);
-                
-                // Verificar se esta cor tem pelo menos 2 territórios
-                int count = 0;
-                for (int i = 0; i < numTerritorios; i++) {
-                    if (strcmp(territorios[i].corExercito, missao->corAlvo) == 0) {
-                        count++;
-                    }
-                }
-                if (count >= 2) {
-                    corEncontrada = 1;
-                    sprintf(missao->descricao, "Conquistar todos os territorios da cor %s", missao->corAlvo);
-                }
-                tentativas++;
-            }
-            if (!corEncontrada) {
-                // Fallback para missão de controlar territórios
-                missao->tipo = CONTROLAR_TERRITORIOS;
-                missao->valorAlvo = (numTerritorios * 60) / 100; // 60% dos territórios
-                sprintf(missao->descricao, "Controlar pelo menos %d territorios", missao->valorAlvo);
-            }
-            break;
-        }
-        
-        case ELIMINAR_COR: {
-            // Encontrar uma cor diferente da primeira para eliminar
-            strcpy(missao->corAlvo, territorios[1 % numTerritorios].corExercito);
-            sprintf(missao->descricao, "Eliminar completamente a cor %s do mapa", missao->corAlvo);
-            break;
-        }
-        
-        case CONTROLAR_TERRITORIOS: {
-            // Controlar uma porcentagem dos territórios
-            missao->valorAlvo = (numTerritorios * 70) / 100; // 70% dos territórios
-            if (missao->valorAlvo < 3) missao->valorAlvo = 3; // Mínimo 3 territórios
-            sprintf(missao->descricao, "Controlar pelo menos %d territorios", missao->valorAlvo);
-            break;
-        }
-        
-        case SOBREVIVER_TURNOS: {
-            // Sobreviver por um número de turnos
-            missao->valorAlvo = 8 + (rand() % 5); // Entre 8 e 12 turnos
-            sprintf(missao->descricao, "Sobreviver por pelo menos %d turnos", missao->valorAlvo);
-            break;
-        }
+    ArenaPartida arena = sessao->arena;
+    char* saida = sessao->saida;
+    size_t capacidadeSaida = sessao->capacidadeSaida;
+    memset(sessao, 0, sizeof(*sessao));
+    sessao->arena = arena;
+    sessao->saida = saida;
+    sessao->capacidadeSaida = capacidadeSaida;
+    sessao->proxima = *livres;
+    *livres = sessao;
+}
+
+// Libera de vez as sessões da lista de livres (fim do servidor)
+static void liberarSessoesLivres(SessaoServidor* livres) {
+    while (livres != NULL) {
+        SessaoServidor* proxima = livres->proxima;
+        liberarArena(&livres->arena);
+        free(livres->saida);
+        free(livres);
+        livres = proxima;
     }
 }
 
-int verificarMissao(const Missao* missao, const Territorio territorios[], int numTerritorios, int turnoAtual) {
-    if (missao->cumprida) {
-        return 1; // Já foi cumprida
+int executarServidor(const char* endereco, const DefinicaoMapa* definicao, uint64_t semente) {
+    int escuta = abrirSocketEscuta(endereco);
+    if (escuta < 0) {
+        return 0;
+    }
+    int epoll = epoll_create1(0);
+    struct epoll_event eventoEscuta = { .events = EPOLLIN, .data.ptr = NULL };
+    if (epoll < 0 || epoll_ctl(epoll, EPOLL_CTL_ADD, escuta, &eventoEscuta) != 0) {
+        printf("%s[ERRO] epoll indisponivel: %s.%s\n", COR_VERMELHO_NEGRITO, strerror(errno), COR_RESET);
+        close(escuta);
+        return 0;
     }
     
-    switch (missao->tipo) {
-        case CONQUISTAR_CONTINENTE: {
-            // Verificar se todos os territórios da cor alvo pertencem ao jogador
-            int territoriosDaCor = 0;
-            int territoriosControlados = 0;
+    // SIGINT/SIGTERM encerram o laço (sem SA_RESTART, epoll_wait retorna EINTR)
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = pararServidor;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    
+    printf("[SERVIDOR] Aguardando conexoes em %s (semente %" PRIu64 ").\n", endereco, semente);
+    fflush(stdout);
+    
+    SessaoServidor* abertas = NULL;
+    SessaoServidor* livres = NULL;
+    uint64_t proximaSessao = 0;
+    long numAbertas = 0;
+    struct epoll_event eventos[EVENTOS_POR_ESPERA];
+    while (servidorAtivo) {
+        int prontos = epoll_wait(epoll, eventos, EVENTOS_POR_ESPERA, -1);
+        if (prontos < 0) {
+            if (errno == EINTR) continue;
+            printf("%s[ERRO] epoll_wait: %s.%s\n", COR_VERMELHO_NEGRITO, strerror(errno), COR_RESET);
+            break;
+        }
+        for (int e = 0; e < prontos; e++) {
+            SessaoServidor* sessao = (SessaoServidor*)eventos[e].data.ptr;
             
-            for (int i = 0; i < numTerritorios; i++) {
-                if (strcmp(territorios[i].corExercito, missao->corAlvo) == 0) {
-                    territoriosDaCor++;
-                    // Assumindo que o jogador é sempre a primeira cor cadastrada
-                    if (strcmp(territorios[i].corExercito, territorios[0].corExercito) == 0) {
-                        territoriosControlados++;
+            if (sessao == NULL) {
+                // Novas conexões: aceitar todas as pendentes
+                int fd;
+                while ((fd = accept(escuta, NULL, NULL)) >= 0) {
+                    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    SessaoServidor* nova = obterSessao(&livres);
+                    nova->fd = fd;
+                    nova->id = proximaSessao++;
+                    nova->proxima = abertas;
+                    if (abertas != NULL) abertas->anterior = nova;
+                    abertas = nova;
+                    numAbertas++;
+                    struct epoll_event evento = { .events = EPOLLIN, .data.ptr = nova };
+                    epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &evento);
+                    iniciarSessao(nova, definicao, semente);
+                    if (!enviarSaidaSessao(nova, epoll)) {
+                        fecharSessao(nova, &abertas, &livres);
+                        numAbertas--;
                     }
                 }
+                continue;
             }
-            return (territoriosControlados == territoriosDaCor && territoriosDaCor > 0);
-        }
-        
-        case ELIMINAR_COR: {
-            // Verificar se a cor alvo não existe mais no mapa
-            for (int i = 0; i < numTerritorios; i++) {
-                if (strcmp(territorios[i].corExercito, missao->corAlvo) == 0) {
-                    return 0; // Cor ainda existe
-                }
-            }
-            return 1; // Cor foi eliminada
-        }
-        
-        case CONTROLAR_TERRITORIOS: {
-            // Contar territórios controlados pelo jogador (primeira cor)
-            int territoriosControlados = 0;
-            const char* corJogador = territorios[0].corExercito;
             
-            for (int i = 0; i < numTerritorios; i++) {
-                if (strcmp(territorios[i].corExercito, corJogador) == 0) {
-                    territoriosControlados++;
-                }
+            int manter = !(eventos[e].events & EPOLLERR);
+            if (manter && (eventos[e].events & (EPOLLIN | EPOLLHUP))) {
+                manter = receberEntradaSessao(sessao, definicao);
+            }
+            if (manter && sessao->tamanhoSaida > 0) {
+                manter = enviarSaidaSessao(sessao, epoll);
+            }
+            if (!manter) {
+                fecharSessao(sessao, &abertas, &livres);
+                numAbertas--;
             }
-            return (territoriosControlados >= missao->valorAlvo);
-        }
-        
-        case SOBREVIVER_TURNOS: {
-            return (turnoAtual >= missao->valorAlvo);
         }
-        
-        default:
-            return 0;
     }
+    
+    printf("\n[SERVIDOR] Encerrando: %ld sessao(oes) aberta(s), %" PRIu64 " atendida(s).\n", numAbertas, proximaSessao);
+    while (abertas != NULL) {
+        fecharSessao(abertas, &abertas, &livres);
+    }
+    liberarSessoesLivres(livres);
+    close(epoll);
+    close(escuta);
+    if (strncmp(endereco, "unix:", 5) == 0) {
+        unlink(endereco + 5);
+    }
+    return 1;
 }
 
-void exibirMissao(const Missao* missao) {
-    printf("\n%s================ MISSAO ATUAL ================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
+#else
+
+int executarServidor(const char* endereco, const DefinicaoMapa* definicao, uint64_t semente) {
+    (void)endereco;
+    (void)definicao;
+    (void)semente;
+    printf("%s[ERRO] --servidor requer Linux (epoll).%s\n", COR_VERMELHO_NEGRITO, COR_RESET);
+    return 0;
+}
+
+#endif // WAR_TEM_SERVIDOR
+
+// ============================================================================
+// LINHA DE COMANDO
+// ============================================================================
+
+int processarArgumentos(int argc, char* argv[], OpcoesPrograma* opcoes) {
+    memset(opcoes, 0, sizeof(*opcoes));
+    opcoes->simulacao.numPartidas = 0;
+    opcoes->simulacao.numTerritorios = NUM_TERRITORIOS_PREDEFINIDOS;
+    opcoes->simulacao.numJogadores = NUM_CORES_PREDEFINIDAS;
+    opcoes->simulacao.maxTurnos = MAX_TURNOS_MASTER;
+    int nucleos = numeroDeNucleos();
+    opcoes->simulacao.numThreads = nucleos < MAX_THREADS_SIMULACAO ? nucleos : MAX_THREADS_SIMULACAO;
+    opcoes->verbosidade = VERBOSIDADE_PADRAO;
+    opcoes->ia.tempoMs = TEMPO_IA_PADRAO_MS;
+    opcoes->ia.numThreads = nucleos < MAX_THREADS_IA ? nucleos : MAX_THREADS_IA;
+    opcoes->semente = ((uint64_t)time(NULL) << 20) ^ (uint64_t)clock();
     
-    if (missao->cumprida) {
-        printf("%s[MISSAO CUMPRIDA!]%s %s\n", COR_VERDE_NEGRITO, COR_RESET, missao->descricao);
-        printf("%s=============================================%s\n", COR_VERDE_NEGRITO, COR_RESET);
-    } else {
-        printf("%s[OBJETIVO:]%s %s\n", COR_CIANO, COR_RESET, missao->descricao);
-        
-        // Informações adicionais baseadas no tipo
-        switch (missao->tipo) {
-            case CONQUISTAR_CONTINENTE:
-                printf("%s[DICA:]%s Foque em atacar territorios da cor %s%s%s\n", 
-                       COR_AMARELO, COR_RESET, COR_MAGENTA, missao->corAlvo, COR_RESET);
-                break;
-            case ELIMINAR_COR:
-                printf("%s[DICA:]%s Elimine todos os territorios da cor %s%s%s\n", 
-                       COR_AMARELO, COR_RESET, COR_MAGENTA, missao->corAlvo, COR_RESET);
-                break;
-            case CONTROLAR_TERRITORIOS:
-                printf("%s[DICA:]%s Expanda seu territorio conquistando %s%d%s territorios\n", 
-                       COR_AMARELO, COR_RESET, COR_VERDE, missao->valorAlvo, COR_RESET);
-                break;
-            case SOBREVIVER_TURNOS:
-                printf("%s[DICA:]%s Defenda seus territorios por %s%d%s turnos\n", 
-                       COR_AMARELO, COR_RESET, COR_VERDE, missao->valorAlvo, COR_RESET);
-                break;
+    for (int i = 1; i < argc; i++) {
+        long valor;
+        if (strcmp(argv[i], "--simular") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, 2000000000L, &valor)) return 0;
+            opcoes->modoSimulacao = 1;
+            opcoes->simulacao.numPartidas = valor;
+        } else if (strcmp(argv[i], "--territorios") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], MIN_TERRITORIOS, MAX_TERRITORIOS_SIMULACAO, &valor)) return 0;
+            opcoes->simulacao.numTerritorios = (int)valor;
+        } else if (strcmp(argv[i], "--jogadores") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 2, NUM_CORES_PREDEFINIDAS, &valor)) return 0;
+            opcoes->simulacao.numJogadores = (int)valor;
+        } else if (strcmp(argv[i], "--tabela-batalha") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, TAM_TABELA_BATALHA, &valor)) return 0;
+            opcoes->limiteTabelaBatalha = (int)valor;
+        } else if (strcmp(argv[i], "--conferir-dados") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, 500000000L, &valor)) return 0;
+            opcoes->rodadasConferencia = (int)valor;
+        } else if (strcmp(argv[i], "--relatorio-memoria") == 0) {
+            opcoes->relatorioMemoria = 1;
+        } else if (strcmp(argv[i], "--verbosidade") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 0, 2, &valor)) return 0;
+            opcoes->verbosidade = (int)valor;
+        } else if (strcmp(argv[i], "--gravar") == 0 && i + 1 < argc) {
+            opcoes->arquivoGravacao = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            opcoes->arquivoReplay = argv[++i];
+        } else if (strcmp(argv[i], "--ate-turno") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, 1000000, &valor)) return 0;
+            opcoes->ateTurno = (int)valor;
+        } else if (strcmp(argv[i], "--passo") == 0) {
+            opcoes->passoAPasso = 1;
+        } else if (strcmp(argv[i], "--ia") == 0) {
+            opcoes->iaAtiva = 1;
+        } else if (strcmp(argv[i], "--ia-tempo") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 10, 600000, &valor)) return 0;
+            opcoes->ia.tempoMs = (int)valor;
+        } else if (strcmp(argv[i], "--ia-threads") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, MAX_THREADS_IA, &valor)) return 0;
+            opcoes->ia.numThreads = (int)valor;
+        } else if (strcmp(argv[i], "--salvar") == 0 && i + 1 < argc) {
+            opcoes->arquivoSalvar = argv[++i];
+        } else if (strcmp(argv[i], "--carregar") == 0 && i + 1 < argc) {
+            opcoes->arquivoCarregar = argv[++i];
+        } else if (strcmp(argv[i], "--config") == 0 && i + 1 < argc) {
+            opcoes->arquivoConfig = argv[++i];
+        } else if (strcmp(argv[i], "--servidor") == 0 && i + 1 < argc) {
+            opcoes->enderecoServidor = argv[++i];
+        } else if (strcmp(argv[i], "--eventos") == 0 && i + 1 < argc) {
+            opcoes->simulacao.arquivoEventos = argv[++i];
+        } else if (strcmp(argv[i], "--metricas-json") == 0 && i + 1 < argc) {
+            opcoes->arquivoMetricas = argv[++i];
+        } else if (strcmp(argv[i], "--mapa") == 0 && i + 1 < argc) {
+            opcoes->arquivoMapa = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            char* fim;
+            opcoes->semente = strtoull(argv[++i], &fim, 10);
+            if (fim == argv[i] || *fim != '\0') {
+                printf("[ERRO] Semente invalida '%s'.\n", argv[i]);
+                return 0;
+            }
+        } else if (strcmp(argv[i], "--blitz") == 0) {
+            opcoes->simulacao.blitz = 1;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, MAX_THREADS_SIMULACAO, &valor)) return 0;
+            opcoes->simulacao.numThreads = (int)valor;
+        } else if (strcmp(argv[i], "--turnos") == 0 && i + 1 < argc) {
+            if (!lerArgumentoInteiro(argv[++i], 1, 1000000, &valor)) return 0;
+            opcoes->simulacao.maxTurnos = (int)valor;
+        } else {
+            printf("[ERRO] Argumento desconhecido ou incompleto: %s\n", argv[i]);
+            return 0;
         }
-        printf("%s=============================================%s\n", COR_AMARELO_NEGRITO, COR_RESET);
     }
+    
+    if (opcoes->arquivoGravacao != NULL && opcoes->arquivoReplay != NULL) {
+        printf("[ERRO] --gravar e --replay nao podem ser usados juntos.\n");
+        return 0;
+    }
+    if (opcoes->arquivoCarregar != NULL && (opcoes->arquivoGravacao != NULL || opcoes->arquivoReplay != NULL)) {
+        // O log reexecuta a partida desde a semente; uma partida retomada não tem esse começo
+        printf("[ERRO] --carregar nao pode ser usado com --gravar ou --replay.\n");
+        return 0;
+    }
+    if (opcoes->arquivoConfig != NULL && (opcoes->arquivoCarregar != NULL || opcoes->arquivoGravacao != NULL ||
+                                          opcoes->arquivoReplay != NULL)) {
+        // O log refaz o cadastro desde a semente; a configuração não passa por ele
+        printf("[ERRO] --config nao pode ser usado com --carregar, --gravar ou --replay.\n");
+        return 0;
+    }
+    if (opcoes->simulacao.arquivoEventos != NULL && !opcoes->modoSimulacao) {
+        printf("[ERRO] --eventos so pode ser usado com --simular.\n");
+        return 0;
+    }
+    if (opcoes->enderecoServidor != NULL && (opcoes->modoSimulacao || opcoes->arquivoReplay != NULL ||
+                                             opcoes->arquivoGravacao != NULL || opcoes->arquivoCarregar != NULL)) {
+        printf("[ERRO] --servidor nao pode ser usado com --simular, --replay, --gravar ou --carregar.\n");
+        return 0;
+    }
+    
+    opcoes->simulacao.semente = opcoes->semente;
+    opcoes->ia.semente = sementeDaPartida(opcoes->semente, UINT64_MAX); // Fluxo próprio da IA
+    if (opcoes->simulacao.numJogadores > opcoes->simulacao.numTerritorios) {
+        opcoes->simulacao.numJogadores = opcoes->simulacao.numTerritorios;
+    }
+    return 1;
+}
+
+int lerArgumentoInteiro(const char* texto, long minimo, long maximo, long* destino) {
+    char* fim;
+    long valor = strtol(texto, &fim, 10);
+    if (fim == texto || *fim != '\0' || valor < minimo || valor > maximo) {
+        printf("[ERRO] Valor invalido '%s' (esperado entre %ld e %ld).\n", texto, minimo, maximo);
+        return 0;
+    }
+    *destino = valor;
+    return 1;
+}
+
+void exibirUso(const char* nomePrograma) {
+    printf("\nUso: %s [opcoes]\n", nomePrograma);
+    printf("Sem opcoes, inicia o jogo interativo.\n\n");
+    printf("  --simular N       Joga N partidas automaticas sem interface e exibe estatisticas\n");
+    printf("  --territorios N   Territorios por partida simulada (%d-%d, padrao %d)\n",
+           MIN_TERRITORIOS, MAX_TERRITORIOS_SIMULACAO, NUM_TERRITORIOS_PREDEFINIDOS);
+    printf("  --jogadores N     Cores em jogo na simulacao (2-%d, padrao %d)\n",
+           NUM_CORES_PREDEFINIDAS, NUM_CORES_PREDEFINIDAS);
+    printf("  --turnos N        Limite de turnos por partida simulada (padrao %d)\n", MAX_TURNOS_MASTER);
+    printf("  --threads N       Trabalhadores da simulacao (1-%d, padrao: numero de processadores)\n",
+           MAX_THREADS_SIMULACAO);
+    printf("  --blitz           Na simulacao, cada ataque escolhido e resolvido ate o fim de uma vez\n");
+    printf("  --eventos ARQUIVO Na simulacao, grava cada ataque, reforco, missao e fim de partida em um\n");
+    printf("                    log binario de registros fixos (analise: analisar_eventos ARQUIVO)\n");
+    printf("  --mapa ARQUIVO    Carrega continentes, territorios e fronteiras de ARQUIVO\n");
+    printf("                    (a simulacao passa a usar esse mapa em vez de --territorios)\n");
+    printf("  --verbosidade N   Detalhe do jogo interativo: 0 = sem dados, 1 = dados e duelos (padrao),\n");
+    printf("                    2 = mapa completo a cada jogada (senao, so as linhas alteradas)\n");
+    printf("  --relatorio-memoria  Exibe a memoria ocupada por um mapa de --territorios N territorios\n");
+    printf("  --seed S          Semente do gerador aleatorio (repete exatamente o mesmo jogo)\n");
+    printf("  --gravar ARQUIVO  Grava a semente e todas as decisoes do jogo interativo\n");
+    printf("  --replay ARQUIVO  Reexecuta uma partida gravada, sem interface (use o mesmo --mapa)\n");
+    printf("  --ate-turno N     Com --replay, para no inicio do turno N e exibe o mapa\n");
+    printf("  --passo           Com --replay, exibe e pausa a cada decisao\n");
+    printf("  --ia              No Nivel Master, os demais exercitos sao comandados pelo computador (MCTS)\n");
+    printf("  --ia-tempo MS     Prazo da IA por jogada em milissegundos (padrao %d)\n", TEMPO_IA_PADRAO_MS);
+    printf("  --ia-threads N    Buscas paralelas da IA (1-%d, padrao: numero de processadores)\n", MAX_THREADS_IA);
+    printf("  --salvar ARQUIVO  Salva a partida Master em ARQUIVO ao fim de cada turno\n");
+    printf("  --carregar ARQUIVO  Retoma a partida Master salva (com --simular, todas as\n");
+    printf("                    partidas automaticas partem dessa posicao)\n");
+    printf("  --config ARQUIVO  Inicia o Nivel Master na posicao declarada em ARQUIVO, sem cadastro (com\n");
+    printf("                    --simular, todas as partidas automaticas partem dessa posicao)\n");
+    printf("  --servidor ENDERECO  Hospeda partidas Master para varios clientes ao mesmo tempo, uma por\n");
+    printf("                    conexao (ENDERECO = porta TCP em 127.0.0.1 ou unix:CAMINHO; so Linux)\n");
+    printf("  --tabela-batalha N  Exibe (CSV) as probabilidades exatas de batalha ate N tropas por lado\n");
+    printf("  --conferir-dados N  Resolve N rodadas em lote (SIMD e escalar), confere e mede a vazao\n");
+    printf("  --metricas-json ARQUIVO  Ao sair, grava contadores, tempos de fase e histogramas em JSON\n");
 }